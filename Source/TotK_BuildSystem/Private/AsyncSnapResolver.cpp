@@ -0,0 +1,98 @@
+#include "AsyncSnapResolver.h"
+#include "MoveableObject.h"
+#include "SnapPointComponent.h"
+#include "BuildSystemMath.h"
+#include "BuildSystemStats.h"
+
+// Take a snapshot of a part's transform, collision proxy and snap point locations
+void FSnapPartSnapshot::Capture(AMoveableObject* InPart)
+{
+	Part = InPart;
+	Transform = InPart->MeshComponent->GetComponentTransform();
+	CollisionProxy = InPart->GetCollisionProxy();
+
+	SnapPoints.Reset();
+	SnapLocations.Reset();
+	for (USnapPointComponent* SnapPoint : InPart->SnapPoints) {
+		if (!SnapPoint) continue;
+
+		SnapPoints.Add(SnapPoint);
+		SnapLocations.Add(SnapPoint->GetComponentLocation());
+	}
+}
+
+// Get the closest point to a world point on the part's collision proxy, or the point itself if it is inside it
+FVector FSnapPartSnapshot::GetClosestPointOnCollision(const FVector& Point) const
+{
+	return CollisionProxy ? CollisionProxy->GetClosestPoint(Transform, Point) : Transform.GetLocation();
+}
+
+// Snapshot the held and nearby parts and start resolving their snap points on a worker thread, unless the previous resolution is still running
+bool FAsyncSnapResolver::Launch(AMoveableObject* HeldObject, AMoveableObject* NearbyObject, float InSnapSearchRadius)
+{
+	if (IsBusy()) return false;
+
+	HeldSnapshot.Capture(HeldObject);
+	NearbySnapshot.Capture(NearbyObject);
+	SnapSearchRadius = InSnapSearchRadius;
+
+	// The task keeps the resolver alive, so a session can end while its last resolution is still running
+	TSharedRef<FAsyncSnapResolver, ESPMode::ThreadSafe> Self = AsShared();
+	const uint64 SnapshotFrame = GFrameCounter;
+	Task = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Self, SnapshotFrame]() {
+		Resolve(Self->HeldSnapshot, Self->NearbySnapshot, Self->SnapSearchRadius, Self->Result);
+		Self->Result.SnapshotFrame = SnapshotFrame;
+		Self->bHasResult = true;
+	});
+
+	return true;
+}
+
+// Take the result of the last resolution if it has finished and has not been taken yet
+bool FAsyncSnapResolver::TryTakeResult(FSnapResolution& OutResult)
+{
+	if (!Task.IsValid() || !Task.IsCompleted() || !bHasResult) return false;
+
+	OutResult = Result;
+	bHasResult = false;
+	return true;
+}
+
+// Resolve the snap points of a held and nearby part from their snapshots. Safe to call from any thread
+void FAsyncSnapResolver::Resolve(const FSnapPartSnapshot& Held, const FSnapPartSnapshot& Nearby, float SnapSearchRadius, FSnapResolution& OutResult)
+{
+	SCOPE_CYCLE_COUNTER(STAT_BuildSystem_ResolveSnapPoints);
+
+	OutResult.HeldObject = Held.Part;
+	OutResult.NearbyObject = Nearby.Part;
+
+	// Anchor all snap math on the held part so it can be done in float without losing precision far from the world origin
+	const FVector HeldFuseObjectCenter = Held.Transform.GetLocation();
+	const BuildSystemMath::FGroupFrame FuseFrame(HeldFuseObjectCenter);
+	OutResult.FuseFrameOrigin = FuseFrame.Origin;
+
+	// Get the closest points between the two parts, starting from the held part's center in the same way as the synchronous path
+	FVector OtherClosestFusionPoint = Nearby.GetClosestPointOnCollision(HeldFuseObjectCenter);
+	const FVector HeldClosestFusionPoint = Held.GetClosestPointOnCollision(OtherClosestFusionPoint);
+	OtherClosestFusionPoint = Nearby.GetClosestPointOnCollision(HeldClosestFusionPoint);
+
+	const FVector3f HeldLocalFusionPoint = FuseFrame.ToLocal(HeldClosestFusionPoint);
+	const FVector3f OtherLocalFusionPoint = FuseFrame.ToLocal(OtherClosestFusionPoint);
+	const float SearchRadiusSquared = SnapSearchRadius * SnapSearchRadius;
+
+	// Get the closest snap point within the search radius of each collision point, keeping the first snap point found if there are any ties
+	auto FindClosestSnapPoint = [&FuseFrame, SearchRadiusSquared](const FSnapPartSnapshot& Snapshot, const FVector3f& TestPoint) -> USnapPointComponent* {
+		TArray<FVector3f, TInlineAllocator<16>> LocalSnapLocations;
+		for (const FVector& SnapLocation : Snapshot.SnapLocations) {
+			LocalSnapLocations.Add(FuseFrame.ToLocal(SnapLocation));
+		}
+
+		const int32 ClosestIndex = BuildSystemMath::FindClosestPoint<FVector3f>(LocalSnapLocations, TestPoint, SearchRadiusSquared);
+		return ClosestIndex != INDEX_NONE ? Snapshot.SnapPoints[ClosestIndex] : nullptr;
+	};
+
+	OutResult.HeldSnapComp = FindClosestSnapPoint(Held, HeldLocalFusionPoint);
+	OutResult.OtherSnapComp = FindClosestSnapPoint(Nearby, OtherLocalFusionPoint);
+	OutResult.HeldLocalCollisionPoint = Held.Transform.InverseTransformPosition(HeldClosestFusionPoint);
+	OutResult.OtherLocalCollisionPoint = Nearby.Transform.InverseTransformPosition(OtherClosestFusionPoint);
+}
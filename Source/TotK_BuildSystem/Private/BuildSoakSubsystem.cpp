@@ -0,0 +1,219 @@
+#include "BuildSoakSubsystem.h"
+#include "BuilderBot.h"
+#include "MoveableObject.h"
+#include "BuildSystemSubsystem.h"
+#include "BuildSystemStats.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "Engine/World.h"
+#include "CoreGlobals.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+// Only create the subsystem when the command line asks for a soak test
+bool UBuildSoakSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	int32 NumBots = 0;
+	return FParse::Value(FCommandLine::Get(), TEXT("BuildSoak="), NumBots) && NumBots > 0 && Super::ShouldCreateSubsystem(Outer);
+}
+
+// Soak tests only run in game worlds
+bool UBuildSoakSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+// Read the soak settings from the command line and start timing physics
+void UBuildSoakSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	float Minutes = 0.f;
+	FParse::Value(FCommandLine::Get(), TEXT("BuildSoak="), NumBotsToSpawn);
+	FParse::Value(FCommandLine::Get(), TEXT("SoakMinutes="), Minutes);
+	FParse::Value(FCommandLine::Get(), TEXT("SoakReportSeconds="), ReportSeconds);
+	FParse::Value(FCommandLine::Get(), TEXT("SoakSeed="), RandomSeed);
+	RunSeconds = Minutes * 60.0;
+	ReportSeconds = FMath::Max(ReportSeconds, 1.0);
+
+	// Each server writes its own file, so several can run side by side on one machine
+	ReportFilename = FPaths::ProfilingDir() / FString::Printf(TEXT("BuildSoak-%d-%s.csv"), InWorld.URL.Port, *FDateTime::Now().ToString());
+	FFileHelper::SaveStringToFile(TEXT("Seconds,Frames,AvgFrameMs,MaxFrameMs,GameThreadMs,PhysicsMs,Parts,Groups,Links,Sessions,Bots,Clients,Grabs,Releases\n"), *ReportFilename);
+
+	// Physics is timed from the start of the physics scene's frame to its end, which includes any game thread work done while physics runs
+	if (FPhysScene_Chaos* PhysScene = InWorld.GetPhysicsScene()) {
+		PreTickHandle = PhysScene->OnPhysScenePreTick.AddUObject(this, &UBuildSoakSubsystem::OnPhysScenePreTick);
+		PostTickHandle = PhysScene->OnPhysScenePostTick.AddUObject(this, &UBuildSoakSubsystem::OnPhysScenePostTick);
+	}
+
+	StartTime = FPlatformTime::Seconds();
+	NextReportTime = StartTime + ReportSeconds;
+	UE_LOG(LogTemp, Display, TEXT("Build soak started with %d bots for %.0f minutes, reporting to %s"), NumBotsToSpawn, Minutes, *ReportFilename);
+}
+
+// Stop timing physics and write the summary of the run
+void UBuildSoakSubsystem::Deinitialize()
+{
+	if (FPhysScene_Chaos* PhysScene = GetWorld()->GetPhysicsScene()) {
+		PhysScene->OnPhysScenePreTick.Remove(PreTickHandle);
+		PhysScene->OnPhysScenePostTick.Remove(PostTickHandle);
+	}
+
+	if (StartTime > 0.0) {
+		WriteSummary();
+	}
+
+	Super::Deinitialize();
+}
+
+// Spawn the bots once the world has parts, time the frame and write a report row whenever one is due, exiting once the run is over
+void UBuildSoakSubsystem::Tick(float DeltaTime)
+{
+	UBuildSystemSubsystem* BuildSystem = GetWorld()->GetSubsystem<UBuildSystemSubsystem>();
+	if (StartTime <= 0.0 || !BuildSystem) return;
+
+	// Parts register themselves as they begin play, which is after the world has told subsystems it has begun
+	if (Bots.Num() == 0 && BuildSystem->GetPartRegistry().Num() > 0) {
+		SpawnBots();
+	}
+
+	// Without any clients connected nothing keeps parts at full fidelity, so the bots stand in as viewers
+	TArray<FVector, TInlineAllocator<64>> ViewerLocations;
+	if (GetWorld()->GetNumPlayerControllers() == 0) {
+		for (const ABuilderBot* Bot : Bots) {
+			if (IsValid(Bot)) {
+				ViewerLocations.Add(Bot->GetActorLocation());
+			}
+		}
+	}
+	BuildSystem->SetVirtualViewers(ViewerLocations);
+
+	++NumFrames;
+	FrameSeconds += DeltaTime;
+	MaxFrameSeconds = FMath::Max(MaxFrameSeconds, (double)DeltaTime);
+	GameThreadSeconds += FPlatformTime::ToSeconds(GGameThreadTime);
+
+	const double Now = FPlatformTime::Seconds();
+	if (Now >= NextReportTime) {
+		WriteReport();
+		NextReportTime = Now + ReportSeconds;
+	}
+
+	if (RunSeconds > 0.0 && Now - StartTime >= RunSeconds && !bSummaryWritten) {
+		WriteSummary();
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+// Get the stat used to track the time spent ticking the subsystem
+TStatId UBuildSoakSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UBuildSoakSubsystem, STATGROUP_BuildSystem);
+}
+
+// Spawn bots around random parts in the world
+void UBuildSoakSubsystem::SpawnBots()
+{
+	const FPartRegistry& Registry = GetWorld()->GetSubsystem<UBuildSystemSubsystem>()->GetPartRegistry();
+	FRandomStream RandomStream(RandomSeed);
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	for (int32 i = 0; i < NumBotsToSpawn; ++i) {
+		const FVector PartLocation = Registry.Locations[RandomStream.RandRange(0, Registry.Num() - 1)];
+		const FVector Offset = FRotator(0.f, RandomStream.FRandRange(0.f, 360.f), 0.f).Vector() * 500.f + FVector(0.f, 0.f, 100.f);
+
+		if (ABuilderBot* Bot = GetWorld()->SpawnActor<ABuilderBot>(PartLocation + Offset, FRotator::ZeroRotator, SpawnParams)) {
+			Bot->SetRandomSeed(RandomSeed + i + 1);
+			Bots.Add(Bot);
+		}
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Build soak spawned %d bots around %d parts"), Bots.Num(), Registry.Num());
+}
+
+// Write a row of the timings gathered since the last report along with the current state of the build system, then start gathering again
+void UBuildSoakSubsystem::WriteReport()
+{
+	// The build system may already be gone when the summary is written as the world is torn down
+	const UBuildSystemSubsystem* BuildSystem = GetWorld()->GetSubsystem<UBuildSystemSubsystem>();
+	if (!BuildSystem) return;
+
+	const FPartRegistry& Registry = BuildSystem->GetPartRegistry();
+
+	// Group ids are only counted when reporting, so the count does not depend on the stats system being compiled in
+	TSet<int32> GroupIds;
+	GroupIds.Append(Registry.GroupIds);
+
+	int32 NumGrabs = 0;
+	int32 NumReleases = 0;
+	for (const ABuilderBot* Bot : Bots) {
+		if (IsValid(Bot)) {
+			NumGrabs += Bot->GetNumGrabs();
+			NumReleases += Bot->GetNumReleases();
+		}
+	}
+
+	const double Frames = FMath::Max(NumFrames, 1);
+	const double Elapsed = FPlatformTime::Seconds() - StartTime;
+	const FString Row = FString::Printf(TEXT("%.1f,%d,%.3f,%.3f,%.3f,%.3f,%d,%d,%d,%d,%d,%d,%d,%d\n"),
+		Elapsed, NumFrames, FrameSeconds * 1000.0 / Frames, MaxFrameSeconds * 1000.0, GameThreadSeconds * 1000.0 / Frames, PhysicsSeconds * 1000.0 / Frames,
+		Registry.Num(), GroupIds.Num(), BuildSystem->GetLinkTable().Num(), BuildSystem->GetNumSessions(), Bots.Num(), GetWorld()->GetNumPlayerControllers(), NumGrabs, NumReleases);
+
+	FFileHelper::SaveStringToFile(Row, *ReportFilename, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+	UE_LOG(LogTemp, Display, TEXT("Build soak %.0fs: frame %.2f ms (max %.2f), game thread %.2f ms, physics %.2f ms, %d parts in %d groups, %d grabs"),
+		Elapsed, FrameSeconds * 1000.0 / Frames, MaxFrameSeconds * 1000.0, GameThreadSeconds * 1000.0 / Frames, PhysicsSeconds * 1000.0 / Frames, Registry.Num(), GroupIds.Num(), NumGrabs);
+
+	TotalFrames += NumFrames;
+	TotalFrameSeconds += FrameSeconds;
+	TotalMaxFrameSeconds = FMath::Max(TotalMaxFrameSeconds, MaxFrameSeconds);
+	TotalPhysicsSeconds += PhysicsSeconds;
+
+	NumFrames = 0;
+	FrameSeconds = 0.0;
+	MaxFrameSeconds = 0.0;
+	GameThreadSeconds = 0.0;
+	PhysicsSeconds = 0.0;
+}
+
+// Add a summary of the whole run to the file of every soak run, so runs can be compared
+void UBuildSoakSubsystem::WriteSummary()
+{
+	if (bSummaryWritten) return;
+	bSummaryWritten = true;
+
+	// Fold in any frames since the last report
+	WriteReport();
+
+	const double Frames = FMath::Max<double>(TotalFrames, 1);
+	const double Minutes = (FPlatformTime::Seconds() - StartTime) / 60.0;
+	const int32 NumParts = GetWorld()->GetSubsystem<UBuildSystemSubsystem>() ? GetWorld()->GetSubsystem<UBuildSystemSubsystem>()->GetPartRegistry().Num() : 0;
+	UE_LOG(LogTemp, Display, TEXT("Build soak finished after %.1f minutes: %lld frames, %.3f ms per frame (max %.2f), %.3f ms physics per frame, %d parts"),
+		Minutes, TotalFrames, TotalFrameSeconds * 1000.0 / Frames, TotalMaxFrameSeconds * 1000.0, TotalPhysicsSeconds * 1000.0 / Frames, NumParts);
+
+	const FString ResultsFilename = FPaths::ProfilingDir() / TEXT("BuildSoaks.csv");
+	if (!FPaths::FileExists(ResultsFilename)) {
+		FFileHelper::SaveStringToFile(TEXT("Date,Port,Bots,Minutes,Frames,AvgFrameMs,MaxFrameMs,PhysicsMs,Parts,Report\n"), *ResultsFilename);
+	}
+	FFileHelper::SaveStringToFile(FString::Printf(TEXT("%s,%d,%d,%.1f,%lld,%.3f,%.3f,%.3f,%d,%s\n"), *FDateTime::Now().ToString(), GetWorld()->URL.Port, Bots.Num(), Minutes, TotalFrames,
+		TotalFrameSeconds * 1000.0 / Frames, TotalMaxFrameSeconds * 1000.0, TotalPhysicsSeconds * 1000.0 / Frames, NumParts, *FPaths::GetCleanFilename(ReportFilename)),
+		*ResultsFilename, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+}
+
+// Physics scene callbacks, timing how long physics takes each frame
+void UBuildSoakSubsystem::OnPhysScenePreTick(FPhysScene_Chaos* PhysScene, float DeltaSeconds)
+{
+	PhysicsStartTime = FPlatformTime::Seconds();
+}
+
+void UBuildSoakSubsystem::OnPhysScenePostTick(FPhysScene_Chaos* PhysScene)
+{
+	if (PhysicsStartTime > 0.0) {
+		PhysicsSeconds += FPlatformTime::Seconds() - PhysicsStartTime;
+		PhysicsStartTime = 0.0;
+	}
+}
@@ -0,0 +1,127 @@
+#include "BuildSystemStats.h"
+#include "MoveableObject.h"
+#include "BuildSystemSubsystem.h"
+
+DEFINE_STAT(STAT_BuildSystem_Tick);
+DEFINE_STAT(STAT_BuildSystem_GetClosestMoveableObjectInRadius);
+DEFINE_STAT(STAT_BuildSystem_UpdateSnapPoints);
+DEFINE_STAT(STAT_BuildSystem_InterpFusedObjects);
+DEFINE_STAT(STAT_BuildSystem_AddPhysicsConstraint);
+DEFINE_STAT(STAT_BuildSystem_MergeMoveableObjects);
+DEFINE_STAT(STAT_BuildSystem_SplitMoveableObjects);
+DEFINE_STAT(STAT_BuildSystem_UpdateFusedSet);
+DEFINE_STAT(STAT_BuildSystem_GrabberTick);
+DEFINE_STAT(STAT_BuildSystem_RefreshPartRegistry);
+DEFINE_STAT(STAT_BuildSystem_ResolveSnapPoints);
+DEFINE_STAT(STAT_BuildSystem_UpdateGroupSleep);
+DEFINE_STAT(STAT_BuildSystem_UpdateSignificance);
+DEFINE_STAT(STAT_BuildSystem_UpdateInstances);
+DEFINE_STAT(STAT_BuildSystem_FreezeGroup);
+DEFINE_STAT(STAT_BuildSystem_UnfreezeGroup);
+DEFINE_STAT(STAT_BuildSystem_RunDeferredWork);
+DEFINE_STAT(STAT_BuildSystem_CaptureStructuralStress);
+DEFINE_STAT(STAT_BuildSystem_SolveStructuralStress);
+
+DEFINE_STAT(STAT_BuildSystem_Parts);
+DEFINE_STAT(STAT_BuildSystem_Groups);
+DEFINE_STAT(STAT_BuildSystem_Links);
+DEFINE_STAT(STAT_BuildSystem_PooledParts);
+DEFINE_STAT(STAT_BuildSystem_FrozenGroups);
+
+DEFINE_STAT(STAT_BuildSystem_CandidatesTested);
+DEFINE_STAT(STAT_BuildSystem_TracesIssued);
+DEFINE_STAT(STAT_BuildSystem_MIDsCreated);
+DEFINE_STAT(STAT_BuildSystem_SnapLatencyFrames);
+DEFINE_STAT(STAT_BuildSystem_AwakeBodies);
+DEFINE_STAT(STAT_BuildSystem_AwakeGroups);
+DEFINE_STAT(STAT_BuildSystem_ReducedParts);
+DEFINE_STAT(STAT_BuildSystem_InstancedParts);
+DEFINE_STAT(STAT_BuildSystem_DeferredWork);
+DEFINE_STAT(STAT_BuildSystem_DeferredWorkParts);
+DEFINE_STAT(STAT_BuildSystem_StressParts);
+
+// Scoping allocations to these tags also tags them in Memory Insights
+LLM_DEFINE_TAG(BuildSystem);
+LLM_DEFINE_TAG(BuildSystem_FusedSets);
+LLM_DEFINE_TAG(BuildSystem_Links);
+LLM_DEFINE_TAG(BuildSystem_SnapPoints);
+LLM_DEFINE_TAG(BuildSystem_Components);
+LLM_DEFINE_TAG(BuildSystem_Materials);
+
+UE_TRACE_CHANNEL_DEFINE(BuildSystemChannel);
+
+UE_TRACE_EVENT_BEGIN(BuildSystem, FuseSessionBegin)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, HeldGroupSize)
+	UE_TRACE_EVENT_FIELD(uint32, OtherGroupSize)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(BuildSystem, FuseSessionEnd)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, MergedGroupSize)
+UE_TRACE_EVENT_END()
+
+// A held group was released next to another group and started fusing with it
+void BuildSystemTrace::FuseSessionBegin(uint32 HeldGroupSize, uint32 OtherGroupSize)
+{
+	UE_TRACE_LOG(BuildSystem, FuseSessionBegin, BuildSystemChannel)
+		<< FuseSessionBegin.Cycle(FPlatformTime::Cycles64())
+		<< FuseSessionBegin.HeldGroupSize(HeldGroupSize)
+		<< FuseSessionBegin.OtherGroupSize(OtherGroupSize);
+}
+
+// A fuse finished, leaving a merged group of the given size
+void BuildSystemTrace::FuseSessionEnd(uint32 MergedGroupSize)
+{
+	UE_TRACE_LOG(BuildSystem, FuseSessionEnd, BuildSystemChannel)
+		<< FuseSessionEnd.Cycle(FPlatformTime::Cycles64())
+		<< FuseSessionEnd.MergedGroupSize(MergedGroupSize);
+}
+
+// Gather the memory used by every moveable object in a world
+FBuildSystemMemoryUsage FBuildSystemMemoryUsage::Gather(UWorld* World)
+{
+	FBuildSystemMemoryUsage Usage;
+	UBuildSystemSubsystem* Subsystem = World ? World->GetSubsystem<UBuildSystemSubsystem>() : nullptr;
+	if (!Subsystem) return Usage;
+
+	for (AMoveableObject* Part : Subsystem->GetPartRegistry().Parts) {
+		Part->AccumulateMemoryUsage(Usage);
+	}
+
+	Subsystem->AccumulateMemoryUsage(Usage);
+
+	return Usage;
+}
+
+// Get the size of an object along with any memory it owns
+SIZE_T BuildSystemStats::GetObjectBytes(UObject* Object)
+{
+	return Object ? Object->GetClass()->GetStructureSize() + Object->GetResourceSizeBytes(EResourceSizeMode::Exclusive) : 0;
+}
+
+// Print the memory used by build system state, in total, per part and per link
+static void PrintBuildSystemMemReport(const TArray<FString>& Args, UWorld* World)
+{
+	const FBuildSystemMemoryUsage Usage = FBuildSystemMemoryUsage::Gather(World);
+	const double KiB = 1024.0;
+
+	UE_LOG(LogTemp, Display, TEXT("BuildSystem memory: %d parts, %d links"), Usage.NumParts, Usage.NumLinks);
+	UE_LOG(LogTemp, Display, TEXT("  Fused sets:  %.1f KiB"), Usage.FusedSetBytes / KiB);
+	UE_LOG(LogTemp, Display, TEXT("  Snap points: %.1f KiB"), Usage.SnapPointBytes / KiB);
+	UE_LOG(LogTemp, Display, TEXT("  Components:  %.1f KiB"), Usage.ComponentBytes / KiB);
+	UE_LOG(LogTemp, Display, TEXT("  Materials:   %.1f KiB"), Usage.MaterialBytes / KiB);
+	UE_LOG(LogTemp, Display, TEXT("  Links:       %.1f KiB"), Usage.LinkBytes / KiB);
+	UE_LOG(LogTemp, Display, TEXT("  Sessions:    %.1f KiB"), Usage.SessionBytes / KiB);
+	UE_LOG(LogTemp, Display, TEXT("  Registry:    %.1f KiB"), Usage.RegistryBytes / KiB);
+	UE_LOG(LogTemp, Display, TEXT("  Proxies:     %.1f KiB"), Usage.ProxyBytes / KiB);
+	UE_LOG(LogTemp, Display, TEXT("  Bytes per part: %.0f"), Usage.NumParts > 0 ? (double)Usage.GetPartBytes() / Usage.NumParts : 0.0);
+	UE_LOG(LogTemp, Display, TEXT("  Bytes per link: %.0f"), Usage.NumLinks > 0 ? (double)Usage.LinkBytes / Usage.NumLinks : 0.0);
+}
+
+// Console command - BuildSystem.MemReport
+static FAutoConsoleCommandWithWorldAndArgs BuildSystemMemReportCommand(
+	TEXT("BuildSystem.MemReport"),
+	TEXT("Print the memory used by build system state, in total, per part and per link"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&PrintBuildSystemMemReport)
+);
@@ -0,0 +1,457 @@
+#include "BuildSystemSubsystem.h"
+#include "MoveableObject.h"
+#include "BuildSystemStats.h"
+#include "AsyncSnapResolver.h"
+#include "GameFramework/PlayerController.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Misc/CoreDelegates.h"
+
+// Put fused groups to sleep together once every member has settled
+static TAutoConsoleVariable<bool> CVarGroupSleep(
+	TEXT("BuildSystem.GroupSleep"),
+	true,
+	TEXT("Put fused groups to sleep together once every member has settled"));
+
+// Linear speed below which a part counts as settled
+static TAutoConsoleVariable<float> CVarGroupSleepLinearThreshold(
+	TEXT("BuildSystem.GroupSleepLinearThreshold"),
+	5.f,
+	TEXT("Linear speed in cm/s below which a part counts as settled"));
+
+// Angular speed below which a part counts as settled
+static TAutoConsoleVariable<float> CVarGroupSleepAngularThreshold(
+	TEXT("BuildSystem.GroupSleepAngularThreshold"),
+	5.f,
+	TEXT("Angular speed in degrees/s below which a part counts as settled"));
+
+// Frames every member of a group has to stay settled before the group is put to sleep
+static TAutoConsoleVariable<int32> CVarGroupSleepFrames(
+	TEXT("BuildSystem.GroupSleepFrames"),
+	30,
+	TEXT("Frames every member of a group has to stay settled before the group is put to sleep"));
+
+// Reduce idle groups far from every viewer to low fidelity
+static TAutoConsoleVariable<bool> CVarSignificance(
+	TEXT("BuildSystem.Significance"),
+	true,
+	TEXT("Reduce idle groups far from every viewer to low fidelity"));
+
+// Distance from the closest viewer beyond which idle groups are reduced
+static TAutoConsoleVariable<float> CVarSignificanceReduceDistance(
+	TEXT("BuildSystem.SignificanceReduceDistance"),
+	5000.f,
+	TEXT("Distance in cm from the closest viewer beyond which idle groups are reduced to low fidelity"));
+
+// Distance inside the reduce distance a viewer has to come before a group returns to full fidelity, so groups on the boundary do not switch every frame
+static TAutoConsoleVariable<float> CVarSignificanceHysteresis(
+	TEXT("BuildSystem.SignificanceHysteresis"),
+	500.f,
+	TEXT("Distance in cm inside the reduce distance a viewer has to come before a group returns to full fidelity"));
+
+// Draw parts sharing a mesh and material through a single instanced static mesh instead of their own mesh components
+static TAutoConsoleVariable<bool> CVarInstancedRendering(
+	TEXT("BuildSystem.InstancedRendering"),
+	false,
+	TEXT("Draw parts sharing a mesh and material through a single instanced static mesh instead of their own mesh components"));
+
+// Number of fuse and split decisions kept by the flight recorder, where 0 stops recording
+static TAutoConsoleVariable<int32> CVarFlightRecorderSize(
+	TEXT("BuildSystem.FlightRecorderSize"),
+	4096,
+	TEXT("Number of fuse and split decisions kept by the flight recorder. 0 stops recording"));
+
+// Start dumping the flight recorder whenever an ensure fails
+void UBuildSystemSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	FlightRecorder.Init(CVarFlightRecorderSize.GetValueOnGameThread());
+	EnsureHandle = FCoreDelegates::OnHandleSystemEnsure.AddUObject(this, &UBuildSystemSubsystem::OnSystemEnsure);
+}
+
+// Stop dumping the flight recorder on ensures
+void UBuildSystemSubsystem::Deinitialize()
+{
+	FCoreDelegates::OnHandleSystemEnsure.Remove(EnsureHandle);
+
+	// Queued work and the stress snapshot point at parts that are going away with the world
+	DeferredWork.Reset();
+	StructuralStress.Reset();
+
+	Super::Deinitialize();
+}
+
+// Refresh the part registry from physics and update group sleep and significance, then tick every active fuse session, removing any that have finished, update structural stress, run deferred work and update part instances
+void UBuildSystemSubsystem::Tick(float DeltaTime)
+{
+	// The ring is only resized when its size is changed, which drops the events already recorded
+	const int32 FlightRecorderSize = FMath::Max(CVarFlightRecorderSize.GetValueOnGameThread(), 0);
+	if (FlightRecorder.GetCapacity() != FlightRecorderSize) {
+		FlightRecorder.Init(FlightRecorderSize);
+	}
+
+	PartRegistry.Refresh();
+	UpdateGroupSleep();
+	UpdateSignificance();
+
+	for (int32 Index = Sessions.Num() - 1; Index >= 0; --Index) {
+		FFuseSession& Session = Sessions[Index];
+
+		// Stop tracking the session if the held object was destroyed or the session has finished
+		if (!IsValid(Session.HeldObject) || !Session.IsActive()) {
+			Sessions.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+			continue;
+		}
+
+		Session.HeldObject->TickFuseSession(Session, DeltaTime);
+	}
+
+	// Links broken by stress queue the rebuild of their groups, which is started with the rest of the deferred work
+	StructuralStress.Update(*this);
+
+	// Deferred highlights are applied before instancing, which leaves highlighted parts on their own mesh components
+	DeferredWork.Run(*this);
+
+	// Parts go back to their own mesh components once instanced rendering is turned off
+	if (CVarInstancedRendering.GetValueOnGameThread()) {
+		InstancedRenderer.Update(GetWorld(), PartRegistry);
+	}
+
+	else if (InstancedRenderer.NumBatches() > 0) {
+		InstancedRenderer.Reset(PartRegistry);
+	}
+}
+
+// Get the stat used to track the time spent ticking the subsystem
+TStatId UBuildSystemSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UBuildSystemSubsystem, STATGROUP_BuildSystem);
+}
+
+// Start a new fuse session for an object that has been grabbed, replacing any previous session for the same object.
+// Sessions are stored by value, so starting one may move every other session and any session pointer or reference held across it must be found again
+FFuseSession& UBuildSystemSubsystem::BeginSession(AMoveableObject* HeldObject)
+{
+	LLM_SCOPE_BYTAG(BuildSystem);
+
+	FFuseSession* Session = FindSession(HeldObject);
+	if (!Session) {
+		Session = &Sessions.AddDefaulted_GetRef();
+	}
+
+	// Keep the overlay materials and scratch memory of a previous session, as they can be reused
+	UMaterialInstanceDynamic* HeldOverlayMat = Session->HeldOverlayMat;
+	UMaterialInstanceDynamic* NearbyOverlayMat = Session->NearbyOverlayMat;
+	FFuseCandidateSearch CandidateSearch = MoveTemp(Session->CandidateSearch);
+	TSharedPtr<FAsyncSnapResolver, ESPMode::ThreadSafe> SnapResolver = MoveTemp(Session->SnapResolver);
+
+	*Session = FFuseSession();
+	Session->HeldObject = HeldObject;
+	Session->ClosestFusedMoveableObject = HeldObject;
+	Session->HeldOverlayMat = HeldOverlayMat;
+	Session->NearbyOverlayMat = NearbyOverlayMat;
+	Session->CandidateSearch = MoveTemp(CandidateSearch);
+	Session->SnapResolver = MoveTemp(SnapResolver);
+	return *Session;
+}
+
+// Get the fuse session for a held object, if it has one. The pointer is only valid until the next session is started or the subsystem ticks
+FFuseSession* UBuildSystemSubsystem::FindSession(const AMoveableObject* HeldObject)
+{
+	return Sessions.FindByPredicate([HeldObject](const FFuseSession& Session) { return Session.HeldObject == HeldObject; });
+}
+
+// Get the fuse session of the object a grabber is holding, if it is holding one. The pointer is only valid until the next session is started or the subsystem ticks
+FFuseSession* UBuildSystemSubsystem::FindGrabberSession(const UObject* Grabber)
+{
+	return Sessions.FindByPredicate([Grabber](const FFuseSession& Session) { return Session.Grabber == Grabber && Session.bIsGrabbed; });
+}
+
+// Check if a part's group is held or being fused with by the fuse session of any object other than the given held object, in which case it cannot be grabbed or fused with
+bool UBuildSystemSubsystem::IsGroupLocked(const AMoveableObject* Part, const AMoveableObject* HeldObject) const
+{
+	TArray<int32, TInlineAllocator<16>> LockedGroupIds;
+	GetLockedGroupIds(HeldObject, LockedGroupIds);
+	return LockedGroupIds.Contains(PartRegistry.GetGroupId(Part));
+}
+
+// Check if a grabber cannot grab a part, as the part's own session belongs to another grabber or its group is held or being fused with by another object
+bool UBuildSystemSubsystem::IsGrabLocked(const AMoveableObject* Part, const UObject* Grabber) const
+{
+	// Group locks skip the part's own session, so grabbing the very object another grabber is holding or fusing would otherwise restart its session
+	for (const FFuseSession& Session : Sessions) {
+		if (Session.HeldObject == Part && Session.IsActive() && Session.Grabber != Grabber) return true;
+	}
+	return IsGroupLocked(Part, Part);
+}
+
+// Get the groups held or being fused with by the fuse sessions of every object other than the given held object
+void UBuildSystemSubsystem::GetLockedGroupIds(const AMoveableObject* HeldObject, TArray<int32, TInlineAllocator<16>>& OutGroupIds) const
+{
+	OutGroupIds.Reset();
+
+	// Locks are worked out from the sessions rather than stored, so they follow groups as they are merged and split
+	for (const FFuseSession& Session : Sessions) {
+		if (Session.HeldObject == HeldObject || !IsValid(Session.HeldObject) || !Session.IsActive()) continue;
+
+		OutGroupIds.AddUnique(PartRegistry.GetGroupId(Session.HeldObject));
+
+		// Only a fuse that has started locks the other group, any number of held objects can hover next to the same group
+		if (Session.bIsFusing && IsValid(Session.ClosestNearbyMoveableObject)) {
+			OutGroupIds.AddUnique(PartRegistry.GetGroupId(Session.ClosestNearbyMoveableObject));
+
+			for (const FFuseContact& Contact : Session.ExtraContacts) {
+				if (IsValid(Contact.NearbyObject)) {
+					OutGroupIds.AddUnique(PartRegistry.GetGroupId(Contact.NearbyObject));
+				}
+			}
+		}
+	}
+	OutGroupIds.Remove(INDEX_NONE);
+}
+
+// Finish any deferred work of a part's group, so its fused object sets and highlight are up to date before it is moved, split, merged or frozen
+void UBuildSystemSubsystem::FinishGroupWork(const AMoveableObject* Part)
+{
+	if (DeferredWork.Num() > 0) {
+		DeferredWork.FinishGroup(*this, PartRegistry.GetGroupId(Part));
+	}
+}
+
+// Start tracking a newly frozen group
+FFrozenGroup& UBuildSystemSubsystem::AddFrozenGroup(AMoveableObject* Anchor)
+{
+	LLM_SCOPE_BYTAG(BuildSystem);
+
+	FFrozenGroup& FrozenGroup = FrozenGroups.AddDefaulted_GetRef();
+	FrozenGroup.Anchor = Anchor;
+	INC_DWORD_STAT(STAT_BuildSystem_FrozenGroups);
+	return FrozenGroup;
+}
+
+// Get the frozen group an object belongs to, if its group is frozen
+FFrozenGroup* UBuildSystemSubsystem::FindFrozenGroup(const AMoveableObject* Member)
+{
+	return FrozenGroups.FindByPredicate([Member](const FFrozenGroup& FrozenGroup) { return FrozenGroup.Members.Contains(Member); });
+}
+
+// Stop tracking a frozen group once it has been unfrozen
+void UBuildSystemSubsystem::RemoveFrozenGroup(const AMoveableObject* Anchor)
+{
+	const int32 Index = FrozenGroups.IndexOfByPredicate([Anchor](const FFrozenGroup& FrozenGroup) { return FrozenGroup.Anchor == Anchor; });
+	if (Index != INDEX_NONE) {
+		FrozenGroups.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+		DEC_DWORD_STAT(STAT_BuildSystem_FrozenGroups);
+	}
+}
+
+// Write the flight recorder to Saved/FlightRecorder, named with the current time unless given, returning the file it was written to or an empty string if it failed
+FString UBuildSystemSubsystem::DumpFlightRecorder(const FString& Name) const
+{
+	const FString Filename = FFlightRecorder::GetDumpFilename(Name.IsEmpty() ? FString::Printf(TEXT("FlightRecorder-%s"), *FDateTime::Now().ToString()) : Name);
+	if (!FlightRecorder.SaveToFile(Filename)) {
+		UE_LOG(LogTemp, Error, TEXT("Failed to write flight recorder dump %s"), *Filename);
+		return FString();
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Wrote %d flight recorder events to %s, decode with BuildSystem.DecodeFlightRecorder"), FlightRecorder.Num(), *Filename);
+	return Filename;
+}
+
+// Dump the flight recorder when an ensure fails, so the decisions leading up to it are kept
+void UBuildSystemSubsystem::OnSystemEnsure()
+{
+	if (FlightRecorder.Num() > 0) {
+		DumpFlightRecorder(FString::Printf(TEXT("Ensure-%s"), *FDateTime::Now().ToString()));
+	}
+}
+
+// Wake every member of a part's group, and only its group, keeping the group awake until it settles again
+void UBuildSystemSubsystem::WakeGroup(AMoveableObject* Part)
+{
+	if (!Part) return;
+
+	for (AMoveableObject* Member : Part->FusedObjects) {
+		if (!Member || !Member->MeshComponent) continue;
+
+		Member->MeshComponent->WakeAllRigidBodies();
+
+		const int32 Index = PartRegistry.GetIndex(Member);
+		if (Index != INDEX_NONE) {
+			PartRegistry.SettledFrames[Index] = 0;
+			PartRegistry.SetAsleep(Index, false);
+		}
+	}
+}
+
+// Put groups to sleep as one once every member has settled, and wake the rest of a group when physics wakes any of its members
+void UBuildSystemSubsystem::UpdateGroupSleep()
+{
+	SCOPE_CYCLE_COUNTER(STAT_BuildSystem_UpdateGroupSleep);
+
+	if (!CVarGroupSleep.GetValueOnGameThread()) return;
+
+	const float LinearThreshold = CVarGroupSleepLinearThreshold.GetValueOnGameThread();
+	const float AngularThreshold = CVarGroupSleepAngularThreshold.GetValueOnGameThread();
+	const int32 SleepFrames = CVarGroupSleepFrames.GetValueOnGameThread();
+
+	// Gather the state of every group from its members
+	LLM_SCOPE_BYTAG(BuildSystem);
+	GroupSleepStates.Reset();
+	for (int32 Index = 0; Index < PartRegistry.Num(); ++Index) {
+		const bool bSettled = PartRegistry.LinearVelocities[Index].SizeSquared() <= LinearThreshold * LinearThreshold
+			&& PartRegistry.AngularVelocities[Index].SizeSquared() <= AngularThreshold * AngularThreshold;
+		PartRegistry.SettledFrames[Index] = bSettled ? (uint16)FMath::Min<int32>(PartRegistry.SettledFrames[Index] + 1, MAX_uint16) : 0;
+
+		const bool bAsleep = EnumHasAnyFlags(PartRegistry.Flags[Index], EPartFlags::Asleep);
+		FGroupSleepState& State = GroupSleepStates.FindOrAdd(PartRegistry.GroupIds[Index]);
+		State.NumAwake += bAsleep ? 0 : 1;
+		State.NumAsleep += bAsleep ? 1 : 0;
+		State.bSettled &= PartRegistry.SettledFrames[Index] >= SleepFrames;
+		State.bHeld |= EnumHasAnyFlags(PartRegistry.Flags[Index], EPartFlags::Grabbed | EPartFlags::Fusing);
+	}
+
+	// Sleep or wake every member of a group that is partly awake, leaving every other group alone
+	for (int32 Index = 0; Index < PartRegistry.Num(); ++Index) {
+		const FGroupSleepState& State = GroupSleepStates.FindChecked(PartRegistry.GroupIds[Index]);
+		if (State.NumAwake == 0) continue;
+
+		// Parts that do not simulate always count as asleep, so waking them would only mark their group changed every frame
+		UStaticMeshComponent* Mesh = PartRegistry.Parts[Index]->MeshComponent;
+		const bool bAsleep = EnumHasAnyFlags(PartRegistry.Flags[Index], EPartFlags::Asleep);
+		if (!Mesh || !Mesh->IsSimulatingPhysics()) continue;
+
+		if (State.ShouldSleep() && !bAsleep) {
+			Mesh->PutAllRigidBodiesToSleep();
+			PartRegistry.SetAsleep(Index, true);
+		}
+
+		else if (!State.ShouldSleep() && bAsleep) {
+			Mesh->WakeAllRigidBodies();
+			PartRegistry.SetAsleep(Index, false);
+		}
+	}
+
+	// Count the groups left awake and their bodies
+	int32 NumAwakeGroups = 0;
+	int32 NumAwakeBodies = 0;
+	for (const TPair<int32, FGroupSleepState>& Group : GroupSleepStates) {
+		if (Group.Value.NumAwake > 0 && !Group.Value.ShouldSleep()) {
+			++NumAwakeGroups;
+			NumAwakeBodies += Group.Value.NumAwake + Group.Value.NumAsleep;
+		}
+	}
+	SET_DWORD_STAT(STAT_BuildSystem_AwakeGroups, NumAwakeGroups);
+	SET_DWORD_STAT(STAT_BuildSystem_AwakeBodies, NumAwakeBodies);
+}
+
+// Reduce idle groups far from every viewer to low fidelity, and return groups to full fidelity as viewers approach or they wake
+void UBuildSystemSubsystem::UpdateSignificance()
+{
+	SCOPE_CYCLE_COUNTER(STAT_BuildSystem_UpdateSignificance);
+	LLM_SCOPE_BYTAG(BuildSystem);
+
+	// Without any viewers, or with significance turned off, every group stays at full fidelity
+	ViewerLocations.Reset();
+	if (CVarSignificance.GetValueOnGameThread()) {
+		if (VirtualViewers.Num() > 0) {
+			ViewerLocations.Append(VirtualViewers);
+		}
+
+		else {
+			for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It) {
+				if (APlayerController* PlayerController = It->Get()) {
+					FVector ViewLocation;
+					FRotator ViewRotation;
+					PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+					ViewerLocations.Add(ViewLocation);
+				}
+			}
+		}
+	}
+
+	// Gather the distance of every group from its closest viewer, and whether it is idle
+	GroupSignificanceStates.Reset();
+	for (int32 Index = 0; Index < PartRegistry.Num(); ++Index) {
+		FGroupSignificanceState& State = GroupSignificanceStates.FindOrAdd(PartRegistry.GroupIds[Index]);
+		for (const FVector& ViewerLocation : ViewerLocations) {
+			State.MinViewerDistSquared = FMath::Min(State.MinViewerDistSquared, (float)FVector::DistSquared(PartRegistry.Locations[Index], ViewerLocation));
+		}
+
+		const EPartFlags PartFlags = PartRegistry.Flags[Index];
+		State.bIdle &= EnumHasAnyFlags(PartFlags, EPartFlags::Asleep) && !EnumHasAnyFlags(PartFlags, EPartFlags::Grabbed | EPartFlags::Fusing);
+		State.bReduced |= EnumHasAnyFlags(PartFlags, EPartFlags::Reduced);
+	}
+
+	// Switch every member of a group whose fidelity has changed
+	const float ReduceDistance = CVarSignificanceReduceDistance.GetValueOnGameThread();
+	const float RestoreDistance = FMath::Max(ReduceDistance - CVarSignificanceHysteresis.GetValueOnGameThread(), 0.f);
+	int32 NumReducedParts = 0;
+
+	for (int32 Index = 0; Index < PartRegistry.Num(); ++Index) {
+		const FGroupSignificanceState& State = GroupSignificanceStates.FindChecked(PartRegistry.GroupIds[Index]);
+		const float Distance = State.bReduced ? RestoreDistance : ReduceDistance;
+		const bool bShouldReduce = ViewerLocations.Num() > 0 && State.bIdle && State.MinViewerDistSquared > Distance * Distance;
+
+		if (bShouldReduce != EnumHasAnyFlags(PartRegistry.Flags[Index], EPartFlags::Reduced)) {
+			PartRegistry.Parts[Index]->SetReducedFidelity(bShouldReduce);
+
+			if (bShouldReduce) {
+				PartRegistry.Flags[Index] |= EPartFlags::Reduced;
+			}
+
+			else {
+				PartRegistry.Flags[Index] &= ~EPartFlags::Reduced;
+			}
+		}
+
+		NumReducedParts += bShouldReduce ? 1 : 0;
+	}
+
+	SET_DWORD_STAT(STAT_BuildSystem_ReducedParts, NumReducedParts);
+}
+
+// Get the collision proxy of the given shape for a mesh, baking it the first time it is asked for
+TSharedRef<const FCollisionProxy, ESPMode::ThreadSafe> UBuildSystemSubsystem::GetCollisionProxy(const UStaticMesh* Mesh, ECollisionProxyShape Shape)
+{
+	const TPair<TObjectKey<UStaticMesh>, ECollisionProxyShape> Key(Mesh, Shape);
+	if (const TSharedRef<const FCollisionProxy, ESPMode::ThreadSafe>* Proxy = CollisionProxies.Find(Key)) {
+		return *Proxy;
+	}
+
+	LLM_SCOPE_BYTAG(BuildSystem);
+	return CollisionProxies.Add(Key, MakeShared<const FCollisionProxy, ESPMode::ThreadSafe>(FCollisionProxy::Bake(Mesh, Shape)));
+}
+
+// Add the memory used by fuse sessions, links, the part registry and pool, and collision proxies to a memory usage report
+void UBuildSystemSubsystem::AccumulateMemoryUsage(FBuildSystemMemoryUsage& Usage) const
+{
+	Usage.RegistryBytes += PartRegistry.GetAllocatedSize() + GroupSleepStates.GetAllocatedSize() + GroupSignificanceStates.GetAllocatedSize() + PartPool.GetAllocatedSize() + InstancedRenderer.GetAllocatedSize();
+
+	Usage.RegistryBytes += FrozenGroups.GetAllocatedSize() + FlightRecorder.GetAllocatedSize() + DeferredWork.GetAllocatedSize() + StructuralStress.GetAllocatedSize();
+	for (const FFrozenGroup& FrozenGroup : FrozenGroups) {
+		Usage.RegistryBytes += FrozenGroup.Members.GetAllocatedSize() + FrozenGroup.Instances.GetAllocatedSize();
+		for (UInstancedStaticMeshComponent* Instances : FrozenGroup.Instances) {
+			Usage.ComponentBytes += BuildSystemStats::GetObjectBytes(Instances);
+		}
+	}
+
+	Usage.ProxyBytes += CollisionProxies.GetAllocatedSize();
+	for (const TPair<TPair<TObjectKey<UStaticMesh>, ECollisionProxyShape>, TSharedRef<const FCollisionProxy, ESPMode::ThreadSafe>>& Proxy : CollisionProxies) {
+		Usage.ProxyBytes += sizeof(FCollisionProxy) + Proxy.Value->GetAllocatedSize();
+	}
+
+	// Every link is stored once in the link table, along with the constraint component it owns
+	Usage.NumLinks += LinkTable.Num();
+	Usage.LinkBytes += LinkTable.GetAllocatedSize();
+	LinkTable.ForEachLink([&Usage](FConstraintLinkHandle, const FPhysicsConstraintLink& Link) {
+		Usage.LinkBytes += BuildSystemStats::GetObjectBytes(Link.Constraint);
+	});
+
+	Usage.SessionBytes += Sessions.GetAllocatedSize();
+
+	for (const FFuseSession& Session : Sessions) {
+		Usage.SessionBytes += Session.CandidateSearch.GetAllocatedSize() + Session.ExtraContacts.GetAllocatedSize() + (Session.SnapResolver ? sizeof(FAsyncSnapResolver) : 0);
+		Usage.MaterialBytes += BuildSystemStats::GetObjectBytes(Session.HeldOverlayMat) + BuildSystemStats::GetObjectBytes(Session.NearbyOverlayMat);
+	}
+}
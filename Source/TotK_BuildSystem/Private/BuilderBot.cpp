@@ -0,0 +1,213 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BuilderBot.h"
+#include "Grabber.h"
+#include "MoveableObject.h"
+#include "BuildSystemSubsystem.h"
+#include "PhysicsEngine/PhysicsHandleComponent.h"
+#include "GameFramework/Controller.h"
+#include "Engine/World.h"
+
+// Create the grabber and physics handle the bot builds with
+ABuilderBot::ABuilderBot()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	// Bots are possessed by an AI controller as soon as they are spawned, so their view rotation comes from the controller like the player's does
+	AutoPossessAI = EAutoPossessAI::PlacedInWorldOrSpawned;
+
+	// The grabber is aimed independently of the capsule, which only turns with the view's yaw
+	Grabber = CreateDefaultSubobject<UGrabber>(TEXT("Grabber"));
+	Grabber->SetupAttachment(RootComponent);
+	Grabber->SetUsingAbsoluteRotation(true);
+
+	PhysicsHandle = CreateDefaultSubobject<UPhysicsHandleComponent>(TEXT("PhysicsHandle"));
+}
+
+// Called when the game starts or when spawned
+void ABuilderBot::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Debug drawing would only add to the cost being measured
+	Grabber->SetDebugMode(false);
+}
+
+// Called every frame
+void ABuilderBot::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	// Only the server builds, clients see the results through replication
+	if (!HasAuthority()) return;
+
+	StateTime += DeltaSeconds;
+
+	switch (State) {
+	case EBuilderBotState::FindPart:
+		TargetPart = PickRandomPart(INDEX_NONE);
+		if (TargetPart.IsValid()) {
+			SetState(EBuilderBotState::ApproachPart);
+		}
+		break;
+
+	case EBuilderBotState::ApproachPart:
+		TickApproachPart();
+		break;
+
+	case EBuilderBotState::CarryPart:
+		TickCarryPart();
+		break;
+
+	case EBuilderBotState::Wait:
+		if (StateTime >= WaitTime) {
+			SetState(EBuilderBotState::FindPart);
+		}
+		break;
+	}
+}
+
+// Pick a random part that no grabber is holding or fusing with, other than any in the given group
+AMoveableObject* ABuilderBot::PickRandomPart(int32 ExcludedGroupId) const
+{
+	const UBuildSystemSubsystem* BuildSystem = GetWorld()->GetSubsystem<UBuildSystemSubsystem>();
+	if (!BuildSystem || BuildSystem->GetPartRegistry().Num() == 0) return nullptr;
+
+	// A few random slots are tried rather than gathering every free part, which finds one quickly while most of the world is free
+	const FPartRegistry& Registry = BuildSystem->GetPartRegistry();
+	for (int32 Attempt = 0; Attempt < 8; ++Attempt) {
+		const int32 Index = RandomStream.RandRange(0, Registry.Num() - 1);
+		AMoveableObject* Part = Registry.Parts[Index];
+
+		if (IsValid(Part) && !Part->IsPooled() && Registry.GroupIds[Index] != ExcludedGroupId && !BuildSystem->IsGroupLocked(Part, nullptr)) {
+			return Part;
+		}
+	}
+
+	return nullptr;
+}
+
+// Walk up to the target part and grab it, teleporting next to it if it cannot be reached in time
+void ABuilderBot::TickApproachPart()
+{
+	// The grab may have been deferred until the bot stepped off the part, so it lands on a later frame
+	if (Grabber->IsHoldingObject()) {
+		++NumGrabs;
+
+		const UBuildSystemSubsystem* BuildSystem = GetWorld()->GetSubsystem<UBuildSystemSubsystem>();
+		TargetPart = PickRandomPart(BuildSystem ? BuildSystem->GetPartRegistry().GetGroupId(Grabber->GetHeldObject()) : INDEX_NONE);
+		SetState(EBuilderBotState::CarryPart);
+		return;
+	}
+
+	// Another grabber got to the part first, or it has gone
+	AMoveableObject* Part = TargetPart.Get();
+	const UBuildSystemSubsystem* BuildSystem = GetWorld()->GetSubsystem<UBuildSystemSubsystem>();
+	if (!IsValid(Part) || (BuildSystem && BuildSystem->IsGroupLocked(Part, nullptr)) || StateTime > GiveUpTime * 2.f) {
+		Grabber->Release();
+		SetState(EBuilderBotState::FindPart);
+		return;
+	}
+
+	const FVector PartLocation = Part->GetActorLocation();
+	const FVector ToPart = PartLocation - GetActorLocation();
+	AimAt(Grabber->GetAimPoint(PartLocation));
+
+	// Walk straight at the part, skipping the rest of the walk if something is in the way
+	if (ToPart.Size2D() > GrabReach) {
+		if (StateTime > GiveUpTime && StateTime <= GiveUpTime * 2.f) {
+			TeleportTo(PartLocation - ToPart.GetSafeNormal2D() * GrabReach * 0.5f + FVector(0.f, 0.f, GetSimpleCollisionHalfHeight()), GetActorRotation());
+			StateTime = GiveUpTime * 2.f - ActionInterval;
+		}
+
+		else {
+			AddMovementInput(ToPart.GetSafeNormal2D());
+		}
+		return;
+	}
+
+	// Try the grab a few times a second rather than sweeping every frame
+	if (StateTime >= NextActionTime) {
+		Grabber->Grab();
+		NextActionTime = StateTime + 0.25f;
+	}
+}
+
+// Carry the held part towards the target part, rotating and pushing it at random, and let go once it is close enough
+void ABuilderBot::TickCarryPart()
+{
+	// The part was dropped without the bot letting go, such as by being merged into a frozen group
+	AMoveableObject* HeldObject = Grabber->GetHeldObject();
+	if (!HeldObject) {
+		SetState(EBuilderBotState::FindPart);
+		return;
+	}
+
+	UBuildSystemSubsystem* BuildSystem = GetWorld()->GetSubsystem<UBuildSystemSubsystem>();
+	AMoveableObject* Target = TargetPart.Get();
+	if (!IsValid(Target) || HeldObject->FusedObjects.Contains(Target)) {
+		TargetPart = Target = PickRandomPart(BuildSystem ? BuildSystem->GetPartRegistry().GetGroupId(HeldObject) : INDEX_NONE);
+	}
+
+	// Once the held part has something to fuse with and has been played with for a while, let go of it, or give up on reaching the target
+	const FFuseSession* Session = BuildSystem ? BuildSystem->FindSession(HeldObject) : nullptr;
+	const bool bHasCandidate = Session && Session->ClosestNearbyMoveableObject;
+	if (!Target || (bHasCandidate && StateTime > ActionInterval * 2.f) || StateTime > GiveUpTime) {
+		Grabber->Release();
+		++NumReleases;
+		SetState(EBuilderBotState::Wait);
+		return;
+	}
+
+	// Walk forwards until the held part is level with the target, and back off if the target is nearer than the held part
+	const FVector TargetLocation = Target->GetActorLocation();
+	const FVector ToTarget = TargetLocation - GetActorLocation();
+	const float HeldDistance = FVector::Dist2D(HeldObject->GetActorLocation(), GetActorLocation());
+	AimAt(Grabber->GetAimPoint(TargetLocation));
+
+	if (ToTarget.Size2D() > HeldDistance + ReleaseDistance) {
+		AddMovementInput(ToTarget.GetSafeNormal2D());
+	}
+
+	else if (ToTarget.Size2D() < HeldDistance - ReleaseDistance) {
+		AddMovementInput(-ToTarget.GetSafeNormal2D());
+	}
+
+	// Turn and push the held part the same way a player would while lining it up
+	if (StateTime >= NextActionTime) {
+		switch (RandomStream.RandRange(0, 5)) {
+		case 0: Grabber->RotateLeft(); break;
+		case 1: Grabber->RotateRight(); break;
+		case 2: Grabber->RotateUp(); break;
+		case 3: Grabber->RotateDown(); break;
+		case 4: Grabber->MoveAway(); break;
+		default: Grabber->MoveTowards(); break;
+		}
+		NextActionTime = StateTime + ActionInterval * RandomStream.FRandRange(0.5f, 1.5f);
+	}
+}
+
+// Point the grabber and the bot's view at a location
+void ABuilderBot::AimAt(const FVector& Location)
+{
+	FVector EyeLocation;
+	FRotator EyeRotation;
+	GetActorEyesViewPoint(EyeLocation, EyeRotation);
+
+	// The grabber sweeps and holds along its own forward vector, while the control rotation turns the bot like the camera turns the player
+	const FRotator AimRotation = (Location - EyeLocation).Rotation();
+	Grabber->SetWorldRotation(AimRotation);
+
+	if (Controller) {
+		Controller->SetControlRotation(AimRotation);
+	}
+}
+
+// Move to a new state, resetting the time spent in it
+void ABuilderBot::SetState(EBuilderBotState NewState)
+{
+	State = NewState;
+	StateTime = 0.f;
+	NextActionTime = 0.f;
+}
@@ -0,0 +1,180 @@
+#include "CollisionProxy.h"
+#include "BuildSystemMath.h"
+#include "BuildSystemStats.h"
+#include "Engine/StaticMesh.h"
+#include "PhysicsEngine/BodySetup.h"
+
+// Bake a box from bounds
+static void BakeBox(FCollisionProxy& Proxy, const FBox& Bounds)
+{
+	Proxy.Shape = ECollisionProxyShape::Box;
+	Proxy.Center = FVector3f(Bounds.GetCenter());
+	Proxy.Extent = FVector3f(Bounds.GetExtent());
+}
+
+// Bake a capsule from the mesh's only collision element if it is a capsule, otherwise fit one along the longest axis of the bounds of every element
+static void BakeCapsule(FCollisionProxy& Proxy, const FKAggregateGeom* AggGeom, const FBox& Bounds)
+{
+	Proxy.Shape = ECollisionProxyShape::Capsule;
+
+	if (AggGeom && AggGeom->GetElementCount() == 1 && AggGeom->SphylElems.Num() == 1) {
+		const FKSphylElem& Sphyl = AggGeom->SphylElems[0];
+		const FVector HalfSegment = Sphyl.Rotation.RotateVector(FVector(0.f, 0.f, Sphyl.Length * 0.5f));
+		Proxy.SegmentStart = FVector3f(Sphyl.Center - HalfSegment);
+		Proxy.SegmentEnd = FVector3f(Sphyl.Center + HalfSegment);
+		Proxy.Radius = Sphyl.Radius;
+		return;
+	}
+
+	// The radius covers the two shorter axes, and the segment runs along the longest axis inside the rounded ends
+	const FVector Extent = Bounds.GetExtent();
+	const int32 LongAxis = Extent.X >= Extent.Y && Extent.X >= Extent.Z ? 0 : (Extent.Y >= Extent.Z ? 1 : 2);
+	Proxy.Radius = LongAxis == 0 ? FMath::Max(Extent.Y, Extent.Z) : (LongAxis == 1 ? FMath::Max(Extent.X, Extent.Z) : FMath::Max(Extent.X, Extent.Y));
+
+	FVector HalfSegment = FVector::ZeroVector;
+	HalfSegment[LongAxis] = FMath::Max(Extent[LongAxis] - Proxy.Radius, 0.f);
+	Proxy.SegmentStart = FVector3f(Bounds.GetCenter() - HalfSegment);
+	Proxy.SegmentEnd = FVector3f(Bounds.GetCenter() + HalfSegment);
+}
+
+// Bake a hull from every convex collision element, returning false if the collision has other elements or too many triangles to bake
+static bool BakeHull(FCollisionProxy& Proxy, const FKAggregateGeom* AggGeom)
+{
+	if (!AggGeom || AggGeom->ConvexElems.Num() == 0 || AggGeom->ConvexElems.Num() != AggGeom->GetElementCount()) return false;
+
+	int32 TotalTriangles = 0;
+	for (const FKConvexElem& Convex : AggGeom->ConvexElems) {
+		const int32 NumTriangles = Convex.IndexData.Num() / 3;
+		if (NumTriangles == 0) return false;
+		TotalTriangles += NumTriangles;
+	}
+	if (TotalTriangles > FCollisionProxy::MaxHullTriangles) return false;
+
+	Proxy.Shape = ECollisionProxyShape::Hull;
+	Proxy.HullVertices.Reset(TotalTriangles * 3);
+	Proxy.HullNormals.Reset(TotalTriangles);
+	Proxy.HullStarts.Reset(AggGeom->ConvexElems.Num());
+
+	for (const FKConvexElem& Convex : AggGeom->ConvexElems) {
+		Proxy.HullStarts.Add(Proxy.HullNormals.Num());
+
+		const FTransform ElemTransform = Convex.GetTransform();
+		const FVector HullCenter = ElemTransform.TransformPosition(Convex.ElemBox.GetCenter());
+		const int32 NumTriangles = Convex.IndexData.Num() / 3;
+
+		for (int32 Triangle = 0; Triangle < NumTriangles; ++Triangle) {
+			const FVector A = ElemTransform.TransformPosition(Convex.VertexData[Convex.IndexData[Triangle * 3]]);
+			const FVector B = ElemTransform.TransformPosition(Convex.VertexData[Convex.IndexData[Triangle * 3 + 1]]);
+			const FVector C = ElemTransform.TransformPosition(Convex.VertexData[Convex.IndexData[Triangle * 3 + 2]]);
+
+			// Face every normal away from the center of the hull, whatever the winding of the index data
+			FVector Normal = FVector::CrossProduct(B - A, C - A).GetSafeNormal();
+			if (FVector::DotProduct(Normal, A - HullCenter) < 0.f) {
+				Normal = -Normal;
+			}
+
+			Proxy.HullVertices.Add(FVector3f(A));
+			Proxy.HullVertices.Add(FVector3f(B));
+			Proxy.HullVertices.Add(FVector3f(C));
+			Proxy.HullNormals.Add(FVector3f(Normal));
+		}
+	}
+
+	return true;
+}
+
+// Bake a proxy of the given shape from a mesh's simple collision, falling back to a box if the mesh has nothing to build the shape from
+FCollisionProxy FCollisionProxy::Bake(const UStaticMesh* Mesh, ECollisionProxyShape InShape)
+{
+	LLM_SCOPE_BYTAG(BuildSystem);
+
+	const UBodySetup* BodySetup = Mesh ? Mesh->GetBodySetup() : nullptr;
+	const FKAggregateGeom* AggGeom = BodySetup && BodySetup->AggGeom.GetElementCount() > 0 ? &BodySetup->AggGeom : nullptr;
+
+	// Use the simple collision bounds where there are any, otherwise fall back to the mesh bounds
+	FBox Bounds = AggGeom ? AggGeom->CalcAABB(FTransform::Identity) : FBox(ForceInit);
+	if (!Bounds.IsValid && Mesh) {
+		Bounds = Mesh->GetBoundingBox();
+	}
+	if (!Bounds.IsValid) {
+		Bounds = FBox(FVector::ZeroVector, FVector::ZeroVector);
+	}
+
+	FCollisionProxy Proxy;
+	switch (InShape) {
+	case ECollisionProxyShape::Capsule:
+		BakeCapsule(Proxy, AggGeom, Bounds);
+		break;
+
+	case ECollisionProxyShape::Hull:
+		if (!BakeHull(Proxy, AggGeom)) {
+			BakeBox(Proxy, Bounds);
+		}
+		break;
+
+	default:
+		BakeBox(Proxy, Bounds);
+		break;
+	}
+
+	return Proxy;
+}
+
+// Get the closest point on the proxy to a point in the part's local space, or the point itself if it is inside the proxy.
+// The local space leaves out the part's scale, which is applied to the proxy instead so distances are measured as they are in the world
+FVector3f FCollisionProxy::GetClosestLocalPoint(const FVector3f& LocalPoint, const FVector3f& Scale) const
+{
+	switch (Shape) {
+	case ECollisionProxyShape::Capsule:
+		// A scaled capsule is no longer a capsule, so the radius grows with the largest axis to keep covering the collision
+		return BuildSystemMath::ClosestPointOnCapsule(LocalPoint, SegmentStart * Scale, SegmentEnd * Scale, Radius * Scale.GetAbsMax());
+
+	case ECollisionProxyShape::Hull:
+	{
+		// Normals are scaled by the inverse of the scale to stay perpendicular to their scaled triangles
+		const bool bScaled = !Scale.Equals(FVector3f::OneVector);
+		const auto GetNormal = [this, &Scale, bScaled](int32 Triangle) {
+			return bScaled ? (HullNormals[Triangle] / Scale).GetSafeNormal() : HullNormals[Triangle];
+		};
+
+		// Points behind every face of any hull are inside the proxy
+		const int32 NumTriangles = HullNormals.Num();
+		for (int32 Hull = 0; Hull < HullStarts.Num(); ++Hull) {
+			const int32 EndTriangle = Hull + 1 < HullStarts.Num() ? HullStarts[Hull + 1] : NumTriangles;
+			bool bInside = true;
+			for (int32 Triangle = HullStarts[Hull]; Triangle < EndTriangle && bInside; ++Triangle) {
+				bInside = FVector3f::DotProduct(LocalPoint - HullVertices[Triangle * 3] * Scale, GetNormal(Triangle)) <= 0.f;
+			}
+			if (bInside) return LocalPoint;
+		}
+
+		// Otherwise the closest point is the closest point on any of the triangles
+		FVector3f ClosestPoint = LocalPoint;
+		float ClosestDistSquared = TNumericLimits<float>::Max();
+		for (int32 Triangle = 0; Triangle < NumTriangles; ++Triangle) {
+			const FVector3f TrianglePoint = BuildSystemMath::ClosestPointOnTriangle(LocalPoint, HullVertices[Triangle * 3] * Scale, HullVertices[Triangle * 3 + 1] * Scale, HullVertices[Triangle * 3 + 2] * Scale);
+			const float DistSquared = FVector3f::DistSquared(TrianglePoint, LocalPoint);
+			if (DistSquared < ClosestDistSquared) {
+				ClosestDistSquared = DistSquared;
+				ClosestPoint = TrianglePoint;
+			}
+		}
+		return ClosestPoint;
+	}
+
+	default:
+		return BuildSystemMath::ClosestPointOnBox(LocalPoint, Center * Scale, Extent * Scale.GetAbs());
+	}
+}
+
+// Get the closest point on the proxy to a world point, or the point itself if it is inside the proxy
+FVector FCollisionProxy::GetClosestPoint(const FTransform& PartTransform, const FVector& WorldPoint) const
+{
+	// Queries are done in float in the part's local space, where parts are small enough to keep full precision. The scale is left out
+	// of the local space and applied to the proxy, as a non-uniform scale would otherwise stretch the distances being compared
+	const FVector3f LocalPoint = FVector3f(PartTransform.InverseTransformPositionNoScale(WorldPoint));
+	const FVector3f ClosestLocalPoint = GetClosestLocalPoint(LocalPoint, FVector3f(PartTransform.GetScale3D()));
+
+	// Return the world point itself when it is inside, so it is not moved by converting back and forth
+	return ClosestLocalPoint == LocalPoint ? WorldPoint : PartTransform.TransformPositionNoScale(FVector(ClosestLocalPoint));
+}
@@ -0,0 +1,159 @@
+#include "ConstraintLinkTable.h"
+#include "MoveableObject.h"
+#include "BuildSystemStats.h"
+
+// Add a link between two objects and return its handle
+FConstraintLinkHandle FConstraintLinkTable::Add(UPhysicsConstraintComponent* Constraint, AMoveableObject* ComponentA, AMoveableObject* ComponentB)
+{
+	LLM_SCOPE_BYTAG(BuildSystem_Links);
+	check(ComponentA && ComponentB);
+
+	// Reuse a free slot if there is one, otherwise grow the table
+	int32 Index = FirstFree;
+	if (Index != INDEX_NONE) {
+		FirstFree = Entries[Index].NextLink[0];
+	}
+
+	else {
+		Index = Entries.AddDefaulted();
+	}
+
+	FEntry& Entry = Entries[Index];
+	Entry.Link.Constraint = Constraint;
+	Entry.Link.ComponentA = ComponentA;
+	Entry.Link.ComponentB = ComponentB;
+	Entry.bInUse = true;
+
+	// A link from an object to itself is only added to its link list once
+	LinkInto(Index, 0);
+	if (ComponentA != ComponentB) {
+		LinkInto(Index, 1);
+	}
+
+	++NumLinks;
+	INC_DWORD_STAT(STAT_BuildSystem_Links);
+	return FConstraintLinkHandle{ Index, Entry.Generation };
+}
+
+// Remove a link, returning false if the handle no longer refers to a link
+bool FConstraintLinkTable::Remove(FConstraintLinkHandle Handle)
+{
+	if (!Find(Handle)) return false;
+
+	const int32 Index = Handle.Index;
+	FEntry& Entry = Entries[Index];
+
+	UnlinkFrom(Index, 0);
+	if (Entry.Link.ComponentA != Entry.Link.ComponentB) {
+		UnlinkFrom(Index, 1);
+	}
+
+	// Clear the slot and add it to the free list
+	Entry.Link = FPhysicsConstraintLink();
+	Entry.PrevLink[0] = Entry.PrevLink[1] = INDEX_NONE;
+	Entry.NextLink[1] = INDEX_NONE;
+	Entry.NextLink[0] = FirstFree;
+	Entry.bInUse = false;
+	++Entry.Generation;
+	FirstFree = Index;
+
+	--NumLinks;
+	DEC_DWORD_STAT(STAT_BuildSystem_Links);
+	return true;
+}
+
+// Get the link a handle refers to, or null if it has been removed
+const FPhysicsConstraintLink* FConstraintLinkTable::Find(FConstraintLinkHandle Handle) const
+{
+	if (!Entries.IsValidIndex(Handle.Index)) return nullptr;
+
+	const FEntry& Entry = Entries[Handle.Index];
+	return Entry.bInUse && Entry.Generation == Handle.Generation ? &Entry.Link : nullptr;
+}
+
+// Replace the constraint component of a link, returning false if the handle no longer refers to a link
+bool FConstraintLinkTable::SetConstraint(FConstraintLinkHandle Handle, UPhysicsConstraintComponent* Constraint)
+{
+	if (!Entries.IsValidIndex(Handle.Index)) return false;
+
+	FEntry& Entry = Entries[Handle.Index];
+	if (!Entry.bInUse || Entry.Generation != Handle.Generation) return false;
+
+	Entry.Link.Constraint = Constraint;
+	return true;
+}
+
+// Get the number of links an object has
+int32 FConstraintLinkTable::NumObjectLinks(const AMoveableObject* Object) const
+{
+	int32 Count = 0;
+	ForEachObjectLink(Object, [&Count](FConstraintLinkHandle, const FPhysicsConstraintLink&) { ++Count; });
+	return Count;
+}
+
+// Remove every link, leaving the objects that were linked with empty link lists
+void FConstraintLinkTable::Reset()
+{
+	for (FEntry& Entry : Entries) {
+		if (!Entry.bInUse) continue;
+
+		if (Entry.Link.ComponentA) Entry.Link.ComponentA->FirstLinkIndex = INDEX_NONE;
+		if (Entry.Link.ComponentB) Entry.Link.ComponentB->FirstLinkIndex = INDEX_NONE;
+	}
+
+	DEC_DWORD_STAT_BY(STAT_BuildSystem_Links, NumLinks);
+	Entries.Reset();
+	FirstFree = INDEX_NONE;
+	NumLinks = 0;
+}
+
+// Get the first link in an object's link list
+int32 FConstraintLinkTable::GetFirstLink(const AMoveableObject* Object) const
+{
+	return Object ? Object->FirstLinkIndex : INDEX_NONE;
+}
+
+// Insert a link at the head of one of its object's link lists
+void FConstraintLinkTable::LinkInto(int32 Index, int32 Side)
+{
+	FEntry& Entry = Entries[Index];
+	AMoveableObject* Object = Side == 0 ? Entry.Link.ComponentA : Entry.Link.ComponentB;
+
+	const int32 OldHead = Object->FirstLinkIndex;
+	Entry.PrevLink[Side] = INDEX_NONE;
+	Entry.NextLink[Side] = OldHead;
+
+	if (OldHead != INDEX_NONE) {
+		FEntry& OldHeadEntry = Entries[OldHead];
+		OldHeadEntry.PrevLink[GetSide(OldHeadEntry, Object)] = Index;
+	}
+
+	Object->FirstLinkIndex = Index;
+}
+
+// Remove a link from one of its object's link lists
+void FConstraintLinkTable::UnlinkFrom(int32 Index, int32 Side)
+{
+	FEntry& Entry = Entries[Index];
+	AMoveableObject* Object = Side == 0 ? Entry.Link.ComponentA : Entry.Link.ComponentB;
+
+	const int32 Prev = Entry.PrevLink[Side];
+	const int32 Next = Entry.NextLink[Side];
+
+	if (Prev != INDEX_NONE) {
+		FEntry& PrevEntry = Entries[Prev];
+		PrevEntry.NextLink[GetSide(PrevEntry, Object)] = Next;
+	}
+
+	else {
+		Object->FirstLinkIndex = Next;
+	}
+
+	if (Next != INDEX_NONE) {
+		FEntry& NextEntry = Entries[Next];
+		NextEntry.PrevLink[GetSide(NextEntry, Object)] = Prev;
+	}
+
+	Entry.PrevLink[Side] = INDEX_NONE;
+	Entry.NextLink[Side] = INDEX_NONE;
+}
@@ -17,10 +17,10 @@ void ACustomPlayerController::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// Initialize the player character and physics handle
+	// Initialize the player character and grabber
 	PlayerCharacter = Cast<ATotK_BuildSystemCharacter>(GetPawn());
 	if (PlayerCharacter) {
-		PhysicsHandle = PlayerCharacter->FindComponentByClass<UPhysicsHandleComponent>();
+		Grabber = PlayerCharacter->FindComponentByClass<UGrabber>();
 	}
 }
 
@@ -29,12 +29,9 @@ void ACustomPlayerController::Tick(float DeltaSeconds)
 {
 	Super::Tick(DeltaSeconds);
 
-	// If the player character is holding a moveable object, check for mouse shake
-	if (PhysicsHandle && PhysicsHandle->GetGrabbedComponent() != nullptr) {
-		//If held object is null, get the currently grabbed component
-		if (HeldObject == nullptr) {
-			HeldObject = Cast<AMoveableObject>(PhysicsHandle->GetGrabbedComponent()->GetOwner());
-		}
+	// If the player character's grabber is holding a moveable object, check for mouse shake
+	if (AMoveableObject* GrabbedObject = Grabber ? Grabber->GetHeldObject() : nullptr) {
+		HeldObject = GrabbedObject;
 		TrackMouseShake();
 	}
 
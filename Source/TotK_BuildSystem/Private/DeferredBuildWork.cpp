@@ -0,0 +1,270 @@
+#include "DeferredBuildWork.h"
+#include "MoveableObject.h"
+#include "BuildSystemSubsystem.h"
+#include "BuildSystemStats.h"
+#include "Components/ActorComponent.h"
+#include "Materials/MaterialInterface.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+
+// Microseconds of deferred build work done each frame, where 0 does all work as soon as it is added
+static TAutoConsoleVariable<int32> CVarDeferredWorkBudget(
+	TEXT("BuildSystem.DeferredWorkBudget"),
+	500,
+	TEXT("Microseconds of deferred build work done each frame, such as handing out fused object sets after large splits and merges. 0 does all work as soon as it is added"));
+
+// Smallest group whose work is deferred, as smaller groups are quicker to finish straight away than to queue
+static TAutoConsoleVariable<int32> CVarDeferredWorkMinParts(
+	TEXT("BuildSystem.DeferredWorkMinParts"),
+	64,
+	TEXT("Smallest group whose splits, merges and highlights are spread over later frames rather than done straight away"));
+
+// Check if work visiting a number of parts should be queued rather than done straight away
+static bool ShouldDefer(int32 NumParts)
+{
+	return CVarDeferredWorkBudget.GetValueOnGameThread() > 0 && NumParts >= CVarDeferredWorkMinParts.GetValueOnGameThread();
+}
+
+// Add work, doing it straight away if it is small or deferring is turned off, otherwise queuing it behind earlier work
+void FDeferredBuildWork::Add(UBuildSystemSubsystem& BuildSystem, FDeferredWork&& Work)
+{
+	// Broken constraints are always left for later, as nothing can see them once they are out of the link table
+	const bool bDefer = Work.Type == EDeferredWorkType::DestroyConstraint ? CVarDeferredWorkBudget.GetValueOnGameThread() > 0 : ShouldDefer(Work.Parts.Num());
+	if (!bDefer) {
+		while (!Step(BuildSystem, Work)) {}
+		return;
+	}
+
+	LLM_SCOPE_BYTAG(BuildSystem);
+	Queue.Add(MoveTemp(Work));
+}
+
+// Highlight every part of a part's group with an overlay material, or clear the highlight, replacing any highlight of the group that has not been finished
+void FDeferredBuildWork::Highlight(UBuildSystemSubsystem& BuildSystem, AMoveableObject* Part, UMaterialInterface* Material)
+{
+	// Only the newest highlight of a group matters, as it sets every part anyway
+	const int32 GroupId = BuildSystem.GetPartRegistry().GetGroupId(Part);
+	if (GroupId != INDEX_NONE) {
+		Queue.RemoveAll([GroupId](const FDeferredWork& Queued) { return Queued.Type == EDeferredWorkType::Highlight && Queued.GroupId == GroupId; });
+	}
+
+	// The group's members have to be settled before they can be highlighted
+	FinishGroup(BuildSystem, GroupId);
+
+	// Small groups are highlighted straight from their set, without taking a copy of it
+	if (!ShouldDefer(Part->FusedObjects.Num())) {
+		for (AMoveableObject* Object : Part->FusedObjects) {
+			if (Object && Object->Mat && Object->MeshComponent) {
+				Object->MeshComponent->SetOverlayMaterial(Material);
+			}
+		}
+		return;
+	}
+
+	FDeferredWork Work;
+	Work.Type = EDeferredWorkType::Highlight;
+	Work.GroupId = GroupId;
+	Work.Parts = Part->FusedObjects.Array();
+	Work.Material = Material;
+	Add(BuildSystem, MoveTemp(Work));
+}
+
+// Do queued work, oldest first, until the frame's budget from BuildSystem.DeferredWorkBudget is used up
+void FDeferredBuildWork::Run(UBuildSystemSubsystem& BuildSystem)
+{
+	SCOPE_CYCLE_COUNTER(STAT_BuildSystem_RunDeferredWork);
+
+	// Work queued before deferring was turned off is finished straight away
+	const int32 BudgetMicroseconds = CVarDeferredWorkBudget.GetValueOnGameThread();
+	if (BudgetMicroseconds <= 0) {
+		FinishAll(BuildSystem);
+	}
+
+	else if (Queue.Num() > 0) {
+		const double EndTime = FPlatformTime::Seconds() + BudgetMicroseconds / 1000000.0;
+
+		// At least one step is always taken, so work keeps moving however small the budget is
+		int32 NumFinished = 0;
+		do {
+			if (Step(BuildSystem, Queue[NumFinished])) {
+				++NumFinished;
+			}
+		} while (NumFinished < Queue.Num() && FPlatformTime::Seconds() < EndTime);
+
+		Queue.RemoveAt(0, NumFinished, EAllowShrinking::No);
+	}
+
+	SET_DWORD_STAT(STAT_BuildSystem_DeferredWork, Queue.Num());
+	SET_DWORD_STAT(STAT_BuildSystem_DeferredWorkParts, NumPartsLeft());
+}
+
+// Check if a piece of work belongs to a group, either the group it was queued for or the connected group a rebuild is part way through handing its new id out to
+static bool BelongsToGroup(const FDeferredWork& Work, int32 GroupId)
+{
+	if (Work.GroupId == GroupId) return true;
+	return Work.Type == EDeferredWorkType::RebuildGroups && Work.Connected.Num() > 0 && Work.GatherIndex == Work.Connected.Num() && Work.ConnectedGroupId == GroupId;
+}
+
+// Finish every piece of queued work belonging to a group, oldest first, including rebuilds whose current connected group has been given the group's id
+void FDeferredBuildWork::FinishGroup(UBuildSystemSubsystem& BuildSystem, int32 GroupId)
+{
+	if (GroupId == INDEX_NONE) return;
+
+	for (int32 Index = 0; Index < Queue.Num();) {
+		if (!BelongsToGroup(Queue[Index], GroupId)) {
+			++Index;
+			continue;
+		}
+
+		while (!Step(BuildSystem, Queue[Index])) {}
+		Queue.RemoveAt(Index, 1, EAllowShrinking::No);
+	}
+}
+
+// Finish every piece of queued work
+void FDeferredBuildWork::FinishAll(UBuildSystemSubsystem& BuildSystem)
+{
+	for (FDeferredWork& Work : Queue) {
+		while (!Step(BuildSystem, Work)) {}
+	}
+	Queue.Reset();
+}
+
+// Get the number of parts queued work still has to visit
+int32 FDeferredBuildWork::NumPartsLeft() const
+{
+	int32 NumParts = 0;
+	for (const FDeferredWork& Work : Queue) {
+		// Rebuilt parts are the ones gathered into a group, less those of the current group still waiting for its set
+		const int32 NumVisited = Work.Type == EDeferredWorkType::RebuildGroups ? Work.Gathered.Num() - (Work.Connected.Num() - Work.AssignIndex) : Work.NextIndex;
+		NumParts += Work.Parts.Num() - NumVisited;
+	}
+	return NumParts;
+}
+
+// Get the memory allocated by queued work
+SIZE_T FDeferredBuildWork::GetAllocatedSize() const
+{
+	SIZE_T Size = Queue.GetAllocatedSize();
+	for (const FDeferredWork& Work : Queue) {
+		Size += Work.Parts.GetAllocatedSize() + Work.FusedSet.GetAllocatedSize() + Work.Connected.GetAllocatedSize() + Work.Gathered.GetAllocatedSize();
+	}
+	return Size;
+}
+
+// Do one part's worth of a piece of work, returning true once the work is finished
+bool FDeferredBuildWork::Step(UBuildSystemSubsystem& BuildSystem, FDeferredWork& Work)
+{
+	switch (Work.Type) {
+	case EDeferredWorkType::RebuildGroups:
+		return StepRebuildGroups(BuildSystem, Work);
+
+	case EDeferredWorkType::MergeGroups:
+		if (Work.Parts.IsValidIndex(Work.NextIndex)) {
+			LLM_SCOPE_BYTAG(BuildSystem_FusedSets);
+			AMoveableObject* Part = Work.Parts[Work.NextIndex++];
+			if (IsValid(Part)) {
+				Part->FusedObjects = Work.FusedSet;
+			}
+		}
+		return Work.NextIndex >= Work.Parts.Num();
+
+	case EDeferredWorkType::Highlight:
+		if (Work.Parts.IsValidIndex(Work.NextIndex)) {
+			AMoveableObject* Part = Work.Parts[Work.NextIndex++];
+			if (IsValid(Part) && Part->Mat && Part->MeshComponent) {
+				Part->MeshComponent->SetOverlayMaterial(Work.Material.Get());
+			}
+		}
+		return Work.NextIndex >= Work.Parts.Num();
+
+	case EDeferredWorkType::DestroyConstraint:
+		if (UActorComponent* Constraint = Work.Constraint.Get()) {
+			Constraint->DestroyComponent();
+		}
+		return true;
+	}
+
+	return true;
+}
+
+// Steps of rebuilding the groups a split left behind
+bool FDeferredBuildWork::StepRebuildGroups(UBuildSystemSubsystem& BuildSystem, FDeferredWork& Work)
+{
+	SCOPE_CYCLE_COUNTER(STAT_BuildSystem_UpdateFusedSet);
+	LLM_SCOPE_BYTAG(BuildSystem_FusedSets);
+
+	FPartRegistry& Registry = BuildSystem.GetPartRegistry();
+
+	// Start gathering the next connected group from the first part that is not in one yet
+	if (Work.Connected.Num() == 0) {
+		while (Work.Parts.IsValidIndex(Work.NextIndex) && (!IsValid(Work.Parts[Work.NextIndex]) || Work.Gathered.Contains(Work.Parts[Work.NextIndex]))) {
+			++Work.NextIndex;
+		}
+
+		// Every part is in a group again, so the split itself is recorded after the groups it left behind, along with the group id it had before
+		if (!Work.Parts.IsValidIndex(Work.NextIndex)) {
+			FFlightEvent Event;
+			Event.Type = EFlightEventType::Split;
+			Event.HeldObject = Work.SplitObject;
+			Event.HeldGroupId = Work.GroupId;
+			Event.Count = Work.NumSplitGroups;
+			BuildSystem.GetFlightRecorder().Record(Event);
+			return true;
+		}
+
+		AMoveableObject* Seed = Work.Parts[Work.NextIndex];
+		Work.Connected.Add(Seed);
+		Work.Gathered.Add(Seed);
+		Work.GatherIndex = 0;
+		Work.AssignIndex = 0;
+		return false;
+	}
+
+	// Follow the links of the next gathered part to the parts it is still connected to
+	if (Work.GatherIndex < Work.Connected.Num()) {
+		AMoveableObject* Part = Work.Connected[Work.GatherIndex++];
+		BuildSystem.GetLinkTable().ForEachObjectLink(Part, [&Work](FConstraintLinkHandle, const FPhysicsConstraintLink& Link) {
+			for (AMoveableObject* Linked : { Link.ComponentA, Link.ComponentB }) {
+				bool bAlreadyGathered = false;
+				if (IsValid(Linked)) {
+					Work.Gathered.Add(Linked, &bAlreadyGathered);
+					if (!bAlreadyGathered) {
+						Work.Connected.Add(Linked);
+					}
+				}
+			}
+		});
+
+		// Once the whole connected group has been gathered it becomes a group of its own
+		if (Work.GatherIndex == Work.Connected.Num()) {
+			Work.FusedSet.Reset();
+			Work.FusedSet.Append(Work.Connected);
+			Work.ConnectedGroupId = Registry.NewGroupId();
+		}
+		return false;
+	}
+
+	// Hand the connected group's set out one part at a time, clearing any highlight it had in the group it left
+	AMoveableObject* Part = Work.Connected[Work.AssignIndex++];
+	Part->FusedObjects = Work.FusedSet;
+	Part->MeshComponent->SetOverlayMaterial(nullptr);
+	Registry.SetGroupId(Part, Work.ConnectedGroupId);
+
+	if (Work.AssignIndex == Work.Connected.Num()) {
+		FFlightEvent Event;
+		Event.Type = EFlightEventType::SplitGroup;
+		Event.HeldObject = Work.Connected[0]->GetFName();
+		Event.HeldGroupId = Work.ConnectedGroupId;
+		Event.Count = Work.Connected.Num();
+		BuildSystem.GetFlightRecorder().Record(Event);
+
+		// The first group left behind replaces the group that was split, every other one is a new group
+		++Work.NumSplitGroups;
+		if (Work.Gathered.Num() > Work.Connected.Num()) {
+			INC_DWORD_STAT(STAT_BuildSystem_Groups);
+		}
+		Work.Connected.Reset();
+	}
+	return false;
+}
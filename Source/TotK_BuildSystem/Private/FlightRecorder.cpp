@@ -0,0 +1,214 @@
+#include "FlightRecorder.h"
+#include "BuildSystemSubsystem.h"
+#include "BuildSystemStats.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "Engine/World.h"
+
+namespace
+{
+	// Identifies flight recorder dumps, followed by the format version
+	const uint32 FlightRecorderMagic = 0x52464254;
+	const uint32 FlightRecorderVersion = 1;
+
+	// Short names of each event type and snap type for decoded dumps
+	const TCHAR* EventTypeNames[] = { TEXT("Grab"), TEXT("Candidate"), TEXT("Snap"), TEXT("FuseBegin"), TEXT("FuseEnd"), TEXT("Split"), TEXT("SplitGroup") };
+	const TCHAR* SnapTypeNames[] = { TEXT("None"), TEXT("SnapPoint"), TEXT("CollisionPoint") };
+	static_assert(UE_ARRAY_COUNT(EventTypeNames) == (int32)EFlightEventType::Num, "Every event type needs a name");
+
+	// Read or write an event, with its object names stored as indices into the dump's name table
+	void SerializeEvent(FArchive& Ar, FFlightEvent& Event, int32& HeldNameIndex, int32& OtherNameIndex)
+	{
+		uint8 Type = (uint8)Event.Type;
+		uint8 HeldSnapType = (uint8)Event.HeldSnapType;
+		uint8 OtherSnapType = (uint8)Event.OtherSnapType;
+
+		Ar << Event.Time << Event.Frame << Type << HeldSnapType << OtherSnapType;
+		Ar << HeldNameIndex << OtherNameIndex << Event.HeldGroupId << Event.OtherGroupId;
+		Ar << Event.Count << Event.Distance << Event.HeldPoint << Event.OtherPoint;
+
+		Event.Type = (EFlightEventType)FMath::Min<uint8>(Type, (uint8)EFlightEventType::Num);
+		Event.HeldSnapType = (EFlightSnapType)FMath::Min<uint8>(HeldSnapType, (uint8)EFlightSnapType::CollisionPoint);
+		Event.OtherSnapType = (EFlightSnapType)FMath::Min<uint8>(OtherSnapType, (uint8)EFlightSnapType::CollisionPoint);
+	}
+}
+
+// Size the ring to hold the given number of events, dropping every recorded event. A capacity of 0 stops recording
+void FFlightRecorder::Init(int32 InCapacity)
+{
+	LLM_SCOPE_BYTAG(BuildSystem);
+
+	Events.Empty(FMath::Max(InCapacity, 0));
+	Events.SetNum(FMath::Max(InCapacity, 0));
+	NextIndex = 0;
+	NumRecorded = 0;
+}
+
+// Copy the events in the ring, oldest first
+void FFlightRecorder::GetEvents(TArray<FFlightEvent>& OutEvents) const
+{
+	OutEvents.Reset(Num());
+
+	// Until the ring has wrapped the oldest event is in the first slot, afterwards it is the next one to be overwritten
+	const int32 FirstIndex = NumRecorded > (uint64)Events.Num() ? NextIndex : 0;
+	for (int32 i = 0; i < Num(); ++i) {
+		OutEvents.Add(Events[(FirstIndex + i) % Events.Num()]);
+	}
+}
+
+// Write the events in the ring to a file, oldest first
+bool FFlightRecorder::SaveToFile(const FString& Filename) const
+{
+	TArray<FFlightEvent> OrderedEvents;
+	GetEvents(OrderedEvents);
+
+	// Names are only written once, the events refer to them by index
+	TArray<FName> Names;
+	TArray<TPair<int32, int32>> NameIndices;
+	NameIndices.Reserve(OrderedEvents.Num());
+	for (const FFlightEvent& Event : OrderedEvents) {
+		NameIndices.Emplace(Names.AddUnique(Event.HeldObject), Names.AddUnique(Event.OtherObject));
+	}
+
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+
+	uint32 Magic = FlightRecorderMagic;
+	uint32 Version = FlightRecorderVersion;
+	uint64 TotalRecorded = NumRecorded;
+	Writer << Magic << Version << TotalRecorded << Names;
+
+	int32 NumEvents = OrderedEvents.Num();
+	Writer << NumEvents;
+	for (int32 i = 0; i < NumEvents; ++i) {
+		SerializeEvent(Writer, OrderedEvents[i], NameIndices[i].Key, NameIndices[i].Value);
+	}
+
+	return FFileHelper::SaveArrayToFile(Bytes, *Filename);
+}
+
+// Read the events written to a file, returning false if it could not be read or is not a flight recorder dump
+bool FFlightRecorder::LoadFromFile(const FString& Filename, TArray<FFlightEvent>& OutEvents)
+{
+	OutEvents.Reset();
+
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Filename)) return false;
+
+	FMemoryReader Reader(Bytes);
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	uint64 TotalRecorded = 0;
+	Reader << Magic << Version;
+	if (Reader.IsError() || Magic != FlightRecorderMagic || Version != FlightRecorderVersion) return false;
+
+	TArray<FName> Names;
+	int32 NumEvents = 0;
+	Reader << TotalRecorded << Names << NumEvents;
+	if (Reader.IsError() || NumEvents < 0) return false;
+
+	OutEvents.SetNum(NumEvents);
+	for (FFlightEvent& Event : OutEvents) {
+		int32 HeldNameIndex = INDEX_NONE;
+		int32 OtherNameIndex = INDEX_NONE;
+		SerializeEvent(Reader, Event, HeldNameIndex, OtherNameIndex);
+		if (Reader.IsError() || !Names.IsValidIndex(HeldNameIndex) || !Names.IsValidIndex(OtherNameIndex) || Event.Type == EFlightEventType::Num) {
+			OutEvents.Reset();
+			return false;
+		}
+
+		Event.HeldObject = Names[HeldNameIndex];
+		Event.OtherObject = Names[OtherNameIndex];
+	}
+
+	return true;
+}
+
+// Describe an event as a line of text, with its time relative to the given start time
+FString FFlightRecorder::Describe(const FFlightEvent& Event, double StartTime)
+{
+	FString Line = FString::Printf(TEXT("%10.4f  frame %-8u %-10s %s (group %d)"),
+		Event.Time - StartTime, Event.Frame, EventTypeNames[(uint8)Event.Type], *Event.HeldObject.ToString(), Event.HeldGroupId);
+
+	switch (Event.Type) {
+	case EFlightEventType::Candidate:
+		Line += FString::Printf(TEXT(" -> %s (group %d), %.1f away, %d overlaps searched"), *Event.OtherObject.ToString(), Event.OtherGroupId, Event.Distance, Event.Count);
+		break;
+
+	case EFlightEventType::Snap:
+	case EFlightEventType::FuseBegin:
+		Line += FString::Printf(TEXT(" -> %s (group %d), %s %s -> %s %s, %.2f apart"), *Event.OtherObject.ToString(), Event.OtherGroupId,
+			SnapTypeNames[(uint8)Event.HeldSnapType], *Event.HeldPoint.ToCompactString(), SnapTypeNames[(uint8)Event.OtherSnapType], *Event.OtherPoint.ToCompactString(), Event.Distance);
+		break;
+
+	case EFlightEventType::FuseEnd:
+		Line += FString::Printf(TEXT(" fused onto %s, %d parts"), *Event.OtherObject.ToString(), Event.Count);
+		break;
+
+	case EFlightEventType::Split:
+		Line += FString::Printf(TEXT(" split into %d groups"), Event.Count);
+		break;
+
+	default:
+		Line += FString::Printf(TEXT(", %d parts"), Event.Count);
+		break;
+	}
+
+	return Line;
+}
+
+// Read a dump and write it out as text next to it, one event per line, returning the number of events decoded or INDEX_NONE if it could not be read
+int32 FFlightRecorder::DecodeFile(const FString& Filename)
+{
+	TArray<FFlightEvent> DecodedEvents;
+	if (!LoadFromFile(Filename, DecodedEvents)) return INDEX_NONE;
+
+	const double StartTime = DecodedEvents.Num() > 0 ? DecodedEvents[0].Time : 0.0;
+	TArray<FString> Lines;
+	Lines.Reserve(DecodedEvents.Num());
+	for (const FFlightEvent& Event : DecodedEvents) {
+		Lines.Add(Describe(Event, StartTime));
+	}
+
+	if (!FFileHelper::SaveStringArrayToFile(Lines, *FPaths::ChangeExtension(Filename, TEXT(".txt")))) return INDEX_NONE;
+	return DecodedEvents.Num();
+}
+
+// Get the file a dump with the given name is written to, which is under Saved/FlightRecorder unless the name is already a path
+FString FFlightRecorder::GetDumpFilename(const FString& Name)
+{
+	return FPaths::IsRelative(Name) && FPaths::GetExtension(Name).IsEmpty() ? FPaths::ProjectSavedDir() / TEXT("FlightRecorder") / Name + TEXT(".flightrec") : Name;
+}
+
+// Console command - BuildSystem.DumpFlightRecorder [Name]
+static FAutoConsoleCommandWithWorldAndArgs DumpFlightRecorderCommand(
+	TEXT("BuildSystem.DumpFlightRecorder"),
+	TEXT("Write the fuse and split decisions in the flight recorder to Saved/FlightRecorder, named with the current time unless given"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World) {
+		if (UBuildSystemSubsystem* BuildSystem = World ? World->GetSubsystem<UBuildSystemSubsystem>() : nullptr) {
+			BuildSystem->DumpFlightRecorder(Args.Num() > 0 ? Args[0] : FString());
+		}
+	})
+);
+
+// Console command - BuildSystem.DecodeFlightRecorder Name
+static FAutoConsoleCommand DecodeFlightRecorderCommand(
+	TEXT("BuildSystem.DecodeFlightRecorder"),
+	TEXT("Write a flight recorder dump out as text next to it, one event per line"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args) {
+		if (Args.Num() == 0) return;
+
+		const FString Filename = FFlightRecorder::GetDumpFilename(Args[0]);
+		const int32 NumEvents = FFlightRecorder::DecodeFile(Filename);
+		if (NumEvents != INDEX_NONE) {
+			UE_LOG(LogTemp, Display, TEXT("Decoded %d flight recorder events to %s"), NumEvents, *FPaths::ChangeExtension(Filename, TEXT(".txt")));
+		}
+
+		else {
+			UE_LOG(LogTemp, Error, TEXT("Failed to decode flight recorder dump %s"), *Filename);
+		}
+	})
+);
@@ -0,0 +1,169 @@
+#include "FuseCandidateSearch.h"
+#include "MoveableObject.h"
+#include "PartRegistry.h"
+#include "BuildSystemStats.h"
+#include "DrawDebugHelpers.h"
+#include "Async/ParallelFor.h"
+
+// Get the snapshot location of a part, falling back to the actor if it is not registered
+static FVector GetSnapshotLocation(const FPartRegistry& Registry, const AMoveableObject* Part, int32& OutGroupId)
+{
+	const int32 Index = Registry.GetIndex(Part);
+	OutGroupId = Index != INDEX_NONE ? Registry.GroupIds[Index] : INDEX_NONE;
+	return Index != INDEX_NONE ? Registry.Locations[Index] : Part->GetActorLocation();
+}
+
+// Gather every member of the held object's group with a fuse collision box, along with the moveable objects overlapping it that are not in a locked group
+void FFuseCandidateSearch::Gather(const AMoveableObject* HeldObject, const FPartRegistry& Registry, TConstArrayView<int32> LockedGroupIds)
+{
+	LLM_SCOPE_BYTAG(BuildSystem_Components);
+
+	Members.Reset();
+	Candidates.Reset();
+
+	for (AMoveableObject* FusedObject : HeldObject->FusedObjects) {
+		// Do not check for collisions if the current object does not have a collision box
+		if (!FusedObject || !FusedObject->FuseCollisionBox) continue;
+
+		FMember& Member = Members.AddDefaulted_GetRef();
+		Member.Object = FusedObject;
+		Member.Location = GetSnapshotLocation(Registry, FusedObject, Member.GroupId);
+		Member.FirstCandidate = Candidates.Num();
+
+		// Overlaps are only safe to read on the game thread, so they are gathered before any work is spread across threads
+		FusedObject->FuseCollisionBox->GetOverlappingActors(OverlapActorsScratch, AMoveableObject::StaticClass());
+		for (AActor* OverlapActor : OverlapActorsScratch) {
+			AMoveableObject* OverlapMoveable = Cast<AMoveableObject>(OverlapActor);
+			if (!OverlapMoveable) continue;
+
+			// Groups held or being fused with by another held object cannot be fused with until they are free again
+			int32 GroupId = INDEX_NONE;
+			const FVector Location = GetSnapshotLocation(Registry, OverlapMoveable, GroupId);
+			if (LockedGroupIds.Contains(GroupId)) continue;
+
+			FCandidate& Candidate = Candidates.AddDefaulted_GetRef();
+			Candidate.Object = OverlapMoveable;
+			Candidate.Location = Location;
+			Candidate.GroupId = GroupId;
+		}
+		Member.NumCandidates = Candidates.Num() - Member.FirstCandidate;
+	}
+}
+
+// Find the closest unblocked candidate of every member on up to MaxWorkers threads, then reduce them to the closest pair
+FFuseCandidate FFuseCandidateSearch::Evaluate(UWorld* World, int32 MaxWorkers)
+{
+	// Members are split into one batch per worker. Line of sight traces only read the physics scene, which is safe from worker threads
+	if (MaxWorkers > 1 && Members.Num() > 1) {
+		const int32 BatchSize = FMath::DivideAndRoundUp(Members.Num(), MaxWorkers);
+		ParallelFor(TEXT("BuildSystem.EvaluateFuseCandidates"), Members.Num(), BatchSize, [this, World](int32 MemberIndex) {
+			EvaluateMember(World, MemberIndex);
+		});
+	}
+
+	else {
+		for (int32 MemberIndex = 0; MemberIndex < Members.Num(); ++MemberIndex) {
+			EvaluateMember(World, MemberIndex);
+		}
+	}
+
+	// Reduce in member order, letting later members win ties so the result matches comparing members one after another
+	FFuseCandidate Best;
+	for (const FMember& Member : Members) {
+		if (Member.Result.Candidate && (!Best.Candidate || Member.Result.Distance <= Best.Distance)) {
+			Best = Member.Result;
+		}
+	}
+
+	return Best;
+}
+
+// Find the closest unblocked candidate of a single member, leaving it in the member's result
+void FFuseCandidateSearch::EvaluateMember(UWorld* World, int32 MemberIndex)
+{
+	static const FName LOSCheckName(TEXT("LOSCheck"));
+
+	FMember& Member = Members[MemberIndex];
+	Member.Result = FFuseCandidate();
+
+	for (int32 CandidateIndex = Member.FirstCandidate; CandidateIndex < Member.FirstCandidate + Member.NumCandidates; ++CandidateIndex) {
+		FCandidate& Candidate = Candidates[CandidateIndex];
+
+		// Move to the next candidate if it is already fused to the member
+		if (Candidate.GroupId != INDEX_NONE && Candidate.GroupId == Member.GroupId) continue;
+		INC_DWORD_STAT(STAT_BuildSystem_CandidatesTested);
+
+		// Line trace from the member to the candidate to see if there are any blocking objects
+		INC_DWORD_STAT(STAT_BuildSystem_TracesIssued);
+		FHitResult TestHit;
+		const bool bBlockedHit = World->LineTraceSingleByChannel(
+			TestHit,
+			Member.Location,
+			Candidate.Location,
+			ECC_Visibility,
+			FCollisionQueryParams(LOSCheckName, false, Member.Object)
+		);
+		Candidate.ImpactPoint = TestHit.ImpactPoint;
+		Candidate.bTraced = true;
+
+		// If the trace is blocked by anything other than the candidate, move to the next candidate
+		Candidate.bClear = !bBlockedHit || TestHit.GetActor() == Candidate.Object;
+		if (!Candidate.bClear) continue;
+
+		// Keep the earlier candidate when two are the same distance away
+		const float Distance = FVector::Distance(Member.Location, Candidate.Location);
+		if (!Member.Result.Candidate || Distance < Member.Result.Distance) {
+			Member.Result.FusedObject = Member.Object;
+			Member.Result.Candidate = Candidate.Object;
+			Member.Result.Distance = Distance;
+		}
+	}
+}
+
+// Get every candidate of the last evaluation with a clear line of sight to a member, paired with its closest member, for fusing at several contacts at once
+void FFuseCandidateSearch::GetContacts(TArray<FFuseCandidate, TInlineAllocator<16>>& OutContacts) const
+{
+	OutContacts.Reset();
+
+	for (const FMember& Member : Members) {
+		for (int32 CandidateIndex = Member.FirstCandidate; CandidateIndex < Member.FirstCandidate + Member.NumCandidates; ++CandidateIndex) {
+			const FCandidate& Candidate = Candidates[CandidateIndex];
+			if (!Candidate.bClear) continue;
+
+			// A candidate overlapping several members is only a contact with the closest of them, keeping the earlier member on ties
+			const float Distance = FVector::Distance(Member.Location, Candidate.Location);
+			FFuseCandidate* Contact = OutContacts.FindByPredicate([&Candidate](const FFuseCandidate& Existing) { return Existing.Candidate == Candidate.Object; });
+			if (!Contact) {
+				OutContacts.Add({ Member.Object, Candidate.Object, Distance });
+			}
+
+			else if (Distance < Contact->Distance) {
+				*Contact = { Member.Object, Candidate.Object, Distance };
+			}
+		}
+	}
+}
+
+// Draw the candidates and line of sight traces of the last evaluation
+void FFuseCandidateSearch::DrawDebug(UWorld* World) const
+{
+	for (const FMember& Member : Members) {
+		for (int32 CandidateIndex = Member.FirstCandidate; CandidateIndex < Member.FirstCandidate + Member.NumCandidates; ++CandidateIndex) {
+			const FCandidate& Candidate = Candidates[CandidateIndex];
+
+			DrawDebugPoint(World, Candidate.Location, 10.f, FColor::Red, false);
+			DrawDebugLine(World, Member.Location, Candidate.Location, FColor::Yellow, false);
+
+			if (Candidate.bTraced) {
+				DrawDebugPoint(World, Candidate.ImpactPoint, 10.f, FColor::Orange, false);
+				DrawDebugLine(World, Member.Location, Candidate.ImpactPoint, FColor::Green, false);
+			}
+		}
+	}
+}
+
+// Get the memory allocated by the search
+SIZE_T FFuseCandidateSearch::GetAllocatedSize() const
+{
+	return Members.GetAllocatedSize() + Candidates.GetAllocatedSize() + OverlapActorsScratch.GetAllocatedSize();
+}
@@ -6,6 +6,8 @@
 #include "Kismet/KismetMathLibrary.h"
 #include "DrawDebugHelpers.h"
 #include "TotK_BuildSystem/TotK_BuildSystemCharacter.h"
+#include "BuildSystemStats.h"
+#include "BuildSystemSubsystem.h"
 
 #include "../DebgugHelper.h"
 
@@ -34,12 +36,17 @@ void UGrabber::BeginPlay()
 
 	// Get reference to the player character
 	PlayerCharacter = Cast<ATotK_BuildSystemCharacter>(GetOwner());
+
+	// Build the table of orientations held objects are rounded to when grabbed
+	OrientationLattice.Build(RotationDegrees);
 }
 
 
 // Called every frame
 void UGrabber::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
+	SCOPE_CYCLE_COUNTER(STAT_BuildSystem_GrabberTick);
+
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
 	// Do nothing if there is no valid physics handle or held object
@@ -63,9 +70,9 @@ void UGrabber::UpdateHeldObjectLocationAndRotation()
 	FQuat AdjustedLookAtQuat = FQuat(AdjustedLookAtRotation);
 	AdjustedLookAtQuat.Normalize();
 
-	// Create the final rotation of the object by applying the offset to hold the original object rotation, then the manually adjusted 
-	// rotation to show player rotations and then the adjust lookat rotation to keep the object facing the player as they turn.
-	FQuat FinalQuat = AdjustedLookAtQuat * AdjustedQuat * OffsetQuat;
+	// Create the final rotation of the object by applying the held orientation, which holds the original object rotation along with any player rotations,
+	// and then the adjust lookat rotation to keep the object facing the player as they turn.
+	FQuat FinalQuat = AdjustedLookAtQuat * HeldOrientation;
 	FinalQuat.Normalize();
 
 	// Set the location and rotation of the held object
@@ -118,6 +125,11 @@ void UGrabber::Grab()
 		// Rotate the player towrards the object being picked up
 		GetOwner()->SetActorRotation(OwnerRotation);
 
+		// Standing on the object is checked against its whole group, so any split or merge of the group still being handed out is finished first
+		if (UBuildSystemSubsystem* BuildSystem = GetWorld()->GetSubsystem<UBuildSystemSubsystem>()) {
+			BuildSystem->FinishGroupWork(MoveableObject);
+		}
+
 		// If the player is trying to grab an object they are standing on, do not do anything until they are no longer standing on the object or stop trying to grab the object
 		if (IsStandingOnObject(MoveableObject)) {
 			// Clear any existing timer handle
@@ -126,14 +138,17 @@ void UGrabber::Grab()
 			// Create a new timer to check every 0.1 seconds if the player is still standing on the grabbed object
 			GetWorld()->GetTimerManager().SetTimer(WaitToGrabHandle,
 				[this, MoveableObject]() {
+					// Owners other than the player character, such as builder bots, keep trying until they release
+					const bool bStillGrabbing = !PlayerCharacter || PlayerCharacter->bIsGrabbing;
+
 					// If the player moves off the object and is still trying to grab it, grab the object
-					if (!IsStandingOnObject(MoveableObject) && PlayerCharacter->bIsGrabbing) {
+					if (!IsStandingOnObject(MoveableObject) && bStillGrabbing) {
 						GetWorld()->GetTimerManager().ClearTimer(WaitToGrabHandle);
 						GrabObject(MoveableObject);
 					}
 
 					// If the player stopped trying to grab the object, clear the timer
-					else if (!PlayerCharacter->bIsGrabbing) {
+					else if (!bStillGrabbing) {
 						GetWorld()->GetTimerManager().ClearTimer(WaitToGrabHandle);
 					}
 
@@ -234,9 +249,15 @@ bool UGrabber::IsStandingOnObject(AMoveableObject* MoveableObject) const
 // Grab the object, setting its initial location and rotation
 void UGrabber::GrabObject(AMoveableObject* MoveableObject)
 {
-	// Get the component being grabbed and wake up rigid bodies
+	// Another grabber is already holding or fusing the object or its group, so leave it to them
+	UBuildSystemSubsystem* BuildSystem = GetWorld()->GetSubsystem<UBuildSystemSubsystem>();
+	if (BuildSystem && BuildSystem->IsGrabLocked(MoveableObject, this)) return;
+
+	// Get the component being grabbed and wake up the rigid bodies of its group
 	UPrimitiveComponent* HitComponent = MoveableObject->MeshComponent;
-	HitComponent->WakeAllRigidBodies();
+	if (BuildSystem) {
+		BuildSystem->WakeGroup(MoveableObject);
+	}
 
 	// Call OnGrab using the moveable objects interface
 	IMoveableObjectInterface::Execute_OnGrab(MoveableObject);
@@ -245,10 +266,9 @@ void UGrabber::GrabObject(AMoveableObject* MoveableObject)
 	FVector PlayerLocation = GetOwner()->GetActorLocation();
 	FVector TargetLocation = HitComponent->GetComponentLocation();
 
-	// Update the current hold distance to be the distance between the player and the held object with an offset of the closest point on the held object to the player
-	FVector OutUnusedVec;
+	// Update the current hold distance to be the distance between the player and the held object with an offset of the closest point on the held object's collision proxy to the player
 	float CenterDistance = FVector::Dist(PlayerLocation, TargetLocation);
-	HoldOffset = CenterDistance - HitComponent->GetClosestPointOnCollision(PlayerLocation, OutUnusedVec);
+	HoldOffset = CenterDistance - FVector::Dist(PlayerLocation, MoveableObject->GetClosestPointOnProxy(PlayerLocation));
 	CurrentHoldDistance = CenterDistance + HoldOffset;
 
 	// Store the lookat rotation from the player to the object. This is backwards due to the way meshes were created in blender, as their forward vector is seemingly backwards
@@ -262,14 +282,19 @@ void UGrabber::GrabObject(AMoveableObject* MoveableObject)
 	FQuat HeldQuat = FQuat(HeldRotation);
 	HeldQuat.Normalize();
 
-	// Store the offset between the look at rotation and the object's initial rotation, then round it based on set rotation degrees
-	OffsetQuat = AdjustedLookAtQuat.Inverse() * HeldQuat;
-	FRotator OffsetRotator = RoundObjectRotation(FRotator(OffsetQuat));
-	OffsetQuat = FQuat(OffsetRotator);
-	OffsetQuat.Normalize();
+	// Rebuild the orientation lattice if the preferred rotation degrees have changed, comparing against what was asked for as increments that do not divide a full turn fall back to quarter turns
+	if (OrientationLattice.GetRequestedStepDegrees() != RotationDegrees) {
+		OrientationLattice.Build(RotationDegrees);
+	}
 
-	// Reset the adjusted rotation when picking up a new object
-	AdjustedQuat = FQuat::Identity;
+	// Store the offset between the look at rotation and the object's initial rotation, rounded to the closest orientation in the lattice. This also resets any rotations from a previously held object
+	HeldOrientation = OrientationLattice.GetOrientation(OrientationLattice.FindNearest(AdjustedLookAtQuat.Inverse() * HeldQuat));
+
+	// The session belongs to this grabber, and fused snap points should round their roll to the same increments the player rotates the object by
+	if (FFuseSession* Session = BuildSystem ? BuildSystem->FindSession(MoveableObject) : nullptr) {
+		Session->Grabber = this;
+		Session->SnapRotationDegrees = RotationDegrees;
+	}
 
 	// Make sure the object is not held too closely
 	if (CurrentHoldDistance < MinHoldDistance) {
@@ -285,59 +310,12 @@ void UGrabber::GrabObject(AMoveableObject* MoveableObject)
 	);
 }
 
-// Round off the grabbed object's initial rotation based on the preferred rotation degrees
-FRotator UGrabber::RoundObjectRotation(FRotator HeldRot)
-{
-	FRotator ResRotation;
-
-	// Get all mods for calculations
-	float PitchMod = FMath::Fmod(HeldRot.Pitch, RotationDegrees);
-	float YawMod = FMath::Fmod(HeldRot.Yaw, RotationDegrees);
-	float RollMod = FMath::Fmod(HeldRot.Roll, RotationDegrees);
-
-	// Calculate the rounded rotations
-	ResRotation.Pitch = CalculateRotation(HeldRot.Pitch, PitchMod);
-	ResRotation.Yaw = CalculateRotation(HeldRot.Yaw, YawMod);
-	ResRotation.Roll = CalculateRotation(HeldRot.Roll, RollMod);
-
-	return ResRotation;
-}
-
-// Round off the specified pitch, yaw, or roll value
-float UGrabber::CalculateRotation(float CurrRot, float CurrMod)
-{
-	float RetRot = 0.0f;
-	float HalfRot = RotationDegrees / 2;
-
-	// Calculate the rounded values based on the mod values for pitch, yaw, and roll. For example: With RotationDegrees set to 45:
-	// If the currMod is close to 0, no adjustment is needed
-	if (FMath::Abs(CurrMod) < 0.01f) {
-		RetRot = 0;
-	}
-
-	// Calculate the rounded values based on the mod values for pitch, yaw, and roll. For example: With RotationDegrees set to 45:
-	// If the current mod is less than -22.5, we want to calculate (held rotation value + (-RotationDegrees - current mod value)) -> (-80 + (-45 - (-80 mod 45 = -35)) = -90)
-	else if (CurrMod < -HalfRot) {
-		RetRot = CurrRot + (-RotationDegrees - CurrMod);
-	}
-
-	// If the current mod is between -22.5 and 0, we want to calculate (held rotation value - current mod value) -> (-147 - (-147 mod 45 = -12) = -135)
-	// If the current mod is between 0 and 22.5, we want to calculate (held rotation value - current mod value) -> (94 - (94 mod 45 = 4) = 90)
-	else if (CurrMod > -HalfRot && CurrMod < HalfRot) {
-		RetRot = CurrRot - CurrMod;
-	}
-
-	// Otherwise, the current mod must be greater than 22.5, we want to calculate (held rotation value + (RotationDegrees - current mod value)) -> (68 + (45 - (68 mod 45 = 23)) = 90)
-	else {
-		RetRot = CurrRot + (RotationDegrees - CurrMod);
-	}
-
-	return RetRot;
-}
-
 // Release the currently grabbed item
 void UGrabber::Release()
 {
+	// Stop waiting to grab an object that is being stood on
+	GetWorld()->GetTimerManager().ClearTimer(WaitToGrabHandle);
+
 	// Check to make sure there is a valid physics handle with a grabbed object
 	if (!PhysicsHandle || !PhysicsHandle->GetGrabbedComponent()) return;
 
@@ -354,32 +332,54 @@ bool UGrabber::IsHoldingObject()
 	return PhysicsHandle->GetGrabbedComponent() != nullptr;
 }
 
+// Get the object currently being held, if there is one
+AMoveableObject* UGrabber::GetHeldObject() const
+{
+	return PhysicsHandle && PhysicsHandle->GetGrabbedComponent() ? Cast<AMoveableObject>(PhysicsHandle->GetGrabbedComponent()->GetOwner()) : nullptr;
+}
+
+// Get the point to aim the grabber at so that its grab sweep passes through a target, making up for the camera offset added to the end of the sweep
+FVector UGrabber::GetAimPoint(const FVector& Target) const
+{
+	FVector OwnerLocation;
+	FRotator OwnerRotation;
+	GetOwner()->GetActorEyesViewPoint(OwnerLocation, OwnerRotation);
+
+	// The offset grows along the sweep, so only the share of it reached at the target's distance is taken off
+	const float SweepFraction = FMath::Min(FVector::Dist(OwnerLocation, Target) / MaxGrabDistance, 1.f);
+	return Target - CameraOffsetVector * SweepFraction;
+}
+
 // Rotate the currently held object to the left
 void UGrabber::RotateLeft()
 {
-	FQuat DeltaRot = FQuat(FVector(0, 0, 1), FMath::DegreesToRadians(RotationDegrees));
-	AdjustedQuat = DeltaRot * AdjustedQuat;
+	StepHeldOrientation(EOrientationStep::Left);
 }
 
 // Rotate the currently held object to the right
 void UGrabber::RotateRight()
 {
-	FQuat DeltaRot = FQuat(FVector(0, 0, 1), FMath::DegreesToRadians(-RotationDegrees));
-	AdjustedQuat = DeltaRot * AdjustedQuat;
+	StepHeldOrientation(EOrientationStep::Right);
 }
 
 // Rotate the currently held object up
 void UGrabber::RotateUp()
 {
-	FQuat DeltaRot = FQuat(FVector(0, 1, 0), FMath::DegreesToRadians(-RotationDegrees));
-	AdjustedQuat = DeltaRot * AdjustedQuat;
+	StepHeldOrientation(EOrientationStep::Up);
 }
 
 // Rotate the currently held object down
 void UGrabber::RotateDown()
 {
-	FQuat DeltaRot = FQuat(FVector(0, 1, 0), FMath::DegreesToRadians(RotationDegrees));
-	AdjustedQuat = DeltaRot * AdjustedQuat;
+	StepHeldOrientation(EOrientationStep::Down);
+}
+
+// Rotate the held object one increment in a direction. The rotation is applied exactly rather than through the lattice, as finer increments
+// reach orientations the lattice does not contain, so only renormalize to keep the quaternion from drifting over many rotations
+void UGrabber::StepHeldOrientation(EOrientationStep Step)
+{
+	HeldOrientation = OrientationLattice.GetStepRotation(Step) * HeldOrientation;
+	HeldOrientation.Normalize();
 }
 
 // Move the currently held object towards player
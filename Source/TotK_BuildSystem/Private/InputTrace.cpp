@@ -0,0 +1,88 @@
+#include "InputTrace.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+
+namespace
+{
+	// Identifies input trace files, followed by the format version
+	const uint32 InputTraceMagic = 0x54494254;
+	const uint32 InputTraceVersion = 2;
+}
+
+// Add an action triggered on a frame, which must not be before the last event's frame
+void FInputTrace::Add(uint32 Frame, float Time, EInputTraceAction Action, const FVector2f& Value)
+{
+	check(Events.Num() == 0 || Events.Last().Frame <= Frame);
+
+	FInputTraceEvent& Event = Events.AddDefaulted_GetRef();
+	Event.Frame = Frame;
+	Event.Time = Time;
+	Event.Action = Action;
+	Event.Value = HasAxisValue(Action) ? Value : FVector2f::ZeroVector;
+}
+
+// Finish the trace after the given number of recorded frames, keeping any frames without input after the last event
+void FInputTrace::Finish(uint32 InNumFrames)
+{
+	RecordedFrames = InNumFrames;
+}
+
+// Read or write the trace, returning false if a trace being read is not valid
+bool FInputTrace::Serialize(FArchive& Ar)
+{
+	uint32 Magic = InputTraceMagic;
+	uint32 Version = InputTraceVersion;
+	Ar << Magic << Version;
+	if (Magic != InputTraceMagic || Version != InputTraceVersion) return false;
+
+	Ar << FixedDeltaTime << MapName << StartTransform << StartControlRotation;
+	Ar.SerializeIntPacked(RecordedFrames);
+
+	int32 NumEvents = Events.Num();
+	Ar << NumEvents;
+	if (Ar.IsLoading()) {
+		if (NumEvents < 0) return false;
+		Events.SetNum(NumEvents);
+	}
+
+	// Most frames are close to the previous event's frame, so they are packed as small deltas
+	uint32 PrevFrame = 0;
+	for (FInputTraceEvent& Event : Events) {
+		uint32 FrameDelta = Event.Frame - PrevFrame;
+		Ar.SerializeIntPacked(FrameDelta);
+		Event.Frame = PrevFrame + FrameDelta;
+		PrevFrame = Event.Frame;
+
+		uint8 Action = (uint8)Event.Action;
+		Ar << Event.Time << Action;
+		if (Action >= (uint8)EInputTraceAction::Num) return false;
+		Event.Action = (EInputTraceAction)Action;
+
+		if (HasAxisValue(Event.Action)) {
+			Ar << Event.Value;
+		}
+	}
+
+	return !Ar.IsError();
+}
+
+// Write the trace to a file
+bool FInputTrace::SaveToFile(const FString& Filename) const
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	const_cast<FInputTrace*>(this)->Serialize(Writer);
+
+	return FFileHelper::SaveArrayToFile(Bytes, *Filename);
+}
+
+// Read the trace from a file, returning false if it could not be read or is not a valid trace
+bool FInputTrace::LoadFromFile(const FString& Filename)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Filename)) return false;
+
+	FMemoryReader Reader(Bytes);
+	return Serialize(Reader);
+}
@@ -0,0 +1,146 @@
+#include "InstancedPartRenderer.h"
+#include "MoveableObject.h"
+#include "BuildSystemStats.h"
+#include "Components/InstancedStaticMeshComponent.h"
+
+// Draw every part that can be instanced through the instances of its mesh and material, and every other part through its own mesh component
+void FInstancedPartRenderer::Update(UWorld* World, const FPartRegistry& Registry)
+{
+	SCOPE_CYCLE_COUNTER(STAT_BuildSystem_UpdateInstances);
+	LLM_SCOPE_BYTAG(BuildSystem);
+
+	// Every instanced static mesh component goes with its host, so start again if the host has been destroyed
+	if (!Host.IsValid()) {
+		Batches.Reset();
+	}
+
+	for (TPair<FBatchKey, FBatch>& Batch : Batches) {
+		Batch.Value.Members.Reset();
+		Batch.Value.Transforms.Reset();
+		Batch.Value.bMoved = false;
+	}
+
+	// Sort every part into the batch of its mesh and material, hiding the mesh components of instanced parts and showing the rest
+	int32 NumInstancedParts = 0;
+	for (int32 Index = 0; Index < Registry.Num(); ++Index) {
+		AMoveableObject* Part = Registry.Parts[Index];
+		UStaticMeshComponent* Mesh = Part->MeshComponent;
+		if (!Mesh) continue;
+
+		// Frozen groups are already drawn through their own instances
+		if (EnumHasAnyFlags(Registry.Flags[Index], EPartFlags::Frozen)) continue;
+
+		const bool bInstanced = CanInstance(Part, Registry.Flags[Index]);
+		if (Mesh->IsVisible() == bInstanced) {
+			Mesh->SetVisibility(!bInstanced);
+		}
+		if (!bInstanced) continue;
+
+		FBatch& Batch = FindOrAddBatch(World, Mesh->GetStaticMesh(), Mesh->GetMaterial(0));
+		Batch.Members.Add(Part);
+		Batch.Transforms.Emplace(FQuat(Registry.Rotations[Index]), Registry.Locations[Index], Mesh->GetComponentScale());
+		Batch.bMoved |= !EnumHasAnyFlags(Registry.Flags[Index], EPartFlags::Asleep);
+		++NumInstancedParts;
+	}
+
+	// Only batches whose parts moved or changed are sent to the render thread
+	for (TPair<FBatchKey, FBatch>& Pair : Batches) {
+		FBatch& Batch = Pair.Value;
+		if (Batch.bMoved || Batch.Members != Batch.PrevMembers) {
+			if (Batch.Component->GetInstanceCount() == Batch.Transforms.Num()) {
+				Batch.Component->BatchUpdateInstancesTransforms(0, Batch.Transforms, true, true, true);
+			}
+
+			else {
+				Batch.Component->ClearInstances();
+				Batch.Component->AddInstances(Batch.Transforms, false, true);
+			}
+		}
+
+		Swap(Batch.Members, Batch.PrevMembers);
+	}
+
+	SET_DWORD_STAT(STAT_BuildSystem_InstancedParts, NumInstancedParts);
+}
+
+// Draw every part through its own mesh component again and remove every instance, leaving frozen groups drawn through their own instances
+void FInstancedPartRenderer::Reset(const FPartRegistry& Registry)
+{
+	for (int32 Index = 0; Index < Registry.Num(); ++Index) {
+		AMoveableObject* Part = Registry.Parts[Index];
+		if (EnumHasAnyFlags(Registry.Flags[Index], EPartFlags::Frozen)) continue;
+
+		if (Part->MeshComponent && !Part->MeshComponent->IsVisible()) {
+			Part->MeshComponent->SetVisibility(true);
+		}
+	}
+
+	if (AActor* HostActor = Host.Get()) {
+		HostActor->Destroy();
+	}
+	Host.Reset();
+	Batches.Reset();
+
+	SET_DWORD_STAT(STAT_BuildSystem_InstancedParts, 0);
+}
+
+// Check if a part can be drawn as an instance, as held, fusing and highlighted parts need their own mesh component for their overlay material
+bool FInstancedPartRenderer::CanInstance(const AMoveableObject* Part, EPartFlags Flags)
+{
+	const UStaticMeshComponent* Mesh = Part->MeshComponent;
+
+	// Instances are batched by their first material, so parts overriding more than one material keep their own mesh component
+	return Mesh && Mesh->GetStaticMesh() && !Mesh->GetOverlayMaterial() && Mesh->OverrideMaterials.Num() <= 1
+		&& !EnumHasAnyFlags(Flags, EPartFlags::Grabbed | EPartFlags::Fusing);
+}
+
+// Get the number of parts drawn as instances
+int32 FInstancedPartRenderer::NumInstances() const
+{
+	int32 NumInstances = 0;
+	for (const TPair<FBatchKey, FBatch>& Batch : Batches) {
+		NumInstances += Batch.Value.Component ? Batch.Value.Component->GetInstanceCount() : 0;
+	}
+	return NumInstances;
+}
+
+// Get the memory allocated by the renderer
+SIZE_T FInstancedPartRenderer::GetAllocatedSize() const
+{
+	SIZE_T Size = Batches.GetAllocatedSize();
+	for (const TPair<FBatchKey, FBatch>& Batch : Batches) {
+		Size += Batch.Value.Members.GetAllocatedSize() + Batch.Value.PrevMembers.GetAllocatedSize() + Batch.Value.Transforms.GetAllocatedSize();
+	}
+	return Size;
+}
+
+// Get the batch for a mesh and material, creating its instanced static mesh component the first time it is needed
+FInstancedPartRenderer::FBatch& FInstancedPartRenderer::FindOrAddBatch(UWorld* World, UStaticMesh* Mesh, UMaterialInterface* Material)
+{
+	const FBatchKey Key(Mesh, Material);
+	if (FBatch* Batch = Batches.Find(Key)) {
+		return *Batch;
+	}
+
+	AActor* HostActor = Host.Get();
+	if (!HostActor) {
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		HostActor = World->SpawnActor<AActor>(SpawnParams);
+		Host = HostActor;
+	}
+
+	// Instances are only drawn, every part keeps its own mesh component for collision and physics
+	UInstancedStaticMeshComponent* Component = NewObject<UInstancedStaticMeshComponent>(HostActor);
+	Component->SetMobility(EComponentMobility::Movable);
+	Component->SetStaticMesh(Mesh);
+	Component->SetMaterial(0, Material);
+	Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Component->SetCanEverAffectNavigation(false);
+	HostActor->AddInstanceComponent(Component);
+	Component->RegisterComponent();
+
+	FBatch& Batch = Batches.Add(Key);
+	Batch.Component = Component;
+	return Batch;
+}
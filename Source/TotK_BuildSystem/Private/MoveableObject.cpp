@@ -2,15 +2,72 @@
 #include "DrawDebugHelpers.h"
 #include "SnapPointComponent.h"
 #include "Kismet/KismetSystemLibrary.h"
+#include "BuildSystemStats.h"
+#include "BuildSystemSubsystem.h"
+#include "FuseCandidateSearch.h"
+#include "AsyncSnapResolver.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "InstancedPartRenderer.h"
 
 #include "../DebgugHelper.h"
 
+// Number of threads fuse candidates are searched on, where 0 uses every task graph worker and 1 searches on the game thread
+static TAutoConsoleVariable<int32> CVarCandidateWorkers(
+	TEXT("BuildSystem.CandidateWorkers"),
+	0,
+	TEXT("Number of threads fuse candidates are searched on. 0 uses every worker thread, 1 searches on the game thread"));
+
+// Smallest held group that searches for fuse candidates on more than one thread, as smaller groups finish faster than the threads can be woken
+static TAutoConsoleVariable<int32> CVarParallelCandidateMinMembers(
+	TEXT("BuildSystem.ParallelCandidateMinMembers"),
+	64,
+	TEXT("Smallest held group that searches for fuse candidates on more than one thread"));
+
+// Resolve snap points on a worker thread, picking up the result on the next frame, instead of on the game thread
+static TAutoConsoleVariable<bool> CVarAsyncSnapResolution(
+	TEXT("BuildSystem.AsyncSnapResolution"),
+	false,
+	TEXT("Resolve snap points on a worker thread with one frame of latency instead of on the game thread"));
+
+// Fuse at every contact between the held group and nearby groups that lines up with the closest one, merging every group touched in a single pass
+static TAutoConsoleVariable<bool> CVarMultiContactFuse(
+	TEXT("BuildSystem.MultiContactFuse"),
+	false,
+	TEXT("On release, fuse at every contact between the held group and nearby groups that lines up with the closest one, merging every group touched at once"));
+
+// Distance a contact may be from lining up with the closest contact and still be fused with it
+static TAutoConsoleVariable<float> CVarMultiContactTolerance(
+	TEXT("BuildSystem.MultiContactTolerance"),
+	10.f,
+	TEXT("Distance in cm a contact may be from lining up with the closest contact and still be fused along with it"));
+
+// Solver iterations used by objects at low fidelity
+static TAutoConsoleVariable<int32> CVarSignificanceSolverIterations(
+	TEXT("BuildSystem.SignificanceSolverIterations"),
+	1,
+	TEXT("Position solver iterations used by objects reduced to low fidelity"));
+
+// Make a flight recorder event for a decision between two objects, with their group ids from the part registry
+static FFlightEvent MakeFlightEvent(EFlightEventType Type, const FPartRegistry& Registry, const AMoveableObject* HeldObject, const AMoveableObject* OtherObject)
+{
+	FFlightEvent Event;
+	Event.Type = Type;
+	Event.HeldObject = HeldObject ? HeldObject->GetFName() : NAME_None;
+	Event.OtherObject = OtherObject ? OtherObject->GetFName() : NAME_None;
+	Event.HeldGroupId = HeldObject ? Registry.GetGroupId(HeldObject) : INDEX_NONE;
+	Event.OtherGroupId = OtherObject ? Registry.GetGroupId(OtherObject) : INDEX_NONE;
+	return Event;
+}
+
 // Sets default values
 AMoveableObject::AMoveableObject()
 {
 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
+	LLM_SCOPE_BYTAG(BuildSystem_Components);
+
 	// Add the static mesh component as the root component
 	MeshComponent = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("MeshComponent"));
 	MeshComponent->SetSimulatePhysics(true);
@@ -21,8 +78,6 @@ AMoveableObject::AMoveableObject()
 	// Add the box collider for fusing objects
 	FuseCollisionBox = CreateDefaultSubobject<UBoxComponent>(TEXT("FuseCollisionBox"));
 	FuseCollisionBox->SetupAttachment(MeshComponent);
-
-	bIsFusing = false;
 }
 
 // Called when the game starts or when spawned
@@ -31,38 +86,73 @@ void AMoveableObject::BeginPlay()
 	Super::BeginPlay();
 
 	// Initialize the set of fused objects and after this object has been created 
-	FusedObjects.Add(this);
-	ClosestFusedMoveableObject = this;
+	{
+		LLM_SCOPE_BYTAG(BuildSystem_FusedSets);
+		FusedObjects.Add(this);
+	}
 
 	// Initialize the array of snap points, storing all snap points created from the blue print
-	GetComponents<USnapPointComponent>(SnapPoints);
+	{
+		LLM_SCOPE_BYTAG(BuildSystem_SnapPoints);
+		GetComponents<USnapPointComponent>(SnapPoints);
+	}
+
+	// Velocities are kept in the part registry and fuse sessions are ticked by the build system subsystem, so objects only need to tick to draw debug information
+	SetActorTickEnabled(bDebugMode && PrimaryActorTick.bStartWithTickEnabled);
+
+	// Every new object starts as its own group
+	if (UBuildSystemSubsystem* BuildSystem = GetBuildSystem()) {
+		BuildSystem->GetPartRegistry().Register(this);
+	}
+	INC_DWORD_STAT(STAT_BuildSystem_Parts);
+	INC_DWORD_STAT(STAT_BuildSystem_Groups);
 }
 
-// Called every frame
-void AMoveableObject::Tick(float DeltaTime)
+// Called when the object is removed from the world
+void AMoveableObject::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
+	Super::EndPlay(EndPlayReason);
 
-	// Update the current velocities of the moveable object
-	UpdateVelocities();
+	// Pooled objects have already left their group and the part registry, so they only need to leave the pool
+	if (bPooled) {
+		if (EndPlayReason == EEndPlayReason::Destroyed) {
+			if (UBuildSystemSubsystem* BuildSystem = GetBuildSystem()) {
+				BuildSystem->GetPartPool().Remove(this);
+			}
+		}
+		return;
+	}
 
-	// If an object is currently held, get the closest moveable object within its radius and update the overlay material based on if there is a nearby object
-	if (bIsGrabbed && MeshComponent) {
-		ClosestNearbyMoveableObject = GetClosestMoveableObjectInRadius();
-		UpdateMoveableObjectMaterial(this, ClosestNearbyMoveableObject ? true : false);
+	// Deferred work of the object's group has to finish before it stops pointing at the object
+	if (UBuildSystemSubsystem* BuildSystem = GetBuildSystem()) {
+		BuildSystem->FinishGroupWork(this);
 	}
 
-	// If a nearby moveable object exists, and if two objects are currently fusing, interpolate the two objects towards each other. Otherwise, simply update their closest snap points
-	if (ClosestNearbyMoveableObject) {
-		if (bIsFusing) {
-			InterpFusedObjects(DeltaTime);
-		}
+	// Remove the links of a destroyed object so the link table does not keep pointing at it. If the whole world is ending, the table goes with it
+	if (EndPlayReason == EEndPlayReason::Destroyed) {
+		UnfreezeGroup();
+		RemovePhysicsLink();
+	}
 
-		else {
-			UpdateSnapPoints();
-		}
+	if (UBuildSystemSubsystem* BuildSystem = GetBuildSystem()) {
+		BuildSystem->GetPartRegistry().Unregister(this);
 	}
 
+	DEC_DWORD_STAT(STAT_BuildSystem_Parts);
+
+	// Only count the group once, when its last object is removed
+	if (FusedObjects.Num() <= 1) {
+		DEC_DWORD_STAT(STAT_BuildSystem_Groups);
+	}
+}
+
+// Called every frame
+void AMoveableObject::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_BuildSystem_Tick);
+
+	Super::Tick(DeltaTime);
+
 	////////////////////////////////////////////////////////////////////////////////////
 	// For debugging 
 	// Draw the moveable object's collision box
@@ -85,12 +175,41 @@ void AMoveableObject::Tick(float DeltaTime)
 				Point->DrawDebug();
 			}
 		}
+	}
+	////////////////////////////////////////////////////////////////////////////////////
+}
+
+// Update the held object's fuse session every frame while it is held or fusing
+void AMoveableObject::TickFuseSession(FFuseSession& Session, float DeltaTime)
+{
+	// If the object is currently held, get the closest moveable object within its radius and update the overlay material based on if there is a nearby object
+	if (Session.bIsGrabbed && MeshComponent) {
+		Session.ClosestNearbyMoveableObject = FindClosestMoveableObjectInRadius(Session);
+		UpdateGroupOverlayMaterial(this, Session.HeldOverlayMat, Session.ClosestNearbyMoveableObject ? true : false);
+	}
+
+	// If a nearby moveable object exists, and if two objects are currently fusing, interpolate the two objects towards each other. Otherwise, simply update their closest snap points
+	if (Session.ClosestNearbyMoveableObject) {
+		if (Session.bIsFusing) {
+			InterpFusedObjects(Session, DeltaTime);
+		}
+
+		else if (CVarAsyncSnapResolution.GetValueOnGameThread()) {
+			UpdateSnapPointsAsync(Session);
+		}
 
-		// For debugging - Draw collision points for fusing objects
-		if (ClosestNearbyMoveableObject && bDebugMode) {
+		else {
+			UpdateSnapPoints(Session);
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////////
+	// For debugging - Draw collision points for fusing objects
+	if (bDebugMode) {
+		if (Session.ClosestNearbyMoveableObject) {
 			DrawDebugPoint(
 				GetWorld(),
-				HeldClosestSnapPoint,
+				Session.HeldClosestSnapPoint,
 				15.f,
 				FColor::Green,
 				false,
@@ -99,7 +218,7 @@ void AMoveableObject::Tick(float DeltaTime)
 
 			DrawDebugPoint(
 				GetWorld(),
-				OtherClosestSnapPoint,
+				Session.OtherClosestSnapPoint,
 				15.f,
 				FColor::Magenta,
 				false,
@@ -110,13 +229,6 @@ void AMoveableObject::Tick(float DeltaTime)
 	////////////////////////////////////////////////////////////////////////////////////
 }
 
-// Update the current velocities of the moveable object
-void AMoveableObject::UpdateVelocities()
-{
-	PreviousVelocity = MeshComponent->GetPhysicsLinearVelocity();
-	PreviousAngularVelocity = MeshComponent->GetPhysicsAngularVelocityInDegrees();
-}
-
 // Remove velocities on hit objects if they are another moveable object
 void AMoveableObject::OnHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& HitResult)
 {
@@ -124,17 +236,48 @@ void AMoveableObject::OnHit(UPrimitiveComponent* HitComponent, AActor* OtherActo
 	if (OtherActor->IsA(AMoveableObject::StaticClass())) {
 		AMoveableObject* OtherMoveable = Cast<AMoveableObject>(OtherActor);
 
-		// Keep any velocity that the moveable objects currently have without adding new velocities
-		OtherComp->SetPhysicsLinearVelocity(OtherMoveable->PreviousVelocity);
-		OtherComp->SetPhysicsAngularVelocityInDegrees(OtherMoveable->PreviousAngularVelocity);
+		UBuildSystemSubsystem* BuildSystem = GetBuildSystem();
+		if (!BuildSystem) return;
+
+		// Keep any velocity that the moveable objects had at the start of the frame without adding new velocities
+		const FPartRegistry& Registry = BuildSystem->GetPartRegistry();
+		const int32 OtherIndex = Registry.GetIndex(OtherMoveable);
+		if (OtherIndex != INDEX_NONE) {
+			OtherComp->SetPhysicsLinearVelocity(FVector(Registry.LinearVelocities[OtherIndex]));
+			OtherComp->SetPhysicsAngularVelocityInDegrees(FVector(Registry.AngularVelocities[OtherIndex]));
+		}
 	}
 }
 
 // When an object is grabbed, add an overlay material
 void AMoveableObject::OnGrab_Implementation()
 {
-	bIsGrabbed = true;
-	UpdateMoveableObjectMaterial(this, false);
+	// A group that another held object is holding or fusing with cannot be picked up until it is free again, and neither can an object that is already held
+	UBuildSystemSubsystem* BuildSystem = GetBuildSystem();
+	if (BuildSystem && BuildSystem->IsGroupLocked(this, this)) return;
+
+	const FFuseSession* HeldSession = BuildSystem ? BuildSystem->FindSession(this) : nullptr;
+	if (HeldSession && HeldSession->bIsGrabbed) return;
+
+	// The group is about to be moved as one, so any split or merge still being handed out has to finish first
+	if (BuildSystem) {
+		BuildSystem->FinishGroupWork(this);
+	}
+
+	// A frozen group turns back into separate parts as soon as it is picked up
+	UnfreezeGroup();
+
+	// Start a fuse session for the held object, which the build system subsystem ticks until the object is released and done fusing
+	if (BuildSystem) {
+		FFuseSession& Session = BuildSystem->BeginSession(this);
+		Session.bIsGrabbed = true;
+		BuildSystem->GetPartRegistry().SetFlags(this, EPartFlags::Grabbed, true);
+		UpdateGroupOverlayMaterial(this, Session.HeldOverlayMat, false);
+
+		FFlightEvent Event = MakeFlightEvent(EFlightEventType::Grab, BuildSystem->GetPartRegistry(), this, nullptr);
+		Event.Count = FusedObjects.Num();
+		BuildSystem->GetFlightRecorder().Record(Event);
+	}
 
 	////////////////////////////////////////////////////////////////////////////////////
 	// For debugging - Print out all fused objects and their physics constraint links
@@ -167,20 +310,22 @@ void AMoveableObject::OnGrab_Implementation()
 		TMap<AMoveableObject*, TArray<FString>> ConstraintMap;
 
 		// Group constraints by owning object
-		for (const FPhysicsConstraintLink& Link : PhysicsConstraintLinks)
-		{
-			if (!Link.Constraint) continue;
+		if (FConstraintLinkTable* LinkTable = GetLinkTable()) {
+			LinkTable->ForEachObjectLink(this, [&](FConstraintLinkHandle, const FPhysicsConstraintLink& Link)
+			{
+				if (!Link.Constraint) return;
 
-			auto AddConstraintTo = [&](AMoveableObject* Obj, AMoveableObject* Other)
-				{
-					if (!Obj || !Other) return;
+				auto AddConstraintTo = [&](AMoveableObject* Obj, AMoveableObject* Other)
+					{
+						if (!Obj || !Other) return;
 
-					FString OtherName = Other->GetName();
-					ConstraintMap.FindOrAdd(Obj).Add(OtherName);
-				};
+						FString OtherName = Other->GetName();
+						ConstraintMap.FindOrAdd(Obj).Add(OtherName);
+					};
 
-			AddConstraintTo(Link.ComponentA, Link.ComponentB);
-			AddConstraintTo(Link.ComponentB, Link.ComponentA);
+				AddConstraintTo(Link.ComponentA, Link.ComponentB);
+				AddConstraintTo(Link.ComponentB, Link.ComponentA);
+			});
 		}
 
 		// Print the constraints
@@ -212,227 +357,278 @@ void AMoveableObject::OnGrab_Implementation()
 // When the object is released, remove overalay materials from all objects
 void AMoveableObject::OnRelease_Implementation()
 {
-	bIsGrabbed = false;
-
 	// Remove material from the currently held object and all of its fused objects
 	RemoveMoveableObjectMaterial(this);
 
-	// Remove material from nearby moveable object and all of its fused objects, if one exists. Then update the previous moveable object to be null
-	if (PrevMoveableObject) {
-		RemoveMoveableObjectMaterial(PrevMoveableObject);
-		PrevMoveableObject = nullptr;
-	}
+	if (FFuseSession* Session = FindFuseSession()) {
+		Session->bIsGrabbed = false;
+		GetBuildSystem()->GetPartRegistry().SetFlags(this, EPartFlags::Grabbed, false);
+
+		// Remove material from nearby moveable object and all of its fused objects, if one exists. Then update the previous moveable object to be null
+		if (Session->PrevMoveableObject) {
+			RemoveMoveableObjectMaterial(Session->PrevMoveableObject);
+			Session->PrevMoveableObject = nullptr;
+		}
+
+		// If there is a nearby moveable object on release, fuse object groups together. The session keeps being ticked until fusing is complete.
+		// Another held object may have started fusing with the nearby group since it was found, in which case the object is simply dropped
+		if (Session->ClosestNearbyMoveableObject && GetBuildSystem()->IsGroupLocked(Session->ClosestNearbyMoveableObject, this)) {
+			Session->ClosestNearbyMoveableObject = nullptr;
+		}
+
+		if (Session->ClosestNearbyMoveableObject) {
+			//FuseMoveableObjects(Session->ClosestNearbyMoveableObject);
+			Session->bIsFusing = true;
+			GetBuildSystem()->GetPartRegistry().SetFlags(this, EPartFlags::Fusing, true);
+			BuildSystemTrace::FuseSessionBegin(FusedObjects.Num(), Session->ClosestNearbyMoveableObject->FusedObjects.Num());
 
-	// If there is a nearby moveable object on release, fuse object groups together
-	if (ClosestNearbyMoveableObject) {
-		//FuseMoveableObjects(ClosestNearbyMoveableObject);
-		bIsFusing = true;
+			// Snap points resolved off the game thread are a frame behind, so resolve them again now that the fuse is starting
+			if (CVarAsyncSnapResolution.GetValueOnGameThread()) {
+				UpdateSnapPoints(*Session);
+			}
+			RecordSnapDecision(*Session, EFlightEventType::FuseBegin);
+			AlignFusedGroupToSnap(*Session);
+
+			// Other contacts are found once the group has been aligned, as aligning moves them along with the closest pair
+			if (CVarMultiContactFuse.GetValueOnGameThread()) {
+				GatherExtraContacts(*Session);
+			}
+		}
 	}
 
 	// Set all fused object's velocities to zero
 	RemoveObjectVelocity();
 }
 
-// Get the closest moveable object within the collision range
+// Get the closest moveable object within the collision range, searching through this object's fuse session. Returns null if it is not being held
 AMoveableObject* AMoveableObject::GetClosestMoveableObjectInRadius()
 {
-	// Initialize variable to store the current object and the currently closest object
-	AMoveableObject* HitResultObject = nullptr;
-	AMoveableObject* CurrClosestMoveableObject = nullptr;
-
-	// Get the closest moveable object for each object in the currently held object's fused group
-	for (AMoveableObject* FusedObject : FusedObjects) {
-		// Do not check for collisions if the current object does not have a collision box
-		if (!FusedObject->FuseCollisionBox) continue;
-
-		// Get all overlapping actors with collision box
-		TArray<AActor*> OverlapActors;
-		FusedObject->FuseCollisionBox->GetOverlappingActors(OverlapActors, AMoveableObject::StaticClass());
-
-		// Get current nearby moveable object
-		HitResultObject = GetClosestMoveableObjectByActor(FusedObject, OverlapActors);
+	FFuseSession* Session = FindFuseSession();
+	return Session ? FindClosestMoveableObjectInRadius(*Session) : nullptr;
+}
 
-		// If there is no hit result, continue. Otherwise, add it to the array
-		if (!HitResultObject) continue;
+// Get the closest moveable object within the collision range of a fuse session
+AMoveableObject* AMoveableObject::FindClosestMoveableObjectInRadius(FFuseSession& Session)
+{
+	SCOPE_CYCLE_COUNTER(STAT_BuildSystem_GetClosestMoveableObjectInRadius);
+
+	UBuildSystemSubsystem* BuildSystem = GetBuildSystem();
+	if (!BuildSystem) return nullptr;
+
+	// Gather the overlaps of every object in the currently held object's fused group, leaving out groups other held objects are holding or fusing with,
+	// then find the closest candidate of each in parallel once the group is large enough
+	TArray<int32, TInlineAllocator<16>> LockedGroupIds;
+	BuildSystem->GetLockedGroupIds(this, LockedGroupIds);
+	Session.CandidateSearch.Gather(this, BuildSystem->GetPartRegistry(), LockedGroupIds);
+
+	// Small groups search on a single thread. Debug drawing is done afterwards from the recorded traces, so it does not limit the search
+	const int32 MaxWorkers = Session.CandidateSearch.NumMembers() < CVarParallelCandidateMinMembers.GetValueOnGameThread() ? 1 : CVarCandidateWorkers.GetValueOnGameThread();
+	const FFuseCandidate Closest = Session.CandidateSearch.Evaluate(GetWorld(), MaxWorkers > 0 ? MaxWorkers : FTaskGraphInterface::Get().GetNumWorkerThreads() + 1);
+	AMoveableObject* CurrClosestMoveableObject = Closest.Candidate;
+	if (CurrClosestMoveableObject) {
+		Session.ClosestFusedMoveableObject = Closest.FusedObject;
+	}
 
-		// If there is no current closest moveable object, update it to be the most recent hit result
-		if (!CurrClosestMoveableObject) {
-			ClosestFusedMoveableObject = FusedObject;
-			CurrClosestMoveableObject = HitResultObject;
-		}
+	////////////////////////////////////////////////////////////////////////////////////
+	// For debugging - Draw the overlapping actors and line traces of each object in the held group
+	if (bDebugMode) {
+		Session.CandidateSearch.DrawDebug(GetWorld());
+	}
+	////////////////////////////////////////////////////////////////////////////////////
 
-		// Otherwise, update the closest fused moveable object and the current moveable object to be the closest of the tested objects
-		else CurrClosestMoveableObject = GetClosestMoveableofTwo(FusedObject, HitResultObject, ClosestFusedMoveableObject, CurrClosestMoveableObject);
+	// Record the closest candidate whenever it changes, including when there stops being one
+	if (Session.PrevMoveableObject != CurrClosestMoveableObject) {
+		FFlightEvent Event = MakeFlightEvent(EFlightEventType::Candidate, BuildSystem->GetPartRegistry(), CurrClosestMoveableObject ? Closest.FusedObject : this, CurrClosestMoveableObject);
+		Event.Count = Session.CandidateSearch.NumCandidates();
+		Event.Distance = Closest.Distance;
+		BuildSystem->GetFlightRecorder().Record(Event);
 	}
 
 	// If the previous movable object is not the current moveable object, update prev movable object accordingly. Then update the overlay material and return
-	if (PrevMoveableObject != CurrClosestMoveableObject && CurrClosestMoveableObject) {
-		// If there was a previous moveable object, remove the overlay material from it, then update the previous moveable object to be the new closest and add an overlay material
-		if (PrevMoveableObject && PrevMoveableObject->MeshComponent->GetOverlayMaterial()) {
-			RemoveMoveableObjectMaterial(PrevMoveableObject);
+	if (Session.PrevMoveableObject != CurrClosestMoveableObject && CurrClosestMoveableObject) {
+		// If there was a previous moveable object, remove the overlay material from it, then update the previous moveable object to be the new closest and add an overlay material.
+		// A large previous group may not have been highlighted yet, in which case removing the highlight drops the pending one
+		if (Session.PrevMoveableObject) {
+			RemoveMoveableObjectMaterial(Session.PrevMoveableObject);
 		}
-		PrevMoveableObject = CurrClosestMoveableObject;
-		UpdateMoveableObjectMaterial(CurrClosestMoveableObject, true);
+		Session.PrevMoveableObject = CurrClosestMoveableObject;
+		UpdateGroupOverlayMaterial(CurrClosestMoveableObject, Session.NearbyOverlayMat, true);
 	}
 
-	else if (!CurrClosestMoveableObject && PrevMoveableObject) {
-		RemoveMoveableObjectMaterial(PrevMoveableObject);
-		PrevMoveableObject = nullptr;
+	else if (!CurrClosestMoveableObject && Session.PrevMoveableObject) {
+		RemoveMoveableObjectMaterial(Session.PrevMoveableObject);
+		Session.PrevMoveableObject = nullptr;
 	}
 
 	return CurrClosestMoveableObject;
 }
 
-// Get the closest moveable object for the current actor
-AMoveableObject* AMoveableObject::GetClosestMoveableObjectByActor(AMoveableObject* FusedObject, TArray<AActor*> OverlapActors)
+// Update the closest collision points on the held object and the nearby fusion object
+void AMoveableObject::UpdateSnapPoints(FFuseSession& Session)
 {
-	// Initialize variables for line trace and to track nearby moveable object and closest moveable object
-	FVector TraceOrigin = FusedObject->GetActorLocation();
-	AMoveableObject* CurrMoveableObject = nullptr;
-	AMoveableObject* CurrClosestMoveableObject = nullptr;
+	SCOPE_CYCLE_COUNTER(STAT_BuildSystem_UpdateSnapPoints);
 
-	////////////////////////////////////////////////////////////////////////////////////
-	// For debugging - Print debug information for the current object
-	if (bDebugMode) {
-		//Debug::Print(TEXT("Checking closest for " + FusedObject->GetName()));
-	}
-	////////////////////////////////////////////////////////////////////////////////////
+	// Get the closest collision points of both the held and nearby moveable object
+	FVector HeldFuseObjectCenter = Session.ClosestFusedMoveableObject->GetActorLocation();
 
-	// Iterate over all hit results to get the closest moveable object
-	for (AActor* OverlapActor : OverlapActors) {
-		////////////////////////////////////////////////////////////////////////////////////
-		// For debugging - Print debug information for the current overlapping actor and draw grabbed object line trace
-		if (bDebugMode) {
-			DrawDebugPoint(
-				GetWorld(),
-				OverlapActor->GetActorLocation(),
-				10.f,
-				FColor::Red,
-				false
-			);
+	// Anchor all snap math on the closest fused object so it can be done in float without losing precision far from the world origin
+	Session.FuseFrame = BuildSystemMath::FGroupFrame(HeldFuseObjectCenter);
 
-			DrawDebugLine(
-				GetWorld(),
-				TraceOrigin,
-				OverlapActor->GetActorLocation(),
-				FColor::Yellow,
-				false
-			);
-		}
-		////////////////////////////////////////////////////////////////////////////////////
+	// Find the snap points of the pair, keeping the collision points relative to each object when there is no snap point so they move with it
+	FindFusePoints(Session, Session.ClosestFusedMoveableObject, Session.ClosestNearbyMoveableObject, Session.HeldClosestSnapComp, Session.HeldClosestSnapPoint, Session.OtherClosestSnapComp, Session.OtherClosestSnapPoint);
+	if (!Session.HeldClosestSnapComp) {
+		Session.HeldLocalCollisionPoint = Session.ClosestFusedMoveableObject->GetActorTransform().InverseTransformPosition(Session.HeldClosestSnapPoint);
+	}
 
-		// Move to the next actor if current hit is not a valid actor, is not a moveable object, or actor is an already fused object
-		if (!OverlapActor || !OverlapActor->IsA(AMoveableObject::StaticClass()) || FusedObject->FusedObjects.Contains(Cast<AMoveableObject>(OverlapActor))) continue;
+	if (!Session.OtherClosestSnapComp) {
+		Session.OtherLocalCollisionPoint = Session.ClosestNearbyMoveableObject->GetActorTransform().InverseTransformPosition(Session.OtherClosestSnapPoint);
+	}
 
-		// Get the current actor moveable object
-		CurrMoveableObject = CheckMoveableObjectTrace(Cast<AMoveableObject>(OverlapActor), FusedObject);
+	RecordSnapDecision(Session, EFlightEventType::Snap);
+}
 
-		// If the current actor has no valid hit, continue
-		if (!CurrMoveableObject) continue;
+// Find the points a held member and a nearby object would fuse at, their closest snap points or the closest points on their collision where there are none, searching relative to the fuse frame
+void AMoveableObject::FindFusePoints(const FFuseSession& Session, AMoveableObject* HeldMember, AMoveableObject* NearbyObject, USnapPointComponent*& OutHeldSnapComp, FVector& OutHeldPoint, USnapPointComponent*& OutNearbySnapComp, FVector& OutNearbyPoint)
+{
+	// We want collision points between the two object's closest points, so get the other object's closest point, then get the closest points between the two closest points
+	// Only getting the "OtherClosestFusionPoint" once leads to a trace from the held objects center, rather than closest point and leads to sometimes snapping to the wrong point on the closest object
+	// The points are found on each object's collision proxy, as the full collision is only needed for physics
+	FVector OtherClosestFusionPoint = NearbyObject->GetClosestPointOnProxy(HeldMember->GetActorLocation());
+	FVector HeldClosestFusionPoint = HeldMember->GetClosestPointOnProxy(OtherClosestFusionPoint);
+	OtherClosestFusionPoint = NearbyObject->GetClosestPointOnProxy(HeldClosestFusionPoint);
 
-		// If there is no current moveable object, update it to be the current moveable object being tested
-		if (!CurrClosestMoveableObject) CurrClosestMoveableObject = CurrMoveableObject;
+	// Convert the collision points into the fuse frame
+	FVector3f HeldLocalFusionPoint = Session.FuseFrame.ToLocal(HeldClosestFusionPoint);
+	FVector3f OtherLocalFusionPoint = Session.FuseFrame.ToLocal(OtherClosestFusionPoint);
 
-		// Otherwise, update moveable object to be the closest of the tested objects
-		else CurrClosestMoveableObject = GetClosestMoveable(FusedObject, CurrClosestMoveableObject, CurrMoveableObject);
-	}
+	// From the closest collision point, get all possible snap points within a specified radius
+	FSnapPointArray HeldSnapPoints, NearbySnapPoints;
+	GetPossibleSnapPoints(Session, HeldLocalFusionPoint, HeldMember, HeldSnapPoints);
+	GetPossibleSnapPoints(Session, OtherLocalFusionPoint, NearbyObject, NearbySnapPoints);
 
-	return CurrClosestMoveableObject;
+	// Get the closest snap point to the previously calculated collision point for each object. If there is none, simply use the collision point itself
+	OutHeldSnapComp = GetClosestObjectSnapPoint(Session, HeldSnapPoints, HeldLocalFusionPoint);
+	OutHeldPoint = OutHeldSnapComp ? OutHeldSnapComp->GetComponentLocation() : HeldClosestFusionPoint;
+
+	OutNearbySnapComp = GetClosestObjectSnapPoint(Session, NearbySnapPoints, OtherLocalFusionPoint);
+	OutNearbyPoint = OutNearbySnapComp ? OutNearbySnapComp->GetComponentLocation() : OtherClosestFusionPoint;
 }
 
-// Run a line trace to check for a clear path between the hit actor and currently held object
-AMoveableObject* AMoveableObject::CheckMoveableObjectTrace(AMoveableObject* NearbyMoveable, AMoveableObject* FusedObject)
+// Find every contact between the held group and nearby groups, other than the closest pair, that closes by the same step as the closest pair so they can all be fused at once
+void AMoveableObject::GatherExtraContacts(FFuseSession& Session)
 {
-	// Initialize variables used for line trace
-	FVector TraceOrigin = FusedObject->GetActorLocation();
-	FVector TargetLocation = NearbyMoveable->GetActorLocation();
-	FHitResult TestHit;
+	Session.ExtraContacts.Reset();
 
-	// Line trace from nearby moveable to  to see if there are any blocking objects
-	bool bBlockedHit = GetWorld()->LineTraceSingleByChannel(
-		TestHit,
-		TraceOrigin,
-		TargetLocation,
-		ECC_Visibility,
-		FCollisionQueryParams(FName("LOSCheck"), false, FusedObject->MeshComponent->GetOwner())
-	);
+	UBuildSystemSubsystem* BuildSystem = GetBuildSystem();
+	if (!BuildSystem) return;
 
-	////////////////////////////////////////////////////////////////////////////////////
-	// For debugging - Draw grabbed object line trace
-	if (bDebugMode) {
-		DrawDebugPoint(
-			GetWorld(),
-			TestHit.ImpactPoint,
-			10.f,
-			FColor::Orange,
-			false
-		);
+	// The closest pair has just been aligned, so its points are taken from where the objects are now
+	const FVector HeldPoint = Session.HeldClosestSnapComp ? Session.HeldClosestSnapComp->GetComponentLocation() : Session.ClosestFusedMoveableObject->GetActorTransform().TransformPosition(Session.HeldLocalCollisionPoint);
+	const FVector NearbyPoint = Session.OtherClosestSnapComp ? Session.OtherClosestSnapComp->GetComponentLocation() : Session.ClosestNearbyMoveableObject->GetActorTransform().TransformPosition(Session.OtherLocalCollisionPoint);
+	const FVector Step = NearbyPoint - HeldPoint;
+	const float Tolerance = CVarMultiContactTolerance.GetValueOnGameThread();
 
-		DrawDebugLine(
-			GetWorld(),
-			TraceOrigin,
-			TestHit.ImpactPoint,
-			FColor::Green,
-			false
-		);
-	}
-	////////////////////////////////////////////////////////////////////////////////////
+	// Every nearby object with a clear line of sight from the last candidate search is a possible contact, unless another held object has its group
+	TArray<int32, TInlineAllocator<16>> LockedGroupIds;
+	BuildSystem->GetLockedGroupIds(this, LockedGroupIds);
 
-	// If line hit result is an already fused object, return nullptr
-	if (FusedObject->FusedObjects.Contains(NearbyMoveable)) return nullptr;
+	TArray<FFuseCandidate, TInlineAllocator<16>> Contacts;
+	Session.CandidateSearch.GetContacts(Contacts);
 
-	// If there are no blocking objects or the line trace hits the nearby moveable object, return moveable object
-	if (!bBlockedHit || TestHit.GetActor() == NearbyMoveable) {
-		return NearbyMoveable;
-	}
+	for (const FFuseCandidate& Contact : Contacts) {
+		if (Contact.Candidate == Session.ClosestNearbyMoveableObject || !IsValid(Contact.Candidate) || !IsValid(Contact.FusedObject)) continue;
+		if (LockedGroupIds.Contains(BuildSystem->GetPartRegistry().GetGroupId(Contact.Candidate))) continue;
+
+		USnapPointComponent* HeldSnapComp = nullptr;
+		USnapPointComponent* NearbySnapComp = nullptr;
+		FVector ContactHeldPoint, ContactNearbyPoint;
+		FindFusePoints(Session, Contact.FusedObject, Contact.Candidate, HeldSnapComp, ContactHeldPoint, NearbySnapComp, ContactNearbyPoint);
+
+		// Only contacts that close when the group moves onto the closest pair are fused, anything else would pull the group out of line
+		if (FVector::Dist(ContactNearbyPoint - ContactHeldPoint, Step) > Tolerance) continue;
 
-	return nullptr;
+		LLM_SCOPE_BYTAG(BuildSystem);
+		Session.ExtraContacts.Add({ Contact.FusedObject, Contact.Candidate });
+	}
 }
 
-// Update the closest collision points on the held object and the nearby fusion object
-void AMoveableObject::UpdateSnapPoints()
+// Pick up the snap points resolved off the game thread from last frame's snapshot, then snapshot this frame's objects for the next frame
+void AMoveableObject::UpdateSnapPointsAsync(FFuseSession& Session)
 {
-	// Get the closest collision points of both the held and nearby moveable object
-	FVector HeldFuseObjectCenter = ClosestFusedMoveableObject->GetActorLocation();
-	FVector HeldClosestFusionPoint, OtherClosestFusionPoint;
+	SCOPE_CYCLE_COUNTER(STAT_BuildSystem_UpdateSnapPoints);
 
-	// We want collision points between the two object's closest points, so get the other object's closest point, then get the closest points between the two closest points
-	// Only getting the "OtherClosestFusionPoint" once leads to a trace from the held objects center, rather than closest point and leads to sometimes snapping to the wrong point on the closest object
-	ClosestNearbyMoveableObject->MeshComponent->GetClosestPointOnCollision(HeldFuseObjectCenter, OtherClosestFusionPoint);
-	ClosestFusedMoveableObject->MeshComponent->GetClosestPointOnCollision(OtherClosestFusionPoint, HeldClosestFusionPoint);
-	ClosestNearbyMoveableObject->MeshComponent->GetClosestPointOnCollision(HeldClosestFusionPoint, OtherClosestFusionPoint);
+	if (!Session.SnapResolver) {
+		LLM_SCOPE_BYTAG(BuildSystem);
+		Session.SnapResolver = MakeShared<FAsyncSnapResolver, ESPMode::ThreadSafe>();
+	}
 
-	// From the closest collision point, get all possible snap points within a specified radius
-	TArray<USnapPointComponent*> HeldSnapPoints = GetPossibleSnapPoints(HeldClosestFusionPoint, ClosestFusedMoveableObject);
-	TArray<USnapPointComponent*> NearbySnapPoints = GetPossibleSnapPoints(OtherClosestFusionPoint, ClosestNearbyMoveableObject);
+	// Only use results for the objects that are still closest, as the nearby object may have changed since the snapshot was taken
+	FSnapResolution Resolution;
+	if (Session.SnapResolver->TryTakeResult(Resolution) && Resolution.HeldObject == Session.ClosestFusedMoveableObject && Resolution.NearbyObject == Session.ClosestNearbyMoveableObject) {
+		ApplySnapResolution(Session, Resolution);
+	}
+
+	Session.SnapResolver->Launch(Session.ClosestFusedMoveableObject, Session.ClosestNearbyMoveableObject, SnapSearchRadius);
+}
 
-	// Get the closest snap point to the previously calculated collision point for the held object. If there is none, simply use the collision point itself
-	HeldClosestSnapComp = GetClosestObjectSnapPoint(HeldSnapPoints, HeldClosestFusionPoint);
-	if (HeldClosestSnapComp) {
-		HeldClosestSnapPoint = HeldClosestSnapComp->GetComponentLocation();
+// Apply snap points resolved off the game thread to a fuse session
+void AMoveableObject::ApplySnapResolution(FFuseSession& Session, const FSnapResolution& Resolution)
+{
+	Session.FuseFrame = BuildSystemMath::FGroupFrame(Resolution.FuseFrameOrigin);
+	Session.HeldClosestSnapComp = Resolution.HeldSnapComp;
+	Session.OtherClosestSnapComp = Resolution.OtherSnapComp;
+	Session.HeldLocalCollisionPoint = Resolution.HeldLocalCollisionPoint;
+	Session.OtherLocalCollisionPoint = Resolution.OtherLocalCollisionPoint;
+
+	// Get the snap points from where the objects are now rather than where they were when the snapshot was taken
+	if (Session.HeldClosestSnapComp) {
+		Session.HeldClosestSnapPoint = Session.HeldClosestSnapComp->GetComponentLocation();
 	}
 
 	else {
-		HeldClosestSnapPoint = HeldClosestFusionPoint;
-		HeldLocalCollisionPoint = ClosestFusedMoveableObject->GetActorTransform().InverseTransformPosition(HeldClosestSnapPoint);
+		Session.HeldClosestSnapPoint = Session.ClosestFusedMoveableObject->GetActorTransform().TransformPosition(Session.HeldLocalCollisionPoint);
 	}
 
-	// Get the closest snap point to the previously calculated collision point for the nearby object. If there is none, simply use the collision point itself
-	OtherClosestSnapComp = GetClosestObjectSnapPoint(NearbySnapPoints, OtherClosestFusionPoint);
-	if (OtherClosestSnapComp) {
-		OtherClosestSnapPoint = OtherClosestSnapComp->GetComponentLocation();
+	if (Session.OtherClosestSnapComp) {
+		Session.OtherClosestSnapPoint = Session.OtherClosestSnapComp->GetComponentLocation();
 	}
 
 	else {
-		OtherClosestSnapPoint = OtherClosestFusionPoint;
-		OtherLocalCollisionPoint = ClosestNearbyMoveableObject->GetActorTransform().InverseTransformPosition(OtherClosestSnapPoint);
+		Session.OtherClosestSnapPoint = Session.ClosestNearbyMoveableObject->GetActorTransform().TransformPosition(Session.OtherLocalCollisionPoint);
 	}
+
+	RecordSnapDecision(Session, EFlightEventType::Snap);
+	SET_DWORD_STAT(STAT_BuildSystem_SnapLatencyFrames, GFrameCounter - Resolution.SnapshotFrame);
 }
 
-// Get possible snap points
-TArray<USnapPointComponent*> AMoveableObject::GetPossibleSnapPoints(FVector TestPoint, AMoveableObject* TestObject)
+// Record the snap pair chosen for a fuse in the flight recorder, only recording snap events when the pair changes
+void AMoveableObject::RecordSnapDecision(FFuseSession& Session, EFlightEventType Type)
 {
-	TArray<USnapPointComponent*> TestSnapPoints;
+	UBuildSystemSubsystem* BuildSystem = GetBuildSystem();
+	if (!BuildSystem) return;
+
+	// Collision points move every frame, so a snap decision only changes with the nearby object or the snap point components chosen
+	const bool bChanged = Session.RecordedNearbyObject != Session.ClosestNearbyMoveableObject || Session.RecordedHeldSnapComp != Session.HeldClosestSnapComp || Session.RecordedOtherSnapComp != Session.OtherClosestSnapComp;
+	if (!bChanged && Type == EFlightEventType::Snap) return;
+
+	Session.RecordedNearbyObject = Session.ClosestNearbyMoveableObject;
+	Session.RecordedHeldSnapComp = Session.HeldClosestSnapComp;
+	Session.RecordedOtherSnapComp = Session.OtherClosestSnapComp;
+
+	FFlightEvent Event = MakeFlightEvent(Type, BuildSystem->GetPartRegistry(), Session.ClosestFusedMoveableObject, Session.ClosestNearbyMoveableObject);
+	Event.HeldSnapType = Session.HeldClosestSnapComp ? EFlightSnapType::SnapPoint : EFlightSnapType::CollisionPoint;
+	Event.OtherSnapType = Session.OtherClosestSnapComp ? EFlightSnapType::SnapPoint : EFlightSnapType::CollisionPoint;
+	Event.HeldPoint = FVector3f(Session.HeldClosestSnapPoint);
+	Event.OtherPoint = FVector3f(Session.OtherClosestSnapPoint);
+	Event.Distance = FVector::Dist(Session.HeldClosestSnapPoint, Session.OtherClosestSnapPoint);
+	BuildSystem->GetFlightRecorder().Record(Event);
+}
+
+// Get possible snap points within the snap search radius of a test point relative to the fuse frame
+void AMoveableObject::GetPossibleSnapPoints(const FFuseSession& Session, const FVector3f& TestPoint, AMoveableObject* TestObject, FSnapPointArray& OutSnapPoints)
+{
+	OutSnapPoints.Reset();
+	const float SearchRadiusSquared = SnapSearchRadius * SnapSearchRadius;
 
 	for (USnapPointComponent* SnapPoint : TestObject->SnapPoints) {
 		if (!SnapPoint) continue;
@@ -444,21 +640,19 @@ TArray<USnapPointComponent*> AMoveableObject::GetPossibleSnapPoints(FVector Test
 		}
 		////////////////////////////////////////////////////////////////////////////////////
 
-		if (FVector::DistSquared(SnapPoint->GetComponentLocation(), TestPoint) < SnapSearchRadius * SnapSearchRadius) {
-			TestSnapPoints.Add(SnapPoint);
+		if (FVector3f::DistSquared(Session.FuseFrame.ToLocal(SnapPoint->GetComponentLocation()), TestPoint) < SearchRadiusSquared) {
+			OutSnapPoints.Add(SnapPoint);
 		}
 	}
-
-	return TestSnapPoints;
 }
 
-// Get the closest snap point on the held object
-USnapPointComponent* AMoveableObject::GetClosestObjectSnapPoint(TArray<USnapPointComponent*> PossibleSnapPoints, FVector TestPoint)
+// Get the closest snap point to a test point relative to the fuse frame
+USnapPointComponent* AMoveableObject::GetClosestObjectSnapPoint(const FFuseSession& Session, const FSnapPointArray& PossibleSnapPoints, const FVector3f& TestPoint)
 {
-	// Initialize a null return snap point
-	USnapPointComponent* ClosestSnap = nullptr;
+	// Gather the valid snap points and their locations in the fuse frame
+	FSnapPointArray ValidSnapPoints;
+	TArray<FVector3f, TInlineAllocator<16>> LocalSnapLocations;
 
-	// Iterate over all possible snap points, making sure to get the closest valid snap point
 	for (USnapPointComponent* SnapPoint : PossibleSnapPoints) {
 		if (!SnapPoint) continue;
 
@@ -469,208 +663,222 @@ USnapPointComponent* AMoveableObject::GetClosestObjectSnapPoint(TArray<USnapPoin
 		}
 		////////////////////////////////////////////////////////////////////////////////////
 
-		/*if (!ClosestSnap) {
-			ClosestSnap = SnapPoint;
-			continue;
-		}*/
-
-		ClosestSnap = GetClosestVector(TestPoint, ClosestSnap, SnapPoint);
+		ValidSnapPoints.Add(SnapPoint);
+		LocalSnapLocations.Add(Session.FuseFrame.ToLocal(SnapPoint->GetComponentLocation()));
 	}
 
-	return ClosestSnap;
-}
-
-// Get the closest snap point to the current test point
-USnapPointComponent* AMoveableObject::GetClosestVector(FVector TestPoint, USnapPointComponent* PointA, USnapPointComponent* PointB)
-{
-	// If an snap point is null, return the other
-	if (!PointA) return PointB;
-	if (!PointB) return PointA;
-
-	// Compare the distance of each snap point to the test point and return the closest result
-	float PointADist = GetVectorDistance(TestPoint, PointA->GetComponentLocation());
-	float PointBDist = GetVectorDistance(TestPoint, PointB->GetComponentLocation());
-
-	////////////////////////////////////////////////////////////////////////////////////
-	// For debugging - Print the distance between objects
-	if (bDebugMode) {
-		/*Debug::Print(FString::Printf(TEXT("Distance A for %s to %s: %f"), *Held->GetName(), *ObjectA->GetName(), ObjectADist));
-		Debug::Print(FString::Printf(TEXT("Distance B for %s to %s: %f"), *Held->GetName(), *ObjectB->GetName(), ObjectBDist));*/
-	}
-	////////////////////////////////////////////////////////////////////////////////////
-
-	// If point A's distance to the test point is less than or equal to point B's distance, return point A
-	if (PointADist <= PointBDist) {
-		return PointA;
-	}
-
-	// Otherwise return point B
-	else {
-		return PointB;
-	}
-}
-
-// Get the distance betwen two vectors
-float AMoveableObject::GetVectorDistance(FVector PointA, FVector PointB)
-{
-	return FVector::Distance(PointA, PointB);
+	// Get the closest valid snap point, keeping the first snap point found if there are any ties
+	int32 ClosestIndex = BuildSystemMath::FindClosestPoint<FVector3f>(LocalSnapLocations, TestPoint);
+	return ClosestIndex != INDEX_NONE ? ValidSnapPoints[ClosestIndex] : nullptr;
 }
 
 // Move objects being fused together via interpolation over time
-void AMoveableObject::InterpFusedObjects(float DeltaTime)
+void AMoveableObject::InterpFusedObjects(FFuseSession& Session, float DeltaTime)
 {
+	SCOPE_CYCLE_COUNTER(STAT_BuildSystem_InterpFusedObjects);
+
 	// If there is a held closest snap component, get its location
-	if (HeldClosestSnapComp) {
-		HeldClosestSnapPoint = HeldClosestSnapComp->GetComponentLocation();
+	if (Session.HeldClosestSnapComp) {
+		Session.HeldClosestSnapPoint = Session.HeldClosestSnapComp->GetComponentLocation();
 	}
 
 	// Otherwise, use the location of the held closest snap point
 	else {
-		HeldClosestSnapPoint = ClosestFusedMoveableObject->GetActorTransform().TransformPosition(HeldLocalCollisionPoint);
+		Session.HeldClosestSnapPoint = Session.ClosestFusedMoveableObject->GetActorTransform().TransformPosition(Session.HeldLocalCollisionPoint);
 	}
 
 	// If there is a other closest snap component, get its location
-	if (OtherClosestSnapComp) {
-		OtherClosestSnapPoint = OtherClosestSnapComp->GetComponentLocation();
+	if (Session.OtherClosestSnapComp) {
+		Session.OtherClosestSnapPoint = Session.OtherClosestSnapComp->GetComponentLocation();
 	}
 
 	// Otherwise, use the location of the other closest snap point
 	else {
-		OtherClosestSnapPoint = ClosestNearbyMoveableObject->GetActorTransform().TransformPosition(OtherLocalCollisionPoint);
+		Session.OtherClosestSnapPoint = Session.ClosestNearbyMoveableObject->GetActorTransform().TransformPosition(Session.OtherLocalCollisionPoint);
 	}
 
-	// Get the object offset from the center of the held object to the closest point of the held object and adjust the target location based on the offset
-	FVector Offset = HeldClosestSnapPoint - ClosestFusedMoveableObject->GetActorLocation();
-	FVector TargetActorLocation = OtherClosestSnapPoint - Offset;
-	ClosestFusedMoveableObject->SetActorLocation(FMath::VInterpTo(ClosestFusedMoveableObject->GetActorLocation(), TargetActorLocation, DeltaTime, InterpSpeed));
-
-	// Check the distance between closest points, once they are within the given tolerance, fusion has been completed and the closest nearby object no longer needs to be tracked
-	float Distance = FVector::Dist(HeldClosestSnapPoint, OtherClosestSnapPoint);
-	if (Distance <= FuseTolerance) {
-		bIsFusing = false;
-		UpdateConstraints(ClosestNearbyMoveableObject);
-		ClosestNearbyMoveableObject = nullptr;
+	// Re-anchor on the closest fused object as it moves, then do the fuse math relative to it
+	Session.FuseFrame = BuildSystemMath::FGroupFrame(Session.ClosestFusedMoveableObject->GetActorLocation());
+	FVector3f HeldLocalSnapPoint = Session.FuseFrame.ToLocal(Session.HeldClosestSnapPoint);
+	FVector3f OtherLocalSnapPoint = Session.FuseFrame.ToLocal(Session.OtherClosestSnapPoint);
+
+	// Get this frame's step towards the target and apply it to the whole held group at once, so the locked constraints between fused objects never need correcting
+	bool bFuseComplete = false;
+	FVector3f LocalStep = BuildSystemMath::GetFuseStep(HeldLocalSnapPoint, OtherLocalSnapPoint, DeltaTime, InterpSpeed, FuseTolerance, bFuseComplete);
+	MoveFusedGroup(FVector(LocalStep));
+
+	// Once the final step has been applied, fusion has been completed and the closest nearby object no longer needs to be tracked
+	if (bFuseComplete) {
+		Session.bIsFusing = false;
+		GetBuildSystem()->GetPartRegistry().SetFlags(this, EPartFlags::Fusing, false);
+
+		// Extra contacts are fused only if they closed along with the closest pair, as a nearby group may have moved while the fuse was interpolating
+		const float Tolerance = CVarMultiContactTolerance.GetValueOnGameThread();
+		Session.ExtraContacts.RemoveAll([this, &Session, Tolerance](const FFuseContact& Contact) {
+			if (!IsValid(Contact.FusedObject) || !IsValid(Contact.NearbyObject) || !FusedObjects.Contains(Contact.FusedObject)) return true;
+
+			USnapPointComponent* HeldSnapComp = nullptr;
+			USnapPointComponent* NearbySnapComp = nullptr;
+			FVector HeldPoint, NearbyPoint;
+			FindFusePoints(Session, Contact.FusedObject, Contact.NearbyObject, HeldSnapComp, HeldPoint, NearbySnapComp, NearbyPoint);
+			return FVector::Dist(HeldPoint, NearbyPoint) > Tolerance;
+		});
+
+		const int32 NumMerged = UpdateConstraints(Session.ClosestFusedMoveableObject, Session.ClosestNearbyMoveableObject, Session.ExtraContacts);
+		BuildSystemTrace::FuseSessionEnd(NumMerged);
+
+		FFlightEvent Event = MakeFlightEvent(EFlightEventType::FuseEnd, GetBuildSystem()->GetPartRegistry(), Session.ClosestFusedMoveableObject, Session.ClosestNearbyMoveableObject);
+		Event.Count = NumMerged;
+		GetBuildSystem()->GetFlightRecorder().Record(Event);
+		Session.ClosestNearbyMoveableObject = nullptr;
+		Session.ExtraContacts.Reset();
 	}
 }
 
-// Get the closest object to what is currently held
-AMoveableObject* AMoveableObject::GetClosestMoveable(AMoveableObject* Held, AMoveableObject* ObjectA, AMoveableObject* ObjectB)
+// Move every object in the held object's fused group by the same offset
+void AMoveableObject::MoveFusedGroup(const FVector& Delta)
 {
-	// If an object is null, return the other
-	if (!ObjectA) return ObjectB;
-	if (!ObjectB) return ObjectA;
-
-	// Compare the distance of each object to the held object and return the closest result
-	float ObjectADist = GetObjectDistance(Held, ObjectA);
-	float ObjectBDist = GetObjectDistance(Held, ObjectB);
-
-	////////////////////////////////////////////////////////////////////////////////////
-	// For debugging - Print the distance between objects
-	if (bDebugMode) {
-		/*Debug::Print(FString::Printf(TEXT("Distance A for %s to %s: %f"), *Held->GetName(), *ObjectA->GetName(), ObjectADist));
-		Debug::Print(FString::Printf(TEXT("Distance B for %s to %s: %f"), *Held->GetName(), *ObjectB->GetName(), ObjectBDist));*/
-	}
-	////////////////////////////////////////////////////////////////////////////////////
-
-	// If object A's distance to the held object is less than or equal to object B's distance, return object A
-	if (ObjectADist <= ObjectBDist) {
-		return ObjectA;
-	}
+	for (AMoveableObject* Object : FusedObjects) {
+		if (!Object || !Object->MeshComponent) continue;
 
-	// Otherwise return object B
-	else {
-		return ObjectB;
+		// Teleport the physics bodies with the actor and stop them from building up velocity while they are being placed
+		Object->SetActorLocation(Object->GetActorLocation() + Delta, false, nullptr, ETeleportType::TeleportPhysics);
+		Object->MeshComponent->SetPhysicsLinearVelocity(FVector::ZeroVector);
+		Object->MeshComponent->SetPhysicsAngularVelocityInDegrees(FVector::ZeroVector);
 	}
 }
 
-// Get the closest objects between two object groups
-AMoveableObject* AMoveableObject::GetClosestMoveableofTwo(AMoveableObject* TestFused, AMoveableObject* TestMoveable, AMoveableObject* CurrentBestFused, AMoveableObject* CurrentBestMoveable)
+// Rotate the held object's fused group in a single step so its closest snap point faces the other object's closest snap point
+void AMoveableObject::AlignFusedGroupToSnap(const FFuseSession& Session)
 {
-	// If an object is null, return the other
-	if (!TestMoveable) return CurrentBestMoveable;
-	if (!CurrentBestMoveable) return TestMoveable;
+	// Orientation can only be aligned when both objects are fusing at snap points, collision points have no orientation
+	if (!Session.HeldClosestSnapComp || !Session.OtherClosestSnapComp) return;
 
-	// Compare the distance of each object to the held object and return the closest result
-	float ObjectADist = GetObjectDistance(TestFused, TestMoveable);
-	float ObjectBDist = GetObjectDistance(CurrentBestFused, CurrentBestMoveable);
+	// Get the closed form rotation of the held snap point, keeping scale out of the snap frames so it stays with each object
+	FTransform HeldSnapTransform(Session.HeldClosestSnapComp->GetComponentQuat(), Session.HeldClosestSnapComp->GetComponentLocation());
+	FTransform OtherSnapTransform(Session.OtherClosestSnapComp->GetComponentQuat(), Session.OtherClosestSnapComp->GetComponentLocation());
+	FTransform AlignedSnapTransform = BuildSystemMath::GetAlignedSnapTransform(HeldSnapTransform, OtherSnapTransform, Session.SnapRotationDegrees);
 
-	////////////////////////////////////////////////////////////////////////////////////
-	// For debugging - Print the distance between objects
-	if (bDebugMode) {
-		/*Debug::Print(FString::Printf(TEXT("Distance A for %s to %s: %f"), *TestFused->GetName(), *TestMoveable->GetName(), ObjectADist));
-		Debug::Print(FString::Printf(TEXT("Distance B for %s to %s: %f"), *CurrentBestFused->GetName(), *CurrentBestMoveable->GetName(), ObjectBDist));*/
-	}
-	////////////////////////////////////////////////////////////////////////////////////
+	// Rotate around the held snap point so that only the remaining offset is left for the fuse interpolation
+	AlignedSnapTransform.SetLocation(HeldSnapTransform.GetLocation());
 
-	// If object A's distance to the held object is less than or equal to object B's distance, return object A
-	if (ObjectADist <= ObjectBDist) {
-		//RemoveMoveableObjectMaterial(currClosestMo)
-		ClosestFusedMoveableObject = TestFused;
-		return TestMoveable;
-	}
+	for (AMoveableObject* Object : FusedObjects) {
+		if (!Object || !Object->MeshComponent) continue;
 
-	// Otherwise return object B
-	else {
-		return CurrentBestMoveable;
+		Object->SetActorTransform(BuildSystemMath::GetGroupMemberTransform(Object->GetActorTransform(), HeldSnapTransform, AlignedSnapTransform), false, nullptr, ETeleportType::TeleportPhysics);
 	}
 }
 
-// Get the distance betwen two moveable objects
-float AMoveableObject::GetObjectDistance(AMoveableObject* MoveableA, AMoveableObject* MoveableB)
-{
-	return FVector::Distance(MoveableA->GetActorLocation(), MoveableB->GetActorLocation());
-}
-
 // Remove velocities from objects when dropping
 void AMoveableObject::RemoveObjectVelocity()
 {
+	// Wake the whole group together, without waking any neighbouring groups it rests on
+	if (UBuildSystemSubsystem* BuildSystem = GetBuildSystem()) {
+		BuildSystem->WakeGroup(this);
+	}
+
 	for (AMoveableObject* Object : FusedObjects) {
-		Object->MeshComponent->WakeAllRigidBodies();
 		Object->MeshComponent->SetPhysicsLinearVelocity(FVector::ZeroVector);
 		Object->MeshComponent->SetPhysicsAngularVelocityInDegrees(FVector::ZeroVector);
 	}
 }
 
-// Update material of nearby fuseable object and its currently fused object set
+// Update material of nearby fuseable object and its currently fused object set, sharing the overlay material of this object's fuse session
 void AMoveableObject::UpdateMoveableObjectMaterial(AMoveableObject* MoveableObject, bool Fuseable)
 {
-	for (AMoveableObject* Object : MoveableObject->FusedObjects) {
-		// If the object is not valid, move onto the next
-		if (!Object || !Object->Mat || !Object->MeshComponent) continue;
+	if (!MoveableObject) return;
+
+	// This object's own group shares the session's held overlay material and any other group its nearby one. Without a session the material is not kept
+	FFuseSession* Session = FindFuseSession();
+	UMaterialInstanceDynamic* UnsharedOverlayMat = nullptr;
+	UMaterialInstanceDynamic*& OverlayMat = !Session ? UnsharedOverlayMat : FusedObjects.Contains(MoveableObject) ? Session->HeldOverlayMat : Session->NearbyOverlayMat;
+	UpdateGroupOverlayMaterial(MoveableObject, OverlayMat, Fuseable);
+}
 
-		// Otherwise, create a dynamic material instance and set it as an overlay material
-		Object->DynamicMat = UMaterialInstanceDynamic::Create(Object->Mat, Object->MeshComponent);
-		Object->DynamicMat->SetScalarParameterValue("Fuseable", Fuseable ? 1.f : 0.f);
-		Object->MeshComponent->SetOverlayMaterial(Object->DynamicMat);
+// Update material of nearby fuseable object and its currently fused object set, sharing a single overlay material across the whole set
+void AMoveableObject::UpdateGroupOverlayMaterial(AMoveableObject* MoveableObject, UMaterialInstanceDynamic*& OverlayMat, bool Fuseable)
+{
+	static const FName FuseableParamName(TEXT("Fuseable"));
+
+	// Create the dynamic material instance from the first valid object if the session does not have one yet. This runs every tick while hovering, so reuse the existing instance
+	if (!OverlayMat) {
+		for (AMoveableObject* Object : MoveableObject->FusedObjects) {
+			if (Object && Object->Mat && Object->MeshComponent) {
+				LLM_SCOPE_BYTAG(BuildSystem_Materials);
+				OverlayMat = UMaterialInstanceDynamic::Create(Object->Mat, this);
+				INC_DWORD_STAT(STAT_BuildSystem_MIDsCreated);
+				break;
+			}
+		}
+	}
+
+	// The held group is highlighted straight away as it is grabbed, other groups as they become the closest candidate, which is spread over frames for large groups
+	UBuildSystemSubsystem* BuildSystem = GetBuildSystem();
+	if (MoveableObject != this && BuildSystem) {
+		BuildSystem->GetDeferredWork().Highlight(*BuildSystem, MoveableObject, OverlayMat);
+	}
+
+	else {
+		for (AMoveableObject* Object : MoveableObject->FusedObjects) {
+			// If the object is not valid, move onto the next
+			if (!Object || !Object->Mat || !Object->MeshComponent) continue;
+
+			Object->MeshComponent->SetOverlayMaterial(OverlayMat);
+		}
+	}
+
+	// Every object shares the same instance, so the parameter only needs to be set once
+	if (OverlayMat) {
+		OverlayMat->SetScalarParameterValue(FuseableParamName, Fuseable ? 1.f : 0.f);
 	}
 }
 
 // Remove material of nearby fuseable object and its currently fused object set
 void AMoveableObject::RemoveMoveableObjectMaterial(AMoveableObject* MoveableObject)
 {
+	// Removing the highlight of a large group is spread over frames, replacing any highlight of it still being applied
+	if (UBuildSystemSubsystem* BuildSystem = GetBuildSystem()) {
+		BuildSystem->GetDeferredWork().Highlight(*BuildSystem, MoveableObject, nullptr);
+		return;
+	}
+
 	for (AMoveableObject* Object : MoveableObject->FusedObjects) {
 		// If the object is not valid, move onto the next
 		if (!Object || !Object->Mat || !Object->MeshComponent) continue;
 
 		// Otherwise remove the overlay material
 		Object->MeshComponent->SetOverlayMaterial(nullptr);
-		Object->DynamicMat = nullptr;
 	}
 }
 
-// Update the physics constraints of the two objects being fused
-void AMoveableObject::UpdateConstraints(AMoveableObject* MoveableObject)
+// Update the physics constraints of the two objects being fused, and of any extra contacts fused along with them, then merge every group touched, returning the size of the merged group
+int32 AMoveableObject::UpdateConstraints(AMoveableObject* FusedObject, AMoveableObject* MoveableObject, TConstArrayView<FFuseContact> ExtraContacts)
 {
+	// Constraints can only be added between separate bodies, so a frozen group being fused onto is unfrozen first
+	FusedObject->UnfreezeGroup();
+	MoveableObject->UnfreezeGroup();
+	for (const FFuseContact& Contact : ExtraContacts) {
+		Contact.NearbyObject->UnfreezeGroup();
+	}
+
 	// Create and setup a physics constraint
-	UPhysicsConstraintComponent* PhysicsConstraint = AddPhysicsConstraint(MoveableObject);
+	UPhysicsConstraintComponent* PhysicsConstraint = AddPhysicsConstraint(FusedObject, MoveableObject);
 
 	// Create a custom link to add to the physics constraints array
-	AddConstraintLink(PhysicsConstraint, MoveableObject);
+	AddConstraintLink(PhysicsConstraint, FusedObject, MoveableObject);
+
+	// Every extra contact gets its own constraint, but the groups are only merged once all of them have been added
+	TArray<AMoveableObject*, TInlineAllocator<8>> MergedObjects;
+	MergedObjects.Add(MoveableObject);
+	for (const FFuseContact& Contact : ExtraContacts) {
+		AddConstraintLink(AddPhysicsConstraint(Contact.FusedObject, Contact.NearbyObject), Contact.FusedObject, Contact.NearbyObject);
+		MergedObjects.Add(Contact.NearbyObject);
+	}
 
 	//////////////////////////////////////////////////////////////////////////////////////
 	// For debugging - Print out all physics constraints on the current moveable object
-	if (bDebugMode) {
-		for (const FPhysicsConstraintLink& Link : PhysicsConstraintLinks)
+	if (bDebugMode && GetLinkTable()) {
+		GetLinkTable()->ForEachObjectLink(this, [&](FConstraintLinkHandle, const FPhysicsConstraintLink& Link)
 		{
 			if (Link.Constraint)
 			{
@@ -692,21 +900,24 @@ void AMoveableObject::UpdateConstraints(AMoveableObject* MoveableObject)
 					*WorldLocation.ToString()
 				));*/
 			}
-		}
+		});
 	}
 	//////////////////////////////////////////////////////////////////////////////////////
 
-	MergeMoveableObjects(MoveableObject);
+	return MergeMoveableObjects(FusedObject, MergedObjects);
 }
 
 // Create a new physics constraint on the closest moveable object within the held object's fused set to be used with the physics constraint link
-UPhysicsConstraintComponent* AMoveableObject::AddPhysicsConstraint(AMoveableObject* MoveableObject)
+UPhysicsConstraintComponent* AMoveableObject::AddPhysicsConstraint(AMoveableObject* FusedObject, AMoveableObject* MoveableObject)
 {
-	UPhysicsConstraintComponent* PhysicsConstraint = NewObject<UPhysicsConstraintComponent>(ClosestFusedMoveableObject->MeshComponent->GetOwner());
+	SCOPE_CYCLE_COUNTER(STAT_BuildSystem_AddPhysicsConstraint);
+	LLM_SCOPE_BYTAG(BuildSystem_Links);
+
+	UPhysicsConstraintComponent* PhysicsConstraint = NewObject<UPhysicsConstraintComponent>(FusedObject->MeshComponent->GetOwner());
 	PhysicsConstraint->RegisterComponent();
-	PhysicsConstraint->AttachToComponent(ClosestFusedMoveableObject->RootComponent, FAttachmentTransformRules::KeepWorldTransform);
-	PhysicsConstraint->SetWorldLocation(ClosestFusedMoveableObject->GetActorLocation());
-	PhysicsConstraint->SetConstrainedComponents(ClosestFusedMoveableObject->MeshComponent, NAME_None, MoveableObject->MeshComponent, NAME_None);
+	PhysicsConstraint->AttachToComponent(FusedObject->RootComponent, FAttachmentTransformRules::KeepWorldTransform);
+	PhysicsConstraint->SetWorldLocation(FusedObject->GetActorLocation());
+	PhysicsConstraint->SetConstrainedComponents(FusedObject->MeshComponent, NAME_None, MoveableObject->MeshComponent, NAME_None);
 
 	// Configure allowed motion and rotation
 	PhysicsConstraint->SetLinearXLimit(ELinearConstraintMotion::LCM_Locked, 0);
@@ -724,126 +935,518 @@ UPhysicsConstraintComponent* AMoveableObject::AddPhysicsConstraint(AMoveableObje
 }
 
 // Create a new constraint link and add it to both objects being fused
-void AMoveableObject::AddConstraintLink(UPhysicsConstraintComponent* PhysicsConstraint, AMoveableObject* MoveableObject)
+void AMoveableObject::AddConstraintLink(UPhysicsConstraintComponent* PhysicsConstraint, AMoveableObject* FusedObject, AMoveableObject* MoveableObject)
 {
-	FPhysicsConstraintLink NewLink;
-	NewLink.Constraint = PhysicsConstraint;
-	NewLink.ComponentA = ClosestFusedMoveableObject;
-	NewLink.ComponentB = MoveableObject;
-	ClosestFusedMoveableObject->PhysicsConstraintLinks.Add(NewLink);
-	MoveableObject->PhysicsConstraintLinks.Add(NewLink);
+	// The link is stored once in the link table, which adds it to the link lists of both objects
+	if (FConstraintLinkTable* LinkTable = GetLinkTable()) {
+		LinkTable->Add(PhysicsConstraint, FusedObject, MoveableObject);
+	}
 }
 
-// Merge the fused object sets of the currently held object and the one it is fusing with
-void AMoveableObject::MergeMoveableObjects(AMoveableObject* MoveableObject)
+// Merge the fused object sets of the currently held object and every object it is fusing with, returning the size of the merged group
+int32 AMoveableObject::MergeMoveableObjects(AMoveableObject* FusedObject, TConstArrayView<AMoveableObject*> MoveableObjects)
 {
-	// Initialize a new set to hold all fused objects
-	TSet<AMoveableObject*> MergedObjects;
+	SCOPE_CYCLE_COUNTER(STAT_BuildSystem_MergeMoveableObjects);
+	LLM_SCOPE_BYTAG(BuildSystem_FusedSets);
+
+	// Every group's sets have to be settled before they can be merged
+	UBuildSystemSubsystem* BuildSystem = GetBuildSystem();
+	if (BuildSystem) {
+		BuildSystem->FinishGroupWork(FusedObject);
+		for (AMoveableObject* MoveableObject : MoveableObjects) {
+			BuildSystem->FinishGroupWork(MoveableObject);
+		}
+	}
 
-	// Build set from currently existing fused object's sets of the held object and fusing object
-	for (AMoveableObject* Object : ClosestFusedMoveableObject->FusedObjects) {
+	// Build the merged set from currently existing fused object's sets of the held object and fusing objects
+	FDeferredWork Work;
+	Work.Type = EDeferredWorkType::MergeGroups;
+	for (AMoveableObject* Object : FusedObject->FusedObjects) {
 		if (Object) {
-			MergedObjects.Add(Object);
+			Work.FusedSet.Add(Object);
 		}
 	}
 
-	for (AMoveableObject* Object : MoveableObject->FusedObjects) {
-		if (Object) {
-			MergedObjects.Add(Object);
+	for (AMoveableObject* MoveableObject : MoveableObjects) {
+		// Separate groups become one, while objects already in the merged set, such as a second contact with the same group, add nothing
+		if (Work.FusedSet.Contains(MoveableObject)) continue;
+		DEC_DWORD_STAT(STAT_BuildSystem_Groups);
+
+		for (AMoveableObject* Object : MoveableObject->FusedObjects) {
+			if (Object) {
+				Work.FusedSet.Add(Object);
+			}
 		}
 	}
 
-	// Update fused object of every object in the merged group
-	for (AMoveableObject* Object : MergedObjects) {
-		if (Object) {
-			Object->FusedObjects = MergedObjects;
+	const int32 NumMerged = Work.FusedSet.Num();
+	if (!BuildSystem) {
+		for (AMoveableObject* Object : Work.FusedSet) {
+			Object->FusedObjects = Work.FusedSet;
 		}
+		return NumMerged;
 	}
+
+	// Move every object in the merged group into the fused object's group straight away, so locks, sleep and significance treat it as one group.
+	// The merged set is handed out to each object afterwards, over later frames for large groups
+	FPartRegistry& Registry = BuildSystem->GetPartRegistry();
+	Work.GroupId = Registry.GetGroupId(FusedObject);
+	for (AMoveableObject* Object : Work.FusedSet) {
+		Registry.SetGroupId(Object, Work.GroupId);
+	}
+
+	Work.Parts = Work.FusedSet.Array();
+	BuildSystem->GetDeferredWork().Add(*BuildSystem, MoveTemp(Work));
+	return NumMerged;
 }
 
 // Split the fused object sets of the currently held object through moveable object interface
 void AMoveableObject::SplitMoveableObjects_Implementation()
 {
+	SCOPE_CYCLE_COUNTER(STAT_BuildSystem_SplitMoveableObjects);
+	LLM_SCOPE_BYTAG(BuildSystem_FusedSets);
+
+	// The group's sets have to be settled before it can be split again
+	UBuildSystemSubsystem* BuildSystem = GetBuildSystem();
+	if (!BuildSystem) return;
+	BuildSystem->FinishGroupWork(this);
+
+	// The links being removed need their constraints back first
+	UnfreezeGroup();
+
 	// Remove all physics constraints from the held object
 	RemovePhysicsLink();
 
-	// Clear the fused object set of each object except for itself and update its overlay material to be null
+	// The rest of the group keeps its set, less this object, until it is rebuilt into the groups its remaining links hold together
+	FDeferredWork Work;
+	Work.Type = EDeferredWorkType::RebuildGroups;
+	Work.SplitObject = GetFName();
+	Work.Parts.Reserve(FusedObjects.Num());
 	for (AMoveableObject* Object : FusedObjects) {
 		if (Object && Object != this) {
-			Object->FusedObjects.Empty();
-			Object->FusedObjects.Add(Object);
-			Object->MeshComponent->SetOverlayMaterial(nullptr);
-			Object->DynamicMat = nullptr;
+			Object->FusedObjects.Remove(this);
+			Work.Parts.Add(Object);
 		}
 	}
 
-	// Rebuild the fused object sets based on their physics links
-	UpdateFusedSet();
-
-	// Clear physics constraint links of held object
-	PhysicsConstraintLinks.Empty();
-
 	// Remove velocity from all previously fused objects to drop them
 	RemoveObjectVelocity();
 
 	// Finally, clear the fused objects set except for the object itself
 	FusedObjects.Empty();
 	FusedObjects.Add(this);
+
+	// This object is a group of its own straight away, and replaces the single group it was part of if nothing was left behind
+	FPartRegistry& Registry = BuildSystem->GetPartRegistry();
+	Work.GroupId = Registry.GetGroupId(this);
+	Registry.SetGroupId(this, Registry.NewGroupId());
+	if (Work.Parts.Num() > 0) {
+		INC_DWORD_STAT(STAT_BuildSystem_Groups);
+	}
+
+	FFlightEvent Event = MakeFlightEvent(EFlightEventType::SplitGroup, Registry, this, nullptr);
+	Event.Count = 1;
+	BuildSystem->GetFlightRecorder().Record(Event);
+
+	// Rebuilding the groups left behind records the split once they all have their own group ids
+	BuildSystem->GetDeferredWork().Add(*BuildSystem, MoveTemp(Work));
+}
+
+// Break one of this object's links, such as one overloaded by structural stress, and rebuild its group into the groups its remaining links hold together, returning false if the handle is not one of its links
+bool AMoveableObject::BreakLink(FConstraintLinkHandle Handle)
+{
+	SCOPE_CYCLE_COUNTER(STAT_BuildSystem_SplitMoveableObjects);
+	LLM_SCOPE_BYTAG(BuildSystem_FusedSets);
+
+	UBuildSystemSubsystem* BuildSystem = GetBuildSystem();
+	if (!BuildSystem) return false;
+
+	const FPhysicsConstraintLink* Link = BuildSystem->GetLinkTable().Find(Handle);
+	if (!Link || (Link->ComponentA != this && Link->ComponentB != this)) return false;
+
+	// The group's sets have to be settled, and the link needs its constraint back, before it can be broken
+	BuildSystem->FinishGroupWork(this);
+	UnfreezeGroup();
+
+	// Unfreezing gives the link a new constraint, so the link is looked up again
+	Link = BuildSystem->GetLinkTable().Find(Handle);
+	if (!Link) return false;
+
+	RemoveLink(*BuildSystem, Handle, *Link);
+
+	// A sleeping group would hang in place, so the whole group is woken to fall apart
+	BuildSystem->WakeGroup(this);
+
+	// Every part keeps its set until the group is rebuilt, which may leave it whole if other links still hold it together
+	FDeferredWork Work;
+	Work.Type = EDeferredWorkType::RebuildGroups;
+	Work.GroupId = BuildSystem->GetPartRegistry().GetGroupId(this);
+	Work.SplitObject = GetFName();
+	Work.NumSplitGroups = 0;
+	Work.Parts.Reserve(FusedObjects.Num());
+	for (AMoveableObject* Object : FusedObjects) {
+		if (Object) {
+			Work.Parts.Add(Object);
+		}
+	}
+
+	BuildSystem->GetDeferredWork().Add(*BuildSystem, MoveTemp(Work));
+	return true;
 }
 
 // Remove all physics constraints from the held object
 void AMoveableObject::RemovePhysicsLink()
 {
-	for (const FPhysicsConstraintLink& Link : PhysicsConstraintLinks) {
-		if (Link.Constraint) {
-			// Re-enable collision on both objects
-			Link.ComponentA->MeshComponent->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-			Link.ComponentB->MeshComponent->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+	UBuildSystemSubsystem* BuildSystem = GetBuildSystem();
+	if (!BuildSystem) return;
 
-			// If components are the same, simply destroy the constraint
-			if (Link.ComponentA == Link.ComponentB) {
-				Link.Constraint->DestroyComponent();
-				continue;
-			}
+	BuildSystem->GetLinkTable().ForEachObjectLink(this, [BuildSystem](FConstraintLinkHandle Handle, const FPhysicsConstraintLink& Link) {
+		RemoveLink(*BuildSystem, Handle, Link);
+	});
+}
 
-			// Remove the link from the physics constraint links of the non-held object to not interfere with this.PhysicsConstraintLinks. This will be cleared later
-			if (Link.ComponentA == this) {
-				Link.ComponentB->PhysicsConstraintLinks.Remove(Link);
-			}
+// Break a link's constraint, restoring collision between its objects, and remove it from the link table
+void AMoveableObject::RemoveLink(UBuildSystemSubsystem& BuildSystem, FConstraintLinkHandle Handle, const FPhysicsConstraintLink& Link)
+{
+	if (Link.Constraint) {
+		// Re-enable collision on both objects
+		Link.ComponentA->MeshComponent->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+		Link.ComponentB->MeshComponent->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+
+		// Break the constraint so the objects come apart this frame, and leave destroying its component until there is time
+		Link.Constraint->BreakConstraint();
+
+		FDeferredWork Work;
+		Work.Type = EDeferredWorkType::DestroyConstraint;
+		Work.Constraint = Link.Constraint;
+		BuildSystem.GetDeferredWork().Add(BuildSystem, MoveTemp(Work));
+	}
+
+	// Remove the link from the table last, as the link belongs to the table. This also removes it from the link lists of both objects
+	BuildSystem.GetLinkTable().Remove(Handle);
+}
+
+// Get the build system subsystem of this object's world
+UBuildSystemSubsystem* AMoveableObject::GetBuildSystem() const
+{
+	return GetWorld() ? GetWorld()->GetSubsystem<UBuildSystemSubsystem>() : nullptr;
+}
+
+// Get the fuse session of this object, if it is being held or is still fusing
+FFuseSession* AMoveableObject::FindFuseSession() const
+{
+	UBuildSystemSubsystem* BuildSystem = GetBuildSystem();
+	return BuildSystem ? BuildSystem->FindSession(this) : nullptr;
+}
+
+// Get the table of physics constraint links for this object's world
+FConstraintLinkTable* AMoveableObject::GetLinkTable() const
+{
+	UBuildSystemSubsystem* BuildSystem = GetBuildSystem();
+	return BuildSystem ? &BuildSystem->GetLinkTable() : nullptr;
+}
 
-			else {
-				Link.ComponentA->PhysicsConstraintLinks.Remove(Link);
+// Get the simple collision proxy of this object's mesh, baking it the first time it is needed or after the mesh changes
+TSharedRef<const FCollisionProxy, ESPMode::ThreadSafe> AMoveableObject::GetCollisionProxy()
+{
+	const UStaticMesh* Mesh = MeshComponent ? MeshComponent->GetStaticMesh() : nullptr;
+	if (!CollisionProxy || CollisionProxyMesh != TObjectKey<UStaticMesh>(Mesh)) {
+		// Proxies are shared by every object with the same mesh and shape, so each is only baked once per world
+		UBuildSystemSubsystem* BuildSystem = GetBuildSystem();
+		CollisionProxy = BuildSystem ? BuildSystem->GetCollisionProxy(Mesh, CollisionProxyShape) : MakeShared<const FCollisionProxy, ESPMode::ThreadSafe>(FCollisionProxy::Bake(Mesh, CollisionProxyShape));
+		CollisionProxyMesh = Mesh;
+	}
+
+	return CollisionProxy.ToSharedRef();
+}
+
+// Get the closest point on this object's collision proxy to a world point, or the point itself if it is inside the proxy
+FVector AMoveableObject::GetClosestPointOnProxy(const FVector& WorldPoint)
+{
+	return GetCollisionProxy()->GetClosestPoint(MeshComponent->GetComponentTransform(), WorldPoint);
+}
+
+// Turn debug drawing on or off, ticking only while it is on
+void AMoveableObject::SetDebugMode(bool bEnabled)
+{
+	bDebugMode = bEnabled;
+
+	// Reduced fidelity and pooled objects turn their tick back on when they return to full fidelity or are reused
+	if (!IsReducedFidelity() && !bPooled) {
+		SetActorTickEnabled(bDebugMode && PrimaryActorTick.bStartWithTickEnabled);
+	}
+}
+
+// Drop this object to low fidelity while its group is idle and far from every viewer, or return it to full fidelity
+void AMoveableObject::SetReducedFidelity(bool bReduced)
+{
+	if (bReduced == IsReducedFidelity()) return;
+
+	FBodyInstance& BodyInstance = MeshComponent->BodyInstance;
+
+	if (bReduced) {
+		FFullFidelitySettings& Settings = FullFidelitySettings.Emplace();
+		Settings.MeshCollision = MeshComponent->GetCollisionEnabled();
+		Settings.FuseBoxCollision = FuseCollisionBox->GetCollisionEnabled();
+		Settings.bMeshOverlaps = MeshComponent->GetGenerateOverlapEvents();
+		Settings.bFuseBoxOverlaps = FuseCollisionBox->GetGenerateOverlapEvents();
+		Settings.PositionSolverIterations = BodyInstance.PositionSolverIterationCount;
+		Settings.VelocitySolverIterations = BodyInstance.VelocitySolverIterationCount;
+
+		// Nothing fuses with a far away object, so its fuse box is switched off and its mesh is only kept for physics, which already uses the simple collision shapes
+		FuseCollisionBox->SetGenerateOverlapEvents(false);
+		FuseCollisionBox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		MeshComponent->SetGenerateOverlapEvents(false);
+		if (Settings.MeshCollision == ECollisionEnabled::QueryAndPhysics) {
+			MeshComponent->SetCollisionEnabled(ECollisionEnabled::PhysicsOnly);
+		}
+
+		const uint8 SolverIterations = (uint8)FMath::Clamp(CVarSignificanceSolverIterations.GetValueOnGameThread(), 1, 255);
+		BodyInstance.SetPositionSolverIterationCount(FMath::Min(SolverIterations, Settings.PositionSolverIterations));
+		BodyInstance.SetVelocitySolverIterationCount(FMath::Min(SolverIterations, Settings.VelocitySolverIterations));
+
+		SetActorTickEnabled(false);
+	}
+
+	else {
+		const FFullFidelitySettings Settings = FullFidelitySettings.GetValue();
+		FullFidelitySettings.Reset();
+
+		MeshComponent->SetCollisionEnabled(Settings.MeshCollision);
+		MeshComponent->SetGenerateOverlapEvents(Settings.bMeshOverlaps);
+		FuseCollisionBox->SetCollisionEnabled(Settings.FuseBoxCollision);
+		FuseCollisionBox->SetGenerateOverlapEvents(Settings.bFuseBoxOverlaps);
+		BodyInstance.SetPositionSolverIterationCount(Settings.PositionSolverIterations);
+		BodyInstance.SetVelocitySolverIterationCount(Settings.VelocitySolverIterations);
+
+		// Objects only tick to draw debug information
+		SetActorTickEnabled(bDebugMode && PrimaryActorTick.bStartWithTickEnabled);
+	}
+}
+
+// End any fuse session, leave the fused group and park the object out of the world while it waits in a part pool
+void AMoveableObject::DisableForPool()
+{
+	UBuildSystemSubsystem* BuildSystem = GetBuildSystem();
+
+	// The object is about to leave its group, so the group's sets have to be settled first
+	if (BuildSystem) {
+		BuildSystem->FinishGroupWork(this);
+	}
+
+	// The subsystem removes the fuse session on its next tick once it is no longer held or fusing
+	RemoveMoveableObjectMaterial(this);
+	if (FFuseSession* Session = FindFuseSession()) {
+		Session->bIsGrabbed = false;
+		Session->bIsFusing = false;
+	}
+
+	// Leave the fused group, which rebuilds the rest of the group from its remaining links
+	UnfreezeGroup();
+	if (FusedObjects.Num() > 1) {
+		SplitMoveableObjects_Implementation();
+	}
+
+	else {
+		RemovePhysicsLink();
+	}
+
+	SetReducedFidelity(false);
+
+	if (BuildSystem) {
+		BuildSystem->GetPartRegistry().Unregister(this);
+	}
+	DEC_DWORD_STAT(STAT_BuildSystem_Parts);
+	DEC_DWORD_STAT(STAT_BuildSystem_Groups);
+
+	// Stop simulating and hide the object, keeping its components registered so it can be reused without constructing them again
+	bSimulatedBeforePooling = MeshComponent->IsSimulatingPhysics();
+	MeshComponent->SetPhysicsLinearVelocity(FVector::ZeroVector);
+	MeshComponent->SetPhysicsAngularVelocityInDegrees(FVector::ZeroVector);
+	MeshComponent->SetSimulatePhysics(false);
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	SetActorTickEnabled(false);
+
+	bPooled = true;
+}
+
+// Bring a pooled object back into the world as its own group
+void AMoveableObject::EnableFromPool(const FTransform& Transform)
+{
+	bPooled = false;
+
+	SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+	SetActorEnableCollision(true);
+	SetActorHiddenInGame(false);
+	MeshComponent->SetSimulatePhysics(bSimulatedBeforePooling);
+
+	// The mesh may have been hidden while the object was drawn as an instance, the instanced renderer hides it again if it still is
+	MeshComponent->SetVisibility(true);
+
+	// Objects only tick to draw debug information
+	SetActorTickEnabled(bDebugMode && PrimaryActorTick.bStartWithTickEnabled);
+
+	// Every reused object starts as its own group, the same as a newly spawned one
+	{
+		LLM_SCOPE_BYTAG(BuildSystem_FusedSets);
+		FusedObjects.Reset();
+		FusedObjects.Add(this);
+	}
+
+	if (UBuildSystemSubsystem* BuildSystem = GetBuildSystem()) {
+		BuildSystem->GetPartRegistry().Register(this);
+	}
+	INC_DWORD_STAT(STAT_BuildSystem_Parts);
+	INC_DWORD_STAT(STAT_BuildSystem_Groups);
+}
+
+// Freeze this object's fused group into a single compound body drawn through instanced meshes, keeping every part and link so it can be unfrozen. Held and fusing groups cannot be frozen
+bool AMoveableObject::FreezeGroup()
+{
+	UBuildSystemSubsystem* BuildSystem = GetBuildSystem();
+	if (!BuildSystem || bFrozen) return false;
+
+	// Every member has to have the group's whole set before it can be frozen
+	BuildSystem->FinishGroupWork(this);
+	if (FusedObjects.Num() < 2) return false;
+
+	FPartRegistry& Registry = BuildSystem->GetPartRegistry();
+	for (AMoveableObject* Member : FusedObjects) {
+		const int32 Index = Registry.GetIndex(Member);
+		if (!Member || Member->bPooled || (Index != INDEX_NONE && EnumHasAnyFlags(Registry.Flags[Index], EPartFlags::Grabbed | EPartFlags::Fusing))) return false;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_BuildSystem_FreezeGroup);
+	LLM_SCOPE_BYTAG(BuildSystem_Components);
+
+	FFrozenGroup& FrozenGroup = BuildSystem->AddFrozenGroup(this);
+	FrozenGroup.Members = FusedObjects.Array();
+
+	// Destroy every constraint in the group but keep its link, so the group keeps its shape and can be split or unfrozen later
+	FConstraintLinkTable& LinkTable = BuildSystem->GetLinkTable();
+	for (AMoveableObject* Member : FrozenGroup.Members) {
+		LinkTable.ForEachObjectLink(Member, [BuildSystem, &LinkTable](FConstraintLinkHandle Handle, const FPhysicsConstraintLink& Link) {
+			if (Link.Constraint) {
+				Link.Constraint->BreakConstraint();
+
+				FDeferredWork Work;
+				Work.Type = EDeferredWorkType::DestroyConstraint;
+				Work.Constraint = Link.Constraint;
+				BuildSystem->GetDeferredWork().Add(*BuildSystem, MoveTemp(Work));
+				LinkTable.SetConstraint(Handle, nullptr);
 			}
+		});
+	}
+
+	// Gather the instance transforms of every member that can be drawn as an instance, relative to this object so the instances move with its body
+	TMap<TPair<UStaticMesh*, UMaterialInterface*>, TArray<FTransform>> InstanceTransforms;
+	const FTransform AnchorTransform = MeshComponent->GetComponentTransform();
+	for (AMoveableObject* Member : FrozenGroup.Members) {
+		if (!FInstancedPartRenderer::CanInstance(Member, EPartFlags::None)) continue;
 
-			// Destroy the constraint between the two objects
-			Link.Constraint->DestroyComponent();
+		InstanceTransforms.FindOrAdd({ Member->MeshComponent->GetStaticMesh(), Member->MeshComponent->GetMaterial(0) }).Add(Member->MeshComponent->GetComponentTransform().GetRelativeTransform(AnchorTransform));
+		Member->MeshComponent->SetVisibility(false);
+	}
+
+	for (const TPair<TPair<UStaticMesh*, UMaterialInterface*>, TArray<FTransform>>& Batch : InstanceTransforms) {
+		UInstancedStaticMeshComponent* Instances = NewObject<UInstancedStaticMeshComponent>(this);
+		Instances->SetupAttachment(MeshComponent);
+		Instances->SetStaticMesh(Batch.Key.Key);
+		Instances->SetMaterial(0, Batch.Key.Value);
+		Instances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		Instances->SetCanEverAffectNavigation(false);
+		Instances->RegisterComponent();
+		Instances->AddInstances(Batch.Value, false, false);
+		AddInstanceComponent(Instances);
+		FrozenGroup.Instances.Add(Instances);
+	}
+
+	// Weld every other member to this object's body, which adds their collision to it as a single compound body
+	for (AMoveableObject* Member : FrozenGroup.Members) {
+		Member->bFrozen = true;
+		Registry.SetFlags(Member, EPartFlags::Frozen, true);
+
+		if (Member != this) {
+			Member->MeshComponent->SetSimulatePhysics(false);
+			Member->MeshComponent->WeldTo(MeshComponent);
 		}
 	}
+
+	return true;
 }
 
-// Update fused object sets based on their physics links
-void AMoveableObject::UpdateFusedSet()
+// Unfreeze this object's group back into separate bodies held together by physics constraints
+void AMoveableObject::UnfreezeGroup()
 {
-	for (AMoveableObject* Object : FusedObjects) {
-		if (Object && Object != this) {
-			// Initialize a new set to store all fused objects from each link component
-			TSet<AMoveableObject*> MergedSet;
+	if (!bFrozen) return;
 
-			// For each object, iterate over all their physics links adding all moveable ojbects within each component's fused object set
-			for (FPhysicsConstraintLink& Link : Object->PhysicsConstraintLinks) {
-				if (Link.ComponentA) {
-					MergedSet.Append(Link.ComponentA->FusedObjects);
-				}
+	UBuildSystemSubsystem* BuildSystem = GetBuildSystem();
+	FFrozenGroup* FrozenGroup = BuildSystem ? BuildSystem->FindFrozenGroup(this) : nullptr;
+	if (!FrozenGroup) {
+		bFrozen = false;
+		return;
+	}
 
-				if (Link.ComponentB) {
-					MergedSet.Append(Link.ComponentB->FusedObjects);
-				}
+	SCOPE_CYCLE_COUNTER(STAT_BuildSystem_UnfreezeGroup);
+	LLM_SCOPE_BYTAG(BuildSystem_Links);
 
-				// Then iterate over every object in the new merged set, setting it's fused object set to include all connected objects
-				for (AMoveableObject* ObjectMerged : MergedSet) {
-					ObjectMerged->FusedObjects = MergedSet;
-				}
+	AMoveableObject* Anchor = FrozenGroup->Anchor;
+	const bool bSimulating = Anchor->MeshComponent->IsSimulatingPhysics();
+	const FVector AngularVelocity = Anchor->MeshComponent->GetPhysicsAngularVelocityInDegrees();
+
+	for (UInstancedStaticMeshComponent* Instances : FrozenGroup->Instances) {
+		if (Instances) {
+			Instances->DestroyComponent();
+		}
+	}
+
+	// Detach every member from the compound body, carrying on with the velocity its part of the body had
+	FPartRegistry& Registry = BuildSystem->GetPartRegistry();
+	for (AMoveableObject* Member : FrozenGroup->Members) {
+		if (!IsValid(Member)) continue;
+
+		Member->bFrozen = false;
+		Registry.SetFlags(Member, EPartFlags::Frozen, false);
+		Member->MeshComponent->SetVisibility(true);
+
+		if (Member != Anchor) {
+			const FVector LinearVelocity = Anchor->MeshComponent->GetBodyInstance() ? Anchor->MeshComponent->GetBodyInstance()->GetUnrealWorldVelocityAtPoint(Member->GetActorLocation()) : FVector::ZeroVector;
+			Member->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+			Member->MeshComponent->SetSimulatePhysics(bSimulating);
+			if (bSimulating) {
+				Member->MeshComponent->SetPhysicsLinearVelocity(LinearVelocity);
+				Member->MeshComponent->SetPhysicsAngularVelocityInDegrees(AngularVelocity);
 			}
 		}
 	}
+
+	// Give every link in the group its constraint back
+	FConstraintLinkTable& LinkTable = BuildSystem->GetLinkTable();
+	for (AMoveableObject* Member : FrozenGroup->Members) {
+		if (!IsValid(Member)) continue;
+
+		LinkTable.ForEachObjectLink(Member, [this, &LinkTable](FConstraintLinkHandle Handle, const FPhysicsConstraintLink& Link) {
+			if (!Link.Constraint && IsValid(Link.ComponentA) && IsValid(Link.ComponentB)) {
+				LinkTable.SetConstraint(Handle, AddPhysicsConstraint(Link.ComponentA, Link.ComponentB));
+			}
+		});
+	}
+
+	BuildSystem->RemoveFrozenGroup(Anchor);
+}
+
+// Add the memory used by this object's build state to a memory usage report
+void AMoveableObject::AccumulateMemoryUsage(FBuildSystemMemoryUsage& Usage) const
+{
+	using BuildSystemStats::GetObjectBytes;
+
+	++Usage.NumParts;
+	Usage.FusedSetBytes += FusedObjects.GetAllocatedSize();
+	Usage.ComponentBytes += GetObjectBytes(FuseCollisionBox);
+
+	Usage.SnapPointBytes += SnapPoints.GetAllocatedSize();
+	for (USnapPointComponent* SnapPoint : SnapPoints) {
+		Usage.SnapPointBytes += GetObjectBytes(SnapPoint);
+	}
 }
\ No newline at end of file
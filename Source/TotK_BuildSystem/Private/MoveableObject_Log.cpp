@@ -3,3 +3,9 @@
 
 #include "MoveableObject_Log.h"
 
+// Sets default values
+AMoveableObject_Log::AMoveableObject_Log()
+{
+	// Logs are round, so a capsule follows their collision far more closely than a box
+	CollisionProxyShape = ECollisionProxyShape::Capsule;
+}
@@ -0,0 +1,96 @@
+#include "OrientationLattice.h"
+#include "BuildSystemStats.h"
+
+// Build the lattice for the given rotation increment
+FOrientationLattice::FOrientationLattice(float InStepDegrees)
+{
+	Build(InStepDegrees);
+}
+
+// Rebuild the lattice for a new rotation increment
+void FOrientationLattice::Build(float InStepDegrees)
+{
+	LLM_SCOPE_BYTAG(BuildSystem);
+
+	// Only whole divisions of a full turn form a lattice, so fall back to quarter turns otherwise
+	RequestedStepDegrees = InStepDegrees;
+	const int32 StepsPerTurn = InStepDegrees > 0.f ? FMath::RoundToInt(360.f / InStepDegrees) : 0;
+	StepDegrees = StepsPerTurn > 0 && FMath::IsNearlyEqual(StepsPerTurn * InStepDegrees, 360.f, 0.01f) ? InStepDegrees : 90.f;
+
+	const int32 NumSteps = FMath::RoundToInt(360.f / StepDegrees);
+	const int32 NumPitchSteps = FMath::FloorToInt(90.f / StepDegrees + UE_KINDA_SMALL_NUMBER);
+
+	Orientations.Reset();
+	OrientationX.Reset();
+	OrientationY.Reset();
+	OrientationZ.Reset();
+	OrientationW.Reset();
+
+	// Add every combination of pitch, yaw and roll increments, skipping duplicate orientations such as those at gimbal lock. With 90 degrees this leaves the 24 rotations of a cube
+	for (int32 Pitch = -NumPitchSteps; Pitch <= NumPitchSteps; ++Pitch) {
+		for (int32 Yaw = 0; Yaw < NumSteps; ++Yaw) {
+			for (int32 Roll = 0; Roll < NumSteps; ++Roll) {
+				FQuat Orientation = FRotator(Pitch * StepDegrees, Yaw * StepDegrees, Roll * StepDegrees).Quaternion();
+				Orientation.Normalize();
+
+				// Keep the orientation if it is not already in the lattice
+				if (Orientations.Num() > 0 && FMath::Abs(Orientations[FindNearest(Orientation)] | Orientation) > 1.f - UE_KINDA_SMALL_NUMBER) continue;
+
+				Orientations.Add(Orientation);
+				OrientationX.Add(Orientation.X);
+				OrientationY.Add(Orientation.Y);
+				OrientationZ.Add(Orientation.Z);
+				OrientationW.Add(Orientation.W);
+			}
+		}
+	}
+
+	// Precompute the transition for every step direction. Quarter turns are closed under every step, finer increments snap steps that leave the lattice to the nearest orientation
+	const int32 NumDirections = (int32)EOrientationStep::Num;
+	Transitions.SetNumUninitialized(Orientations.Num() * NumDirections);
+	for (int32 Index = 0; Index < Orientations.Num(); ++Index) {
+		for (int32 Direction = 0; Direction < NumDirections; ++Direction) {
+			Transitions[Index * NumDirections + Direction] = FindNearest(GetStepRotation((EOrientationStep)Direction) * Orientations[Index]);
+		}
+	}
+}
+
+// Get the index of the lattice orientation closest to the given rotation
+int32 FOrientationLattice::FindNearest(const FQuat& Rotation) const
+{
+	const float X = Rotation.X;
+	const float Y = Rotation.Y;
+	const float Z = Rotation.Z;
+	const float W = Rotation.W;
+
+	// The closest orientation has the largest absolute dot product, as a quaternion and its negative are the same rotation
+	int32 NearestIndex = INDEX_NONE;
+	float NearestDot = -1.f;
+	for (int32 Index = 0; Index < OrientationW.Num(); ++Index) {
+		const float Dot = FMath::Abs(OrientationX[Index] * X + OrientationY[Index] * Y + OrientationZ[Index] * Z + OrientationW[Index] * W);
+		if (Dot > NearestDot) {
+			NearestDot = Dot;
+			NearestIndex = Index;
+		}
+	}
+
+	return NearestIndex;
+}
+
+// Get the rotation applied for a single step in a direction
+FQuat FOrientationLattice::GetStepRotation(EOrientationStep Step) const
+{
+	switch (Step)
+	{
+	case EOrientationStep::Left:
+		return FQuat(FVector(0, 0, 1), FMath::DegreesToRadians(StepDegrees));
+	case EOrientationStep::Right:
+		return FQuat(FVector(0, 0, 1), FMath::DegreesToRadians(-StepDegrees));
+	case EOrientationStep::Up:
+		return FQuat(FVector(0, 1, 0), FMath::DegreesToRadians(-StepDegrees));
+	case EOrientationStep::Down:
+		return FQuat(FVector(0, 1, 0), FMath::DegreesToRadians(StepDegrees));
+	default:
+		return FQuat::Identity;
+	}
+}
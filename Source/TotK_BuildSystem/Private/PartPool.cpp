@@ -0,0 +1,75 @@
+#include "PartPool.h"
+#include "MoveableObject.h"
+#include "BuildSystemStats.h"
+
+// Most objects of a single class kept in its pool, any released past this are destroyed
+static TAutoConsoleVariable<int32> CVarPartPoolMaxSize(
+	TEXT("BuildSystem.PartPoolMaxSize"),
+	256,
+	TEXT("Most released objects of a single moveable object class kept for reuse, any released past this are destroyed"));
+
+// Take a pooled object of the given class and move it into place, spawning a new one if none of that class are pooled
+AMoveableObject* FPartPool::Acquire(UWorld* World, TSubclassOf<AMoveableObject> PartClass, const FTransform& Transform)
+{
+	if (!World || !PartClass) return nullptr;
+
+	if (TArray<AMoveableObject*>* Pool = Pools.Find(PartClass.Get())) {
+		while (Pool->Num() > 0) {
+			AMoveableObject* Part = Pool->Pop(EAllowShrinking::No);
+			DEC_DWORD_STAT(STAT_BuildSystem_PooledParts);
+
+			// Objects from another world, or ones that are being destroyed, are left for the engine to clean up
+			if (!IsValid(Part) || Part->GetWorld() != World) continue;
+
+			Part->EnableFromPool(Transform);
+			return Part;
+		}
+	}
+
+	return World->SpawnActor<AMoveableObject>(PartClass, Transform);
+}
+
+// Put an object into the pool of its class, destroying it instead if that pool is full
+void FPartPool::Release(AMoveableObject* Part)
+{
+	if (!IsValid(Part) || Part->IsPooled()) return;
+
+	LLM_SCOPE_BYTAG(BuildSystem);
+
+	TArray<AMoveableObject*>& Pool = Pools.FindOrAdd(Part->GetClass());
+	if (Pool.Num() >= CVarPartPoolMaxSize.GetValueOnGameThread()) {
+		Part->Destroy();
+		return;
+	}
+
+	Part->DisableForPool();
+	Pool.Add(Part);
+	INC_DWORD_STAT(STAT_BuildSystem_PooledParts);
+}
+
+// Forget a pooled object that has been destroyed
+void FPartPool::Remove(AMoveableObject* Part)
+{
+	if (TArray<AMoveableObject*>* Pool = Pools.Find(Part->GetClass())) {
+		if (Pool->RemoveSingleSwap(Part, EAllowShrinking::No) > 0) {
+			DEC_DWORD_STAT(STAT_BuildSystem_PooledParts);
+		}
+	}
+}
+
+// Get the number of pooled objects of a class
+int32 FPartPool::NumPooled(TSubclassOf<AMoveableObject> PartClass) const
+{
+	const TArray<AMoveableObject*>* Pool = Pools.Find(PartClass.Get());
+	return Pool ? Pool->Num() : 0;
+}
+
+// Get the memory allocated by the pools
+SIZE_T FPartPool::GetAllocatedSize() const
+{
+	SIZE_T Size = Pools.GetAllocatedSize();
+	for (const TPair<TObjectKey<UClass>, TArray<AMoveableObject*>>& Pool : Pools) {
+		Size += Pool.Value.GetAllocatedSize();
+	}
+	return Size;
+}
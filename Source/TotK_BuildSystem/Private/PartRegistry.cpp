@@ -0,0 +1,145 @@
+#include "PartRegistry.h"
+#include "MoveableObject.h"
+#include "BuildSystemStats.h"
+
+// Add an object to the registry in its own group
+void FPartRegistry::Register(AMoveableObject* Part)
+{
+	LLM_SCOPE_BYTAG(BuildSystem);
+	check(Part && Part->RegistryIndex == INDEX_NONE);
+
+	Part->RegistryIndex = Parts.Add(Part);
+	Locations.Add(Part->GetActorLocation());
+	Rotations.Add(FQuat4f(Part->GetActorQuat()));
+	LinearVelocities.Add(FVector3f::ZeroVector);
+	AngularVelocities.Add(FVector3f::ZeroVector);
+	Bounds.Add(Part->MeshComponent ? Part->MeshComponent->Bounds.GetBox() : FBox(ForceInit));
+	GroupIds.Add(NewGroupId());
+	Flags.Add(EPartFlags::None);
+	SettledFrames.Add(0);
+	MarkGroupDirty(GroupIds.Last());
+}
+
+// Remove an object from the registry, moving the last part into its slot
+void FPartRegistry::Unregister(AMoveableObject* Part)
+{
+	const int32 Index = GetIndex(Part);
+	if (Index == INDEX_NONE) return;
+
+	// The group the part leaves behind is a part smaller
+	MarkGroupDirty(GroupIds[Index]);
+
+	Parts.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Locations.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Rotations.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	LinearVelocities.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	AngularVelocities.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Bounds.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	GroupIds.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Flags.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	SettledFrames.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+	// The last part now lives in the removed part's slot
+	if (Parts.IsValidIndex(Index)) {
+		Parts[Index]->RegistryIndex = Index;
+	}
+	Part->RegistryIndex = INDEX_NONE;
+}
+
+// Copy the transform, velocity, bounds and sleep state of every part from physics
+void FPartRegistry::Refresh()
+{
+	SCOPE_CYCLE_COUNTER(STAT_BuildSystem_RefreshPartRegistry);
+
+	for (int32 Index = 0; Index < Parts.Num(); ++Index) {
+		const UStaticMeshComponent* Mesh = Parts[Index]->MeshComponent;
+		if (!Mesh) continue;
+
+		const FTransform& Transform = Mesh->GetComponentTransform();
+		Locations[Index] = Transform.GetLocation();
+		Rotations[Index] = FQuat4f(Transform.GetRotation());
+		LinearVelocities[Index] = FVector3f(Mesh->GetPhysicsLinearVelocity());
+		AngularVelocities[Index] = FVector3f(Mesh->GetPhysicsAngularVelocityInDegrees());
+		Bounds[Index] = Mesh->Bounds.GetBox();
+
+		// Physics reports bodies that do not simulate as awake, but nothing moves them, so they count as asleep
+		SetAsleep(Index, !Mesh->IsSimulatingPhysics() || !Mesh->RigidBodyIsAwake());
+	}
+}
+
+// Get the slot of a part, or INDEX_NONE if it is not registered
+int32 FPartRegistry::GetIndex(const AMoveableObject* Part) const
+{
+	return Part && Parts.IsValidIndex(Part->RegistryIndex) && Parts[Part->RegistryIndex] == Part ? Part->RegistryIndex : INDEX_NONE;
+}
+
+// Get the group id of a part, or INDEX_NONE if it is not registered
+int32 FPartRegistry::GetGroupId(const AMoveableObject* Part) const
+{
+	const int32 Index = GetIndex(Part);
+	return Index != INDEX_NONE ? GroupIds[Index] : INDEX_NONE;
+}
+
+// Move a part into a group
+void FPartRegistry::SetGroupId(const AMoveableObject* Part, int32 GroupId)
+{
+	const int32 Index = GetIndex(Part);
+	if (Index != INDEX_NONE && GroupIds[Index] != GroupId) {
+		MarkGroupDirty(GroupIds[Index]);
+		MarkGroupDirty(GroupId);
+		GroupIds[Index] = GroupId;
+	}
+}
+
+// Set or clear flags on a part
+void FPartRegistry::SetFlags(const AMoveableObject* Part, EPartFlags InFlags, bool bSet)
+{
+	const int32 Index = GetIndex(Part);
+	if (Index == INDEX_NONE) return;
+
+	const EPartFlags OldFlags = Flags[Index];
+	if (bSet) {
+		Flags[Index] |= InFlags;
+	}
+
+	else {
+		Flags[Index] &= ~InFlags;
+	}
+
+	// Grabbing, fusing and freezing lock a group, and letting go of it means it may need looking at again
+	if (EnumHasAnyFlags(OldFlags ^ Flags[Index], EPartFlags::Grabbed | EPartFlags::Fusing | EPartFlags::Frozen | EPartFlags::Asleep)) {
+		MarkGroupDirty(GroupIds[Index]);
+	}
+}
+
+// Set or clear the sleep flag of the part in a slot, marking its group as changed if the part falls asleep or wakes up
+void FPartRegistry::SetAsleep(int32 Index, bool bAsleep)
+{
+	if (EnumHasAnyFlags(Flags[Index], EPartFlags::Asleep) == bAsleep) return;
+
+	if (bAsleep) {
+		Flags[Index] |= EPartFlags::Asleep;
+	}
+
+	else {
+		Flags[Index] &= ~EPartFlags::Asleep;
+	}
+	MarkGroupDirty(GroupIds[Index]);
+}
+
+// Mark a group as changed, for passes that only revisit groups whose members, sleep or lock state have changed
+void FPartRegistry::MarkGroupDirty(int32 GroupId)
+{
+	if (GroupId != INDEX_NONE) {
+		LLM_SCOPE_BYTAG(BuildSystem);
+		DirtyGroupIds.Add(GroupId);
+	}
+}
+
+// Get the memory allocated by the registry
+SIZE_T FPartRegistry::GetAllocatedSize() const
+{
+	return Parts.GetAllocatedSize() + Locations.GetAllocatedSize() + Rotations.GetAllocatedSize() + LinearVelocities.GetAllocatedSize()
+		+ AngularVelocities.GetAllocatedSize() + Bounds.GetAllocatedSize() + GroupIds.GetAllocatedSize() + Flags.GetAllocatedSize()
+		+ SettledFrames.GetAllocatedSize() + DirtyGroupIds.GetAllocatedSize();
+}
@@ -0,0 +1,407 @@
+#include "StructuralStress.h"
+#include "MoveableObject.h"
+#include "BuildSystemSubsystem.h"
+#include "BuildSystemStats.h"
+#include "Engine/World.h"
+#include "Algo/BinarySearch.h"
+#include "HAL/IConsoleManager.h"
+
+// Evaluate the stress on the links of fused groups on a worker thread, breaking links that are overloaded
+static TAutoConsoleVariable<bool> CVarStructuralStress(
+	TEXT("BuildSystem.StructuralStress"),
+	false,
+	TEXT("Evaluate the stress on the links of fused groups from the weight of their parts on a worker thread, breaking links loaded over BuildSystem.StructuralStressBreakLoad"));
+
+// Load a link can carry before it breaks, where 0 publishes stress without ever breaking links
+static TAutoConsoleVariable<float> CVarStructuralStressBreakLoad(
+	TEXT("BuildSystem.StructuralStressBreakLoad"),
+	20000.f,
+	TEXT("Load in kg a link can carry before it breaks. 0 publishes stress without ever breaking links"));
+
+// Depth of a link's cross section, which turns the bending moment a link carries into an equivalent load
+static TAutoConsoleVariable<float> CVarStructuralStressLeverArm(
+	TEXT("BuildSystem.StructuralStressLeverArm"),
+	100.f,
+	TEXT("Depth in cm of a link's cross section, which turns the bending moment a link carries into an equivalent load. Smaller values make overhangs weaker"));
+
+// Parts snapshot for each evaluation, where a group bigger than the budget is still evaluated on its own
+static TAutoConsoleVariable<int32> CVarStructuralStressMaxParts(
+	TEXT("BuildSystem.StructuralStressMaxParts"),
+	2048,
+	TEXT("Parts snapshot for each structural stress evaluation. Groups that do not fit are evaluated on later frames, and a group bigger than the budget is evaluated on its own"));
+
+// Gap below a part within which world geometry supports it
+static TAutoConsoleVariable<float> CVarStructuralStressSupportDistance(
+	TEXT("BuildSystem.StructuralStressSupportDistance"),
+	5.f,
+	TEXT("Gap in cm below a part within which world geometry supports it"));
+
+// Empty the snapshot, keeping its memory
+void FStressSnapshot::Reset()
+{
+	Parts.Reset();
+	Links.Reset();
+	Groups.Reset();
+}
+
+// Wait for any evaluation still running, as it reads the snapshot this owns
+FStructuralStress::~FStructuralStress()
+{
+	WaitForEvaluation();
+}
+
+// Publish the stress of the last evaluation once it has finished, breaking the most stressed link of every group over the break load, then start evaluating the next groups that need it
+void FStructuralStress::Update(UBuildSystemSubsystem& BuildSystem)
+{
+	// Nothing is kept once the model is turned off, so turning it back on evaluates every group again
+	if (!CVarStructuralStress.GetValueOnGameThread()) {
+		if (Task.IsValid() || PublishedStress.Num() > 0 || !bEvaluateAll) {
+			Reset();
+		}
+		BuildSystem.GetPartRegistry().DirtyGroupIds.Reset();
+		return;
+	}
+
+	if (bHasResult && Task.IsCompleted()) {
+		Apply(BuildSystem);
+	}
+
+	// Only one evaluation runs at a time, so the next one starts on the frame the last one is published
+	if (!IsBusy() && !bHasResult && Capture(BuildSystem)) {
+		const float LeverArm = CVarStructuralStressLeverArm.GetValueOnGameThread();
+		bHasResult = true;
+		Task = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, LeverArm]() {
+			Solve(Snapshot, LeverArm, LinkStress);
+		});
+	}
+}
+
+// Get the stress of a link from the last evaluation of its group, in kg of load, or 0 if it has not been evaluated or was broken by its stress
+float FStructuralStress::GetLinkStress(FConstraintLinkHandle Handle) const
+{
+	if (!PublishedStress.IsValidIndex(Handle.Index) || PublishedStress[Handle.Index].Generation != Handle.Generation) return 0.f;
+	return PublishedStress[Handle.Index].Stress;
+}
+
+// Wait for the evaluation in flight to finish, for tests and benchmarks that need its result straight away
+void FStructuralStress::WaitForEvaluation() const
+{
+	if (Task.IsValid()) {
+		Task.Wait();
+	}
+}
+
+// Drop every published stress and start over, waiting for any evaluation still running
+void FStructuralStress::Reset()
+{
+	WaitForEvaluation();
+	Task = UE::Tasks::FTask();
+	bHasResult = false;
+
+	Snapshot.Reset();
+	LinkStress.Reset();
+	PublishedStress.Reset();
+	PendingGroupIds.Reset();
+	bEvaluateAll = true;
+	LastGroupId = INDEX_NONE;
+}
+
+// Get the memory allocated by the snapshot, results and published stress
+SIZE_T FStructuralStress::GetAllocatedSize() const
+{
+	return Snapshot.GetAllocatedSize() + LinkStress.GetAllocatedSize() + PublishedStress.GetAllocatedSize() + PendingGroupIds.GetAllocatedSize()
+		+ GroupStates.GetAllocatedSize() + DirtyGroupIds.GetAllocatedSize() + SnapshotIndices.GetAllocatedSize();
+}
+
+// Work out the stress of every link in a snapshot, where a part's load reaches a support through the fewest links and links not on any part's path carry none. Safe to call from any thread
+void FStructuralStress::Solve(const FStressSnapshot& Snapshot, float LeverArm, TArray<float>& OutLinkStress)
+{
+	SCOPE_CYCLE_COUNTER(STAT_BuildSystem_SolveStructuralStress);
+
+	OutLinkStress.Reset();
+	OutLinkStress.SetNumZeroed(Snapshot.Links.Num());
+	const double InvLeverArm = LeverArm > 0.f ? 1.0 / LeverArm : 0.0;
+
+	// Parts not reached from a support yet, as opposed to supports, which have no link to pass their load down
+	const int32 Unreached = INDEX_NONE - 1;
+
+	// Scratch space for a group at a time, which only grows to the size of the largest group
+	TArray<int32> FirstAdjacent, NextAdjacent, AdjacentLinks, ParentLinks, Order;
+	TArray<double> Loads;
+	TArray<FVector2D> Moments;
+
+	for (const FStressSnapshot::FGroup& Group : Snapshot.Groups) {
+		const int32 NumParts = Group.NumParts;
+		const int32 LastLink = Group.FirstLink + Group.NumLinks;
+
+		// Lay out the links of each part one after another, so following them is a walk over a single array
+		FirstAdjacent.Reset();
+		FirstAdjacent.SetNumZeroed(NumParts + 1);
+		for (int32 LinkIndex = Group.FirstLink; LinkIndex < LastLink; ++LinkIndex) {
+			++FirstAdjacent[Snapshot.Links[LinkIndex].PartA - Group.FirstPart + 1];
+			++FirstAdjacent[Snapshot.Links[LinkIndex].PartB - Group.FirstPart + 1];
+		}
+
+		for (int32 Part = 0; Part < NumParts; ++Part) {
+			FirstAdjacent[Part + 1] += FirstAdjacent[Part];
+		}
+
+		NextAdjacent = FirstAdjacent;
+		AdjacentLinks.SetNumUninitialized(FirstAdjacent[NumParts], EAllowShrinking::No);
+		for (int32 LinkIndex = Group.FirstLink; LinkIndex < LastLink; ++LinkIndex) {
+			AdjacentLinks[NextAdjacent[Snapshot.Links[LinkIndex].PartA - Group.FirstPart]++] = LinkIndex;
+			AdjacentLinks[NextAdjacent[Snapshot.Links[LinkIndex].PartB - Group.FirstPart]++] = LinkIndex;
+		}
+
+		// Search outwards from every support at once, so each part's load takes the fewest links down to its closest support
+		ParentLinks.Init(Unreached, NumParts);
+		Order.Reset();
+		for (int32 Part = 0; Part < NumParts; ++Part) {
+			if (Snapshot.Parts[Group.FirstPart + Part].bSupported) {
+				ParentLinks[Part] = INDEX_NONE;
+				Order.Add(Part);
+			}
+		}
+
+		// A group with nothing under it is falling or held, so its links carry nothing
+		if (Order.Num() == 0) continue;
+
+		for (int32 Head = 0; Head < Order.Num(); ++Head) {
+			const int32 Part = Order[Head];
+			for (int32 Adjacent = FirstAdjacent[Part]; Adjacent < FirstAdjacent[Part + 1]; ++Adjacent) {
+				const FStressSnapshot::FLink& Link = Snapshot.Links[AdjacentLinks[Adjacent]];
+				const int32 Other = (Link.PartA - Group.FirstPart == Part ? Link.PartB : Link.PartA) - Group.FirstPart;
+				if (ParentLinks[Other] == Unreached) {
+					ParentLinks[Other] = AdjacentLinks[Adjacent];
+					Order.Add(Other);
+				}
+			}
+		}
+
+		// Every part starts with its own weight, and the weight of its horizontal position for the moment about the link below it
+		Loads.SetNumUninitialized(NumParts, EAllowShrinking::No);
+		Moments.SetNumUninitialized(NumParts, EAllowShrinking::No);
+		for (int32 Part = 0; Part < NumParts; ++Part) {
+			const FStressSnapshot::FPart& SnapshotPart = Snapshot.Parts[Group.FirstPart + Part];
+			Loads[Part] = SnapshotPart.Mass;
+			Moments[Part] = FVector2D(SnapshotPart.Location) * SnapshotPart.Mass;
+		}
+
+		// Pass loads down from the parts furthest from a support, so every part has gathered everything resting on it before passing it on
+		for (int32 OrderIndex = Order.Num() - 1; OrderIndex >= 0; --OrderIndex) {
+			const int32 Part = Order[OrderIndex];
+			const int32 LinkIndex = ParentLinks[Part];
+			if (LinkIndex == INDEX_NONE) continue;
+
+			const FStressSnapshot::FLink& Link = Snapshot.Links[LinkIndex];
+			const int32 Parent = (Link.PartA - Group.FirstPart == Part ? Link.PartB : Link.PartA) - Group.FirstPart;
+			const FVector2D ParentLocation(Snapshot.Parts[Group.FirstPart + Parent].Location);
+
+			// The link carries the load beyond it, plus the bending moment of that load about the part below
+			const double Bending = (Moments[Part] - ParentLocation * Loads[Part]).Size();
+			OutLinkStress[LinkIndex] = (float)(Loads[Part] + Bending * InvLeverArm);
+
+			Loads[Parent] += Loads[Part];
+			Moments[Parent] += Moments[Part];
+		}
+	}
+}
+
+// Publish the stress of the finished evaluation and break overloaded links
+void FStructuralStress::Apply(UBuildSystemSubsystem& BuildSystem)
+{
+	LLM_SCOPE_BYTAG(BuildSystem);
+	bHasResult = false;
+
+	const FConstraintLinkTable& LinkTable = BuildSystem.GetLinkTable();
+	const FPartRegistry& Registry = BuildSystem.GetPartRegistry();
+	const float BreakLoad = CVarStructuralStressBreakLoad.GetValueOnGameThread();
+
+	// Groups held or being fused with, found from the sessions rather than the parts
+	TArray<int32, TInlineAllocator<16>> LockedGroupIds;
+	BuildSystem.GetLockedGroupIds(nullptr, LockedGroupIds);
+
+	TArray<TPair<AMoveableObject*, FConstraintLinkHandle>, TInlineAllocator<16>> OverloadedLinks;
+	for (const FStressSnapshot::FGroup& Group : Snapshot.Groups) {
+		int32 MostStressedLink = INDEX_NONE;
+		for (int32 LinkIndex = Group.FirstLink; LinkIndex < Group.FirstLink + Group.NumLinks; ++LinkIndex) {
+			// Links removed since the snapshot are skipped, as their slot may already hold a new link
+			const FConstraintLinkHandle Handle = Snapshot.Links[LinkIndex].Handle;
+			if (!LinkTable.Find(Handle)) continue;
+
+			if (!PublishedStress.IsValidIndex(Handle.Index)) {
+				PublishedStress.SetNum(Handle.Index + 1);
+			}
+			PublishedStress[Handle.Index] = { Handle.Generation, LinkStress[LinkIndex] };
+
+			if (MostStressedLink == INDEX_NONE || LinkStress[LinkIndex] > LinkStress[MostStressedLink]) {
+				MostStressedLink = LinkIndex;
+			}
+		}
+
+		// Only the most stressed link of a group breaks, as the load on the rest changes once it has. What is left is evaluated again as it falls
+		if (BreakLoad <= 0.f || MostStressedLink == INDEX_NONE || LinkStress[MostStressedLink] <= BreakLoad) continue;
+
+		// Groups grabbed, fused with or frozen since the snapshot was taken are left alone
+		const FConstraintLinkHandle Handle = Snapshot.Links[MostStressedLink].Handle;
+		AMoveableObject* Part = LinkTable.Find(Handle)->ComponentA;
+		const int32 PartIndex = Registry.GetIndex(Part);
+		if (PartIndex == INDEX_NONE || LockedGroupIds.Contains(Registry.GroupIds[PartIndex]) || EnumHasAnyFlags(Registry.Flags[PartIndex], EPartFlags::Frozen)) continue;
+
+		OverloadedLinks.Add({ Part, Handle });
+	}
+
+	// Links are only broken once every stress has been published, as breaking a link rebuilds its group. A broken link carries nothing
+	for (const TPair<AMoveableObject*, FConstraintLinkHandle>& Overloaded : OverloadedLinks) {
+		if (Overloaded.Key->BreakLink(Overloaded.Value)) {
+			PublishedStress[Overloaded.Value.Index].Stress = 0.f;
+		}
+	}
+}
+
+// Gather the size of every group waiting to be evaluated and whether it is awake, held, fusing or frozen from the part registry
+void FStructuralStress::GatherGroupStates(const UBuildSystemSubsystem& BuildSystem)
+{
+	LLM_SCOPE_BYTAG(BuildSystem);
+
+	const FPartRegistry& Registry = BuildSystem.GetPartRegistry();
+	GroupStates.Reset();
+	for (int32 GroupId : PendingGroupIds) {
+		GroupStates.Add(GroupId);
+	}
+
+	for (int32 Index = 0; Index < Registry.Num(); ++Index) {
+		FGroupState* FoundState = GroupStates.Find(Registry.GroupIds[Index]);
+		if (!FoundState) continue;
+
+		FGroupState& State = *FoundState;
+		++State.NumParts;
+		State.bAwake |= !EnumHasAnyFlags(Registry.Flags[Index], EPartFlags::Asleep);
+		State.bLocked |= EnumHasAnyFlags(Registry.Flags[Index], EPartFlags::Grabbed | EPartFlags::Fusing | EPartFlags::Frozen);
+	}
+
+	// Groups being fused with are locked too, as the fuse is about to change them
+	TArray<int32, TInlineAllocator<16>> LockedGroupIds;
+	BuildSystem.GetLockedGroupIds(nullptr, LockedGroupIds);
+	for (int32 GroupId : LockedGroupIds) {
+		if (FGroupState* State = GroupStates.Find(GroupId)) {
+			State->bLocked = true;
+		}
+	}
+}
+
+// Snapshot the groups that need evaluating, returning false if none do
+bool FStructuralStress::Capture(UBuildSystemSubsystem& BuildSystem)
+{
+	SCOPE_CYCLE_COUNTER(STAT_BuildSystem_CaptureStructuralStress);
+	LLM_SCOPE_BYTAG(BuildSystem);
+
+	// Take the groups that have changed since the last snapshot, or every group when starting over
+	FPartRegistry& Registry = BuildSystem.GetPartRegistry();
+	if (bEvaluateAll) {
+		for (int32 GroupId : Registry.GroupIds) {
+			PendingGroupIds.Add(GroupId);
+		}
+		bEvaluateAll = false;
+	}
+	PendingGroupIds.Append(Registry.DirtyGroupIds);
+	Registry.DirtyGroupIds.Reset();
+
+	// While no group has changed and none is awake, no part is looked at
+	Snapshot.Reset();
+	if (PendingGroupIds.Num() == 0) return false;
+
+	GatherGroupStates(BuildSystem);
+
+	// Groups that no longer exist or have nothing to link are dropped, such as ones merged or split since they changed. Held and frozen groups wait until they are let go
+	DirtyGroupIds.Reset();
+	for (TSet<int32>::TIterator It = PendingGroupIds.CreateIterator(); It; ++It) {
+		const FGroupState& State = GroupStates.FindChecked(*It);
+		if (State.NumParts < 2) {
+			It.RemoveCurrent();
+		}
+
+		else if (!State.bLocked) {
+			DirtyGroupIds.Add(*It);
+		}
+	}
+	if (DirtyGroupIds.Num() == 0) return false;
+
+	// Groups are taken in turn from the one after the last evaluated, and the first is always taken so a group bigger than the budget is still evaluated
+	DirtyGroupIds.Sort();
+	const int32 FirstDirty = Algo::UpperBound(DirtyGroupIds, LastGroupId) % DirtyGroupIds.Num();
+	const int32 MaxParts = CVarStructuralStressMaxParts.GetValueOnGameThread();
+	int32 NumParts = 0;
+
+	for (int32 Offset = 0; Offset < DirtyGroupIds.Num(); ++Offset) {
+		const int32 GroupId = DirtyGroupIds[(FirstDirty + Offset) % DirtyGroupIds.Num()];
+		FGroupState& State = GroupStates.FindChecked(GroupId);
+		if (Snapshot.Groups.Num() > 0 && NumParts + State.NumParts > MaxParts) break;
+
+		State.SnapshotGroup = Snapshot.Groups.Num();
+		FStressSnapshot::FGroup& Group = Snapshot.Groups.AddDefaulted_GetRef();
+		Group.GroupId = GroupId;
+		Group.FirstPart = NumParts;
+
+		NumParts += State.NumParts;
+		LastGroupId = GroupId;
+
+		// An awake group's supports may still move, so it waits to be evaluated again until it has been evaluated asleep
+		if (!State.bAwake) {
+			PendingGroupIds.Remove(GroupId);
+		}
+	}
+
+	// Copy every part of the groups taken, tracing down from any that are not held in place to find what is resting on the world
+	UWorld* World = BuildSystem.GetWorld();
+	const float SupportDistance = CVarStructuralStressSupportDistance.GetValueOnGameThread();
+	const FCollisionObjectQueryParams SupportObjectParams(ECC_WorldStatic);
+	int32 NumTraces = 0;
+
+	Snapshot.Parts.SetNum(NumParts);
+	SnapshotIndices.Reset();
+	for (int32 Index = 0; Index < Registry.Num(); ++Index) {
+		const FGroupState* State = GroupStates.Find(Registry.GroupIds[Index]);
+		if (!State || State->SnapshotGroup == INDEX_NONE) continue;
+
+		FStressSnapshot::FGroup& Group = Snapshot.Groups[State->SnapshotGroup];
+		const int32 PartIndex = Group.FirstPart + Group.NumParts++;
+		AMoveableObject* Part = Registry.Parts[Index];
+
+		FStressSnapshot::FPart& SnapshotPart = Snapshot.Parts[PartIndex];
+		SnapshotPart.Part = Part;
+		SnapshotPart.Location = Registry.Locations[Index];
+		SnapshotPart.Mass = Part->MeshComponent->GetMass();
+		SnapshotPart.bSupported = !Part->MeshComponent->IsSimulatingPhysics();
+
+		if (!SnapshotPart.bSupported && World) {
+			const FBox& Bounds = Registry.Bounds[Index];
+			const FVector Center = Bounds.GetCenter();
+			const FCollisionQueryParams SupportQueryParams(SCENE_QUERY_STAT(StructuralStressSupport), false, Part);
+			SnapshotPart.bSupported = World->LineTraceTestByObjectType(Center, FVector(Center.X, Center.Y, Bounds.Min.Z - SupportDistance), SupportObjectParams, SupportQueryParams);
+			++NumTraces;
+		}
+
+		SnapshotIndices.Add(Part, PartIndex);
+	}
+
+	// Copy every link between parts of the same group once, from the part that comes first in the snapshot
+	const FConstraintLinkTable& LinkTable = BuildSystem.GetLinkTable();
+	for (FStressSnapshot::FGroup& Group : Snapshot.Groups) {
+		Group.FirstLink = Snapshot.Links.Num();
+		for (int32 PartIndex = Group.FirstPart; PartIndex < Group.FirstPart + Group.NumParts; ++PartIndex) {
+			LinkTable.ForEachObjectLink(Snapshot.Parts[PartIndex].Part, [this, &Group, PartIndex](FConstraintLinkHandle Handle, const FPhysicsConstraintLink& Link) {
+				const int32* PartA = SnapshotIndices.Find(Link.ComponentA);
+				const int32* PartB = SnapshotIndices.Find(Link.ComponentB);
+				if (!PartA || !PartB || FMath::Min(*PartA, *PartB) != PartIndex || FMath::Max(*PartA, *PartB) >= Group.FirstPart + Group.NumParts) return;
+
+				Snapshot.Links.Add({ Handle, *PartA, *PartB });
+			});
+		}
+		Group.NumLinks = Snapshot.Links.Num() - Group.FirstLink;
+	}
+
+	INC_DWORD_STAT_BY(STAT_BuildSystem_TracesIssued, NumTraces);
+	SET_DWORD_STAT(STAT_BuildSystem_StressParts, NumParts);
+	return true;
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Engine/StaticMesh.h"
+#include "Components/BoxComponent.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformTLS.h"
+#include "MoveableObject.h"
+#include "BuildSystemSubsystem.h"
+
+// Helpers shared by build system tests and benchmarks that need a running world
+namespace BuildSystemTest
+{
+	// Malloc that forwards to the engine allocator while counting allocations made on a single thread
+	class FAllocationCountingMalloc final : public FMalloc
+	{
+	public:
+		// Start counting allocations made on the given thread
+		void Start(FMalloc* InInnerMalloc, uint32 InThreadId)
+		{
+			InnerMalloc = InInnerMalloc;
+			ThreadId = InThreadId;
+			NumAllocations = 0;
+		}
+
+		int32 GetNumAllocations() const { return NumAllocations; }
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return InnerMalloc->Malloc(Count, Alignment);
+		}
+
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return InnerMalloc->TryMalloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			// Reallocating to zero is a free, anything else may allocate
+			if (Count > 0) {
+				CountAllocation();
+			}
+			return InnerMalloc->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (Count > 0) {
+				CountAllocation();
+			}
+			return InnerMalloc->TryRealloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override { InnerMalloc->Free(Original); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return InnerMalloc->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return InnerMalloc->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { InnerMalloc->Trim(bTrimThreadCaches); }
+		virtual bool IsInternallyThreadSafe() const override { return InnerMalloc->IsInternallyThreadSafe(); }
+		virtual const TCHAR* GetDescriptiveName() override { return TEXT("BuildSystemAllocationCounter"); }
+
+	private:
+		// Only count allocations from the thread being measured, other engine threads keep allocating in the background
+		void CountAllocation()
+		{
+			if (FPlatformTLS::GetCurrentThreadId() == ThreadId) {
+				++NumAllocations;
+			}
+		}
+
+		FMalloc* InnerMalloc = nullptr;
+		uint32 ThreadId = 0;
+		int32 NumAllocations = 0;
+	};
+
+	// Count every heap allocation made on the current thread while in scope
+	class FScopedAllocationCounter
+	{
+	public:
+		FScopedAllocationCounter()
+		{
+			// The counting malloc is never destroyed, as other threads may still be inside it after it has been swapped back out
+			static FAllocationCountingMalloc CountingMalloc;
+			Counter = &CountingMalloc;
+			Counter->Start(GMalloc, FPlatformTLS::GetCurrentThreadId());
+
+			PreviousMalloc = GMalloc;
+			GMalloc = Counter;
+		}
+
+		~FScopedAllocationCounter()
+		{
+			GMalloc = PreviousMalloc;
+		}
+
+		int32 GetNumAllocations() const { return Counter->GetNumAllocations(); }
+
+	private:
+		FAllocationCountingMalloc* Counter = nullptr;
+		FMalloc* PreviousMalloc = nullptr;
+	};
+
+	// A game world that can spawn moveable objects and be ticked from a test
+	class FTestWorld
+	{
+	public:
+		FTestWorld()
+		{
+			World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("BuildSystemTestWorld"));
+			FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+			WorldContext.SetCurrentWorld(World);
+
+			FURL URL;
+			World->InitializeActorsForPlay(URL);
+			World->BeginPlay();
+
+			CubeMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+		}
+
+		~FTestWorld()
+		{
+			GEngine->DestroyWorldContext(World);
+			World->DestroyWorld(false);
+		}
+
+		// Spawn a moveable object using the engine cube, with debug drawing disabled and a fuse box that generates overlaps
+		template<typename PartType = AMoveableObject>
+		PartType* SpawnPart(const FVector& Location, const FRotator& Rotation = FRotator::ZeroRotator, float FuseBoxExtent = 120.f)
+		{
+			PartType* Part = World->SpawnActor<PartType>(Location, Rotation);
+			if (!Part) return nullptr;
+
+			// Turn debug drawing off, which also stops the part ticking, to keep it out of measurements
+			Part->SetDebugMode(false);
+
+			Part->MeshComponent->SetStaticMesh(CubeMesh);
+			Part->MeshComponent->SetGenerateOverlapEvents(true);
+
+			if (UBoxComponent* FuseBox = Part->FindComponentByClass<UBoxComponent>()) {
+				FuseBox->SetBoxExtent(FVector(FuseBoxExtent));
+				FuseBox->SetCollisionProfileName(TEXT("OverlapAllDynamic"));
+				FuseBox->SetGenerateOverlapEvents(true);
+			}
+
+			return Part;
+		}
+
+		// Spawn a row of parts along the X axis
+		TArray<AMoveableObject*> SpawnRow(int32 NumParts, const FVector& Start, float Spacing = 100.f)
+		{
+			TArray<AMoveableObject*> Parts;
+			for (int32 i = 0; i < NumParts; ++i) {
+				Parts.Add(SpawnPart(Start + FVector(i * Spacing, 0.f, 0.f)));
+			}
+			return Parts;
+		}
+
+		// Put every part into the same fused object set and part registry group
+		static void FuseParts(const TArray<AMoveableObject*>& Parts)
+		{
+			if (Parts.Num() == 0) return;
+
+			UBuildSystemSubsystem* BuildSystem = Parts[0]->GetWorld()->GetSubsystem<UBuildSystemSubsystem>();
+			const int32 GroupId = BuildSystem ? BuildSystem->GetPartRegistry().NewGroupId() : INDEX_NONE;
+
+			TSet<AMoveableObject*> Group(Parts);
+			for (AMoveableObject* Part : Parts) {
+				Part->FusedObjects = Group;
+
+				if (BuildSystem) {
+					BuildSystem->GetPartRegistry().SetGroupId(Part, GroupId);
+				}
+			}
+		}
+
+		// Tick the world for a number of frames
+		void Tick(int32 NumFrames = 1, float DeltaTime = 1.f / 60.f)
+		{
+			for (int32 Frame = 0; Frame < NumFrames; ++Frame) {
+				World->Tick(LEVELTICK_All, DeltaTime);
+			}
+		}
+
+		UWorld* World = nullptr;
+		UStaticMesh* CubeMesh = nullptr;
+	};
+}
@@ -0,0 +1,143 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// To run tests, enter console command - Automation RunTests GrabSystem.AsyncSnapResolution
+// To run the benchmark, enter console command - Automation RunTests GrabSystem.Perf.AsyncSnapResolution
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/IConsoleManager.h"
+#include "Tests/BuildSystemTestHelpers.h"
+#include "MoveableObjectInterface.h"
+#include "BuildSystemSubsystem.h"
+#include "AsyncSnapResolver.h"
+
+namespace
+{
+	// Switch between resolving snap points on the game thread and on a worker thread
+	void SetAsyncSnapResolution(bool bAsync)
+	{
+		if (IConsoleVariable* AsyncSnapResolution = IConsoleManager::Get().FindConsoleVariable(TEXT("BuildSystem.AsyncSnapResolution"))) {
+			AsyncSnapResolution->Set(bAsync, ECVF_SetByCode);
+		}
+	}
+
+	// Spawn a held group hovering next to a second group, close enough for the fuse boxes to overlap, and grab the held group
+	AMoveableObject* SetupHover(BuildSystemTest::FTestWorld& TestWorld, int32 NumParts)
+	{
+		TArray<AMoveableObject*> HeldGroup = TestWorld.SpawnRow(NumParts, FVector(0.f, 0.f, 500.f));
+		TArray<AMoveableObject*> NearbyGroup = TestWorld.SpawnRow(NumParts, FVector(0.f, 150.f, 500.f));
+		if (HeldGroup.Contains(nullptr) || NearbyGroup.Contains(nullptr)) return nullptr;
+
+		BuildSystemTest::FTestWorld::FuseParts(HeldGroup);
+		BuildSystemTest::FTestWorld::FuseParts(NearbyGroup);
+
+		// Hold the groups still so the snap points stay the same between ticks
+		for (AMoveableObject* Part : HeldGroup) {
+			Part->MeshComponent->SetSimulatePhysics(false);
+		}
+		for (AMoveableObject* Part : NearbyGroup) {
+			Part->MeshComponent->SetSimulatePhysics(false);
+		}
+
+		IMoveableObjectInterface::Execute_OnGrab(HeldGroup[0]);
+		return HeldGroup[0];
+	}
+}
+
+// Register the test
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAsyncSnapResolutionTest,
+	"GrabSystem.AsyncSnapResolution",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+	bool FAsyncSnapResolutionTest::RunTest(const FString& Parameters)
+{
+	BuildSystemTest::FTestWorld TestWorld;
+	AMoveableObject* Held = SetupHover(TestWorld, 1);
+	UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+	if (!TestNotNull(TEXT("Parts spawned"), Held) || !TestNotNull(TEXT("Build system subsystem exists"), BuildSystem)) {
+		return false;
+	}
+
+	// Resolve the snap points on the game thread
+	SetAsyncSnapResolution(false);
+	TestWorld.Tick(2);
+	FFuseSession* Session = BuildSystem->FindSession(Held);
+	if (!TestTrue(TEXT("Held object has found a nearby object"), Session && Session->ClosestNearbyMoveableObject)) {
+		SetAsyncSnapResolution(false);
+		return false;
+	}
+	const FVector SyncHeldSnapPoint = Session->HeldClosestSnapPoint;
+	const FVector SyncOtherSnapPoint = Session->OtherClosestSnapPoint;
+
+	// Test 1: Snap points resolved on a worker thread are picked up on a later frame and match the game thread's
+	{
+		// Clear the game thread's snap points so they can only come from the worker thread
+		Session->HeldClosestSnapPoint = FVector::ZeroVector;
+		Session->OtherClosestSnapPoint = FVector::ZeroVector;
+
+		// Launch the resolution, wait for it to finish, then pick it up on the next frame
+		SetAsyncSnapResolution(true);
+		TestWorld.Tick();
+		Session = BuildSystem->FindSession(Held);
+		for (int32 Wait = 0; Session && Session->SnapResolver && Session->SnapResolver->IsBusy() && Wait < 100; ++Wait) {
+			FPlatformProcess::Sleep(0.01f);
+		}
+		TestWorld.Tick();
+
+		Session = BuildSystem->FindSession(Held);
+		TestTrue(TEXT("Session has a snap resolver"), Session && Session->SnapResolver.IsValid());
+		TestTrue(TEXT("Held snap point matches the game thread"), Session && Session->HeldClosestSnapPoint.Equals(SyncHeldSnapPoint, 0.1));
+		TestTrue(TEXT("Other snap point matches the game thread"), Session && Session->OtherClosestSnapPoint.Equals(SyncOtherSnapPoint, 0.1));
+	}
+
+	// Test 2: Resolving from snapshots finds the closest points between two boxes
+	if (Session) {
+		FSnapPartSnapshot HeldSnapshot, NearbySnapshot;
+		HeldSnapshot.Capture(Held);
+		NearbySnapshot.Capture(Session->ClosestNearbyMoveableObject);
+
+		FSnapResolution Resolution;
+		FAsyncSnapResolver::Resolve(HeldSnapshot, NearbySnapshot, 60.f, Resolution);
+		TestTrue(TEXT("Resolution is for the snapshot objects"), Resolution.HeldObject == Held && Resolution.NearbyObject == Session->ClosestNearbyMoveableObject);
+		TestTrue(TEXT("Held collision point is on the face towards the nearby object"), FMath::IsNearlyEqual(Resolution.HeldLocalCollisionPoint.Y, 50.0, 0.1));
+		TestTrue(TEXT("Other collision point is on the face towards the held object"), FMath::IsNearlyEqual(Resolution.OtherLocalCollisionPoint.Y, -50.0, 0.1));
+	}
+
+	IMoveableObjectInterface::Execute_OnRelease(Held);
+	SetAsyncSnapResolution(false);
+	return true;
+}
+
+// Register the benchmark
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAsyncSnapResolutionPerfTest,
+	"GrabSystem.Perf.AsyncSnapResolution",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+	bool FAsyncSnapResolutionPerfTest::RunTest(const FString& Parameters)
+{
+	BuildSystemTest::FTestWorld TestWorld;
+	AMoveableObject* Held = SetupHover(TestWorld, 50);
+	UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+	if (!TestNotNull(TEXT("Parts spawned"), Held) || !TestNotNull(TEXT("Build system subsystem exists"), BuildSystem)) {
+		return false;
+	}
+
+	// Game thread time of a hover tick with snap points resolved on the game thread and on a worker thread, averaged over a number of ticks
+	const int32 NumTicks = 200;
+	for (bool bAsync : { false, true }) {
+		SetAsyncSnapResolution(bAsync);
+		TestWorld.Tick(5);
+
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumTicks; ++i) {
+			BuildSystem->Tick(1.f / 60.f);
+		}
+		const double Seconds = (FPlatformTime::Seconds() - StartTime) / NumTicks;
+
+		AddInfo(FString::Printf(TEXT("Hover tick with %s snap resolution: %.3f ms, %d frame latency"), bAsync ? TEXT("asynchronous") : TEXT("synchronous"), Seconds * 1000.0, bAsync ? 1 : 0));
+	}
+
+	IMoveableObjectInterface::Execute_OnRelease(Held);
+	SetAsyncSnapResolution(false);
+	return true;
+}
@@ -0,0 +1,160 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// To run tests, enter console command - Automation RunTests GrabSystem.BuilderBot
+// To run the benchmark, enter console command - Automation RunTests GrabSystem.Perf.BuilderBots
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Tests/BuildSystemTestHelpers.h"
+#include "MoveableObjectInterface.h"
+#include "BuildSystemSubsystem.h"
+#include "BuilderBot.h"
+
+namespace
+{
+	// Spawn a part that floats where it is put
+	AMoveableObject* SpawnFloatingPart(BuildSystemTest::FTestWorld& TestWorld, const FVector& Location)
+	{
+		AMoveableObject* Part = TestWorld.SpawnPart(Location);
+		if (Part) {
+			Part->MeshComponent->SetEnableGravity(false);
+		}
+		return Part;
+	}
+
+	// Spawn a bot that flies, as test worlds have no floor to walk on
+	ABuilderBot* SpawnBot(BuildSystemTest::FTestWorld& TestWorld, const FVector& Location, int32 Seed)
+	{
+		ABuilderBot* Bot = TestWorld.World->SpawnActor<ABuilderBot>(Location, FRotator::ZeroRotator);
+		if (Bot) {
+			Bot->SetRandomSeed(Seed);
+			Bot->GetCharacterMovement()->SetMovementMode(MOVE_Flying);
+		}
+		return Bot;
+	}
+
+	// Tick the world until a condition is met or a number of frames have passed, returning whether it was met
+	template<typename ConditionType>
+	bool TickUntil(BuildSystemTest::FTestWorld& TestWorld, int32 MaxFrames, ConditionType Condition)
+	{
+		for (int32 Frame = 0; Frame < MaxFrames && !Condition(); ++Frame) {
+			TestWorld.Tick();
+		}
+		return Condition();
+	}
+}
+
+// Register the test
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBuilderBotTest,
+	"GrabSystem.BuilderBot",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+	bool FBuilderBotTest::RunTest(const FString& Parameters)
+{
+	BuildSystemTest::FTestWorld TestWorld;
+	UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+	if (!TestNotNull(TEXT("Build system subsystem exists"), BuildSystem)) {
+		return false;
+	}
+
+	// A part just within reach of the bot and another to carry it to
+	AMoveableObject* PartA = SpawnFloatingPart(TestWorld, FVector(300.f, 0.f, 560.f));
+	AMoveableObject* PartB = SpawnFloatingPart(TestWorld, FVector(700.f, 300.f, 560.f));
+	ABuilderBot* Bot = SpawnBot(TestWorld, FVector(0.f, 0.f, 500.f), 1);
+	if (!TestTrue(TEXT("Parts and bot spawned"), PartA && PartB && Bot)) {
+		return false;
+	}
+
+	// Test 1: Parts held by another grabber are never picked
+	{
+		AActor* OtherGrabber = TestWorld.World->SpawnActor<AActor>();
+		IMoveableObjectInterface::Execute_OnGrab(PartA);
+		IMoveableObjectInterface::Execute_OnGrab(PartB);
+		BuildSystem->FindSession(PartA)->Grabber = OtherGrabber;
+		BuildSystem->FindSession(PartB)->Grabber = OtherGrabber;
+
+		TestWorld.Tick(30);
+		TestTrue(TEXT("Bot is still looking for a part"), Bot->GetState() == EBuilderBotState::FindPart);
+		TestEqual(TEXT("Bot has not grabbed anything"), Bot->GetNumGrabs(), 0);
+
+		IMoveableObjectInterface::Execute_OnRelease(PartA);
+		IMoveableObjectInterface::Execute_OnRelease(PartB);
+		TestWorld.Tick(120);
+	}
+
+	// Test 2: Once parts are free the bot walks up to one and grabs it through its grabber
+	{
+		TestTrue(TEXT("Bot grabs a part"), TickUntil(TestWorld, 600, [Bot]() { return Bot->GetNumGrabs() > 0; }));
+		TestTrue(TEXT("Bot is carrying the part"), Bot->GetState() == EBuilderBotState::CarryPart);
+		TestEqual(TEXT("Bot's grab started a session"), BuildSystem->GetNumSessions(), 1);
+	}
+
+	// Test 3: The bot lets go of the part it is carrying, and goes back to looking for another once the fuse has had time to finish
+	{
+		TestTrue(TEXT("Bot lets go of the part"), TickUntil(TestWorld, 1200, [Bot]() { return Bot->GetNumReleases() > 0; }));
+		TestTrue(TEXT("Bot looks for another part"), TickUntil(TestWorld, 600, [Bot]() { return Bot->GetState() != EBuilderBotState::Wait; }));
+	}
+
+	return true;
+}
+
+// Register the benchmark
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBuilderBotsPerfTest,
+	"GrabSystem.Perf.BuilderBots",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+	bool FBuilderBotsPerfTest::RunTest(const FString& Parameters)
+{
+	// A short soak of a 10 by 10 grid of parts, with more bots building out of it each run
+	const int32 GridSize = 10;
+	const int32 NumFrames = 1200;
+
+	for (int32 NumBots : { 1, 8, 32 }) {
+		BuildSystemTest::FTestWorld TestWorld;
+		UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+		if (!TestNotNull(TEXT("Build system subsystem exists"), BuildSystem)) {
+			return false;
+		}
+
+		for (int32 X = 0; X < GridSize; ++X) {
+			for (int32 Y = 0; Y < GridSize; ++Y) {
+				SpawnFloatingPart(TestWorld, FVector(X * 400.f, Y * 400.f, 500.f));
+			}
+		}
+
+		TArray<ABuilderBot*> Bots;
+		for (int32 i = 0; i < NumBots; ++i) {
+			Bots.Add(SpawnBot(TestWorld, FVector(i * 4000.f / NumBots, -600.f, 500.f), i + 1));
+		}
+		if (Bots.Contains(nullptr)) {
+			AddError(TEXT("Bots failed to spawn"));
+			return false;
+		}
+
+		double MaxFrameSeconds = 0.0;
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame) {
+			const double FrameStartTime = FPlatformTime::Seconds();
+			TestWorld.Tick();
+			MaxFrameSeconds = FMath::Max(MaxFrameSeconds, FPlatformTime::Seconds() - FrameStartTime);
+		}
+		const double Seconds = (FPlatformTime::Seconds() - StartTime) / NumFrames;
+
+		int32 NumGrabs = 0;
+		int32 NumReleases = 0;
+		for (const ABuilderBot* Bot : Bots) {
+			NumGrabs += Bot->GetNumGrabs();
+			NumReleases += Bot->GetNumReleases();
+		}
+
+		TSet<int32> GroupIds;
+		GroupIds.Append(BuildSystem->GetPartRegistry().GroupIds);
+
+		TestTrue(TEXT("Bots grabbed parts"), NumGrabs > 0);
+		AddInfo(FString::Printf(TEXT("%2d bots: tick %.3f ms (max %.3f ms) over %d frames, %d grabs, %d releases, %d parts in %d groups, %d links"),
+			NumBots, Seconds * 1000.0, MaxFrameSeconds * 1000.0, NumFrames, NumGrabs, NumReleases, BuildSystem->GetPartRegistry().Num(), GroupIds.Num(), BuildSystem->GetLinkTable().Num()));
+	}
+
+	return true;
+}
@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// To run tests, enter console command - Automation RunTests GrabSystem.CandidateSearch
+// To run the benchmark, enter console command - Automation RunTests GrabSystem.Perf.CandidateSearch
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Tests/BuildSystemTestHelpers.h"
+#include "BuildSystemSubsystem.h"
+#include "FuseCandidateSearch.h"
+
+namespace
+{
+	// Spawn a held row of parts hovering next to a second row, close enough for the fuse boxes to overlap, and gather the held row's candidates
+	AMoveableObject* SetupCandidateSearch(BuildSystemTest::FTestWorld& TestWorld, int32 NumParts, FFuseCandidateSearch& Search)
+	{
+		TArray<AMoveableObject*> HeldGroup = TestWorld.SpawnRow(NumParts, FVector(0.f, 0.f, 500.f));
+		TArray<AMoveableObject*> NearbyGroup = TestWorld.SpawnRow(NumParts, FVector(0.f, 150.f, 500.f));
+		if (HeldGroup.Contains(nullptr) || NearbyGroup.Contains(nullptr)) return nullptr;
+
+		BuildSystemTest::FTestWorld::FuseParts(HeldGroup);
+		BuildSystemTest::FTestWorld::FuseParts(NearbyGroup);
+
+		// Hold the rows still so overlaps stay the same between searches
+		for (AMoveableObject* Part : HeldGroup) {
+			Part->MeshComponent->SetSimulatePhysics(false);
+		}
+		for (AMoveableObject* Part : NearbyGroup) {
+			Part->MeshComponent->SetSimulatePhysics(false);
+		}
+		TestWorld.Tick();
+
+		UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+		BuildSystem->GetPartRegistry().Refresh();
+		Search.Gather(HeldGroup[0], BuildSystem->GetPartRegistry());
+		return HeldGroup[0];
+	}
+}
+
+// Register the test
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCandidateSearchTest,
+	"GrabSystem.CandidateSearch",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+	bool FCandidateSearchTest::RunTest(const FString& Parameters)
+{
+	BuildSystemTest::FTestWorld TestWorld;
+	FFuseCandidateSearch Search;
+	AMoveableObject* Held = SetupCandidateSearch(TestWorld, 128, Search);
+	if (!TestNotNull(TEXT("Parts spawned"), Held)) {
+		return false;
+	}
+
+	// Test 1: The search finds a candidate outside of the held group
+	const FFuseCandidate Serial = Search.Evaluate(TestWorld.World, 1);
+	TestEqual(TEXT("Every member is gathered"), Search.NumMembers(), 128);
+	TestNotNull(TEXT("A candidate is found"), Serial.Candidate);
+	TestTrue(TEXT("The candidate is not part of the held group"), Serial.Candidate && !Held->FusedObjects.Contains(Serial.Candidate));
+	TestTrue(TEXT("The fused object is part of the held group"), Held->FusedObjects.Contains(Serial.FusedObject));
+
+	// Test 2: Searching on any number of threads gives exactly the same result as searching on one
+	for (int32 NumWorkers : { 2, 4, 8, 16 }) {
+		const FFuseCandidate Parallel = Search.Evaluate(TestWorld.World, NumWorkers);
+		TestTrue(FString::Printf(TEXT("Same fused object on %d threads"), NumWorkers), Parallel.FusedObject == Serial.FusedObject);
+		TestTrue(FString::Printf(TEXT("Same candidate on %d threads"), NumWorkers), Parallel.Candidate == Serial.Candidate);
+		TestTrue(FString::Printf(TEXT("Same distance on %d threads"), NumWorkers), FMemory::Memcmp(&Parallel.Distance, &Serial.Distance, sizeof(float)) == 0);
+	}
+
+	return true;
+}
+
+// Register the benchmark
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCandidateSearchPerfTest,
+	"GrabSystem.Perf.CandidateSearch",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+	bool FCandidateSearchPerfTest::RunTest(const FString& Parameters)
+{
+	BuildSystemTest::FTestWorld TestWorld;
+	FFuseCandidateSearch Search;
+	if (!TestNotNull(TEXT("Parts spawned"), SetupCandidateSearch(TestWorld, 256, Search))) {
+		return false;
+	}
+
+	AddInfo(FString::Printf(TEXT("Task graph worker threads available: %d"), FTaskGraphInterface::Get().GetNumWorkerThreads()));
+
+	// Evaluating a 256 part group hovering next to another 256 part group, averaged over a number of searches
+	const int32 NumSearches = 100;
+	double SerialSeconds = 0.0;
+	for (int32 NumWorkers : { 1, 2, 4, 8, 16 }) {
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumSearches; ++i) {
+			Search.Evaluate(TestWorld.World, NumWorkers);
+		}
+		const double Seconds = (FPlatformTime::Seconds() - StartTime) / NumSearches;
+
+		if (NumWorkers == 1) {
+			SerialSeconds = Seconds;
+		}
+		AddInfo(FString::Printf(TEXT("Searching %d members on %d threads: %.3f ms (%.2fx)"), Search.NumMembers(), NumWorkers, Seconds * 1000.0, SerialSeconds / Seconds));
+	}
+
+	return true;
+}
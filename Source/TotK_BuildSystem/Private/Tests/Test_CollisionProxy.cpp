@@ -0,0 +1,164 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// To run tests, enter console command - Automation RunTests GrabSystem.CollisionProxy
+// To run the benchmark, enter console command - Automation RunTests GrabSystem.Perf.CollisionProxy
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "Tests/BuildSystemTestHelpers.h"
+#include "CollisionProxy.h"
+
+// Register the test
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCollisionProxyTest,
+	"GrabSystem.CollisionProxy",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+	bool FCollisionProxyTest::RunTest(const FString& Parameters)
+{
+	// Test 1: Box proxies clamp points onto the box and leave points inside alone
+	{
+		FCollisionProxy Box;
+		Box.Shape = ECollisionProxyShape::Box;
+		Box.Extent = FVector3f(50.f, 20.f, 10.f);
+
+		TestEqual(TEXT("Point outside a face"), Box.GetClosestLocalPoint(FVector3f(100.f, 0.f, 0.f)), FVector3f(50.f, 0.f, 0.f));
+		TestEqual(TEXT("Point outside a corner"), Box.GetClosestLocalPoint(FVector3f(100.f, 100.f, -100.f)), FVector3f(50.f, 20.f, -10.f));
+		TestEqual(TEXT("Point inside"), Box.GetClosestLocalPoint(FVector3f(10.f, 5.f, 0.f)), FVector3f(10.f, 5.f, 0.f));
+	}
+
+	// Test 2: Capsule proxies push points onto the rounded surface around the segment
+	{
+		FCollisionProxy Capsule;
+		Capsule.Shape = ECollisionProxyShape::Capsule;
+		Capsule.SegmentStart = FVector3f(-50.f, 0.f, 0.f);
+		Capsule.SegmentEnd = FVector3f(50.f, 0.f, 0.f);
+		Capsule.Radius = 10.f;
+
+		TestTrue(TEXT("Point beside the segment"), Capsule.GetClosestLocalPoint(FVector3f(20.f, 100.f, 0.f)).Equals(FVector3f(20.f, 10.f, 0.f), 0.001f));
+		TestTrue(TEXT("Point past the end cap"), Capsule.GetClosestLocalPoint(FVector3f(100.f, 0.f, 0.f)).Equals(FVector3f(60.f, 0.f, 0.f), 0.001f));
+		TestEqual(TEXT("Point inside"), Capsule.GetClosestLocalPoint(FVector3f(0.f, 5.f, 0.f)), FVector3f(0.f, 5.f, 0.f));
+	}
+
+	// Test 3: Hull proxies find the closest point on any face, and leave points inside alone
+	{
+		// A tetrahedron with its right angled corner at the origin
+		const FVector3f A(0.f, 0.f, 0.f), B(100.f, 0.f, 0.f), C(0.f, 100.f, 0.f), D(0.f, 0.f, 100.f);
+		FCollisionProxy Hull;
+		Hull.Shape = ECollisionProxyShape::Hull;
+		Hull.HullVertices = { A, B, C, A, B, D, A, C, D, B, C, D };
+		Hull.HullNormals = { FVector3f(0.f, 0.f, -1.f), FVector3f(0.f, -1.f, 0.f), FVector3f(-1.f, 0.f, 0.f), FVector3f(1.f, 1.f, 1.f).GetSafeNormal() };
+		Hull.HullStarts = { 0 };
+
+		TestTrue(TEXT("Point outside an axis face"), Hull.GetClosestLocalPoint(FVector3f(-50.f, 10.f, 10.f)).Equals(FVector3f(0.f, 10.f, 10.f), 0.001f));
+		TestTrue(TEXT("Point outside the slanted face"), Hull.GetClosestLocalPoint(FVector3f(100.f, 100.f, 100.f)).Equals(FVector3f(100.f / 3.f), 0.01f));
+		TestEqual(TEXT("Point inside"), Hull.GetClosestLocalPoint(FVector3f(10.f, 10.f, 10.f)), FVector3f(10.f, 10.f, 10.f));
+	}
+
+	// Test 4: Hull proxies made of several convex elements treat the inside of any of them as inside the proxy
+	{
+		// Two tetrahedra with their right angled corners 200 apart along X
+		const FVector3f Offset(200.f, 0.f, 0.f);
+		const FVector3f A(0.f, 0.f, 0.f), B(100.f, 0.f, 0.f), C(0.f, 100.f, 0.f), D(0.f, 0.f, 100.f);
+		const FVector3f Normals[] = { FVector3f(0.f, 0.f, -1.f), FVector3f(0.f, -1.f, 0.f), FVector3f(-1.f, 0.f, 0.f), FVector3f(1.f, 1.f, 1.f).GetSafeNormal() };
+		FCollisionProxy Hull;
+		Hull.Shape = ECollisionProxyShape::Hull;
+		Hull.HullVertices = { A, B, C, A, B, D, A, C, D, B, C, D, A + Offset, B + Offset, C + Offset, A + Offset, B + Offset, D + Offset, A + Offset, C + Offset, D + Offset, B + Offset, C + Offset, D + Offset };
+		Hull.HullNormals = { Normals[0], Normals[1], Normals[2], Normals[3], Normals[0], Normals[1], Normals[2], Normals[3] };
+		Hull.HullStarts = { 0, 4 };
+
+		TestEqual(TEXT("Point inside the second hull"), Hull.GetClosestLocalPoint(FVector3f(210.f, 10.f, 10.f)), FVector3f(210.f, 10.f, 10.f));
+		TestTrue(TEXT("Point between the hulls finds the closer hull"), Hull.GetClosestLocalPoint(FVector3f(190.f, 10.f, 10.f)).Equals(FVector3f(200.f, 10.f, 10.f), 0.001f));
+	}
+
+	// Test 5: Non-uniform scale is applied to the proxy, so the closest point is the closest in the world rather than in the unscaled part
+	{
+		const FVector3f A(0.f, 0.f, 0.f), B(100.f, 0.f, 0.f), C(0.f, 100.f, 0.f), D(0.f, 0.f, 100.f);
+		FCollisionProxy Hull;
+		Hull.Shape = ECollisionProxyShape::Hull;
+		Hull.HullVertices = { A, B, C, A, B, D, A, C, D, B, C, D };
+		Hull.HullNormals = { FVector3f(0.f, 0.f, -1.f), FVector3f(0.f, -1.f, 0.f), FVector3f(-1.f, 0.f, 0.f), FVector3f(1.f, 1.f, 1.f).GetSafeNormal() };
+		Hull.HullStarts = { 0 };
+
+		// Stretched to 400 along X, the slanted face is x / 400 + y / 100 + z / 100 = 1, and the point projects straight onto it
+		const FTransform PartTransform(FQuat::Identity, FVector::ZeroVector, FVector(4.f, 1.f, 1.f));
+		const FVector ClosestPoint = Hull.GetClosestPoint(PartTransform, FVector(400.f, 100.f, 100.f));
+		TestTrue(TEXT("Scaled hull closest point is on the scaled face"), ClosestPoint.Equals(FVector(12400.f / 33.f, 100.f / 33.f, 100.f / 33.f), 0.1));
+		TestEqual(TEXT("Point inside the scaled hull"), Hull.GetClosestPoint(PartTransform, FVector(200.f, 10.f, 10.f)), FVector(200.f, 10.f, 10.f));
+
+		// A capsule stretched along its segment reaches past the unscaled end cap
+		FCollisionProxy Capsule;
+		Capsule.Shape = ECollisionProxyShape::Capsule;
+		Capsule.SegmentStart = FVector3f(-50.f, 0.f, 0.f);
+		Capsule.SegmentEnd = FVector3f(50.f, 0.f, 0.f);
+		Capsule.Radius = 10.f;
+		TestTrue(TEXT("Scaled capsule end cap"), Capsule.GetClosestLocalPoint(FVector3f(300.f, 0.f, 0.f), FVector3f(2.f, 1.f, 1.f)).Equals(FVector3f(120.f, 0.f, 0.f), 0.001f));
+	}
+
+	// Test 6: Baked proxies of the engine cube match its collision
+	{
+		BuildSystemTest::FTestWorld TestWorld;
+		AMoveableObject* Part = TestWorld.SpawnPart(FVector(0.f, 0.f, 500.f));
+		if (!TestNotNull(TEXT("Part spawned"), Part)) {
+			return false;
+		}
+
+		TestTrue(TEXT("Cube proxy is a box the size of the cube"), Part->GetCollisionProxy()->Extent.Equals(FVector3f(50.f), 0.01f));
+
+		FVector PhysicsPoint;
+		const FVector QueryPoint(300.f, 40.f, 520.f);
+		Part->MeshComponent->GetClosestPointOnCollision(QueryPoint, PhysicsPoint);
+		TestTrue(TEXT("Proxy closest point matches the full collision"), Part->GetClosestPointOnProxy(QueryPoint).Equals(PhysicsPoint, 0.1));
+	}
+
+	return true;
+}
+
+// Register the benchmark
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCollisionProxyPerfTest,
+	"GrabSystem.Perf.CollisionProxy",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+	bool FCollisionProxyPerfTest::RunTest(const FString& Parameters)
+{
+	BuildSystemTest::FTestWorld TestWorld;
+	AMoveableObject* Part = TestWorld.SpawnPart(FVector(0.f, 0.f, 500.f));
+	if (!TestNotNull(TEXT("Part spawned"), Part)) {
+		return false;
+	}
+
+	// Query points scattered around the part, the same for every method
+	const int32 NumQueries = 10000;
+	TArray<FVector> QueryPoints;
+	FRandomStream Random(1234);
+	for (int32 i = 0; i < NumQueries; ++i) {
+		QueryPoints.Add(Part->GetActorLocation() + Random.GetUnitVector() * Random.FRandRange(0.f, 300.f));
+	}
+
+	// Full collision through physics
+	double PhysicsSum = 0.0;
+	const double PhysicsStartTime = FPlatformTime::Seconds();
+	for (const FVector& QueryPoint : QueryPoints) {
+		FVector ClosestPoint;
+		PhysicsSum += Part->MeshComponent->GetClosestPointOnCollision(QueryPoint, ClosestPoint);
+	}
+	const double PhysicsSeconds = FPlatformTime::Seconds() - PhysicsStartTime;
+	AddInfo(FString::Printf(TEXT("GetClosestPointOnCollision: %.1f ns per query"), PhysicsSeconds * 1e9 / NumQueries));
+
+	// Each proxy shape, baked from the same mesh
+	for (ECollisionProxyShape Shape : { ECollisionProxyShape::Box, ECollisionProxyShape::Capsule, ECollisionProxyShape::Hull }) {
+		const FCollisionProxy Proxy = FCollisionProxy::Bake(Part->MeshComponent->GetStaticMesh(), Shape);
+		const FTransform PartTransform = Part->MeshComponent->GetComponentTransform();
+
+		double ProxySum = 0.0;
+		const double ProxyStartTime = FPlatformTime::Seconds();
+		for (const FVector& QueryPoint : QueryPoints) {
+			ProxySum += FVector::Dist(QueryPoint, Proxy.GetClosestPoint(PartTransform, QueryPoint));
+		}
+		const double ProxySeconds = FPlatformTime::Seconds() - ProxyStartTime;
+
+		AddInfo(FString::Printf(TEXT("%s proxy: %.1f ns per query (%.1fx), mean distance error %.2f"), *UEnum::GetValueAsString(Shape), ProxySeconds * 1e9 / NumQueries,
+			PhysicsSeconds / FMath::Max(ProxySeconds, UE_SMALL_NUMBER), FMath::Abs(ProxySum - PhysicsSum) / NumQueries));
+	}
+
+	return true;
+}
@@ -0,0 +1,244 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// To run tests, enter console command - Automation RunTests GrabSystem.DeferredWork
+// To run the benchmark, enter console command - Automation RunTests GrabSystem.Perf.DeferredWork
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/IConsoleManager.h"
+#include "Tests/BuildSystemTestHelpers.h"
+#include "MoveableObjectInterface.h"
+#include "BuildSystemSubsystem.h"
+
+namespace
+{
+	// Set the per-frame budget of deferred work and the smallest group whose work is deferred
+	void SetDeferredWork(int32 BudgetMicroseconds, int32 MinParts)
+	{
+		if (IConsoleVariable* Budget = IConsoleManager::Get().FindConsoleVariable(TEXT("BuildSystem.DeferredWorkBudget"))) {
+			Budget->Set(BudgetMicroseconds, ECVF_SetByCode);
+		}
+
+		if (IConsoleVariable* DeferredMinParts = IConsoleManager::Get().FindConsoleVariable(TEXT("BuildSystem.DeferredWorkMinParts"))) {
+			DeferredMinParts->Set(MinParts, ECVF_SetByCode);
+		}
+	}
+
+	// Spawn a floating row of parts fused into a single group, with a link between each neighbouring pair
+	TArray<AMoveableObject*> SpawnLinkedRow(BuildSystemTest::FTestWorld& TestWorld, int32 NumParts, const FVector& Start)
+	{
+		TArray<AMoveableObject*> Parts = TestWorld.SpawnRow(NumParts, Start);
+		if (Parts.Contains(nullptr)) return Parts;
+
+		BuildSystemTest::FTestWorld::FuseParts(Parts);
+		for (AMoveableObject* Part : Parts) {
+			Part->MeshComponent->SetEnableGravity(false);
+		}
+
+		// Links only need their objects for the table, so no constraint components are created
+		FConstraintLinkTable& LinkTable = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>()->GetLinkTable();
+		for (int32 i = 1; i < Parts.Num(); ++i) {
+			LinkTable.Add(nullptr, Parts[i - 1], Parts[i]);
+		}
+		return Parts;
+	}
+
+	// Check that every part in a range of a row has exactly that range as its fused set, and shares one group id
+	bool IsExactGroup(const UBuildSystemSubsystem& BuildSystem, const TArray<AMoveableObject*>& Parts, int32 First, int32 Last)
+	{
+		const int32 GroupId = BuildSystem.GetPartRegistry().GetGroupId(Parts[First]);
+		for (int32 i = First; i <= Last; ++i) {
+			if (Parts[i]->FusedObjects.Num() != Last - First + 1 || !Parts[i]->FusedObjects.Contains(Parts[First]) || !Parts[i]->FusedObjects.Contains(Parts[Last])) return false;
+			if (BuildSystem.GetPartRegistry().GetGroupId(Parts[i]) != GroupId) return false;
+		}
+		return true;
+	}
+}
+
+// Register the test
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDeferredWorkTest,
+	"GrabSystem.DeferredWork",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+	bool FDeferredWorkTest::RunTest(const FString& Parameters)
+{
+	BuildSystemTest::FTestWorld TestWorld;
+	UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+	if (!TestNotNull(TEXT("Build system subsystem exists"), BuildSystem)) {
+		return false;
+	}
+
+	const FDeferredBuildWork& DeferredWork = BuildSystem->GetDeferredWork();
+
+	// Test 1: Splitting a small group is done straight away, the same as without deferred work
+	{
+		SetDeferredWork(500, 64);
+		TArray<AMoveableObject*> Parts = SpawnLinkedRow(TestWorld, 3, FVector(0.f, 0.f, 500.f));
+		if (!TestTrue(TEXT("Parts spawned"), !Parts.Contains(nullptr))) {
+			return false;
+		}
+
+		IMoveableObjectInterface::Execute_SplitMoveableObjects(Parts[1]);
+		TestEqual(TEXT("Nothing is queued for a small split"), DeferredWork.Num(), 0);
+		TestTrue(TEXT("Small split leaves three groups"), IsExactGroup(*BuildSystem, Parts, 0, 0) && IsExactGroup(*BuildSystem, Parts, 1, 1) && IsExactGroup(*BuildSystem, Parts, 2, 2));
+	}
+
+	// A tiny budget and minimum size, so splits of a 10 part row are queued and take several frames
+	SetDeferredWork(1, 4);
+	TArray<AMoveableObject*> Parts = SpawnLinkedRow(TestWorld, 10, FVector(0.f, 1000.f, 500.f));
+	if (!TestTrue(TEXT("Parts spawned"), !Parts.Contains(nullptr))) {
+		SetDeferredWork(500, 64);
+		return false;
+	}
+
+	// Test 2: A large split separates the split part straight away and queues the rest, which a query of the group finishes
+	{
+		const int32 GroupId = BuildSystem->GetPartRegistry().GetGroupId(Parts[0]);
+		IMoveableObjectInterface::Execute_SplitMoveableObjects(Parts[7]);
+
+		TestTrue(TEXT("Split part is its own group straight away"), IsExactGroup(*BuildSystem, Parts, 7, 7) && BuildSystem->GetPartRegistry().GetGroupId(Parts[7]) != GroupId);
+		TestEqual(TEXT("Rest of the split is queued"), DeferredWork.Num(), 1);
+		TestEqual(TEXT("Rest of the group keeps its set until it is rebuilt"), Parts[0]->FusedObjects.Num(), 9);
+
+		BuildSystem->FinishGroupWork(Parts[9]);
+		TestEqual(TEXT("Finishing the group empties the queue"), DeferredWork.Num(), 0);
+		TestTrue(TEXT("Parts before the split part form a group"), IsExactGroup(*BuildSystem, Parts, 0, 6));
+		TestTrue(TEXT("Parts after the split part form another group"), IsExactGroup(*BuildSystem, Parts, 8, 9));
+		TestNotEqual(TEXT("Groups left behind have different ids"), BuildSystem->GetPartRegistry().GetGroupId(Parts[0]), BuildSystem->GetPartRegistry().GetGroupId(Parts[8]));
+	}
+
+	// Test 3: Ticking the world finishes a queued split within the budget, a few steps every frame
+	{
+		IMoveableObjectInterface::Execute_SplitMoveableObjects(Parts[3]);
+		TestEqual(TEXT("Split is queued"), DeferredWork.Num(), 1);
+		TestEqual(TEXT("Every part left behind is still to be rebuilt"), DeferredWork.NumPartsLeft(), 6);
+
+		int32 NumFrames = 0;
+		for (; NumFrames < 200 && DeferredWork.Num() > 0; ++NumFrames) {
+			TestWorld.Tick();
+		}
+		TestEqual(TEXT("Split finishes over later frames"), DeferredWork.Num(), 0);
+		TestTrue(TEXT("Split leaves the parts on either side as groups"), IsExactGroup(*BuildSystem, Parts, 0, 2) && IsExactGroup(*BuildSystem, Parts, 4, 6));
+		AddInfo(FString::Printf(TEXT("Split of 6 parts finished over %d frames"), NumFrames));
+	}
+
+	// Groups of 2 parts or more are deferred from here on, as the groups left are small
+	SetDeferredWork(1, 2);
+
+	// Test 4: Only the newest highlight of a group is kept while it waits
+	{
+		BuildSystem->GetDeferredWork().Highlight(*BuildSystem, Parts[0], TestWorld.CubeMesh->GetMaterial(0));
+		BuildSystem->GetDeferredWork().Highlight(*BuildSystem, Parts[1], nullptr);
+		TestEqual(TEXT("Later highlight of the same group replaces the earlier one"), DeferredWork.Num(), 1);
+
+		TestWorld.Tick(60);
+		TestEqual(TEXT("Highlight finishes"), DeferredWork.Num(), 0);
+	}
+
+	// Test 5: Grabbing a part of a group with a queued split finishes the split first, so the whole group is picked up
+	{
+		IMoveableObjectInterface::Execute_SplitMoveableObjects(Parts[5]);
+		TestEqual(TEXT("Split is queued"), DeferredWork.Num(), 1);
+
+		IMoveableObjectInterface::Execute_OnGrab(Parts[4]);
+		TestEqual(TEXT("Grab finishes the queued split"), DeferredWork.Num(), 0);
+		TestTrue(TEXT("Grabbed group is exact"), IsExactGroup(*BuildSystem, Parts, 4, 4) && IsExactGroup(*BuildSystem, Parts, 6, 6));
+		IMoveableObjectInterface::Execute_OnRelease(Parts[4]);
+	}
+
+	// Test 6: Grabbing a part that a queued split has already given its new group id finishes the split, so none of its group is left with a stale set
+	{
+		TArray<AMoveableObject*> Row = SpawnLinkedRow(TestWorld, 6, FVector(0.f, 2000.f, 500.f));
+		if (!TestTrue(TEXT("Parts spawned"), !Row.Contains(nullptr))) {
+			SetDeferredWork(500, 64);
+			return false;
+		}
+
+		const FPartRegistry& Registry = BuildSystem->GetPartRegistry();
+		const int32 OldGroupId = Registry.GetGroupId(Row[1]);
+		IMoveableObjectInterface::Execute_SplitMoveableObjects(Row[0]);
+		TestEqual(TEXT("Split is queued"), DeferredWork.Num(), 1);
+
+		// Run the queue a step or so at a time until the group left behind is part way through being handed its new id
+		AMoveableObject* Rebuilt = nullptr;
+		bool bHalfRebuilt = false;
+		for (int32 Run = 0; Run < 100 && !bHalfRebuilt && DeferredWork.Num() > 0; ++Run) {
+			BuildSystem->GetDeferredWork().Run(*BuildSystem);
+
+			bool bAnyOld = false;
+			Rebuilt = nullptr;
+			for (int32 i = 1; i < Row.Num(); ++i) {
+				if (Registry.GetGroupId(Row[i]) == OldGroupId) {
+					bAnyOld = true;
+				}
+
+				else {
+					Rebuilt = Row[i];
+				}
+			}
+			bHalfRebuilt = bAnyOld && Rebuilt;
+		}
+
+		if (TestTrue(TEXT("Split stopped part way through handing out the new group"), bHalfRebuilt)) {
+			IMoveableObjectInterface::Execute_OnGrab(Rebuilt);
+			TestEqual(TEXT("Grab finishes the half done split"), DeferredWork.Num(), 0);
+			TestTrue(TEXT("Every member of the grabbed group has its whole set and id"), IsExactGroup(*BuildSystem, Row, 1, 5));
+			IMoveableObjectInterface::Execute_OnRelease(Rebuilt);
+		}
+	}
+
+	SetDeferredWork(500, 64);
+	return true;
+}
+
+// Register the benchmark
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDeferredWorkPerfTest,
+	"GrabSystem.Perf.DeferredWork",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+	bool FDeferredWorkPerfTest::RunTest(const FString& Parameters)
+{
+	// Split the middle part out of a 500 part row, once with all of the work done straight away and once spread over frames under the default budget
+	const int32 NumParts = 500;
+
+	for (int32 BudgetMicroseconds : { 0, 500 }) {
+		SetDeferredWork(BudgetMicroseconds, 64);
+
+		BuildSystemTest::FTestWorld TestWorld;
+		UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+		if (!TestNotNull(TEXT("Build system subsystem exists"), BuildSystem)) {
+			SetDeferredWork(500, 64);
+			return false;
+		}
+
+		TArray<AMoveableObject*> Parts = SpawnLinkedRow(TestWorld, NumParts, FVector(0.f, 0.f, 500.f));
+		if (Parts.Contains(nullptr)) {
+			AddError(TEXT("Parts failed to spawn"));
+			SetDeferredWork(500, 64);
+			return false;
+		}
+		TestWorld.Tick(10);
+
+		// The frame of the split is the split itself and that frame's tick, later frames only tick
+		double MaxFrameSeconds = 0.0;
+		int32 NumFrames = 0;
+		const double SplitStartTime = FPlatformTime::Seconds();
+		IMoveableObjectInterface::Execute_SplitMoveableObjects(Parts[NumParts / 2]);
+		const double SplitSeconds = FPlatformTime::Seconds() - SplitStartTime;
+
+		do {
+			const double FrameStartTime = FPlatformTime::Seconds();
+			TestWorld.Tick();
+			MaxFrameSeconds = FMath::Max(MaxFrameSeconds, FPlatformTime::Seconds() - FrameStartTime + (NumFrames == 0 ? SplitSeconds : 0.0));
+			++NumFrames;
+		} while (BuildSystem->GetDeferredWork().Num() > 0 && NumFrames < 1000);
+
+		TestEqual(TEXT("Split is finished"), BuildSystem->GetDeferredWork().Num(), 0);
+		TestTrue(TEXT("Split leaves two groups either side"), Parts[0]->FusedObjects.Num() == NumParts / 2 && Parts[NumParts - 1]->FusedObjects.Num() == NumParts - NumParts / 2 - 1);
+		AddInfo(FString::Printf(TEXT("Split of %d parts with a %d us budget: split call %.3f ms, worst frame %.3f ms, finished over %d frames"),
+			NumParts, BudgetMicroseconds, SplitSeconds * 1000.0, MaxFrameSeconds * 1000.0, NumFrames));
+	}
+
+	SetDeferredWork(500, 64);
+	return true;
+}
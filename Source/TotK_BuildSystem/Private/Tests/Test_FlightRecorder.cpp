@@ -0,0 +1,152 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// To run tests, enter console command - Automation RunTests GrabSystem.FlightRecorder
+// To run the benchmark, enter console command - Automation RunTests GrabSystem.Perf.FlightRecorder
+
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Tests/BuildSystemTestHelpers.h"
+#include "MoveableObjectInterface.h"
+#include "BuildSystemSubsystem.h"
+
+// Register the test
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFlightRecorderTest,
+	"GrabSystem.FlightRecorder",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+	bool FFlightRecorderTest::RunTest(const FString& Parameters)
+{
+	// A ring of four events, with six candidate decisions recorded into it
+	FFlightRecorder Recorder;
+	Recorder.Init(4);
+	for (int32 i = 0; i < 6; ++i) {
+		FFlightEvent Event;
+		Event.Type = EFlightEventType::Candidate;
+		Event.HeldObject = FName(TEXT("Held"), i);
+		Event.OtherObject = FName(TEXT("Other"));
+		Event.Count = i;
+		Event.Distance = i * 10.f;
+		Recorder.Record(Event);
+	}
+
+	// Test 1: The ring keeps the newest events once it wraps, oldest first
+	TArray<FFlightEvent> Events;
+	{
+		Recorder.GetEvents(Events);
+		TestEqual(TEXT("Ring is full"), Recorder.Num(), 4);
+		TestEqual(TEXT("Every recorded event is counted"), Recorder.GetNumRecorded(), (uint64)6);
+		TestEqual(TEXT("Oldest events are overwritten first"), Events[0].Count, 2);
+		TestEqual(TEXT("Newest event is last"), Events.Last().Count, 5);
+		TestTrue(TEXT("Events are stamped with the time they were recorded"), Events[0].Time > 0.0 && Events[0].Time <= Events.Last().Time);
+	}
+
+	// Test 2: A dump reads back exactly as it was recorded, and decodes to one line per event
+	const FString Filename = FPaths::CreateTempFilename(*FPaths::ProjectIntermediateDir(), TEXT("FlightRecorder"), TEXT(".flightrec"));
+	{
+		TestTrue(TEXT("Dump is written"), Recorder.SaveToFile(Filename));
+
+		TArray<FFlightEvent> LoadedEvents;
+		TestTrue(TEXT("Dump is read"), FFlightRecorder::LoadFromFile(Filename, LoadedEvents));
+		TestEqual(TEXT("Every event is kept"), LoadedEvents.Num(), Events.Num());
+		for (int32 i = 0; i < LoadedEvents.Num() && i < Events.Num(); ++i) {
+			TestEqual(TEXT("Object names are kept"), LoadedEvents[i].HeldObject, Events[i].HeldObject);
+			TestEqual(TEXT("Decisions are kept"), LoadedEvents[i].Count, Events[i].Count);
+			TestEqual(TEXT("Distances are kept"), LoadedEvents[i].Distance, Events[i].Distance);
+		}
+
+		TestEqual(TEXT("Every event is decoded"), FFlightRecorder::DecodeFile(Filename), Events.Num());
+		TArray<FString> Lines;
+		const FString TextFilename = FPaths::ChangeExtension(Filename, TEXT(".txt"));
+		FFileHelper::LoadFileToStringArray(Lines, *TextFilename);
+		TestEqual(TEXT("One line per event"), Lines.Num(), Events.Num());
+		TestTrue(TEXT("Lines name the objects"), Lines.Num() > 0 && Lines[0].Contains(Events[0].HeldObject.ToString()));
+
+		IFileManager::Get().Delete(*Filename);
+		IFileManager::Get().Delete(*TextFilename);
+	}
+
+	// Test 3: Files that are not dumps are rejected
+	{
+		TArray<FFlightEvent> LoadedEvents;
+		TestFalse(TEXT("Missing files are rejected"), FFlightRecorder::LoadFromFile(Filename, LoadedEvents));
+
+		TArray<uint8> Garbage = { 1, 2, 3, 4, 5, 6, 7, 8 };
+		FFileHelper::SaveArrayToFile(Garbage, *Filename);
+		TestFalse(TEXT("Data that is not a dump is rejected"), FFlightRecorder::LoadFromFile(Filename, LoadedEvents));
+		IFileManager::Get().Delete(*Filename);
+	}
+
+	// Test 4: Grabbing and splitting a group records the group it was and the groups it was split into
+	{
+		BuildSystemTest::FTestWorld TestWorld;
+		UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+		if (!TestNotNull(TEXT("Build system subsystem exists"), BuildSystem)) {
+			return false;
+		}
+
+		TArray<AMoveableObject*> Parts = TestWorld.SpawnRow(3, FVector(0.f, 0.f, 500.f));
+		if (!TestTrue(TEXT("Parts spawned"), !Parts.Contains(nullptr))) {
+			return false;
+		}
+
+		// Links only need their objects for the table, so no constraint components are created
+		BuildSystemTest::FTestWorld::FuseParts(Parts);
+		BuildSystem->GetLinkTable().Add(nullptr, Parts[0], Parts[1]);
+		BuildSystem->GetLinkTable().Add(nullptr, Parts[1], Parts[2]);
+		const int32 GroupId = BuildSystem->GetPartRegistry().GetGroupId(Parts[1]);
+
+		IMoveableObjectInterface::Execute_OnGrab(Parts[1]);
+		IMoveableObjectInterface::Execute_SplitMoveableObjects(Parts[1]);
+		IMoveableObjectInterface::Execute_OnRelease(Parts[1]);
+
+		BuildSystem->GetFlightRecorder().GetEvents(Events);
+		const FFlightEvent* Grab = Events.FindByPredicate([](const FFlightEvent& Event) { return Event.Type == EFlightEventType::Grab; });
+		const FFlightEvent* Split = Events.FindByPredicate([](const FFlightEvent& Event) { return Event.Type == EFlightEventType::Split; });
+		const int32 NumSplitGroups = Events.FilterByPredicate([](const FFlightEvent& Event) { return Event.Type == EFlightEventType::SplitGroup; }).Num();
+
+		TestTrue(TEXT("Grab is recorded with the size of the group"), Grab && Grab->HeldObject == Parts[1]->GetFName() && Grab->Count == Parts.Num());
+		TestTrue(TEXT("Split is recorded with the group it split"), Split && Split->HeldGroupId == GroupId && Split->Count == Parts.Num());
+		TestEqual(TEXT("Every group left by the split is recorded"), NumSplitGroups, Parts.Num());
+	}
+
+	return true;
+}
+
+// Register the benchmark
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFlightRecorderPerfTest,
+	"GrabSystem.Perf.FlightRecorder",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+	bool FFlightRecorderPerfTest::RunTest(const FString& Parameters)
+{
+	// Record far more decisions than the ring holds, so most of them overwrite older events
+	FFlightRecorder Recorder;
+	Recorder.Init(4096);
+
+	FFlightEvent Event;
+	Event.Type = EFlightEventType::Snap;
+	Event.HeldObject = FName(TEXT("Held"));
+	Event.OtherObject = FName(TEXT("Other"));
+
+	const int32 NumEvents = 1000000;
+	int32 NumAllocations = 0;
+	const double StartTime = FPlatformTime::Seconds();
+	{
+		BuildSystemTest::FScopedAllocationCounter AllocationCounter;
+		for (int32 i = 0; i < NumEvents; ++i) {
+			Event.Count = i;
+			Recorder.Record(Event);
+		}
+		NumAllocations = AllocationCounter.GetNumAllocations();
+	}
+	const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+	TestEqual(TEXT("Recording does not allocate"), NumAllocations, 0);
+	AddInfo(FString::Printf(TEXT("%d events recorded: %.1f ns per event, %d allocations, %.1f KiB ring"),
+		NumEvents, Seconds * 1e9 / NumEvents, NumAllocations, Recorder.GetAllocatedSize() / 1024.0));
+
+	return true;
+}
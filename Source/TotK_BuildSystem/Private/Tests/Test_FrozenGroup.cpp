@@ -0,0 +1,185 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// To run tests, enter console command - Automation RunTests GrabSystem.FrozenGroup
+// To run the benchmark, enter console command - Automation RunTests GrabSystem.Perf.FrozenGroup
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Tests/BuildSystemTestHelpers.h"
+#include "MoveableObjectInterface.h"
+#include "BuildSystemSubsystem.h"
+
+namespace
+{
+	// Spawn a row of parts fused into a single group, with a link between each neighbouring pair
+	TArray<AMoveableObject*> SpawnLinkedRow(BuildSystemTest::FTestWorld& TestWorld, int32 NumParts, const FVector& Start)
+	{
+		TArray<AMoveableObject*> Parts = TestWorld.SpawnRow(NumParts, Start);
+		if (Parts.Contains(nullptr)) return Parts;
+
+		BuildSystemTest::FTestWorld::FuseParts(Parts);
+		for (AMoveableObject* Part : Parts) {
+			Part->MeshComponent->SetEnableGravity(false);
+		}
+
+		// Links only need their objects for the table, unfreezing gives every link without a constraint a new one
+		FConstraintLinkTable& LinkTable = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>()->GetLinkTable();
+		for (int32 i = 1; i < Parts.Num(); ++i) {
+			LinkTable.Add(nullptr, Parts[i - 1], Parts[i]);
+		}
+		return Parts;
+	}
+
+	// Count the links in a table that have a constraint component
+	int32 NumConstrainedLinks(const FConstraintLinkTable& LinkTable)
+	{
+		int32 NumConstrained = 0;
+		LinkTable.ForEachLink([&NumConstrained](FConstraintLinkHandle, const FPhysicsConstraintLink& Link) {
+			NumConstrained += Link.Constraint ? 1 : 0;
+		});
+		return NumConstrained;
+	}
+
+	// Count the primitive components of a group that are simulating or drawn
+	void CountGroupComponents(const TArray<AMoveableObject*>& Group, int32& OutNumBodies, int32& OutNumDrawn)
+	{
+		OutNumBodies = 0;
+		OutNumDrawn = 0;
+		for (AMoveableObject* Part : Group) {
+			TArray<UPrimitiveComponent*> Primitives;
+			Part->GetComponents<UPrimitiveComponent>(Primitives);
+			for (UPrimitiveComponent* Primitive : Primitives) {
+				OutNumBodies += Primitive->IsSimulatingPhysics() ? 1 : 0;
+				OutNumDrawn += Primitive->IsVisible() && Primitive->IsA<UStaticMeshComponent>() ? 1 : 0;
+			}
+		}
+	}
+}
+
+// Register the test
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFrozenGroupTest,
+	"GrabSystem.FrozenGroup",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+	bool FFrozenGroupTest::RunTest(const FString& Parameters)
+{
+	BuildSystemTest::FTestWorld TestWorld;
+	UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+	if (!TestNotNull(TEXT("Build system subsystem exists"), BuildSystem)) {
+		return false;
+	}
+
+	TArray<AMoveableObject*> Parts = SpawnLinkedRow(TestWorld, 4, FVector(0.f, 0.f, 500.f));
+	if (!TestTrue(TEXT("Parts spawned"), !Parts.Contains(nullptr))) {
+		return false;
+	}
+
+	AMoveableObject* Anchor = Parts[0];
+	FConstraintLinkTable& LinkTable = BuildSystem->GetLinkTable();
+
+	// Test 1: Freezing welds the group into the anchor's body and draws it through instances, keeping every link
+	{
+		TestTrue(TEXT("Group is frozen"), Anchor->FreezeGroup());
+		TestEqual(TEXT("One frozen group"), BuildSystem->GetNumFrozenGroups(), 1);
+		TestFalse(TEXT("A frozen group cannot be frozen again"), Parts[2]->FreezeGroup());
+
+		for (AMoveableObject* Part : Parts) {
+			TestTrue(TEXT("Every member is frozen"), Part->IsFrozen());
+			TestFalse(TEXT("Every member's own mesh is hidden"), Part->MeshComponent->IsVisible());
+			TestTrue(TEXT("Every member is still fused with the group"), Part->FusedObjects.Num() == Parts.Num());
+		}
+		for (int32 i = 1; i < Parts.Num(); ++i) {
+			TestFalse(TEXT("Welded members do not simulate on their own"), Parts[i]->MeshComponent->IsSimulatingPhysics());
+		}
+		TestTrue(TEXT("Anchor simulates the whole group"), Anchor->MeshComponent->IsSimulatingPhysics());
+
+		UInstancedStaticMeshComponent* Instances = Anchor->FindComponentByClass<UInstancedStaticMeshComponent>();
+		TestTrue(TEXT("Group is drawn through a single instanced mesh"), Instances && Instances->GetInstanceCount() == Parts.Num());
+		TestEqual(TEXT("Every link is kept"), LinkTable.Num(), Parts.Num() - 1);
+		TestEqual(TEXT("No constraints while frozen"), NumConstrainedLinks(LinkTable), 0);
+	}
+
+	// Test 2: A frozen group moves as a single body
+	{
+		const FVector Offset = Parts[3]->GetActorLocation() - Anchor->GetActorLocation();
+		Anchor->MeshComponent->SetPhysicsLinearVelocity(FVector(0.f, 0.f, 300.f));
+		TestWorld.Tick(10);
+
+		TestTrue(TEXT("Group moved"), Anchor->GetActorLocation().Z > 510.f);
+		TestTrue(TEXT("Members keep their place in the group"), (Parts[3]->GetActorLocation() - Anchor->GetActorLocation()).Equals(Offset, 0.1f));
+	}
+
+	// Test 3: Unfreezing gives every member its own body and every link its constraint back
+	{
+		Parts[2]->UnfreezeGroup();
+		TestEqual(TEXT("No frozen groups"), BuildSystem->GetNumFrozenGroups(), 0);
+
+		for (AMoveableObject* Part : Parts) {
+			TestFalse(TEXT("Every member is unfrozen"), Part->IsFrozen());
+			TestTrue(TEXT("Every member's own mesh is shown"), Part->MeshComponent->IsVisible());
+			TestTrue(TEXT("Every member simulates again"), Part->MeshComponent->IsSimulatingPhysics());
+			TestTrue(TEXT("Every member keeps its velocity"), Part->MeshComponent->GetPhysicsLinearVelocity().Z > 100.f);
+		}
+		TestNull(TEXT("Instances are removed"), Anchor->FindComponentByClass<UInstancedStaticMeshComponent>());
+		TestEqual(TEXT("Every link has a constraint"), NumConstrainedLinks(LinkTable), Parts.Num() - 1);
+	}
+
+	// Test 4: Grabbing a frozen group unfreezes it, and a held group cannot be frozen
+	{
+		TestTrue(TEXT("Group is frozen again"), Anchor->FreezeGroup());
+		IMoveableObjectInterface::Execute_OnGrab(Parts[3]);
+
+		TestFalse(TEXT("Grabbed group is unfrozen"), Parts[3]->IsFrozen());
+		TestFalse(TEXT("Held group cannot be frozen"), Anchor->FreezeGroup());
+
+		IMoveableObjectInterface::Execute_OnRelease(Parts[3]);
+	}
+
+	return true;
+}
+
+// Register the benchmark
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFrozenGroupPerfTest,
+	"GrabSystem.Perf.FrozenGroup",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+	bool FFrozenGroupPerfTest::RunTest(const FString& Parameters)
+{
+	BuildSystemTest::FTestWorld TestWorld;
+	UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+	if (!TestNotNull(TEXT("Build system subsystem exists"), BuildSystem)) {
+		return false;
+	}
+
+	// A 100 part bridge, given its constraints by freezing and unfreezing it once
+	TArray<AMoveableObject*> Parts = SpawnLinkedRow(TestWorld, 100, FVector(0.f, 0.f, 500.f));
+	if (!TestTrue(TEXT("Parts spawned"), !Parts.Contains(nullptr))) {
+		return false;
+	}
+	Parts[0]->FreezeGroup();
+	Parts[0]->UnfreezeGroup();
+
+	// Keep the bridge spinning so the solver has to work on it every frame
+	const int32 NumFrames = 60;
+	for (bool bFrozen : { false, true }) {
+		if (bFrozen) {
+			Parts[0]->FreezeGroup();
+		}
+		BuildSystem->WakeGroup(Parts[0]);
+		Parts[0]->MeshComponent->SetPhysicsAngularVelocityInDegrees(FVector(0.f, 0.f, 30.f));
+		TestWorld.Tick();
+
+		const double StartTime = FPlatformTime::Seconds();
+		TestWorld.Tick(NumFrames);
+		const double Seconds = (FPlatformTime::Seconds() - StartTime) / NumFrames;
+
+		int32 NumBodies = 0;
+		int32 NumDrawn = 0;
+		CountGroupComponents(Parts, NumBodies, NumDrawn);
+		AddInfo(FString::Printf(TEXT("%s: %d simulated bodies, %d constraints, %d drawn mesh components, world tick %.3f ms"),
+			bFrozen ? TEXT("Frozen") : TEXT("Constrained"), NumBodies, NumConstrainedLinks(BuildSystem->GetLinkTable()), NumDrawn, Seconds * 1000.0));
+	}
+
+	return true;
+}
@@ -0,0 +1,130 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// To run tests, enter console command - Automation RunTests GrabSystem.FuseStep
+
+#include "Misc/AutomationTest.h"
+#include "Tests/BuildSystemTestHelpers.h"
+#include "MoveableObjectInterface.h"
+#include "BuildSystemSubsystem.h"
+#include "BuildSystemMath.h"
+
+namespace
+{
+	// Result of fusing a held group onto a single part
+	struct FGroupFuseResult
+	{
+		int32 Frames = 0;
+		bool bCompleted = false;
+		bool bStayedRigid = false;
+		bool bFused = false;
+	};
+
+	// Spawn a floating row of parts fused into a single group, held together by a locked constraint between each neighbouring pair
+	TArray<AMoveableObject*> SpawnConstrainedRow(BuildSystemTest::FTestWorld& TestWorld, int32 NumParts, const FVector& Start)
+	{
+		TArray<AMoveableObject*> Parts = TestWorld.SpawnRow(NumParts, Start);
+		if (Parts.Contains(nullptr)) return Parts;
+
+		BuildSystemTest::FTestWorld::FuseParts(Parts);
+		for (AMoveableObject* Part : Parts) {
+			Part->MeshComponent->SetEnableGravity(false);
+		}
+
+		// Links are added without constraints, then freezing and unfreezing the group gives every link its constraint the same way a fuse does
+		FConstraintLinkTable& LinkTable = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>()->GetLinkTable();
+		for (int32 i = 1; i < Parts.Num(); ++i) {
+			LinkTable.Add(nullptr, Parts[i - 1], Parts[i]);
+		}
+
+		if (Parts[0]->FreezeGroup()) {
+			Parts[0]->UnfreezeGroup();
+		}
+		return Parts;
+	}
+
+	// Fuse a held row of the given size onto a single part through the fuse session, returning the number of frames until the fuse completes
+	// and whether every member kept its place relative to the held object the whole way
+	FGroupFuseResult SimulateGroupFuse(int32 GroupSize)
+	{
+		const int32 MaxFrames = 600;
+		FGroupFuseResult Result;
+
+		BuildSystemTest::FTestWorld TestWorld;
+		UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+		if (!BuildSystem) return Result;
+
+		// The target sits off the end of the row, so the held object is always the closest member of its group
+		TArray<AMoveableObject*> Held = SpawnConstrainedRow(TestWorld, GroupSize, FVector(0.f, 0.f, 500.f));
+		AMoveableObject* Target = TestWorld.SpawnPart(FVector(-150.f, 0.f, 500.f));
+		if (Held.Contains(nullptr) || !Target) return Result;
+
+		Target->MeshComponent->SetEnableGravity(false);
+		TestWorld.Tick(5);
+
+		TArray<FTransform> InitialOffsets;
+		for (AMoveableObject* Member : Held) {
+			InitialOffsets.Add(Member->GetActorTransform().GetRelativeTransform(Held[0]->GetActorTransform()));
+		}
+
+		// Hover for a few frames so the target is found, then release and tick until the fuse has completed
+		IMoveableObjectInterface::Execute_OnGrab(Held[0]);
+		TestWorld.Tick(3);
+		IMoveableObjectInterface::Execute_OnRelease(Held[0]);
+
+		Result.bStayedRigid = true;
+		for (Result.Frames = 0; Result.Frames < MaxFrames && BuildSystem->FindSession(Held[0]) && BuildSystem->FindSession(Held[0])->bIsFusing; ++Result.Frames) {
+			TestWorld.Tick();
+
+			for (int32 i = 0; i < Held.Num(); ++i) {
+				const FTransform Offset = Held[i]->GetActorTransform().GetRelativeTransform(Held[0]->GetActorTransform());
+				Result.bStayedRigid &= Offset.GetLocation().Equals(InitialOffsets[i].GetLocation(), 0.5f) && Offset.GetRotation().Equals(InitialOffsets[i].GetRotation(), 0.01f);
+			}
+		}
+
+		BuildSystem->FinishGroupWork(Held[0]);
+		Result.bCompleted = Result.Frames > 0 && Result.Frames < MaxFrames;
+		Result.bFused = Held[0]->FusedObjects.Contains(Target) && Held[0]->FusedObjects.Num() == GroupSize + 1;
+		return Result;
+	}
+}
+
+// Register the test
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFuseStepTest,
+	"GrabSystem.FuseStep",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+	bool FFuseStepTest::RunTest(const FString& Parameters)
+{
+	// Test 1: Constrained groups of 1, 10 and 100 parts fuse in the same number of frames and stay rigid while they move
+	{
+		const FGroupFuseResult Result1 = SimulateGroupFuse(1);
+		const FGroupFuseResult Result10 = SimulateGroupFuse(10);
+		const FGroupFuseResult Result100 = SimulateGroupFuse(100);
+
+		AddInfo(FString::Printf(TEXT("Frames to converge: 1 part = %d, 10 parts = %d, 100 parts = %d"), Result1.Frames, Result10.Frames, Result100.Frames));
+		TestTrue(TEXT("Fuse completes for every group size"), Result1.bCompleted && Result10.bCompleted && Result100.bCompleted);
+		TestTrue(TEXT("10 part group converges as fast as a single part"), FMath::Abs(Result10.Frames - Result1.Frames) <= 1);
+		TestTrue(TEXT("100 part group converges as fast as a single part"), FMath::Abs(Result100.Frames - Result1.Frames) <= 1);
+		TestTrue(TEXT("Groups stay rigid while fusing"), Result1.bStayedRigid && Result10.bStayedRigid && Result100.bStayedRigid);
+		TestTrue(TEXT("Every group is fused to the target"), Result1.bFused && Result10.bFused && Result100.bFused);
+	}
+
+	// Test 2: The final step lands exactly on the other snap point
+	{
+		bool bComplete = false;
+		const FVector3f HeldSnapPoint(0.5f, 0.f, 0.f);
+		const FVector3f Step = BuildSystemMath::GetFuseStep(HeldSnapPoint, FVector3f::ZeroVector, 1.f / 60.f, 6.f, 1.f, bComplete);
+		TestTrue(TEXT("Fuse completes within tolerance"), bComplete);
+		TestTrue(TEXT("Final step closes the remaining gap"), (HeldSnapPoint + Step).Equals(FVector3f::ZeroVector, UE_KINDA_SMALL_NUMBER));
+	}
+
+	// Test 3: Steps outside of tolerance only move part of the way
+	{
+		bool bComplete = true;
+		const FVector3f Step = BuildSystemMath::GetFuseStep(FVector3f::ZeroVector, FVector3f(100.f, 0.f, 0.f), 1.f / 60.f, 6.f, 1.f, bComplete);
+		TestFalse(TEXT("Fuse is not complete outside of tolerance"), bComplete);
+		TestTrue(TEXT("Step moves a tenth of the remaining gap"), Step.Equals(FVector3f(10.f, 0.f, 0.f), 0.01f));
+	}
+
+	return true;
+}
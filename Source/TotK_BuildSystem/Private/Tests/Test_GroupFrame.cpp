@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// To run tests, enter console command - Automation RunTests GrabSystem.GroupFrame
+// To run the benchmark, enter console command - Automation RunTests GrabSystem.Perf.GroupFrame
+
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "HAL/PlatformTime.h"
+#include "BuildSystemMath.h"
+
+// 10km from the world origin in centimeters
+static const double FarFromOrigin = 1000000.0;
+
+// Register the test
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGroupFrameTest,
+	"GrabSystem.GroupFrame",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+	bool FGroupFrameTest::RunTest(const FString& Parameters)
+{
+	const FVector Anchor(FarFromOrigin, FarFromOrigin, 250.0);
+	const BuildSystemMath::FGroupFrame Frame(Anchor);
+
+	// Test 1: Round trip through the group frame keeps sub-millimeter precision 10km from the origin
+	{
+		const FVector WorldPoint = Anchor + FVector(12.3456, -78.9012, 3.4567);
+		const FVector RoundTrip = Frame.ToWorld(Frame.ToLocal(WorldPoint));
+		TestTrue(TEXT("Round trip at 10km is within 0.0001cm"), RoundTrip.Equals(WorldPoint, 0.0001));
+	}
+
+	// Test 2: Snap points 0.01cm apart at 10km can be told apart in the group frame, even though they collapse in world float space
+	{
+		const FVector TestPoint = Anchor + FVector(10.0, 0.0, 0.0);
+		TArray<FVector> WorldSnapPoints = {
+			TestPoint + FVector(0.03, 0.0, 0.0),
+			TestPoint + FVector(0.02, 0.0, 0.0),
+		};
+
+		TArray<FVector3f> LocalSnapPoints;
+		TArray<FVector3f> WorldFloatSnapPoints;
+		for (const FVector& Point : WorldSnapPoints) {
+			LocalSnapPoints.Add(Frame.ToLocal(Point));
+			WorldFloatSnapPoints.Add(FVector3f(Point));
+		}
+
+		TestEqual(TEXT("Group frame picks the closest snap point at 10km"), BuildSystemMath::FindClosestPoint<FVector3f>(LocalSnapPoints, Frame.ToLocal(TestPoint)), 1);
+		TestEqual(TEXT("World doubles pick the closest snap point at 10km"), BuildSystemMath::FindClosestPoint<FVector>(WorldSnapPoints, TestPoint), 1);
+		TestEqual(TEXT("World floats cannot tell the snap points apart at 10km"), BuildSystemMath::FindClosestPoint<FVector3f>(WorldFloatSnapPoints, FVector3f(TestPoint)), 0);
+	}
+
+	// Test 3: Points outside of the search radius are ignored
+	{
+		TArray<FVector3f> LocalSnapPoints = { FVector3f(70.f, 0.f, 0.f), FVector3f(0.f, 61.f, 0.f) };
+		TestEqual(TEXT("No snap point within the search radius"), BuildSystemMath::FindClosestPoint<FVector3f>(LocalSnapPoints, FVector3f::ZeroVector, 60.f * 60.f), (int32)INDEX_NONE);
+	}
+
+	// Test 4: Ties keep the first snap point, matching the previous double precision search
+	{
+		TArray<FVector3f> LocalSnapPoints = { FVector3f(5.f, 0.f, 0.f), FVector3f(-5.f, 0.f, 0.f) };
+		TestEqual(TEXT("Ties keep the first snap point"), BuildSystemMath::FindClosestPoint<FVector3f>(LocalSnapPoints, FVector3f::ZeroVector), 0);
+	}
+
+	// Test 5: Interpolating in the group frame converges on the same world location as interpolating in world space
+	{
+		const FVector Start = Anchor;
+		const FVector Target = Anchor + FVector(40.0, -25.0, 10.0);
+		const BuildSystemMath::FGroupFrame StartFrame(Start);
+
+		FVector WorldResult = FMath::VInterpTo(Start, Target, 1.f / 60.f, 6.f);
+		FVector FrameResult = StartFrame.ToWorld(BuildSystemMath::InterpTo(FVector3f::ZeroVector, StartFrame.ToLocal(Target), 1.f / 60.f, 6.f));
+		TestTrue(TEXT("Group frame interpolation matches world interpolation at 10km"), FrameResult.Equals(WorldResult, 0.001));
+	}
+
+	return true;
+}
+
+// Register the benchmark
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGroupFramePerfTest,
+	"GrabSystem.Perf.GroupFrame",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+	bool FGroupFramePerfTest::RunTest(const FString& Parameters)
+{
+	const int32 NumPoints = 4096;
+	const int32 NumIterations = 2000;
+	const FVector Anchor(FarFromOrigin, FarFromOrigin, 0.0);
+	const BuildSystemMath::FGroupFrame Frame(Anchor);
+
+	// Build the same random snap points in world doubles and in the group frame
+	FRandomStream Stream(1337);
+	TArray<FVector> WorldPoints;
+	TArray<FVector3f> LocalPoints;
+	for (int32 i = 0; i < NumPoints; ++i) {
+		FVector Point = Anchor + Stream.GetUnitVector() * Stream.FRandRange(0.f, 500.f);
+		WorldPoints.Add(Point);
+		LocalPoints.Add(Frame.ToLocal(Point));
+	}
+
+	const FVector WorldTestPoint = Anchor + FVector(30.0, 20.0, 10.0);
+	const FVector3f LocalTestPoint = Frame.ToLocal(WorldTestPoint);
+
+	// Time the closest point search using world doubles
+	int32 DoubleResult = INDEX_NONE;
+	double StartTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < NumIterations; ++i) {
+		DoubleResult = BuildSystemMath::FindClosestPoint<FVector>(WorldPoints, WorldTestPoint);
+	}
+	const double DoubleSeconds = FPlatformTime::Seconds() - StartTime;
+
+	// Time the closest point search using floats in the group frame
+	int32 FloatResult = INDEX_NONE;
+	StartTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < NumIterations; ++i) {
+		FloatResult = BuildSystemMath::FindClosestPoint<FVector3f>(LocalPoints, LocalTestPoint);
+	}
+	const double FloatSeconds = FPlatformTime::Seconds() - StartTime;
+
+	TestEqual(TEXT("Double and float paths find the same closest point"), FloatResult, DoubleResult);
+	AddInfo(FString::Printf(TEXT("Closest point over %d points x %d: double %.3f ms, float %.3f ms (%.2fx)"),
+		NumPoints, NumIterations, DoubleSeconds * 1000.0, FloatSeconds * 1000.0, FloatSeconds > 0.0 ? DoubleSeconds / FloatSeconds : 0.0));
+
+	return true;
+}
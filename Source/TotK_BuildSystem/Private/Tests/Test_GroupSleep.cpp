@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// To run tests, enter console command - Automation RunTests GrabSystem.GroupSleep
+
+#include "Misc/AutomationTest.h"
+#include "Tests/BuildSystemTestHelpers.h"
+#include "BuildSystemSubsystem.h"
+
+namespace
+{
+	// Check if every part in a group is awake
+	bool IsGroupAwake(const TArray<AMoveableObject*>& Group)
+	{
+		return !Group.ContainsByPredicate([](const AMoveableObject* Part) { return !Part->MeshComponent->RigidBodyIsAwake(); });
+	}
+
+	// Check if every part in a group is asleep
+	bool IsGroupAsleep(const TArray<AMoveableObject*>& Group)
+	{
+		return !Group.ContainsByPredicate([](const AMoveableObject* Part) { return Part->MeshComponent->RigidBodyIsAwake(); });
+	}
+}
+
+// Register the test
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGroupSleepTest,
+	"GrabSystem.GroupSleep",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+	bool FGroupSleepTest::RunTest(const FString& Parameters)
+{
+	BuildSystemTest::FTestWorld TestWorld;
+	UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+	if (!TestNotNull(TEXT("Build system subsystem exists"), BuildSystem)) {
+		return false;
+	}
+
+	// Two groups floating side by side without gravity, so they settle straight away
+	TArray<AMoveableObject*> GroupA = TestWorld.SpawnRow(3, FVector(0.f, 0.f, 500.f));
+	TArray<AMoveableObject*> GroupB = TestWorld.SpawnRow(3, FVector(0.f, 300.f, 500.f));
+	if (!TestTrue(TEXT("Parts spawned"), !GroupA.Contains(nullptr) && !GroupB.Contains(nullptr))) {
+		return false;
+	}
+
+	BuildSystemTest::FTestWorld::FuseParts(GroupA);
+	BuildSystemTest::FTestWorld::FuseParts(GroupB);
+	for (AMoveableObject* Part : GroupA) {
+		Part->MeshComponent->SetEnableGravity(false);
+	}
+	for (AMoveableObject* Part : GroupB) {
+		Part->MeshComponent->SetEnableGravity(false);
+	}
+
+	// Test 1: Settled groups are put to sleep as a whole
+	{
+		BuildSystem->WakeGroup(GroupA[0]);
+		BuildSystem->WakeGroup(GroupB[0]);
+		TestWorld.Tick(40);
+
+		TestTrue(TEXT("Group A is asleep"), IsGroupAsleep(GroupA));
+		TestTrue(TEXT("Group B is asleep"), IsGroupAsleep(GroupB));
+	}
+
+	// Test 2: Waking a group only wakes its own members
+	{
+		BuildSystem->WakeGroup(GroupA[1]);
+		TestTrue(TEXT("Every member of group A is awake"), IsGroupAwake(GroupA));
+		TestTrue(TEXT("Group B is still asleep"), IsGroupAsleep(GroupB));
+	}
+
+	// Test 3: A group goes back to sleep once it settles again
+	{
+		TestWorld.Tick(40);
+		TestTrue(TEXT("Group A is asleep again"), IsGroupAsleep(GroupA));
+	}
+
+	// Test 4: When physics wakes a single member, the rest of its group wakes with it
+	{
+		GroupB[2]->MeshComponent->SetPhysicsLinearVelocity(FVector(0.f, 0.f, 200.f));
+		TestWorld.Tick(2);
+		TestTrue(TEXT("Every member of group B is awake"), IsGroupAwake(GroupB));
+		TestTrue(TEXT("Group A is still asleep"), IsGroupAsleep(GroupA));
+	}
+
+	return true;
+}
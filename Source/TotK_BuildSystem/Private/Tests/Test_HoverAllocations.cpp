@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// To run tests, enter console command - Automation RunTests GrabSystem.HoverAllocations
+
+#include "Misc/AutomationTest.h"
+#include "Tests/BuildSystemTestHelpers.h"
+#include "MoveableObjectInterface.h"
+#include "BuildSystemSubsystem.h"
+
+// Register the test
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHoverAllocationsTest,
+	"GrabSystem.HoverAllocations",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+	bool FHoverAllocationsTest::RunTest(const FString& Parameters)
+{
+	BuildSystemTest::FTestWorld TestWorld;
+
+	// Build a held 50 part group hovering next to a second group, close enough for the fuse boxes to overlap
+	TArray<AMoveableObject*> HeldGroup = TestWorld.SpawnRow(50, FVector(0.f, 0.f, 500.f));
+	TArray<AMoveableObject*> NearbyGroup = TestWorld.SpawnRow(10, FVector(0.f, 150.f, 500.f));
+	if (!TestTrue(TEXT("Parts spawned"), HeldGroup.Num() == 50 && !HeldGroup.Contains(nullptr) && !NearbyGroup.Contains(nullptr))) {
+		return false;
+	}
+
+	BuildSystemTest::FTestWorld::FuseParts(HeldGroup);
+	BuildSystemTest::FTestWorld::FuseParts(NearbyGroup);
+
+	// Hold the group still so overlaps stay the same between ticks
+	for (AMoveableObject* Part : HeldGroup) {
+		Part->MeshComponent->SetSimulatePhysics(false);
+	}
+	for (AMoveableObject* Part : NearbyGroup) {
+		Part->MeshComponent->SetSimulatePhysics(false);
+	}
+
+	// Grab the group, then tick a few frames so overlaps, materials and scratch storage reach their steady state
+	AMoveableObject* Held = HeldGroup[0];
+	IMoveableObjectInterface::Execute_OnGrab(Held);
+	TestWorld.Tick(5);
+
+	UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+	if (!TestTrue(TEXT("Held object has a fuse session"), BuildSystem && BuildSystem->FindSession(Held))) {
+		return false;
+	}
+
+	// Measure a single hover tick of the held object's fuse session, which searches for fuse candidates and updates snap points
+	int32 NumAllocations = 0;
+	{
+		BuildSystemTest::FScopedAllocationCounter AllocationCounter;
+		BuildSystem->Tick(1.f / 60.f);
+		NumAllocations = AllocationCounter.GetNumAllocations();
+	}
+
+	AddInfo(FString::Printf(TEXT("Heap allocations in a steady state hover tick of a 50 part group: %d"), NumAllocations));
+	TestEqual(TEXT("Steady state hover tick does not allocate"), NumAllocations, 0);
+
+	IMoveableObjectInterface::Execute_OnRelease(Held);
+	return true;
+}
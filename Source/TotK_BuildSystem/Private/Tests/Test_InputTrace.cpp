@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// To run tests, enter console command - Automation RunTests GrabSystem.InputTrace
+
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "InputTrace.h"
+
+// Register the test
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInputTraceTest,
+	"GrabSystem.InputTrace",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+	bool FInputTraceTest::RunTest(const FString& Parameters)
+{
+	// A short session of looking around, walking up to a part, grabbing it, rotating it and letting go
+	FInputTrace Trace;
+	Trace.FixedDeltaTime = 1.f / 30.f;
+	Trace.MapName = TEXT("ThirdPersonMap");
+	Trace.StartTransform = FTransform(FRotator(0.f, 45.f, 0.f), FVector(100.f, 200.f, 90.f));
+	Trace.StartControlRotation = FRotator(-10.f, 45.f, 0.f);
+
+	for (uint32 Frame = 0; Frame < 60; ++Frame) {
+		Trace.Add(Frame, Frame * Trace.FixedDeltaTime, EInputTraceAction::Look, FVector2f(0.5f, -0.25f));
+		Trace.Add(Frame, Frame * Trace.FixedDeltaTime, EInputTraceAction::Move, FVector2f(0.f, 1.f));
+	}
+	Trace.Add(61, 61 * Trace.FixedDeltaTime, EInputTraceAction::Grab, FVector2f(1.f, 0.f));
+	Trace.Add(90, 90 * Trace.FixedDeltaTime, EInputTraceAction::RotateLeft, FVector2f(1.f, 0.f));
+	Trace.Add(1000, 1000 * Trace.FixedDeltaTime, EInputTraceAction::Release, FVector2f(1.f, 0.f));
+
+	// The player then watches the part settle without touching anything until recording stops
+	const uint32 RecordedFrames = 1200;
+	Trace.Finish(RecordedFrames);
+
+	// Test 1: Only move and look keep an axis value
+	{
+		TestEqual(TEXT("Look keeps its axis value"), Trace.Events[0].Value, FVector2f(0.5f, -0.25f));
+		TestEqual(TEXT("Grab does not keep an axis value"), Trace.Events[120].Value, FVector2f::ZeroVector);
+		TestEqual(TEXT("Trace lasts until recording stopped, not its last event"), Trace.NumFrames(), RecordedFrames);
+	}
+
+	// Test 2: A trace reads back exactly as it was written
+	TArray<uint8> Bytes;
+	{
+		FMemoryWriter Writer(Bytes);
+		TestTrue(TEXT("Trace is written"), Trace.Serialize(Writer));
+
+		FInputTrace ReadTrace;
+		FMemoryReader Reader(Bytes);
+		TestTrue(TEXT("Trace is read"), ReadTrace.Serialize(Reader));
+
+		TestEqual(TEXT("Fixed timestep is kept"), ReadTrace.FixedDeltaTime, Trace.FixedDeltaTime);
+		TestEqual(TEXT("Map is kept"), ReadTrace.MapName, Trace.MapName);
+		TestTrue(TEXT("Start transform is kept"), ReadTrace.StartTransform.Equals(Trace.StartTransform));
+		TestEqual(TEXT("Start control rotation is kept"), ReadTrace.StartControlRotation, Trace.StartControlRotation);
+		TestTrue(TEXT("Every event is kept"), ReadTrace.Events == Trace.Events);
+		TestEqual(TEXT("Frames without input after the last event are kept"), ReadTrace.NumFrames(), RecordedFrames);
+	}
+
+	// Test 3: Traces are compact, with small frame deltas and no values for actions without an axis
+	{
+		const double BytesPerEvent = (double)Bytes.Num() / Trace.Events.Num();
+		TestTrue(TEXT("Events take less than 16 bytes each"), BytesPerEvent < 16.0);
+		AddInfo(FString::Printf(TEXT("%d events in %d bytes, %.1f bytes per event"), Trace.Events.Num(), Bytes.Num(), BytesPerEvent));
+	}
+
+	// Test 4: Traces survive a round trip through a file, and files that are not traces are rejected
+	{
+		const FString Filename = FPaths::CreateTempFilename(*FPaths::ProjectIntermediateDir(), TEXT("InputTrace"), TEXT(".inputtrace"));
+		TestTrue(TEXT("Trace is saved"), Trace.SaveToFile(Filename));
+
+		FInputTrace LoadedTrace;
+		TestTrue(TEXT("Trace is loaded"), LoadedTrace.LoadFromFile(Filename));
+		TestTrue(TEXT("Loaded events match"), LoadedTrace.Events == Trace.Events);
+		IFileManager::Get().Delete(*Filename);
+
+		TArray<uint8> Garbage = { 1, 2, 3, 4, 5, 6, 7, 8 };
+		FMemoryReader Reader(Garbage);
+		FInputTrace GarbageTrace;
+		TestFalse(TEXT("Data that is not a trace is rejected"), GarbageTrace.Serialize(Reader));
+		TestFalse(TEXT("Missing files are rejected"), GarbageTrace.LoadFromFile(Filename));
+	}
+
+	// Test 5: Replaying frame by frame dispatches every event and keeps running through the frames without input at the end, as the character's replay does
+	{
+		int32 NextEvent = 0;
+		uint32 NumReplayedFrames = 0;
+		for (uint32 Frame = 0; Frame < Trace.NumFrames(); ++Frame) {
+			while (Trace.Events.IsValidIndex(NextEvent) && Trace.Events[NextEvent].Frame <= Frame) {
+				++NextEvent;
+			}
+			++NumReplayedFrames;
+		}
+
+		TestEqual(TEXT("Every event is replayed"), NextEvent, Trace.Events.Num());
+		TestEqual(TEXT("Every recorded frame is replayed"), NumReplayedFrames, RecordedFrames);
+	}
+
+	// Test 6: A trace finished before any input still replays for as long as it was recorded
+	{
+		FInputTrace IdleTrace;
+		IdleTrace.Finish(30);
+		TestEqual(TEXT("Trace without events lasts until recording stopped"), IdleTrace.NumFrames(), 30u);
+	}
+
+	return true;
+}
@@ -0,0 +1,200 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// To run tests, enter console command - Automation RunTests GrabSystem.InstancedRendering
+// To run the benchmark, enter console command - Automation RunTests GrabSystem.Perf.InstancedRendering
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/StaticMesh.h"
+#include "Components/PrimitiveComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "UObject/UObjectIterator.h"
+#include "Tests/BuildSystemTestHelpers.h"
+#include "BuildSystemSubsystem.h"
+
+namespace
+{
+	// Turn the instanced render path on or off
+	void SetInstancedRendering(bool bEnabled)
+	{
+		if (IConsoleVariable* InstancedRendering = IConsoleManager::Get().FindConsoleVariable(TEXT("BuildSystem.InstancedRendering"))) {
+			InstancedRendering->Set(bEnabled, ECVF_SetByCode);
+		}
+	}
+
+	// Primitives added to a world's scene, each of which gets its own scene proxy, and the mesh draws they would issue before any batching by the renderer
+	struct FSceneCounts
+	{
+		int32 NumPrimitives = 0;
+		int32 NumDraws = 0;
+		int32 NumInstances = 0;
+	};
+
+	// Count the primitives added to a world's scene, which works without a renderer so it can be measured with -nullrhi
+	FSceneCounts CountScene(UWorld* World)
+	{
+		FSceneCounts Counts;
+		for (TObjectIterator<UStaticMeshComponent> It; It; ++It) {
+			UStaticMeshComponent* Component = *It;
+			if (Component->GetWorld() != World || !Component->IsRegistered() || !Component->ShouldComponentAddToScene() || !Component->GetStaticMesh()) continue;
+
+			// Every section of a mesh is drawn separately, but all instances of an instanced mesh share the draws of their sections
+			const int32 NumSections = Component->GetStaticMesh()->GetNumSections(0);
+			if (const UInstancedStaticMeshComponent* Instanced = Cast<UInstancedStaticMeshComponent>(Component)) {
+				if (Instanced->GetInstanceCount() == 0) continue;
+				Counts.NumInstances += Instanced->GetInstanceCount();
+			}
+
+			++Counts.NumPrimitives;
+			Counts.NumDraws += NumSections;
+		}
+		return Counts;
+	}
+}
+
+// Register the test
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInstancedRenderingTest,
+	"GrabSystem.InstancedRendering",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+	bool FInstancedRenderingTest::RunTest(const FString& Parameters)
+{
+	BuildSystemTest::FTestWorld TestWorld;
+	UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+	if (!TestNotNull(TEXT("Build system subsystem exists"), BuildSystem)) {
+		return false;
+	}
+
+	TArray<AMoveableObject*> Parts = TestWorld.SpawnRow(4, FVector(0.f, 0.f, 500.f));
+	if (!TestTrue(TEXT("Parts spawned"), !Parts.Contains(nullptr))) {
+		return false;
+	}
+	for (AMoveableObject* Part : Parts) {
+		Part->MeshComponent->SetEnableGravity(false);
+	}
+
+	const FInstancedPartRenderer& Renderer = BuildSystem->GetInstancedRenderer();
+
+	// Test 1: Parts sharing a mesh are drawn through a single instanced mesh, while keeping their own physics bodies
+	SetInstancedRendering(true);
+	TestWorld.Tick();
+	{
+		TestEqual(TEXT("One instanced mesh for the shared mesh"), Renderer.NumBatches(), 1);
+		TestEqual(TEXT("Every part is an instance"), Renderer.NumInstances(), Parts.Num());
+		for (AMoveableObject* Part : Parts) {
+			TestFalse(TEXT("Instanced part's own mesh is hidden"), Part->MeshComponent->IsVisible());
+			TestTrue(TEXT("Instanced part still simulates"), Part->MeshComponent->IsSimulatingPhysics());
+		}
+	}
+
+	// Test 2: Instances follow their parts' physics bodies
+	{
+		Parts[0]->MeshComponent->SetPhysicsLinearVelocity(FVector(0.f, 0.f, 300.f));
+		TestWorld.Tick(10);
+
+		UInstancedStaticMeshComponent* Instances = nullptr;
+		for (TObjectIterator<UInstancedStaticMeshComponent> It; It; ++It) {
+			if (It->GetWorld() == TestWorld.World) {
+				Instances = *It;
+			}
+		}
+
+		bool bFoundMovedInstance = false;
+		for (int32 Index = 0; Instances && Index < Instances->GetInstanceCount(); ++Index) {
+			FTransform InstanceTransform;
+			Instances->GetInstanceTransform(Index, InstanceTransform, true);
+			bFoundMovedInstance |= InstanceTransform.GetLocation().Equals(Parts[0]->GetActorLocation(), 10.f);
+		}
+		TestTrue(TEXT("An instance is at the moved part's location"), bFoundMovedInstance);
+	}
+
+	// Test 3: Held parts and highlighted parts are drawn through their own mesh for their overlay material
+	{
+		BuildSystem->GetPartRegistry().SetFlags(Parts[1], EPartFlags::Grabbed, true);
+		Parts[2]->MeshComponent->SetOverlayMaterial(Parts[2]->MeshComponent->GetMaterial(0));
+		TestWorld.Tick();
+
+		TestEqual(TEXT("Held and highlighted parts are not instanced"), Renderer.NumInstances(), Parts.Num() - 2);
+		TestTrue(TEXT("Held part's own mesh is shown"), Parts[1]->MeshComponent->IsVisible());
+		TestTrue(TEXT("Highlighted part's own mesh is shown"), Parts[2]->MeshComponent->IsVisible());
+
+		BuildSystem->GetPartRegistry().SetFlags(Parts[1], EPartFlags::Grabbed, false);
+		Parts[2]->MeshComponent->SetOverlayMaterial(nullptr);
+		TestWorld.Tick();
+		TestEqual(TEXT("Released parts are instanced again"), Renderer.NumInstances(), Parts.Num());
+	}
+
+	// Test 4: Turning instanced rendering off draws every part through its own mesh again
+	SetInstancedRendering(false);
+	TestWorld.Tick();
+	{
+		TestEqual(TEXT("No instanced meshes are left"), Renderer.NumBatches(), 0);
+		for (AMoveableObject* Part : Parts) {
+			TestTrue(TEXT("Part's own mesh is shown"), Part->MeshComponent->IsVisible());
+		}
+	}
+
+	// Test 5: Turning instanced rendering off leaves frozen groups drawn only through their own instances
+	SetInstancedRendering(true);
+	TestWorld.Tick();
+	{
+		const TArray<AMoveableObject*> FrozenParts = { Parts[2], Parts[3] };
+		BuildSystemTest::FTestWorld::FuseParts(FrozenParts);
+		TestTrue(TEXT("Group is frozen"), Parts[2]->FreezeGroup());
+
+		SetInstancedRendering(false);
+		TestWorld.Tick();
+		TestEqual(TEXT("No instanced meshes are left"), Renderer.NumBatches(), 0);
+		TestTrue(TEXT("Unfrozen parts' own meshes are shown"), Parts[0]->MeshComponent->IsVisible() && Parts[1]->MeshComponent->IsVisible());
+		for (AMoveableObject* Part : FrozenParts) {
+			TestFalse(TEXT("Frozen part's own mesh stays hidden"), Part->MeshComponent->IsVisible());
+		}
+
+		Parts[2]->UnfreezeGroup();
+	}
+
+	return true;
+}
+
+// Register the benchmark
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInstancedRenderingPerfTest,
+	"GrabSystem.Perf.InstancedRendering",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+	bool FInstancedRenderingPerfTest::RunTest(const FString& Parameters)
+{
+	BuildSystemTest::FTestWorld TestWorld;
+	UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+	if (!TestNotNull(TEXT("Build system subsystem exists"), BuildSystem)) {
+		return false;
+	}
+
+	// A 1000 part build made from a single part, floating so every part keeps moving slightly as it settles
+	const int32 NumParts = 1000;
+	for (int32 i = 0; i < NumParts; ++i) {
+		AMoveableObject* Part = TestWorld.SpawnPart(FVector((i % 10) * 110.f, ((i / 10) % 10) * 110.f, 500.f + (i / 100) * 110.f));
+		if (!Part) {
+			AddError(TEXT("Parts failed to spawn"));
+			return false;
+		}
+		Part->MeshComponent->SetEnableGravity(false);
+	}
+
+	const int32 NumFrames = 60;
+	for (bool bInstanced : { false, true }) {
+		SetInstancedRendering(bInstanced);
+		TestWorld.Tick();
+
+		const double StartTime = FPlatformTime::Seconds();
+		TestWorld.Tick(NumFrames);
+		const double Seconds = (FPlatformTime::Seconds() - StartTime) / NumFrames;
+
+		const FSceneCounts Counts = CountScene(TestWorld.World);
+		AddInfo(FString::Printf(TEXT("%s: %d primitives in the scene, %d mesh draws, %d instances, world tick %.3f ms"),
+			bInstanced ? TEXT("Instanced") : TEXT("Separate meshes"), Counts.NumPrimitives, Counts.NumDraws, Counts.NumInstances, Seconds * 1000.0));
+	}
+
+	SetInstancedRendering(false);
+	return true;
+}
@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// To run tests, enter console command - Automation RunTests GrabSystem.LinkTable
+// To run the benchmark, enter console command - Automation RunTests GrabSystem.Perf.LinkTable
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "Tests/BuildSystemTestHelpers.h"
+#include "ConstraintLinkTable.h"
+
+// Register the test
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLinkTableTest,
+	"GrabSystem.LinkTable",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+	bool FLinkTableTest::RunTest(const FString& Parameters)
+{
+	BuildSystemTest::FTestWorld TestWorld;
+	TArray<AMoveableObject*> Parts = TestWorld.SpawnRow(4, FVector(0.f, 0.f, 500.f));
+	if (!TestTrue(TEXT("Parts spawned"), !Parts.Contains(nullptr))) {
+		return false;
+	}
+
+	AMoveableObject* A = Parts[0];
+	AMoveableObject* B = Parts[1];
+	AMoveableObject* C = Parts[2];
+	AMoveableObject* D = Parts[3];
+
+	// Links only need their objects for the table, so no constraint components are created
+	FConstraintLinkTable LinkTable;
+
+	// Test 1: Every link is stored once and appears in the link lists of both of its objects
+	FConstraintLinkHandle AB = LinkTable.Add(nullptr, A, B);
+	FConstraintLinkHandle AC = LinkTable.Add(nullptr, A, C);
+	FConstraintLinkHandle BC = LinkTable.Add(nullptr, B, C);
+	{
+		TestEqual(TEXT("Three links in the table"), LinkTable.Num(), 3);
+		TestEqual(TEXT("A has two links"), LinkTable.NumObjectLinks(A), 2);
+		TestEqual(TEXT("B has two links"), LinkTable.NumObjectLinks(B), 2);
+		TestEqual(TEXT("C has two links"), LinkTable.NumObjectLinks(C), 2);
+		TestEqual(TEXT("D has no links"), LinkTable.NumObjectLinks(D), 0);
+
+		const FPhysicsConstraintLink* Link = LinkTable.Find(AB);
+		TestTrue(TEXT("Handle resolves to its link"), Link && Link->ComponentA == A && Link->ComponentB == B);
+	}
+
+	// Test 2: Removing a link takes it out of both link lists and its handle stops resolving
+	{
+		TestTrue(TEXT("Link is removed"), LinkTable.Remove(AB));
+		TestFalse(TEXT("Removed links cannot be removed again"), LinkTable.Remove(AB));
+		TestNull(TEXT("Removed handle no longer resolves"), LinkTable.Find(AB));
+		TestEqual(TEXT("A has one link left"), LinkTable.NumObjectLinks(A), 1);
+		TestEqual(TEXT("B has one link left"), LinkTable.NumObjectLinks(B), 1);
+		TestNotNull(TEXT("Other handles still resolve"), LinkTable.Find(AC));
+		TestNotNull(TEXT("Other handles still resolve"), LinkTable.Find(BC));
+	}
+
+	// Test 3: Removed slots are reused without old handles resolving to the new link
+	{
+		FConstraintLinkHandle CD = LinkTable.Add(nullptr, C, D);
+		TestEqual(TEXT("New link reuses the removed slot"), CD.Index, AB.Index);
+		TestNull(TEXT("Old handle does not resolve to the new link"), LinkTable.Find(AB));
+		TestEqual(TEXT("C has three links"), LinkTable.NumObjectLinks(C), 3);
+	}
+
+	// Test 4: Links can be removed while iterating over an object's links
+	{
+		LinkTable.ForEachObjectLink(C, [&LinkTable](FConstraintLinkHandle Handle, const FPhysicsConstraintLink&) {
+			LinkTable.Remove(Handle);
+		});
+
+		TestEqual(TEXT("Every link of C has been removed"), LinkTable.Num(), 0);
+		for (AMoveableObject* Part : Parts) {
+			TestEqual(TEXT("No object has links left"), LinkTable.NumObjectLinks(Part), 0);
+		}
+	}
+
+	// Test 5: A link from an object to itself is only listed once
+	{
+		FConstraintLinkHandle AA = LinkTable.Add(nullptr, A, A);
+		TestEqual(TEXT("Self link is listed once"), LinkTable.NumObjectLinks(A), 1);
+		TestTrue(TEXT("Self link is removed"), LinkTable.Remove(AA));
+		TestEqual(TEXT("No links left on A"), LinkTable.NumObjectLinks(A), 0);
+	}
+
+	return true;
+}
+
+// Register the benchmark
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLinkTablePerfTest,
+	"GrabSystem.Perf.LinkTable",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+	bool FLinkTablePerfTest::RunTest(const FString& Parameters)
+{
+	BuildSystemTest::FTestWorld TestWorld;
+
+	// Splitting a hub removes every one of its links, which used to scan the other object's links for each one
+	for (int32 NumLinks : { 10, 100, 1000 }) {
+		TArray<AMoveableObject*> Parts = TestWorld.SpawnRow(NumLinks + 1, FVector(0.f, 0.f, 500.f + NumLinks));
+		AMoveableObject* Hub = Parts[0];
+
+		FConstraintLinkTable LinkTable;
+		for (int32 i = 1; i < Parts.Num(); ++i) {
+			LinkTable.Add(nullptr, Hub, Parts[i]);
+		}
+
+		const double StartTime = FPlatformTime::Seconds();
+		LinkTable.ForEachObjectLink(Hub, [&LinkTable](FConstraintLinkHandle Handle, const FPhysicsConstraintLink&) {
+			LinkTable.Remove(Handle);
+		});
+		const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+		TestEqual(TEXT("Every link of the hub has been removed"), LinkTable.Num(), 0);
+		AddInfo(FString::Printf(TEXT("Removing %d links from a hub: %.3f ms (%.1f ns per link)"), NumLinks, Seconds * 1000.0, Seconds * 1e9 / NumLinks));
+
+		for (AMoveableObject* Part : Parts) {
+			Part->Destroy();
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// To run tests, enter console command - Automation RunTests GrabSystem.MemoryUsage
+
+#include "Misc/AutomationTest.h"
+#include "Tests/BuildSystemTestHelpers.h"
+#include "BuildSystemStats.h"
+
+// Register the test
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMemoryUsageTest,
+	"GrabSystem.MemoryUsage",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+	bool FMemoryUsageTest::RunTest(const FString& Parameters)
+{
+	BuildSystemTest::FTestWorld TestWorld;
+
+	// Spawn a row of separate parts, then fuse them into a single group
+	TArray<AMoveableObject*> Parts = TestWorld.SpawnRow(10, FVector(0.f, 0.f, 500.f));
+	if (!TestTrue(TEXT("Parts spawned"), !Parts.Contains(nullptr))) {
+		return false;
+	}
+
+	FBuildSystemMemoryUsage SeparateUsage = FBuildSystemMemoryUsage::Gather(TestWorld.World);
+	TestEqual(TEXT("Every part is counted"), SeparateUsage.NumParts, 10);
+	TestEqual(TEXT("Separate parts have no links"), SeparateUsage.NumLinks, 0);
+	TestTrue(TEXT("Parts report the memory they use"), SeparateUsage.GetPartBytes() > 0);
+
+	// Every object in a group keeps its own copy of the group's fused object set, so fused set memory grows with the square of the group size
+	BuildSystemTest::FTestWorld::FuseParts(Parts);
+	FBuildSystemMemoryUsage FusedUsage = FBuildSystemMemoryUsage::Gather(TestWorld.World);
+	TestTrue(TEXT("Fused sets grow when parts are grouped"), FusedUsage.FusedSetBytes > SeparateUsage.FusedSetBytes);
+
+	AddInfo(FString::Printf(TEXT("Bytes per part, separate: %.0f, fused in a group of 10: %.0f"),
+		(double)SeparateUsage.GetPartBytes() / SeparateUsage.NumParts,
+		(double)FusedUsage.GetPartBytes() / FusedUsage.NumParts));
+
+	// Hover and fuse state is only held by the fuse session of a held object, not by every part
+	AddInfo(FString::Printf(TEXT("sizeof(AMoveableObject): %d, sizeof(FFuseSession): %d"), (int32)sizeof(AMoveableObject), (int32)sizeof(FFuseSession)));
+	TestEqual(TEXT("Resting parts have no overlay materials"), FusedUsage.MaterialBytes, (SIZE_T)0);
+
+	return true;
+}
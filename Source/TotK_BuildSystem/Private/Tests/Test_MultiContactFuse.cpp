@@ -0,0 +1,201 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// To run tests, enter console command - Automation RunTests GrabSystem.MultiContactFuse
+// To run the benchmark, enter console command - Automation RunTests GrabSystem.Perf.MultiContactFuse
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/IConsoleManager.h"
+#include "Tests/BuildSystemTestHelpers.h"
+#include "MoveableObjectInterface.h"
+#include "BuildSystemSubsystem.h"
+
+namespace
+{
+	// Turn fusing at every lined up contact on or off
+	void SetMultiContactFuse(bool bEnabled)
+	{
+		if (IConsoleVariable* MultiContactFuse = IConsoleManager::Get().FindConsoleVariable(TEXT("BuildSystem.MultiContactFuse"))) {
+			MultiContactFuse->Set(bEnabled, ECVF_SetByCode);
+		}
+	}
+
+	// Spawn a floating row of parts, either fused into a single group or left as a group each
+	TArray<AMoveableObject*> SpawnFloatingRow(BuildSystemTest::FTestWorld& TestWorld, int32 NumParts, const FVector& Start, bool bFused)
+	{
+		TArray<AMoveableObject*> Parts = TestWorld.SpawnRow(NumParts, Start);
+		if (Parts.Contains(nullptr)) return Parts;
+
+		if (bFused) {
+			BuildSystemTest::FTestWorld::FuseParts(Parts);
+		}
+
+		for (AMoveableObject* Part : Parts) {
+			Part->MeshComponent->SetEnableGravity(false);
+		}
+		return Parts;
+	}
+
+	// Hover a held object for a few frames so it finds a candidate, then release it and tick until its fuse has finished
+	void GrabAndFuse(BuildSystemTest::FTestWorld& TestWorld, UBuildSystemSubsystem* BuildSystem, AMoveableObject* Held)
+	{
+		IMoveableObjectInterface::Execute_OnGrab(Held);
+		TestWorld.Tick(3);
+		IMoveableObjectInterface::Execute_OnRelease(Held);
+
+		for (int32 Frame = 0; Frame < 240 && BuildSystem->FindSession(Held) && BuildSystem->FindSession(Held)->bIsFusing; ++Frame) {
+			TestWorld.Tick();
+		}
+	}
+
+	// Count the parts of a row that are in the held object's group
+	int32 NumInGroup(const AMoveableObject* Held, const TArray<AMoveableObject*>& Parts)
+	{
+		int32 NumFused = 0;
+		for (AMoveableObject* Part : Parts) {
+			NumFused += Held->FusedObjects.Contains(Part) ? 1 : 0;
+		}
+		return NumFused;
+	}
+}
+
+// Register the test
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMultiContactFuseTest,
+	"GrabSystem.MultiContactFuse",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+	bool FMultiContactFuseTest::RunTest(const FString& Parameters)
+{
+	BuildSystemTest::FTestWorld TestWorld;
+	UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+	if (!TestNotNull(TEXT("Build system subsystem exists"), BuildSystem)) {
+		return false;
+	}
+
+	// A held row of 3 parts alongside a row of 3 separate parts, each part facing one of the held row's parts
+	TArray<AMoveableObject*> Held = SpawnFloatingRow(TestWorld, 3, FVector(0.f, 0.f, 500.f), true);
+	TArray<AMoveableObject*> Targets = SpawnFloatingRow(TestWorld, 3, FVector(0.f, 150.f, 500.f), false);
+	if (!TestTrue(TEXT("Parts spawned"), !Held.Contains(nullptr) && !Targets.Contains(nullptr))) {
+		return false;
+	}
+
+	// Test 1: With the option off, releasing fuses the closest pair only
+	{
+		SetMultiContactFuse(false);
+		IMoveableObjectInterface::Execute_OnGrab(Held[0]);
+		TestWorld.Tick(3);
+		IMoveableObjectInterface::Execute_OnRelease(Held[0]);
+
+		FFuseSession* Session = BuildSystem->FindSession(Held[0]);
+		TestTrue(TEXT("Held row is fusing"), Session && Session->bIsFusing);
+		TestTrue(TEXT("No extra contacts without the option"), Session && Session->ExtraContacts.Num() == 0);
+
+		for (int32 Frame = 0; Frame < 240 && BuildSystem->FindSession(Held[0]) && BuildSystem->FindSession(Held[0])->bIsFusing; ++Frame) {
+			TestWorld.Tick();
+		}
+		TestEqual(TEXT("One part fused"), NumInGroup(Held[0], Targets), 1);
+		TestEqual(TEXT("One link made"), BuildSystem->GetLinkTable().Num(), 1);
+	}
+
+	// A fresh pair of rows, as the last fuse has already joined one of the parts
+	TArray<AMoveableObject*> MultiHeld = SpawnFloatingRow(TestWorld, 3, FVector(0.f, 2000.f, 500.f), true);
+	TArray<AMoveableObject*> MultiTargets = SpawnFloatingRow(TestWorld, 3, FVector(0.f, 2150.f, 500.f), false);
+	if (!TestTrue(TEXT("Parts spawned"), !MultiHeld.Contains(nullptr) && !MultiTargets.Contains(nullptr))) {
+		return false;
+	}
+
+	// Test 2: With the option on, releasing finds the other lined up contacts along with the closest pair, and locks their groups
+	int32 NumContacts = 0;
+	{
+		SetMultiContactFuse(true);
+		IMoveableObjectInterface::Execute_OnGrab(MultiHeld[0]);
+		TestWorld.Tick(3);
+		IMoveableObjectInterface::Execute_OnRelease(MultiHeld[0]);
+
+		FFuseSession* Session = BuildSystem->FindSession(MultiHeld[0]);
+		if (!TestTrue(TEXT("Held row is fusing"), Session && Session->bIsFusing)) {
+			SetMultiContactFuse(false);
+			return false;
+		}
+
+		NumContacts = 1 + Session->ExtraContacts.Num();
+		TestEqual(TEXT("Every facing part is a contact"), NumContacts, 3);
+		for (const FFuseContact& Contact : Session->ExtraContacts) {
+			TestTrue(TEXT("Extra contact is not the closest pair"), Contact.NearbyObject != Session->ClosestNearbyMoveableObject);
+			TestTrue(TEXT("Extra contact's group is locked"), BuildSystem->IsGroupLocked(Contact.NearbyObject, Contact.NearbyObject));
+		}
+	}
+
+	// Test 3: Once the fuse finishes every contact has a link, and every part is in a single group
+	{
+		const int32 NumLinks = BuildSystem->GetLinkTable().Num();
+		for (int32 Frame = 0; Frame < 240 && BuildSystem->FindSession(MultiHeld[0]) && BuildSystem->FindSession(MultiHeld[0])->bIsFusing; ++Frame) {
+			TestWorld.Tick();
+		}
+		BuildSystem->FinishGroupWork(MultiHeld[0]);
+
+		TestEqual(TEXT("A link is made at every contact"), BuildSystem->GetLinkTable().Num() - NumLinks, NumContacts);
+		TestEqual(TEXT("Every contacted part is fused"), NumInGroup(MultiHeld[0], MultiTargets), NumContacts);
+
+		const int32 GroupId = BuildSystem->GetPartRegistry().GetGroupId(MultiHeld[0]);
+		bool bOneGroup = true;
+		for (AMoveableObject* Part : MultiHeld[0]->FusedObjects) {
+			bOneGroup &= BuildSystem->GetPartRegistry().GetGroupId(Part) == GroupId && Part->FusedObjects.Num() == MultiHeld[0]->FusedObjects.Num();
+		}
+		TestTrue(TEXT("Merged parts share one group and one set"), bOneGroup);
+		TestEqual(TEXT("Extra contacts are cleared"), BuildSystem->FindSession(MultiHeld[0]) ? BuildSystem->FindSession(MultiHeld[0])->ExtraContacts.Num() : 0, 0);
+	}
+
+	SetMultiContactFuse(false);
+	return true;
+}
+
+// Register the benchmark
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMultiContactFusePerfTest,
+	"GrabSystem.Perf.MultiContactFuse",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+	bool FMultiContactFusePerfTest::RunTest(const FString& Parameters)
+{
+	// Join a held row of 10 parts to a facing row of 10 separate parts, once a fuse at a time and once with every contact fused together
+	const int32 NumParts = 10;
+
+	for (bool bMultiContact : { false, true }) {
+		SetMultiContactFuse(bMultiContact);
+
+		BuildSystemTest::FTestWorld TestWorld;
+		UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+		if (!TestNotNull(TEXT("Build system subsystem exists"), BuildSystem)) {
+			SetMultiContactFuse(false);
+			return false;
+		}
+
+		TArray<AMoveableObject*> Held = SpawnFloatingRow(TestWorld, NumParts, FVector(0.f, 0.f, 500.f), true);
+		TArray<AMoveableObject*> Targets = SpawnFloatingRow(TestWorld, NumParts, FVector(0.f, 150.f, 500.f), false);
+		if (Held.Contains(nullptr) || Targets.Contains(nullptr)) {
+			AddError(TEXT("Parts failed to spawn"));
+			SetMultiContactFuse(false);
+			return false;
+		}
+		TestWorld.Tick(10);
+
+		// Each fuse is a grab, a short hover and the fuse itself, repeated until the rows are joined or no fuse joins anything more
+		int32 NumFuses = 0;
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 NumFused = 0; NumFused < NumParts && NumFuses < NumParts * 2;) {
+			GrabAndFuse(TestWorld, BuildSystem, Held[0]);
+			++NumFuses;
+
+			const int32 NumNowFused = NumInGroup(Held[0], Targets);
+			if (NumNowFused == NumFused) break;
+			NumFused = NumNowFused;
+		}
+		const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+		AddInfo(FString::Printf(TEXT("Multi contact %s: %d of %d parts joined in %d fuses, %.3f ms, %d links, %d parts in the held group"),
+			bMultiContact ? TEXT("on ") : TEXT("off"), NumInGroup(Held[0], Targets), NumParts, NumFuses, Seconds * 1000.0, BuildSystem->GetLinkTable().Num(), Held[0]->FusedObjects.Num()));
+	}
+
+	SetMultiContactFuse(false);
+	return true;
+}
@@ -0,0 +1,210 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// To run tests, enter console command - Automation RunTests GrabSystem.MultipleGrabbers
+// To run the benchmark, enter console command - Automation RunTests GrabSystem.Perf.MultipleGrabbers
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "Tests/BuildSystemTestHelpers.h"
+#include "MoveableObjectInterface.h"
+#include "BuildSystemSubsystem.h"
+
+namespace
+{
+	// Spawn a row of parts fused into a single group, held still so its overlaps stay the same between ticks
+	TArray<AMoveableObject*> SpawnStillGroup(BuildSystemTest::FTestWorld& TestWorld, int32 NumParts, const FVector& Start)
+	{
+		TArray<AMoveableObject*> Group = TestWorld.SpawnRow(NumParts, Start);
+		if (Group.Contains(nullptr)) return Group;
+
+		BuildSystemTest::FTestWorld::FuseParts(Group);
+		for (AMoveableObject* Part : Group) {
+			Part->MeshComponent->SetEnableGravity(false);
+		}
+		return Group;
+	}
+
+	// Grab an object on behalf of a grabber, the same way a grabber component does, returning its fuse session if the grab was allowed
+	FFuseSession* GrabAs(UBuildSystemSubsystem* BuildSystem, AMoveableObject* Object, UObject* Grabber)
+	{
+		if (BuildSystem->IsGrabLocked(Object, Grabber)) return nullptr;
+		IMoveableObjectInterface::Execute_OnGrab(Object);
+
+		FFuseSession* Session = BuildSystem->FindSession(Object);
+		if (Session) {
+			Session->Grabber = Grabber;
+		}
+		return Session;
+	}
+}
+
+// Register the test
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMultipleGrabbersTest,
+	"GrabSystem.MultipleGrabbers",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+	bool FMultipleGrabbersTest::RunTest(const FString& Parameters)
+{
+	BuildSystemTest::FTestWorld TestWorld;
+	UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+	if (!TestNotNull(TEXT("Build system subsystem exists"), BuildSystem)) {
+		return false;
+	}
+
+	// Two groups side by side, close enough for their fuse boxes to overlap, and a free part on the far side of the first group
+	TArray<AMoveableObject*> GroupA = SpawnStillGroup(TestWorld, 3, FVector(0.f, 0.f, 500.f));
+	TArray<AMoveableObject*> GroupB = SpawnStillGroup(TestWorld, 3, FVector(0.f, 150.f, 500.f));
+	TArray<AMoveableObject*> Free = SpawnStillGroup(TestWorld, 1, FVector(0.f, -150.f, 500.f));
+	if (!TestTrue(TEXT("Parts spawned"), !GroupA.Contains(nullptr) && !GroupB.Contains(nullptr) && !Free.Contains(nullptr))) {
+		return false;
+	}
+
+	AActor* GrabberA = TestWorld.World->SpawnActor<AActor>();
+	AActor* GrabberB = TestWorld.World->SpawnActor<AActor>();
+
+	// Test 1: Each grabber owns the session of the object it holds, and both can hold at once
+	{
+		TestNotNull(TEXT("First grabber holds its group"), GrabAs(BuildSystem, GroupA[0], GrabberA));
+		TestNotNull(TEXT("Second grabber holds its group"), GrabAs(BuildSystem, GroupB[0], GrabberB));
+		TestEqual(TEXT("Both sessions are ticked"), BuildSystem->GetNumSessions(), 2);
+
+		FFuseSession* SessionA = BuildSystem->FindGrabberSession(GrabberA);
+		FFuseSession* SessionB = BuildSystem->FindGrabberSession(GrabberB);
+		TestTrue(TEXT("First grabber's session holds its object"), SessionA && SessionA->HeldObject == GroupA[0]);
+		TestTrue(TEXT("Second grabber's session holds its object"), SessionB && SessionB->HeldObject == GroupB[0]);
+	}
+
+	// Test 2: A group held by one grabber cannot be grabbed through any of its parts by another
+	{
+		TestTrue(TEXT("Held group is locked to other objects"), BuildSystem->IsGroupLocked(GroupA[2], GroupA[2]));
+		TestFalse(TEXT("Held group is not locked to its own held object"), BuildSystem->IsGroupLocked(GroupA[2], GroupA[0]));
+		TestNull(TEXT("Another part of a held group cannot be grabbed"), GrabAs(BuildSystem, GroupA[2], GrabberB));
+		TestEqual(TEXT("No session was started"), BuildSystem->GetNumSessions(), 2);
+	}
+
+	// Test 3: A held group is never a fuse candidate for another grabber, even when it is closest
+	TestWorld.Tick(3);
+	{
+		FFuseSession* SessionA = BuildSystem->FindGrabberSession(GrabberA);
+		TestTrue(TEXT("First grabber fuses with the free part rather than the other held group"), SessionA && SessionA->ClosestNearbyMoveableObject == Free[0]);
+
+		FFuseSession* SessionB = BuildSystem->FindGrabberSession(GrabberB);
+		TestTrue(TEXT("Second grabber does not fuse with the other held group"), SessionB && !GroupA.Contains(SessionB->ClosestNearbyMoveableObject));
+	}
+
+	// Test 4: A group being fused with is locked until the fuse finishes, then both groups are free again
+	{
+		IMoveableObjectInterface::Execute_OnRelease(GroupA[0]);
+		TestTrue(TEXT("First group is fusing"), BuildSystem->FindSession(GroupA[0]) && BuildSystem->FindSession(GroupA[0])->bIsFusing);
+		TestTrue(TEXT("Group being fused with is locked"), BuildSystem->IsGroupLocked(Free[0], Free[0]));
+		TestNull(TEXT("Group being fused with cannot be grabbed"), GrabAs(BuildSystem, Free[0], GrabberA));
+
+		TestWorld.Tick(120);
+		TestTrue(TEXT("Fuse finished"), GroupA[0]->FusedObjects.Contains(Free[0]));
+		TestFalse(TEXT("Fused group is free again"), BuildSystem->IsGroupLocked(Free[0], Free[0]));
+		TestTrue(TEXT("Second grabber still holds its group"), BuildSystem->FindGrabberSession(GrabberB) && BuildSystem->FindGrabberSession(GrabberB)->bIsGrabbed);
+	}
+
+	// Test 5: The very object another grabber is holding cannot be grabbed, and its session carries on untouched
+	{
+		TestWorld.Tick(3);
+		FFuseSession* SessionB = BuildSystem->FindGrabberSession(GrabberB);
+		const AMoveableObject* ClosestBefore = SessionB ? SessionB->ClosestNearbyMoveableObject : nullptr;
+
+		TestTrue(TEXT("Held object is locked to another grabber"), BuildSystem->IsGrabLocked(GroupB[0], GrabberA));
+		TestFalse(TEXT("Held object is not locked to its own grabber"), BuildSystem->IsGrabLocked(GroupB[0], GrabberB));
+		TestNull(TEXT("Held object cannot be grabbed by another grabber"), GrabAs(BuildSystem, GroupB[0], GrabberA));
+
+		// The object turns away a grab of itself while held too, for callers that grab without going through a grabber
+		IMoveableObjectInterface::Execute_OnGrab(GroupB[0]);
+
+		SessionB = BuildSystem->FindSession(GroupB[0]);
+		TestTrue(TEXT("Session still belongs to the holding grabber"), SessionB && SessionB->Grabber == GrabberB && SessionB->bIsGrabbed);
+		TestTrue(TEXT("Session kept its fuse candidate"), SessionB && SessionB->ClosestNearbyMoveableObject == ClosestBefore);
+		TestNull(TEXT("Other grabber holds nothing"), BuildSystem->FindGrabberSession(GrabberA));
+	}
+
+	// Test 6: The very object another grabber released to fuse cannot be grabbed until the fuse finishes
+	{
+		IMoveableObjectInterface::Execute_OnRelease(GroupB[0]);
+		FFuseSession* SessionB = BuildSystem->FindSession(GroupB[0]);
+		if (TestTrue(TEXT("Second group is fusing"), SessionB && SessionB->bIsFusing)) {
+			const AMoveableObject* FuseTarget = SessionB->ClosestNearbyMoveableObject;
+
+			TestNull(TEXT("Fusing object cannot be grabbed by another grabber"), GrabAs(BuildSystem, GroupB[0], GrabberA));
+
+			SessionB = BuildSystem->FindSession(GroupB[0]);
+			TestTrue(TEXT("Fuse carries on for the releasing grabber"), SessionB && SessionB->bIsFusing && SessionB->Grabber == GrabberB && SessionB->ClosestNearbyMoveableObject == FuseTarget);
+
+			TestWorld.Tick(120);
+			TestTrue(TEXT("Fuse finished"), GroupB[0]->FusedObjects.Contains(FuseTarget));
+			TestFalse(TEXT("Fused object is free again"), BuildSystem->IsGrabLocked(GroupB[0], GrabberA));
+		}
+	}
+
+	return true;
+}
+
+// Register the benchmark
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMultipleGrabbersPerfTest,
+	"GrabSystem.Perf.MultipleGrabbers",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+	bool FMultipleGrabbersPerfTest::RunTest(const FString& Parameters)
+{
+	// Every grabber holds a 10 part group next to its own 10 part target group, hovers for a while and then fuses
+	const int32 NumParts = 10;
+	const int32 NumHoverFrames = 60;
+	const int32 MaxFuseFrames = 240;
+	double SingleGrabberSeconds = 0.0;
+
+	for (int32 NumGrabbers : { 1, 4, 16 }) {
+		BuildSystemTest::FTestWorld TestWorld;
+		UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+		if (!TestNotNull(TEXT("Build system subsystem exists"), BuildSystem)) {
+			return false;
+		}
+
+		TArray<AMoveableObject*> HeldObjects;
+		for (int32 i = 0; i < NumGrabbers; ++i) {
+			const FVector Start(0.f, i * 2000.f, 500.f);
+			TArray<AMoveableObject*> Held = SpawnStillGroup(TestWorld, NumParts, Start);
+			TArray<AMoveableObject*> Target = SpawnStillGroup(TestWorld, NumParts, Start + FVector(0.f, 150.f, 0.f));
+			if (Held.Contains(nullptr) || Target.Contains(nullptr)) {
+				AddError(TEXT("Parts failed to spawn"));
+				return false;
+			}
+
+			GrabAs(BuildSystem, Held[0], TestWorld.World->SpawnActor<AActor>());
+			HeldObjects.Add(Held[0]);
+		}
+		TestWorld.Tick();
+
+		const double HoverStartTime = FPlatformTime::Seconds();
+		TestWorld.Tick(NumHoverFrames);
+		const double HoverSeconds = (FPlatformTime::Seconds() - HoverStartTime) / NumHoverFrames;
+
+		for (AMoveableObject* Held : HeldObjects) {
+			IMoveableObjectInterface::Execute_OnRelease(Held);
+		}
+
+		int32 NumFuseFrames = 0;
+		const double FuseStartTime = FPlatformTime::Seconds();
+		while (BuildSystem->GetNumSessions() > 0 && NumFuseFrames < MaxFuseFrames) {
+			TestWorld.Tick();
+			++NumFuseFrames;
+		}
+		const double FuseSeconds = (FPlatformTime::Seconds() - FuseStartTime) / FMath::Max(NumFuseFrames, 1);
+
+		const int32 NumFused = HeldObjects.FilterByPredicate([NumParts](const AMoveableObject* Held) { return Held->FusedObjects.Num() == NumParts * 2; }).Num();
+		TestEqual(TEXT("Every grabber fused with its own target"), NumFused, NumGrabbers);
+
+		if (NumGrabbers == 1) {
+			SingleGrabberSeconds = HoverSeconds;
+		}
+		AddInfo(FString::Printf(TEXT("%2d grabbers: hover tick %.3f ms (%.2f ms per grabber, %.2fx one grabber), fuse tick %.3f ms over %d frames, %d of %d fused"),
+			NumGrabbers, HoverSeconds * 1000.0, HoverSeconds * 1000.0 / NumGrabbers, HoverSeconds / SingleGrabberSeconds, FuseSeconds * 1000.0, NumFuseFrames, NumFused, NumGrabbers));
+	}
+
+	return true;
+}
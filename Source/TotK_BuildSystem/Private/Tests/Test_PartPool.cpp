@@ -0,0 +1,160 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// To run tests, enter console command - Automation RunTests GrabSystem.PartPool
+// To run the benchmark, enter console command - Automation RunTests GrabSystem.Perf.PartPool
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "UObject/UObjectGlobals.h"
+#include "Tests/BuildSystemTestHelpers.h"
+#include "BuildSystemSubsystem.h"
+#include "MoveableObject_Log.h"
+
+// Register the test
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPartPoolTest,
+	"GrabSystem.PartPool",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+	bool FPartPoolTest::RunTest(const FString& Parameters)
+{
+	BuildSystemTest::FTestWorld TestWorld;
+	UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+	if (!TestNotNull(TEXT("Build system subsystem exists"), BuildSystem)) {
+		return false;
+	}
+
+	TArray<AMoveableObject*> Parts = TestWorld.SpawnRow(3, FVector(0.f, 0.f, 500.f));
+	if (!TestTrue(TEXT("Parts spawned"), !Parts.Contains(nullptr))) {
+		return false;
+	}
+
+	AMoveableObject* A = Parts[0];
+	AMoveableObject* B = Parts[1];
+	AMoveableObject* C = Parts[2];
+
+	// Links only need their objects for the table, so no constraint components are created
+	BuildSystemTest::FTestWorld::FuseParts(Parts);
+	FConstraintLinkTable& LinkTable = BuildSystem->GetLinkTable();
+	LinkTable.Add(nullptr, A, B);
+	LinkTable.Add(nullptr, B, C);
+
+	FPartPool& Pool = BuildSystem->GetPartPool();
+
+	// Test 1: Releasing a fused object takes it out of its group and its links, and parks it out of the world
+	{
+		Pool.Release(C);
+
+		TestTrue(TEXT("Released object is pooled"), C->IsPooled());
+		TestEqual(TEXT("Pool holds the released object"), Pool.NumPooled(AMoveableObject::StaticClass()), 1);
+		TestEqual(TEXT("Released object has no links"), LinkTable.NumObjectLinks(C), 0);
+		TestEqual(TEXT("Released object is left in its own set"), C->FusedObjects.Num(), 1);
+		TestFalse(TEXT("Rest of the group no longer contains the released object"), A->FusedObjects.Contains(C));
+		TestTrue(TEXT("Rest of the group is still fused"), A->FusedObjects.Contains(B) && B->FusedObjects.Contains(A));
+		TestEqual(TEXT("Released object left the part registry"), BuildSystem->GetPartRegistry().GetIndex(C), INDEX_NONE);
+		TestTrue(TEXT("Released object is hidden"), C->IsHidden());
+		TestFalse(TEXT("Released object has no collision"), C->GetActorEnableCollision());
+		TestFalse(TEXT("Released object is not simulating"), C->MeshComponent->IsSimulatingPhysics());
+	}
+
+	// Test 2: Releasing an object twice only pools it once
+	{
+		Pool.Release(C);
+		TestEqual(TEXT("Pool still holds one object"), Pool.NumPooled(AMoveableObject::StaticClass()), 1);
+	}
+
+	// Test 3: Acquiring reuses the pooled object, in place and as its own group, with its components still registered
+	const FTransform NewTransform(FRotator(0.f, 90.f, 0.f), FVector(500.f, 500.f, 500.f));
+	{
+		AMoveableObject* Acquired = Pool.Acquire(TestWorld.World, AMoveableObject::StaticClass(), NewTransform);
+
+		TestEqual(TEXT("Pooled object is reused"), Acquired, C);
+		TestFalse(TEXT("Reused object is no longer pooled"), C->IsPooled());
+		TestEqual(TEXT("Pool is empty"), Pool.NumPooled(AMoveableObject::StaticClass()), 0);
+		TestTrue(TEXT("Reused object is moved into place"), C->GetActorLocation().Equals(NewTransform.GetLocation(), 0.1f));
+		TestTrue(TEXT("Reused object is its own group"), C->FusedObjects.Num() == 1 && C->FusedObjects.Contains(C));
+		TestNotEqual(TEXT("Reused object is back in the part registry"), BuildSystem->GetPartRegistry().GetIndex(C), (int32)INDEX_NONE);
+		TestNotEqual(TEXT("Reused object is in a different group to its old one"), BuildSystem->GetPartRegistry().GetGroupId(C), BuildSystem->GetPartRegistry().GetGroupId(A));
+		TestFalse(TEXT("Reused object is visible"), C->IsHidden());
+		TestTrue(TEXT("Reused object has collision"), C->GetActorEnableCollision());
+		TestTrue(TEXT("Reused object is simulating again"), C->MeshComponent->IsSimulatingPhysics());
+		TestTrue(TEXT("Reused object's components are still registered"), C->MeshComponent->IsRegistered());
+	}
+
+	// Test 4: Pools are kept per class, so acquiring a class with an empty pool spawns a new object
+	{
+		Pool.Release(A);
+		AMoveableObject* Log = Pool.Acquire(TestWorld.World, AMoveableObject_Log::StaticClass(), NewTransform);
+
+		TestNotNull(TEXT("New object is spawned"), Log);
+		TestTrue(TEXT("New object is of the requested class"), Log && Log->IsA<AMoveableObject_Log>());
+		TestEqual(TEXT("Pool of the other class is untouched"), Pool.NumPooled(AMoveableObject::StaticClass()), 1);
+	}
+
+	// Test 5: Destroying a pooled object takes it out of the pool
+	{
+		A->Destroy();
+		TestEqual(TEXT("Destroyed object left the pool"), Pool.NumPooled(AMoveableObject::StaticClass()), 0);
+	}
+
+	return true;
+}
+
+// Register the benchmark
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPartPoolPerfTest,
+	"GrabSystem.Perf.PartPool",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+	bool FPartPoolPerfTest::RunTest(const FString& Parameters)
+{
+	BuildSystemTest::FTestWorld TestWorld;
+	UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+	if (!TestNotNull(TEXT("Build system subsystem exists"), BuildSystem)) {
+		return false;
+	}
+
+	// A dispenser spawning a wave of parts and a cleanup removing them again, repeated a number of times
+	const int32 NumParts = 200;
+	const int32 NumWaves = 10;
+	FPartPool& Pool = BuildSystem->GetPartPool();
+	TArray<AMoveableObject*> Parts;
+
+	for (bool bPooled : { false, true }) {
+		double SpawnSeconds = 0.0;
+		double DespawnSeconds = 0.0;
+		double GCSeconds = 0.0;
+
+		for (int32 Wave = 0; Wave < NumWaves; ++Wave) {
+			double StartTime = FPlatformTime::Seconds();
+			for (int32 i = 0; i < NumParts; ++i) {
+				const FTransform Transform(FVector(i * 200.f, Wave * 200.f, 500.f));
+				Parts.Add(bPooled ? Pool.Acquire(TestWorld.World, AMoveableObject::StaticClass(), Transform) : TestWorld.World->SpawnActor<AMoveableObject>(AMoveableObject::StaticClass(), Transform));
+			}
+			SpawnSeconds += FPlatformTime::Seconds() - StartTime;
+
+			TestWorld.Tick();
+
+			StartTime = FPlatformTime::Seconds();
+			for (AMoveableObject* Part : Parts) {
+				if (bPooled) {
+					Pool.Release(Part);
+				}
+
+				else {
+					Part->Destroy();
+				}
+			}
+			DespawnSeconds += FPlatformTime::Seconds() - StartTime;
+			Parts.Reset();
+
+			StartTime = FPlatformTime::Seconds();
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+			GCSeconds += FPlatformTime::Seconds() - StartTime;
+		}
+
+		const int32 NumSpawned = NumParts * NumWaves;
+		AddInfo(FString::Printf(TEXT("%s: spawn %.1f us per part, despawn %.1f us per part, GC %.3f ms per wave of %d parts"),
+			bPooled ? TEXT("Pooled") : TEXT("Spawn and destroy"), SpawnSeconds * 1e6 / NumSpawned, DespawnSeconds * 1e6 / NumSpawned, GCSeconds * 1000.0 / NumWaves, NumParts));
+	}
+
+	return true;
+}
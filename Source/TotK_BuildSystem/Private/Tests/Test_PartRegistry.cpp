@@ -0,0 +1,144 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// To run tests, enter console command - Automation RunTests GrabSystem.PartRegistry
+// To run the benchmark, enter console command - Automation RunTests GrabSystem.Perf.PartRegistry
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "EngineUtils.h"
+#include "Tests/BuildSystemTestHelpers.h"
+#include "MoveableObjectInterface.h"
+#include "BuildSystemSubsystem.h"
+
+// Register the test
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPartRegistryTest,
+	"GrabSystem.PartRegistry",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+	bool FPartRegistryTest::RunTest(const FString& Parameters)
+{
+	BuildSystemTest::FTestWorld TestWorld;
+	UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+	if (!TestNotNull(TEXT("Build system subsystem exists"), BuildSystem)) {
+		return false;
+	}
+
+	FPartRegistry& Registry = BuildSystem->GetPartRegistry();
+	TArray<AMoveableObject*> Parts = TestWorld.SpawnRow(4, FVector(0.f, 0.f, 500.f), 150.f);
+	if (!TestTrue(TEXT("Parts spawned"), !Parts.Contains(nullptr))) {
+		return false;
+	}
+
+	// Test 1: Every spawned part is registered in its own group
+	{
+		TestEqual(TEXT("Every part is registered"), Registry.Num(), 4);
+
+		TSet<int32> GroupIds;
+		for (AMoveableObject* Part : Parts) {
+			const int32 Index = Registry.GetIndex(Part);
+			TestTrue(TEXT("Part slot points back to the part"), Index != INDEX_NONE && Registry.Parts[Index] == Part);
+			GroupIds.Add(Registry.GetGroupId(Part));
+		}
+		TestEqual(TEXT("Every part starts in its own group"), GroupIds.Num(), 4);
+	}
+
+	// Test 2: Parts fused through a real merge share a group id, and splitting one off through the real split moves it to a group of its own
+	{
+		for (AMoveableObject* Part : Parts) {
+			Part->MeshComponent->SetEnableGravity(false);
+		}
+
+		// Hover for a few frames so the neighbouring part is found, then release and tick until the fuse has merged the two groups
+		IMoveableObjectInterface::Execute_OnGrab(Parts[0]);
+		TestWorld.Tick(3);
+		IMoveableObjectInterface::Execute_OnRelease(Parts[0]);
+		for (int32 Frame = 0; Frame < 240 && BuildSystem->FindSession(Parts[0]) && BuildSystem->FindSession(Parts[0])->bIsFusing; ++Frame) {
+			TestWorld.Tick();
+		}
+		BuildSystem->FinishGroupWork(Parts[0]);
+
+		const int32 MergedGroupId = Registry.GetGroupId(Parts[0]);
+		TestTrue(TEXT("Parts were merged"), Parts[0]->FusedObjects.Contains(Parts[1]));
+		TestEqual(TEXT("Merged parts share a group"), Registry.GetGroupId(Parts[1]), MergedGroupId);
+		TestNotEqual(TEXT("Other parts keep their own group"), Registry.GetGroupId(Parts[2]), MergedGroupId);
+
+		IMoveableObjectInterface::Execute_SplitMoveableObjects(Parts[1]);
+		BuildSystem->FinishGroupWork(Parts[0]);
+		TestNotEqual(TEXT("Split parts are in separate groups"), Registry.GetGroupId(Parts[0]), Registry.GetGroupId(Parts[1]));
+		TestNotEqual(TEXT("Split off part leaves the merged group"), Registry.GetGroupId(Parts[1]), MergedGroupId);
+		TestTrue(TEXT("Split parts are in valid groups"), Registry.GetGroupId(Parts[0]) != INDEX_NONE && Registry.GetGroupId(Parts[1]) != INDEX_NONE);
+	}
+
+	// Test 3: Refreshing copies the part transforms from physics
+	{
+		Parts[3]->SetActorLocation(FVector(0.f, 1000.f, 500.f));
+		Registry.Refresh();
+		TestTrue(TEXT("Registry location follows the part"), Registry.Locations[Registry.GetIndex(Parts[3])].Equals(FVector(0.f, 1000.f, 500.f), 0.1));
+	}
+
+	// Test 4: Removing a part moves the last part into its slot without breaking any other slot
+	{
+		AMoveableObject* Removed = Parts[0];
+		Parts.RemoveAt(0);
+		Removed->Destroy();
+
+		TestEqual(TEXT("Removed part is unregistered"), Registry.Num(), 3);
+		TestEqual(TEXT("Removed part has no slot"), Registry.GetIndex(Removed), (int32)INDEX_NONE);
+		for (AMoveableObject* Part : Parts) {
+			const int32 Index = Registry.GetIndex(Part);
+			TestTrue(TEXT("Remaining slots point back to their parts"), Index != INDEX_NONE && Registry.Parts[Index] == Part);
+		}
+	}
+
+	return true;
+}
+
+// Register the benchmark
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPartRegistryPerfTest,
+	"GrabSystem.Perf.PartRegistry",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+	bool FPartRegistryPerfTest::RunTest(const FString& Parameters)
+{
+	BuildSystemTest::FTestWorld TestWorld;
+	UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+	if (!TestNotNull(TEXT("Build system subsystem exists"), BuildSystem)) {
+		return false;
+	}
+
+	// Spawn a 100 x 100 grid of parts
+	const int32 GridSize = 100;
+	for (int32 Row = 0; Row < GridSize; ++Row) {
+		TestWorld.SpawnRow(GridSize, FVector(0.f, Row * 100.f, 500.f));
+	}
+
+	const FPartRegistry& Registry = BuildSystem->GetPartRegistry();
+	TestEqual(TEXT("Every part is registered"), Registry.Num(), GridSize * GridSize);
+	BuildSystem->GetPartRegistry().Refresh();
+
+	// A typical pass over every part reads its location and velocity, here summed so the work cannot be skipped
+	const double ActorStartTime = FPlatformTime::Seconds();
+	FVector ActorSum = FVector::ZeroVector;
+	for (TActorIterator<AMoveableObject> It(TestWorld.World); It; ++It) {
+		ActorSum += It->GetActorLocation() + It->MeshComponent->GetPhysicsLinearVelocity();
+	}
+	const double ActorSeconds = FPlatformTime::Seconds() - ActorStartTime;
+
+	const double RegistryStartTime = FPlatformTime::Seconds();
+	FVector RegistrySum = FVector::ZeroVector;
+	for (int32 Index = 0; Index < Registry.Num(); ++Index) {
+		RegistrySum += Registry.Locations[Index] + FVector(Registry.LinearVelocities[Index]);
+	}
+	const double RegistrySeconds = FPlatformTime::Seconds() - RegistryStartTime;
+
+	const double RefreshStartTime = FPlatformTime::Seconds();
+	BuildSystem->GetPartRegistry().Refresh();
+	const double RefreshSeconds = FPlatformTime::Seconds() - RefreshStartTime;
+
+	TestTrue(TEXT("Both passes see the same parts"), ActorSum.Equals(RegistrySum, 1.0));
+	AddInfo(FString::Printf(TEXT("Pass over %d parts through actors: %.3f ms"), Registry.Num(), ActorSeconds * 1000.0));
+	AddInfo(FString::Printf(TEXT("Pass over %d parts through the registry: %.3f ms"), Registry.Num(), RegistrySeconds * 1000.0));
+	AddInfo(FString::Printf(TEXT("Refreshing the registry from physics: %.3f ms"), RefreshSeconds * 1000.0));
+
+	return true;
+}
@@ -7,6 +7,10 @@
 #include "Math/Quat.h"
 #include "Math/Rotator.h"
 #include "Math/UnrealMathUtility.h"
+#include "Math/RandomStream.h"
+#include "OrientationLattice.h"
+#include "Grabber.h"
+#include "FuseSession.h"
 
 // Round off the specified pitch, yaw, or roll value
 float CalculateRotation(float CurrRot, float CurrMod)
@@ -124,4 +128,203 @@ IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRotationRoundingTest,
 	}
 
 	return true;
-}
\ No newline at end of file
+}
+
+// Register the exhaustive orientation lattice test
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FOrientationLatticeTest,
+	"GrabSystem.RotationRounding.Lattice",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+	bool FOrientationLatticeTest::RunTest(const FString& Parameters)
+{
+	// Test 1: Quarter turns give the 24 rotations of a cube
+	FOrientationLattice CubeLattice(90.f);
+	TestEqual(TEXT("90 degree lattice has 24 orientations"), CubeLattice.Num(), 24);
+
+	// Test 2: Every orientation is its own nearest orientation, including its negated quaternion
+	FOrientationLattice EighthLattice(45.f);
+	for (const FOrientationLattice* Lattice : { &CubeLattice, &EighthLattice }) {
+		for (int32 Index = 0; Index < Lattice->Num(); ++Index) {
+			const FQuat& Orientation = Lattice->GetOrientation(Index);
+			TestEqual(FString::Printf(TEXT("%.0f degree orientation %d is nearest itself"), Lattice->GetStepDegrees(), Index), Lattice->FindNearest(Orientation), Index);
+			TestEqual(FString::Printf(TEXT("%.0f degree orientation %d is nearest its negation"), Lattice->GetStepDegrees(), Index), Lattice->FindNearest(-Orientation), Index);
+		}
+	}
+
+	// Test 3: At the grabber's default increment, every step from every grabbed orientation rotates by exactly the increment and is undone by the opposite step
+	{
+		const float DefaultStepDegrees = GetDefault<UGrabber>()->RotationDegrees;
+		const FOrientationLattice DefaultLattice(DefaultStepDegrees);
+		TestEqual(TEXT("Default increment is 45 degrees"), DefaultStepDegrees, 45.f);
+		TestEqual(TEXT("Fuse sessions round roll to the grabber's default increment"), FFuseSession().SnapRotationDegrees, DefaultStepDegrees);
+		TestEqual(TEXT("Default lattice is built for the default increment"), DefaultLattice.GetStepDegrees(), DefaultStepDegrees);
+
+		const EOrientationStep InverseSteps[] = { EOrientationStep::Right, EOrientationStep::Left, EOrientationStep::Down, EOrientationStep::Up };
+
+		for (int32 Index = 0; Index < DefaultLattice.Num(); ++Index) {
+			const FQuat& Start = DefaultLattice.GetOrientation(Index);
+			for (int32 Step = 0; Step < (int32)EOrientationStep::Num; ++Step) {
+				const FQuat Next = DefaultLattice.GetStepRotation((EOrientationStep)Step) * Start;
+				const FQuat Back = DefaultLattice.GetStepRotation(InverseSteps[Step]) * Next;
+
+				TestTrue(FString::Printf(TEXT("Step %d from %d rotates by the increment"), Step, Index), FMath::IsNearlyEqual(FMath::RadiansToDegrees(Start.AngularDistance(Next)), DefaultStepDegrees, 0.01f));
+				TestTrue(FString::Printf(TEXT("Step %d from %d is undone by the opposite step"), Step, Index), FMath::Abs(Back | Start) > 1.f - UE_KINDA_SMALL_NUMBER);
+			}
+		}
+	}
+
+	// Test 4: Every cube orientation can be reached from the identity with player rotations
+	{
+		TSet<int32> Reached = { CubeLattice.FindNearest(FQuat::Identity) };
+		TArray<int32> Frontier = Reached.Array();
+		while (Frontier.Num() > 0) {
+			const int32 Index = Frontier.Pop();
+			for (int32 Step = 0; Step < (int32)EOrientationStep::Num; ++Step) {
+				const int32 Next = CubeLattice.GetStep(Index, (EOrientationStep)Step);
+				if (!Reached.Contains(Next)) {
+					Reached.Add(Next);
+					Frontier.Add(Next);
+				}
+			}
+		}
+		TestEqual(TEXT("All 24 cube orientations are reachable"), Reached.Num(), 24);
+	}
+
+	// Test 5: Yaw steps are exact for 45 degrees, so a full turn returns to the start
+	{
+		for (int32 Index = 0; Index < EighthLattice.Num(); ++Index) {
+			int32 Current = Index;
+			for (int32 Step = 0; Step < 8; ++Step) {
+				Current = EighthLattice.GetStep(Current, EOrientationStep::Left);
+			}
+			TestEqual(FString::Printf(TEXT("Eight 45 degree left steps from %d"), Index), Current, Index);
+		}
+	}
+
+	// Test 6: The lattice agrees with the original rounding cases, which were all away from gimbal lock
+	{
+		const float Yaws[] = { 0.0002f, 22.4f, 23.6f, -67.f, -80.f, -147.f, 94.f, 68.f };
+		for (float Yaw : Yaws) {
+			const FQuat Input = FRotator(0.f, Yaw, 0.f).Quaternion();
+			const FQuat Expected = RoundObjectRotation(FRotator(0.f, Yaw, 0.f)).Quaternion();
+			TestTrue(FString::Printf(TEXT("Lattice rounds yaw of %.4f like the Euler rounding"), Yaw), EighthLattice.GetOrientation(EighthLattice.FindNearest(Input)).Equals(Expected, 0.0001f));
+		}
+	}
+
+	// Test 7: Near gimbal lock the lattice rounds to the closest real orientation, where separate pitch, yaw and roll rounding does not
+	{
+		const FRotator NearGimbal(89.f, 20.f, -20.f);
+		const FQuat Input = NearGimbal.Quaternion();
+		const FQuat LatticeResult = EighthLattice.GetOrientation(EighthLattice.FindNearest(Input));
+		const FQuat EulerResult = RoundObjectRotation(NearGimbal).Quaternion();
+		TestTrue(TEXT("Lattice result is within 10 degrees near gimbal lock"), FMath::RadiansToDegrees(LatticeResult.AngularDistance(Input)) < 10.f);
+		TestTrue(TEXT("Euler rounding is over 30 degrees off near gimbal lock"), FMath::RadiansToDegrees(EulerResult.AngularDistance(Input)) > 30.f);
+	}
+
+	// Test 8: An increment that does not divide a full turn falls back to quarter turns, but keeps the increment asked for so grabbing does not rebuild it every time
+	{
+		const FOrientationLattice FallbackLattice(50.f);
+		TestEqual(TEXT("Lattice falls back to quarter turns"), FallbackLattice.GetStepDegrees(), 90.f);
+		TestEqual(TEXT("Lattice keeps the increment asked for"), FallbackLattice.GetRequestedStepDegrees(), 50.f);
+	}
+
+	return true;
+}
+
+// Register the orientation lattice fuzz test
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FOrientationLatticeFuzzTest,
+	"GrabSystem.RotationRounding.Fuzz",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+	bool FOrientationLatticeFuzzTest::RunTest(const FString& Parameters)
+{
+	const int32 NumSamples = 10000;
+	FRandomStream Stream(4242);
+
+	for (float StepDegrees : { 90.f, 45.f }) {
+		FOrientationLattice Lattice(StepDegrees);
+		int32 NumWrong = 0;
+		float WorstAngle = 0.f;
+
+		for (int32 Sample = 0; Sample < NumSamples; ++Sample) {
+			FQuat Random(Stream.FRandRange(-1.f, 1.f), Stream.FRandRange(-1.f, 1.f), Stream.FRandRange(-1.f, 1.f), Stream.FRandRange(-1.f, 1.f));
+			if (Random.SizeSquared() < UE_KINDA_SMALL_NUMBER) continue;
+			Random.Normalize();
+
+			// The nearest lookup must agree with a brute force search over angular distance
+			const int32 Nearest = Lattice.FindNearest(Random);
+			const float NearestAngle = Lattice.GetOrientation(Nearest).AngularDistance(Random);
+			for (int32 Index = 0; Index < Lattice.Num(); ++Index) {
+				if (Lattice.GetOrientation(Index).AngularDistance(Random) < NearestAngle - 0.0001f) {
+					++NumWrong;
+					break;
+				}
+			}
+
+			WorstAngle = FMath::Max(WorstAngle, FMath::RadiansToDegrees(NearestAngle));
+		}
+
+		AddInfo(FString::Printf(TEXT("%.0f degree lattice: %d orientations, worst rounding %.2f degrees"), StepDegrees, Lattice.Num(), WorstAngle));
+		TestEqual(FString::Printf(TEXT("%.0f degree nearest lookup matches brute force"), StepDegrees), NumWrong, 0);
+
+		// No rotation is further from a cube orientation than the cube's covering radius of about 62.8 degrees
+		if (StepDegrees == 90.f) {
+			TestTrue(TEXT("Quarter turn rounding is within the cube covering radius"), WorstAngle <= 63.f);
+		}
+	}
+
+	// Many random player rotations never drift off the lattice
+	{
+		FOrientationLattice Lattice(90.f);
+		int32 Index = Lattice.FindNearest(FQuat::Identity);
+		FQuat Accumulated = FQuat::Identity;
+		const float StepRadians = FMath::DegreesToRadians(90.f);
+		const FQuat StepRotations[] = {
+			FQuat(FVector(0, 0, 1), StepRadians),
+			FQuat(FVector(0, 0, 1), -StepRadians),
+			FQuat(FVector(0, 1, 0), -StepRadians),
+			FQuat(FVector(0, 1, 0), StepRadians),
+		};
+
+		for (int32 Press = 0; Press < 100000; ++Press) {
+			const int32 Step = Stream.RandRange(0, (int32)EOrientationStep::Num - 1);
+			Index = Lattice.GetStep(Index, (EOrientationStep)Step);
+			Accumulated = StepRotations[Step] * Accumulated;
+		}
+
+		Accumulated.Normalize();
+		TestTrue(TEXT("Lattice orientation matches accumulated rotations after 100000 presses"), FMath::RadiansToDegrees(Lattice.GetOrientation(Index).AngularDistance(Accumulated)) < 1.f);
+	}
+
+	// Random 45 degree up, down, left and right presses stay exact, so playing them back in reverse with the opposite steps returns to the start,
+	// even though the orientations in between are not in the lattice
+	{
+		const FOrientationLattice Lattice(45.f);
+		const EOrientationStep InverseSteps[] = { EOrientationStep::Right, EOrientationStep::Left, EOrientationStep::Down, EOrientationStep::Up };
+		const FQuat Start = Lattice.GetOrientation(Stream.RandRange(0, Lattice.Num() - 1));
+		FQuat Current = Start;
+		TArray<int32> Presses;
+
+		for (int32 Press = 0; Press < 10000; ++Press) {
+			const int32 Step = Stream.RandRange(0, (int32)EOrientationStep::Num - 1);
+			Current = Lattice.GetStepRotation((EOrientationStep)Step) * Current;
+			Current.Normalize();
+			Presses.Add(Step);
+		}
+
+		int32 NumInexact = 0;
+		for (int32 Press = Presses.Num() - 1; Press >= 0; --Press) {
+			const FQuat Previous = Current;
+			Current = Lattice.GetStepRotation(InverseSteps[Presses[Press]]) * Current;
+			Current.Normalize();
+			if (!FMath::IsNearlyEqual(FMath::RadiansToDegrees(Previous.AngularDistance(Current)), 45.f, 0.01f)) {
+				++NumInexact;
+			}
+		}
+
+		TestEqual(TEXT("Every undone 45 degree press rotates by exactly 45 degrees"), NumInexact, 0);
+		TestTrue(TEXT("Undoing 10000 45 degree presses returns to the start"), FMath::RadiansToDegrees(Start.AngularDistance(Current)) < 0.01f);
+	}
+
+	return true;
+}
@@ -0,0 +1,199 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// To run tests, enter console command - Automation RunTests GrabSystem.Significance
+// To run the benchmark, enter console command - Automation RunTests GrabSystem.Perf.Significance
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/IConsoleManager.h"
+#include "Tests/BuildSystemTestHelpers.h"
+#include "BuildSystemSubsystem.h"
+
+namespace
+{
+	// Turn significance based fidelity on or off
+	void SetSignificance(bool bEnabled)
+	{
+		if (IConsoleVariable* Significance = IConsoleManager::Get().FindConsoleVariable(TEXT("BuildSystem.Significance"))) {
+			Significance->Set(bEnabled, ECVF_SetByCode);
+		}
+	}
+
+	// Spawn a group floating without gravity, so it settles and sleeps straight away
+	TArray<AMoveableObject*> SpawnIdleGroup(BuildSystemTest::FTestWorld& TestWorld, int32 NumParts, const FVector& Start)
+	{
+		TArray<AMoveableObject*> Group = TestWorld.SpawnRow(NumParts, Start);
+		if (Group.Contains(nullptr)) return Group;
+
+		BuildSystemTest::FTestWorld::FuseParts(Group);
+		for (AMoveableObject* Part : Group) {
+			Part->MeshComponent->SetEnableGravity(false);
+		}
+		return Group;
+	}
+
+	// Check if every part in a group has been dropped to low fidelity
+	bool IsGroupReduced(const TArray<AMoveableObject*>& Group)
+	{
+		return !Group.ContainsByPredicate([](const AMoveableObject* Part) { return !Part->IsReducedFidelity(); });
+	}
+
+	// Check if every part in a group is at full fidelity
+	bool IsGroupFull(const TArray<AMoveableObject*>& Group)
+	{
+		return !Group.ContainsByPredicate([](const AMoveableObject* Part) { return Part->IsReducedFidelity(); });
+	}
+}
+
+// Register the test
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSignificanceTest,
+	"GrabSystem.Significance",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+	bool FSignificanceTest::RunTest(const FString& Parameters)
+{
+	BuildSystemTest::FTestWorld TestWorld;
+	UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+	if (!TestNotNull(TEXT("Build system subsystem exists"), BuildSystem)) {
+		return false;
+	}
+
+	// One group next to the viewer and one 100m away, both left to settle and sleep
+	TArray<AMoveableObject*> NearGroup = SpawnIdleGroup(TestWorld, 3, FVector(0.f, 0.f, 500.f));
+	TArray<AMoveableObject*> FarGroup = SpawnIdleGroup(TestWorld, 3, FVector(10000.f, 0.f, 500.f));
+	if (!TestTrue(TEXT("Parts spawned"), !NearGroup.Contains(nullptr) && !FarGroup.Contains(nullptr))) {
+		return false;
+	}
+
+	SetSignificance(true);
+	BuildSystem->WakeGroup(NearGroup[0]);
+	BuildSystem->WakeGroup(FarGroup[0]);
+	TestWorld.Tick(40);
+
+	// Test 1: Without any viewers every group stays at full fidelity
+	{
+		TestTrue(TEXT("Near group is at full fidelity"), IsGroupFull(NearGroup));
+		TestTrue(TEXT("Far group is at full fidelity"), IsGroupFull(FarGroup));
+	}
+
+	// Test 2: Idle groups far from the viewer lose their fuse box and tick, groups near the viewer keep them
+	const FVector ViewerAtNearGroup(0.f, 0.f, 500.f);
+	BuildSystem->SetVirtualViewers(MakeArrayView(&ViewerAtNearGroup, 1));
+	TestWorld.Tick(1);
+	{
+		TestTrue(TEXT("Near group is at full fidelity"), IsGroupFull(NearGroup));
+		TestTrue(TEXT("Far group is reduced"), IsGroupReduced(FarGroup));
+
+		UBoxComponent* FuseBox = FarGroup[0]->FindComponentByClass<UBoxComponent>();
+		TestEqual(TEXT("Far fuse box has no collision"), FuseBox->GetCollisionEnabled(), ECollisionEnabled::NoCollision);
+		TestFalse(TEXT("Far fuse box generates no overlaps"), FuseBox->GetGenerateOverlapEvents());
+		TestEqual(TEXT("Far mesh only collides for physics"), FarGroup[0]->MeshComponent->GetCollisionEnabled(), ECollisionEnabled::PhysicsOnly);
+	}
+
+	// Test 3: Groups return to full fidelity as the viewer approaches, with their original settings
+	const FVector ViewerAtFarGroup(10000.f, 0.f, 500.f);
+	BuildSystem->SetVirtualViewers(MakeArrayView(&ViewerAtFarGroup, 1));
+	TestWorld.Tick(1);
+	{
+		TestTrue(TEXT("Far group is back at full fidelity"), IsGroupFull(FarGroup));
+		TestTrue(TEXT("Near group is now reduced"), IsGroupReduced(NearGroup));
+
+		UBoxComponent* FuseBox = FarGroup[0]->FindComponentByClass<UBoxComponent>();
+		TestEqual(TEXT("Far fuse box collision is restored"), FuseBox->GetCollisionEnabled(), ECollisionEnabled::QueryOnly);
+		TestTrue(TEXT("Far fuse box overlaps are restored"), FuseBox->GetGenerateOverlapEvents());
+		TestEqual(TEXT("Far mesh collision is restored"), FarGroup[0]->MeshComponent->GetCollisionEnabled(), ECollisionEnabled::QueryAndPhysics);
+	}
+
+	// Test 4: A reduced group just inside the reduce distance stays reduced until the viewer passes the hysteresis band
+	const FVector ViewerInsideBand(4900.f, 0.f, 500.f);
+	BuildSystem->SetVirtualViewers(MakeArrayView(&ViewerInsideBand, 1));
+	TestWorld.Tick(1);
+	{
+		TestTrue(TEXT("Near group stays reduced inside the hysteresis band"), IsGroupReduced(NearGroup));
+	}
+
+	// Test 5: Waking a reduced group returns every member to full fidelity, however far away it is
+	{
+		BuildSystem->WakeGroup(NearGroup[1]);
+		TestWorld.Tick(1);
+		TestTrue(TEXT("Woken group is at full fidelity"), IsGroupFull(NearGroup));
+	}
+
+	// Test 6: Objects only tick while debug drawing is on, and turning it back on after spawning starts them ticking again
+	{
+		AMoveableObject* Part = NearGroup[0];
+		TestFalse(TEXT("Object without debug drawing does not tick"), Part->IsActorTickEnabled());
+
+		Part->SetDebugMode(true);
+		TestWorld.Tick(1);
+		TestTrue(TEXT("Turning debug drawing on starts the object ticking"), Part->IsActorTickEnabled());
+
+		Part->SetDebugMode(false);
+		TestFalse(TEXT("Turning debug drawing off stops the object ticking"), Part->IsActorTickEnabled());
+	}
+
+	BuildSystem->SetVirtualViewers({});
+	return true;
+}
+
+// Register the benchmark
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSignificancePerfTest,
+	"GrabSystem.Perf.Significance",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+	bool FSignificancePerfTest::RunTest(const FString& Parameters)
+{
+	BuildSystemTest::FTestWorld TestWorld;
+	UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+	if (!TestNotNull(TEXT("Build system subsystem exists"), BuildSystem)) {
+		return false;
+	}
+
+	// A sparse 16 by 16 grid of idle 4 part groups spread over 1.5km, left to settle and sleep
+	const int32 GridSize = 16;
+	const float GridSpacing = 10000.f;
+	for (int32 X = 0; X < GridSize; ++X) {
+		for (int32 Y = 0; Y < GridSize; ++Y) {
+			TArray<AMoveableObject*> Group = SpawnIdleGroup(TestWorld, 4, FVector(X * GridSpacing, Y * GridSpacing, 500.f));
+			if (Group.Contains(nullptr)) {
+				AddError(TEXT("Parts failed to spawn"));
+				return false;
+			}
+			BuildSystem->WakeGroup(Group[0]);
+		}
+	}
+	TestWorld.Tick(40);
+
+	// A virtual viewer flies diagonally across the grid, measured with significance off and on
+	const int32 NumFrames = 300;
+	const FVector FlightStart(0.f, 0.f, 500.f);
+	const FVector FlightEnd((GridSize - 1) * GridSpacing, (GridSize - 1) * GridSpacing, 500.f);
+
+	double FullFidelitySeconds = 0.0;
+	for (bool bSignificance : { false, true }) {
+		SetSignificance(bSignificance);
+
+		int32 NumReducedFrames = 0;
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame) {
+			const FVector Viewer = FMath::Lerp(FlightStart, FlightEnd, (float)Frame / (NumFrames - 1));
+			BuildSystem->SetVirtualViewers(MakeArrayView(&Viewer, 1));
+			TestWorld.Tick();
+
+			const FPartRegistry& Registry = BuildSystem->GetPartRegistry();
+			for (int32 Index = 0; Index < Registry.Num(); ++Index) {
+				NumReducedFrames += EnumHasAnyFlags(Registry.Flags[Index], EPartFlags::Reduced) ? 1 : 0;
+			}
+		}
+		const double Seconds = (FPlatformTime::Seconds() - StartTime) / NumFrames;
+
+		if (!bSignificance) {
+			FullFidelitySeconds = Seconds;
+		}
+		AddInfo(FString::Printf(TEXT("World tick with significance %s: %.3f ms (%.2fx), %.0f of %d parts reduced on average"),
+			bSignificance ? TEXT("on") : TEXT("off"), Seconds * 1000.0, FullFidelitySeconds / Seconds, (double)NumReducedFrames / NumFrames, BuildSystem->GetPartRegistry().Num()));
+	}
+
+	BuildSystem->SetVirtualViewers({});
+	return true;
+}
@@ -0,0 +1,125 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// To run tests, enter console command - Automation RunTests GrabSystem.SnapAlignment
+
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "Tests/BuildSystemTestHelpers.h"
+#include "BuildSystemMath.h"
+#include "SnapPointComponent.h"
+
+namespace
+{
+	// Moveable object blueprints that place snap points
+	const TCHAR* const SnapBlueprintPaths[] = {
+		TEXT("/Game/BluePrints/BP_MoveableObject.BP_MoveableObject_C"),
+		TEXT("/Game/BluePrints/BP_MoveableObjectBeam.BP_MoveableObjectBeam_C"),
+		TEXT("/Game/BluePrints/BP_MoveableObjectBoard.BP_MoveableObjectBoard_C"),
+		TEXT("/Game/BluePrints/BP_MoveableObjectLog.BP_MoveableObjectLog_C"),
+		TEXT("/Game/BluePrints/BP_MoveableObjectWheel.BP_MoveableObjectWheel_C"),
+	};
+
+	// Spawn one of every moveable object blueprint with a random rotation, returning those that have snap points
+	TArray<AMoveableObject*> SpawnSnapObjects(BuildSystemTest::FTestWorld& TestWorld, FRandomStream& Stream, const FVector& Start)
+	{
+		TArray<AMoveableObject*> Objects;
+		for (const TCHAR* Path : SnapBlueprintPaths) {
+			UClass* Class = LoadClass<AMoveableObject>(nullptr, Path);
+			if (!Class) continue;
+
+			const FRotator Rotation(Stream.FRandRange(-180.f, 180.f), Stream.FRandRange(-180.f, 180.f), Stream.FRandRange(-180.f, 180.f));
+			AMoveableObject* Object = TestWorld.World->SpawnActor<AMoveableObject>(Class, Start + FVector(Objects.Num() * 500.f, 0.f, 0.f), Rotation);
+			if (Object && Object->FindComponentByClass<USnapPointComponent>()) {
+				Object->MeshComponent->SetSimulatePhysics(false);
+				Objects.Add(Object);
+			}
+		}
+		return Objects;
+	}
+
+	// Check if two snap points can be fused together, from either side's compatible types
+	bool AreCompatible(const USnapPointComponent* HeldSnapPoint, const USnapPointComponent* OtherSnapPoint)
+	{
+		return HeldSnapPoint->CompatableSnapTypes.Contains(OtherSnapPoint->SnapType) || OtherSnapPoint->CompatableSnapTypes.Contains(HeldSnapPoint->SnapType);
+	}
+}
+
+// Register the test
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSnapAlignmentTest,
+	"GrabSystem.SnapAlignment",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+	bool FSnapAlignmentTest::RunTest(const FString& Parameters)
+{
+	const float RollStepDegrees = 45.f;
+	FRandomStream Stream(2024);
+
+	// Two randomly rotated copies of every blueprint, so each snap point can be fused onto a snap point of another object
+	BuildSystemTest::FTestWorld TestWorld;
+	TArray<AMoveableObject*> HeldObjects = SpawnSnapObjects(TestWorld, Stream, FVector(0.f, 0.f, 500.f));
+	TArray<AMoveableObject*> OtherObjects = SpawnSnapObjects(TestWorld, Stream, FVector(0.f, 1000.f, 500.f));
+	if (!TestTrue(TEXT("Blueprints with snap points loaded"), HeldObjects.Num() > 0 && OtherObjects.Num() > 0)) {
+		return false;
+	}
+
+	// Test every compatible pairing of real snap points, from the transforms their blueprints place them at
+	int32 NumPairs = 0;
+	for (AMoveableObject* HeldObject : HeldObjects) {
+		TArray<USnapPointComponent*> HeldSnapPoints;
+		HeldObject->GetComponents<USnapPointComponent>(HeldSnapPoints);
+
+		for (AMoveableObject* OtherObject : OtherObjects) {
+			TArray<USnapPointComponent*> OtherSnapPoints;
+			OtherObject->GetComponents<USnapPointComponent>(OtherSnapPoints);
+
+			for (USnapPointComponent* HeldSnapPoint : HeldSnapPoints) {
+				for (USnapPointComponent* OtherSnapPoint : OtherSnapPoints) {
+					if (!AreCompatible(HeldSnapPoint, OtherSnapPoint)) continue;
+					++NumPairs;
+
+					const FString Pairing = FString::Printf(TEXT("%s.%s -> %s.%s"), *HeldObject->GetClass()->GetName(), *HeldSnapPoint->GetName(), *OtherObject->GetClass()->GetName(), *OtherSnapPoint->GetName());
+
+					// Snap frames leave out scale so it stays with each object, as when a fuse is released
+					const FTransform HeldActor = HeldObject->GetActorTransform();
+					const FTransform HeldSnap(HeldSnapPoint->GetComponentQuat(), HeldSnapPoint->GetComponentLocation());
+					const FTransform OtherSnap(OtherSnapPoint->GetComponentQuat(), OtherSnapPoint->GetComponentLocation());
+
+					// Get the closed form result, then move the held object along with it
+					const FTransform AlignedSnap = BuildSystemMath::GetAlignedSnapTransform(HeldSnap, OtherSnap, RollStepDegrees);
+					const FTransform NewHeldActor = BuildSystemMath::GetGroupMemberTransform(HeldActor, HeldSnap, AlignedSnap);
+					const FTransform NewHeldSnap = HeldSnap.GetRelativeTransform(HeldActor) * NewHeldActor;
+
+					// The held snap point lands on the other snap point
+					TestTrue(FString::Printf(TEXT("%s: snap locations match"), *Pairing), NewHeldSnap.GetLocation().Equals(OtherSnap.GetLocation(), 0.01));
+
+					// The held snap point faces into the other snap point
+					TestTrue(FString::Printf(TEXT("%s: forwards are opposed"), *Pairing), NewHeldSnap.GetRotation().GetForwardVector().Equals(-OtherSnap.GetRotation().GetForwardVector(), 0.001));
+
+					// The roll between the snap points is a multiple of the rotation increment
+					const FQuat FacingRotation = OtherSnap.GetRotation() * FQuat(FVector::UpVector, UE_DOUBLE_PI);
+					const double RollDegrees = FMath::RadiansToDegrees((FacingRotation.Inverse() * NewHeldSnap.GetRotation()).GetTwistAngle(FVector::ForwardVector));
+					const double RollRemainder = FMath::Abs(RollDegrees - FMath::RoundToDouble(RollDegrees / RollStepDegrees) * RollStepDegrees);
+					TestTrue(FString::Printf(TEXT("%s: roll is snapped to %.0f degrees"), *Pairing, RollStepDegrees), RollRemainder < 0.01);
+
+					// Aligning an already aligned snap point changes nothing
+					const FTransform RealignedSnap = BuildSystemMath::GetAlignedSnapTransform(NewHeldSnap, OtherSnap, RollStepDegrees);
+					TestTrue(FString::Printf(TEXT("%s: alignment is stable"), *Pairing), RealignedSnap.GetRotation().Equals(NewHeldSnap.GetRotation(), 0.001));
+				}
+			}
+		}
+	}
+
+	AddInfo(FString::Printf(TEXT("Compatible snap point pairs tested: %d"), NumPairs));
+	TestTrue(TEXT("Blueprints have compatible snap points"), NumPairs > 0);
+
+	// Roll is rounded to the nearest increment rather than reset
+	{
+		const FTransform OtherSnap(FQuat::Identity, FVector::ZeroVector);
+		const FQuat FacingRotation(FVector::UpVector, UE_DOUBLE_PI);
+		const FTransform HeldSnap(FacingRotation * FQuat(FVector::ForwardVector, FMath::DegreesToRadians(100.f)), FVector(10.f, 0.f, 0.f));
+		const FQuat Expected = FacingRotation * FQuat(FVector::ForwardVector, FMath::DegreesToRadians(90.f));
+		TestTrue(TEXT("Roll of 100 degrees rounds to 90 degrees"), BuildSystemMath::GetAlignedSnapRotation(HeldSnap.GetRotation(), OtherSnap.GetRotation(), 45.f).Equals(Expected, 0.001));
+	}
+
+	return true;
+}
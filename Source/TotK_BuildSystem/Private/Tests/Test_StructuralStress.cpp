@@ -0,0 +1,279 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// To run tests, enter console command - Automation RunTests GrabSystem.StructuralStress
+// To run the benchmark, enter console command - Automation RunTests GrabSystem.Perf.StructuralStress
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/IConsoleManager.h"
+#include "Tests/BuildSystemTestHelpers.h"
+#include "BuildSystemSubsystem.h"
+#include "StructuralStress.h"
+
+namespace
+{
+	// Turn the structural model on or off, along with the load links break at and the parts snapshot each evaluation
+	void SetStructuralStress(bool bEnabled, float BreakLoad, int32 MaxParts = 2048)
+	{
+		if (IConsoleVariable* StructuralStress = IConsoleManager::Get().FindConsoleVariable(TEXT("BuildSystem.StructuralStress"))) {
+			StructuralStress->Set(bEnabled, ECVF_SetByCode);
+		}
+
+		if (IConsoleVariable* StressBreakLoad = IConsoleManager::Get().FindConsoleVariable(TEXT("BuildSystem.StructuralStressBreakLoad"))) {
+			StressBreakLoad->Set(BreakLoad, ECVF_SetByCode);
+		}
+
+		if (IConsoleVariable* StressMaxParts = IConsoleManager::Get().FindConsoleVariable(TEXT("BuildSystem.StructuralStressMaxParts"))) {
+			StressMaxParts->Set(MaxParts, ECVF_SetByCode);
+		}
+	}
+
+	// Put the defaults back
+	void ResetStructuralStress()
+	{
+		SetStructuralStress(false, 20000.f);
+	}
+
+	// Build a snapshot of a single group from part locations, a unit mass each, with a link between each neighbouring pair and only the first part supported
+	FStressSnapshot MakeChainSnapshot(const TArray<FVector>& Locations)
+	{
+		FStressSnapshot Snapshot;
+		for (int32 i = 0; i < Locations.Num(); ++i) {
+			FStressSnapshot::FPart& Part = Snapshot.Parts.AddDefaulted_GetRef();
+			Part.Location = Locations[i];
+			Part.Mass = 1.f;
+			Part.bSupported = i == 0;
+
+			if (i > 0) {
+				Snapshot.Links.Add({ FConstraintLinkHandle(), i - 1, i });
+			}
+		}
+
+		FStressSnapshot::FGroup& Group = Snapshot.Groups.AddDefaulted_GetRef();
+		Group.NumParts = Snapshot.Parts.Num();
+		Group.NumLinks = Snapshot.Links.Num();
+		return Snapshot;
+	}
+
+	// Spawn a tower of parts fused into a single group, with a link between each part and the one below and the bottom part held in place.
+	// Gravity is turned off so the tower stands without a floor, the model takes each part's weight from its mass either way
+	TArray<AMoveableObject*> SpawnTower(BuildSystemTest::FTestWorld& TestWorld, int32 NumParts, const FVector& Base, TArray<FConstraintLinkHandle>& OutLinks)
+	{
+		TArray<AMoveableObject*> Parts;
+		for (int32 i = 0; i < NumParts; ++i) {
+			Parts.Add(TestWorld.SpawnPart(Base + FVector(0.f, 0.f, i * 100.f)));
+		}
+		if (Parts.Contains(nullptr)) return Parts;
+
+		BuildSystemTest::FTestWorld::FuseParts(Parts);
+		for (AMoveableObject* Part : Parts) {
+			Part->MeshComponent->SetEnableGravity(false);
+		}
+		Parts[0]->MeshComponent->SetSimulatePhysics(false);
+
+		// Links only need their objects for the table, so no constraint components are created
+		FConstraintLinkTable& LinkTable = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>()->GetLinkTable();
+		OutLinks.Reset();
+		for (int32 i = 1; i < Parts.Num(); ++i) {
+			OutLinks.Add(LinkTable.Add(nullptr, Parts[i - 1], Parts[i]));
+		}
+		return Parts;
+	}
+
+	// Tick the world until the stress of a link has been published, returning whether it was
+	bool TickUntilPublished(BuildSystemTest::FTestWorld& TestWorld, const FStructuralStress& StructuralStress, FConstraintLinkHandle Handle)
+	{
+		for (int32 Frame = 0; Frame < 60 && StructuralStress.GetLinkStress(Handle) <= 0.f; ++Frame) {
+			TestWorld.Tick();
+		}
+		return StructuralStress.GetLinkStress(Handle) > 0.f;
+	}
+}
+
+// Register the test
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStructuralStressTest,
+	"GrabSystem.StructuralStress",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+	bool FStructuralStressTest::RunTest(const FString& Parameters)
+{
+	// Test 1: Each link of a tower carries the weight of every part above it
+	{
+		const FStressSnapshot Snapshot = MakeChainSnapshot({ FVector(0.f, 0.f, 0.f), FVector(0.f, 0.f, 100.f), FVector(0.f, 0.f, 200.f), FVector(0.f, 0.f, 300.f) });
+		TArray<float> LinkStress;
+		FStructuralStress::Solve(Snapshot, 100.f, LinkStress);
+
+		TestEqual(TEXT("Bottom link carries three parts"), LinkStress[0], 3.f);
+		TestEqual(TEXT("Middle link carries two parts"), LinkStress[1], 2.f);
+		TestEqual(TEXT("Top link carries one part"), LinkStress[2], 1.f);
+	}
+
+	// Test 2: An overhang adds the bending moment of the weight beyond each link
+	{
+		const FStressSnapshot Snapshot = MakeChainSnapshot({ FVector(0.f, 0.f, 0.f), FVector(100.f, 0.f, 0.f), FVector(200.f, 0.f, 0.f) });
+		TArray<float> LinkStress;
+		FStructuralStress::Solve(Snapshot, 100.f, LinkStress);
+
+		// The root carries two parts, plus one part at 100 cm and one at 200 cm of lever
+		TestEqual(TEXT("Root of the overhang carries its weight and moment"), LinkStress[0], 5.f);
+		TestEqual(TEXT("Tip of the overhang carries its weight and moment"), LinkStress[1], 2.f);
+	}
+
+	// Test 3: A group with nothing under it carries nothing, and loads take the fewest links down to a support
+	{
+		FStressSnapshot Snapshot = MakeChainSnapshot({ FVector(0.f, 0.f, 0.f), FVector(0.f, 0.f, 100.f), FVector(0.f, 0.f, 200.f) });
+		Snapshot.Parts[0].bSupported = false;
+
+		TArray<float> LinkStress;
+		FStructuralStress::Solve(Snapshot, 100.f, LinkStress);
+		TestTrue(TEXT("Unsupported group carries nothing"), LinkStress[0] == 0.f && LinkStress[1] == 0.f);
+
+		Snapshot.Parts[2].bSupported = true;
+		FStructuralStress::Solve(Snapshot, 100.f, LinkStress);
+		TestEqual(TEXT("Hanging part's load goes up to the support above it"), LinkStress[0], 1.f);
+		TestEqual(TEXT("Link to the support carries both parts below it"), LinkStress[1], 2.f);
+	}
+
+	BuildSystemTest::FTestWorld TestWorld;
+	UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+	if (!TestNotNull(TEXT("Build system subsystem exists"), BuildSystem)) {
+		return false;
+	}
+
+	TArray<FConstraintLinkHandle> Links;
+	TArray<AMoveableObject*> Parts = SpawnTower(TestWorld, 5, FVector(0.f, 0.f, 500.f), Links);
+	if (!TestTrue(TEXT("Parts spawned"), !Parts.Contains(nullptr))) {
+		return false;
+	}
+
+	const FStructuralStress& StructuralStress = BuildSystem->GetStructuralStress();
+
+	// Test 4: In a world, stress is published a frame or more later, more at the bottom of the tower than the top
+	{
+		SetStructuralStress(true, 0.f);
+		if (!TestTrue(TEXT("Stress is published"), TickUntilPublished(TestWorld, StructuralStress, Links[0]))) {
+			ResetStructuralStress();
+			return false;
+		}
+
+		TestTrue(TEXT("Bottom link carries more than the top link"), StructuralStress.GetLinkStress(Links[0]) > StructuralStress.GetLinkStress(Links.Last()));
+		TestEqual(TEXT("Links stay whole without a break load"), BuildSystem->GetLinkTable().Num(), Links.Num());
+	}
+
+	// Test 5: A break load between the bottom and second links breaks only the bottom link, leaving the bottom part on its own
+	{
+		const float BreakLoad = (StructuralStress.GetLinkStress(Links[0]) + StructuralStress.GetLinkStress(Links[1])) * 0.5f;
+		SetStructuralStress(true, BreakLoad);
+		BuildSystem->GetStructuralStress().Reset();
+
+		for (int32 Frame = 0; Frame < 60 && BuildSystem->GetLinkTable().Find(Links[0]); ++Frame) {
+			TestWorld.Tick();
+		}
+		BuildSystem->FinishGroupWork(Parts[1]);
+
+		TestNull(TEXT("Bottom link is broken"), BuildSystem->GetLinkTable().Find(Links[0]));
+		TestEqual(TEXT("Other links are whole"), BuildSystem->GetLinkTable().Num(), Links.Num() - 1);
+		TestEqual(TEXT("Broken link has no stress"), StructuralStress.GetLinkStress(Links[0]), 0.f);
+		TestNotEqual(TEXT("Bottom part is a group of its own"), BuildSystem->GetPartRegistry().GetGroupId(Parts[0]), BuildSystem->GetPartRegistry().GetGroupId(Parts[1]));
+		TestEqual(TEXT("Rest of the tower is still one group"), Parts[1]->FusedObjects.Num(), Parts.Num() - 1);
+
+		// The rest of the tower has nothing under it, so nothing else breaks
+		TestWorld.Tick(10);
+		TestEqual(TEXT("Nothing else breaks"), BuildSystem->GetLinkTable().Num(), Links.Num() - 1);
+	}
+
+	ResetStructuralStress();
+	return true;
+}
+
+// Register the benchmark
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStructuralStressPerfTest,
+	"GrabSystem.Perf.StructuralStress",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+	bool FStructuralStressPerfTest::RunTest(const FString& Parameters)
+{
+	// Evaluate a 500 part tower from scratch, then with nothing changed, then after a link in the middle breaks, timing the game thread and the worker separately
+	const int32 NumParts = 500;
+	const int32 NumIdleFrames = 100;
+
+	BuildSystemTest::FTestWorld TestWorld;
+	UBuildSystemSubsystem* BuildSystem = TestWorld.World->GetSubsystem<UBuildSystemSubsystem>();
+	if (!TestNotNull(TEXT("Build system subsystem exists"), BuildSystem)) {
+		return false;
+	}
+
+	TArray<FConstraintLinkHandle> Links;
+	TArray<AMoveableObject*> Parts = SpawnTower(TestWorld, NumParts, FVector(0.f, 0.f, 500.f), Links);
+	if (Parts.Contains(nullptr)) {
+		AddError(TEXT("Parts failed to spawn"));
+		return false;
+	}
+
+	// Let the tower settle and fall asleep, so only changes to it are evaluated again
+	SetStructuralStress(true, 0.f);
+	TestWorld.Tick(60);
+
+	const FPartRegistry& Registry = BuildSystem->GetPartRegistry();
+	auto IsTowerAsleep = [&Registry, &Parts]() {
+		return Parts.FindByPredicate([&Registry](const AMoveableObject* Part) { return !EnumHasAnyFlags(Registry.Flags[Registry.GetIndex(Part)], EPartFlags::Asleep); }) == nullptr;
+	};
+	for (int32 Frame = 0; Frame < 600 && !IsTowerAsleep(); ++Frame) {
+		TestWorld.Tick();
+	}
+	TestTrue(TEXT("Tower falls asleep"), IsTowerAsleep());
+
+	FStructuralStress& StructuralStress = BuildSystem->GetStructuralStress();
+
+	// Time the snapshot on the game thread and the solve on the worker, waiting on it here rather than a frame later
+	auto TimeEvaluation = [BuildSystem, &StructuralStress](double& OutCaptureSeconds, double& OutSolveSeconds) {
+		const double CaptureStartTime = FPlatformTime::Seconds();
+		StructuralStress.Update(*BuildSystem);
+		OutCaptureSeconds = FPlatformTime::Seconds() - CaptureStartTime;
+
+		const double SolveStartTime = FPlatformTime::Seconds();
+		StructuralStress.WaitForEvaluation();
+		OutSolveSeconds = FPlatformTime::Seconds() - SolveStartTime;
+
+		// Publishes the result, and snapshots anything still waiting
+		StructuralStress.Update(*BuildSystem);
+		StructuralStress.WaitForEvaluation();
+	};
+
+	// Full evaluation of the tower from scratch
+	double CaptureSeconds = 0.0;
+	double SolveSeconds = 0.0;
+	StructuralStress.Reset();
+	TimeEvaluation(CaptureSeconds, SolveSeconds);
+	const int32 NumFullParts = StructuralStress.NumSnapshotParts();
+	TestTrue(TEXT("Bottom link carries the tower"), StructuralStress.GetLinkStress(Links[0]) > StructuralStress.GetLinkStress(Links.Last()));
+	AddInfo(FString::Printf(TEXT("Full evaluation of a %d part tower: capture %.3f ms on the game thread, solve %.3f ms on a worker"), NumParts, CaptureSeconds * 1000.0, SolveSeconds * 1000.0));
+
+	// With nothing changed, an update only checks whether any group has changed, and the sleeping tower is never snapshot again
+	bool bSnapshotTaken = false;
+	const double IdleStartTime = FPlatformTime::Seconds();
+	for (int32 Frame = 0; Frame < NumIdleFrames; ++Frame) {
+		StructuralStress.Update(*BuildSystem);
+		bSnapshotTaken |= StructuralStress.IsBusy() || StructuralStress.NumSnapshotParts() > 0;
+	}
+	const double IdleSeconds = (FPlatformTime::Seconds() - IdleStartTime) / NumIdleFrames;
+	TestFalse(TEXT("Unchanged sleeping tower takes no snapshot"), bSnapshotTaken);
+	AddInfo(FString::Printf(TEXT("Update with nothing changed: %.4f ms"), IdleSeconds * 1000.0));
+
+	// Breaking a link in the middle leaves two groups, which are evaluated again
+	Parts[NumParts / 2]->BreakLink(Links[NumParts / 2 - 1]);
+	BuildSystem->FinishGroupWork(Parts[0]);
+	TimeEvaluation(CaptureSeconds, SolveSeconds);
+	AddInfo(FString::Printf(TEXT("Evaluation after a break: %d of %d parts evaluated, capture %.3f ms, solve %.3f ms"),
+		StructuralStress.NumSnapshotParts(), NumFullParts, CaptureSeconds * 1000.0, SolveSeconds * 1000.0));
+
+	// A budget smaller than the tower still evaluates it, one group per evaluation
+	SetStructuralStress(true, 0.f, 64);
+	StructuralStress.Reset();
+	TimeEvaluation(CaptureSeconds, SolveSeconds);
+	AddInfo(FString::Printf(TEXT("Evaluation with a 64 part budget: %d parts evaluated, capture %.3f ms, solve %.3f ms"),
+		StructuralStress.NumSnapshotParts(), CaptureSeconds * 1000.0, SolveSeconds * 1000.0));
+
+	ResetStructuralStress();
+	return true;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tasks/Task.h"
+#include "CollisionProxy.h"
+
+class AMoveableObject;
+class USnapPointComponent;
+
+// Snapshot of a part taken on the game thread, holding everything snap resolution needs so it can run without touching the part
+struct FSnapPartSnapshot
+{
+	// Take a snapshot of a part's transform, collision proxy and snap point locations
+	void Capture(AMoveableObject* InPart);
+
+	// Get the closest point to a world point on the part's collision proxy, or the point itself if it is inside it
+	FVector GetClosestPointOnCollision(const FVector& Point) const;
+
+	// Part the snapshot was taken from, only compared and handed back to the game thread, never read from other threads
+	AMoveableObject* Part = nullptr;
+
+	// Actor transform of the part
+	FTransform Transform = FTransform::Identity;
+
+	// Collision proxy of the part, which is immutable and so safe to read from any thread
+	TSharedPtr<const FCollisionProxy, ESPMode::ThreadSafe> CollisionProxy;
+
+	// Snap points of the part and their world locations
+	TArray<USnapPointComponent*, TInlineAllocator<16>> SnapPoints;
+	TArray<FVector, TInlineAllocator<16>> SnapLocations;
+};
+
+// Snap points found for a held and nearby part, along with the collision points used when either has no snap point in range
+struct FSnapResolution
+{
+	AMoveableObject* HeldObject = nullptr;
+	AMoveableObject* NearbyObject = nullptr;
+
+	// Closest snap point on each part, or null if none are in range of the collision point
+	USnapPointComponent* HeldSnapComp = nullptr;
+	USnapPointComponent* OtherSnapComp = nullptr;
+
+	// Closest collision points relative to each part, used when it has no snap point in range
+	FVector HeldLocalCollisionPoint = FVector::ZeroVector;
+	FVector OtherLocalCollisionPoint = FVector::ZeroVector;
+
+	// Origin of the fuse frame the snap math was done in
+	FVector FuseFrameOrigin = FVector::ZeroVector;
+
+	// Frame the snapshots were taken on
+	uint64 SnapshotFrame = 0;
+};
+
+/**
+ * Resolves the snap points of a held and nearby part on a worker thread from snapshots taken on the game thread.
+ * Results are picked up by the game thread on the following frame, so the game thread never waits on the resolution
+ */
+class TOTK_BUILDSYSTEM_API FAsyncSnapResolver : public TSharedFromThis<FAsyncSnapResolver, ESPMode::ThreadSafe>
+{
+public:
+	// Snapshot the held and nearby parts and start resolving their snap points on a worker thread, unless the previous resolution is still running
+	bool Launch(AMoveableObject* HeldObject, AMoveableObject* NearbyObject, float SnapSearchRadius);
+
+	// Take the result of the last resolution if it has finished and has not been taken yet
+	bool TryTakeResult(FSnapResolution& OutResult);
+
+	// Check if a resolution is still running
+	bool IsBusy() const { return Task.IsValid() && !Task.IsCompleted(); }
+
+	// Resolve the snap points of a held and nearby part from their snapshots. Safe to call from any thread
+	static void Resolve(const FSnapPartSnapshot& Held, const FSnapPartSnapshot& Nearby, float SnapSearchRadius, FSnapResolution& OutResult);
+
+private:
+	FSnapPartSnapshot HeldSnapshot;
+	FSnapPartSnapshot NearbySnapshot;
+	float SnapSearchRadius = 0.f;
+
+	FSnapResolution Result;
+	bool bHasResult = false;
+
+	UE::Tasks::FTask Task;
+};
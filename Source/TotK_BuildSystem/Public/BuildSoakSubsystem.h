@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "BuildSoakSubsystem.generated.h"
+
+class ABuilderBot;
+class FPhysScene_Chaos;
+
+/**
+ * Long running soak test of a server building with scripted builder bots, only created when the command line asks for it. Run headless as a dedicated server,
+ * with the number of bots, how long to run for and how often to report, for example -
+ *   TotK_BuildSystemServer ThirdPersonMap -BuildSoak=32 -SoakMinutes=120 -SoakReportSeconds=10 -log
+ * or from an editor build - UnrealEditor-Cmd TotK_BuildSystem.uproject ThirdPersonMap -server -nullrhi -BuildSoak=32 -SoakMinutes=120 -log
+ * Local clients can join with -game 127.0.0.1 -nullrhi to add replication to the load, and several servers on different ports can share one machine.
+ * Tick time, game thread time, physics time, part count and group count are written to Saved/Profiling/BuildSoak-<Port>-<Date>.csv every report,
+ * and a summary of each run is added to Saved/Profiling/BuildSoaks.csv
+ */
+UCLASS()
+class TOTK_BUILDSYSTEM_API UBuildSoakSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Only create the subsystem when the command line asks for a soak test
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	// Read the soak settings from the command line and start timing physics
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	// Stop timing physics and write the summary of the run
+	virtual void Deinitialize() override;
+
+	// Spawn the bots once the world has parts, time the frame and write a report row whenever one is due, exiting once the run is over
+	virtual void Tick(float DeltaTime) override;
+
+	// Get the stat used to track the time spent ticking the subsystem
+	virtual TStatId GetStatId() const override;
+
+	// Get the number of bots building in the world
+	int32 GetNumBots() const { return Bots.Num(); }
+
+protected:
+	// Soak tests only run in game worlds
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	// Spawn bots around random parts in the world
+	void SpawnBots();
+
+	// Write a row of the timings gathered since the last report along with the current state of the build system, then start gathering again
+	void WriteReport();
+
+	// Add a summary of the whole run to the file of every soak run, so runs can be compared
+	void WriteSummary();
+
+	// Physics scene callbacks, timing how long physics takes each frame
+	void OnPhysScenePreTick(FPhysScene_Chaos* PhysScene, float DeltaSeconds);
+	void OnPhysScenePostTick(FPhysScene_Chaos* PhysScene);
+
+	// Bots building in the world
+	UPROPERTY()
+	TArray<ABuilderBot*> Bots;
+
+	// Settings read from the command line
+	int32 NumBotsToSpawn = 0;
+	int32 RandomSeed = 0;
+	double RunSeconds = 0.0;
+	double ReportSeconds = 10.0;
+
+	// File each report row is added to
+	FString ReportFilename;
+
+	double StartTime = 0.0;
+	double NextReportTime = 0.0;
+	double PhysicsStartTime = 0.0;
+	FDelegateHandle PreTickHandle;
+	FDelegateHandle PostTickHandle;
+
+	// Timings gathered since the last report
+	int32 NumFrames = 0;
+	double FrameSeconds = 0.0;
+	double MaxFrameSeconds = 0.0;
+	double GameThreadSeconds = 0.0;
+	double PhysicsSeconds = 0.0;
+
+	// Timings gathered over the whole run
+	int64 TotalFrames = 0;
+	double TotalFrameSeconds = 0.0;
+	double TotalMaxFrameSeconds = 0.0;
+	double TotalPhysicsSeconds = 0.0;
+	bool bSummaryWritten = false;
+};
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Helper namespace for snap and fuse math. Fuse math is done in float relative to a group anchor and only converted back to world doubles at the edges
+namespace BuildSystemMath
+{
+	// Default degrees held objects are rotated by, shared by the grabber's rotation increment and the roll rounding of fused snap points
+	constexpr float DefaultRotationDegrees = 45.f;
+
+	// Anchor frame for a fused group. Builds are tiny compared to the world, so float offsets from the anchor keep full precision far from the origin
+	struct FGroupFrame
+	{
+		FGroupFrame() = default;
+
+		explicit FGroupFrame(const FVector& InOrigin)
+			: Origin(InOrigin)
+		{
+		}
+
+		// Convert a world position into a float position relative to the anchor
+		FORCEINLINE FVector3f ToLocal(const FVector& WorldPoint) const
+		{
+			return FVector3f(WorldPoint - Origin);
+		}
+
+		// Convert a float position relative to the anchor back into a world position
+		FORCEINLINE FVector ToWorld(const FVector3f& LocalPoint) const
+		{
+			return Origin + FVector(LocalPoint);
+		}
+
+		// World location of the anchor
+		FVector Origin = FVector::ZeroVector;
+	};
+
+	// Float version of FMath::VInterpTo for interpolating positions within a group frame
+	FORCEINLINE FVector3f InterpTo(const FVector3f& Current, const FVector3f& Target, float DeltaTime, float InterpSpeed)
+	{
+		// If there is no interp speed, jump to the target
+		if (InterpSpeed <= 0.f) return Target;
+
+		// If the distance is too small, just set the target
+		const FVector3f Dist = Target - Current;
+		if (Dist.SizeSquared() < UE_KINDA_SMALL_NUMBER) return Target;
+
+		// Otherwise move a fraction of the remaining distance
+		return Current + Dist * FMath::Clamp(DeltaTime * InterpSpeed, 0.f, 1.f);
+	}
+
+	// Get the step that moves the held group's snap point towards the other snap point this frame. Once the step lands within tolerance the full remaining offset is returned so the fuse finishes exactly aligned
+	FORCEINLINE FVector3f GetFuseStep(const FVector3f& HeldSnapPoint, const FVector3f& OtherSnapPoint, float DeltaTime, float InterpSpeed, float Tolerance, bool& bOutComplete)
+	{
+		const FVector3f Remaining = OtherSnapPoint - HeldSnapPoint;
+		const FVector3f Step = InterpTo(FVector3f::ZeroVector, Remaining, DeltaTime, InterpSpeed);
+
+		bOutComplete = (Remaining - Step).SizeSquared() <= Tolerance * Tolerance;
+		return bOutComplete ? Remaining : Step;
+	}
+
+	// Get the rotation for the held snap point that faces it into the other snap point, keeping its roll around the forward axis snapped to the given increments
+	FORCEINLINE FQuat GetAlignedSnapRotation(const FQuat& HeldSnapRotation, const FQuat& OtherSnapRotation, float RollStepDegrees)
+	{
+		// Facing the other snap point is a half turn around its up axis, leaving only the roll around the shared forward axis to be chosen
+		const FQuat FacingRotation = OtherSnapRotation * FQuat(FVector::UpVector, UE_DOUBLE_PI);
+
+		// Keep the roll the held snap point already has relative to the facing rotation, rounded to the nearest increment
+		float RollDegrees = FMath::RadiansToDegrees((FacingRotation.Inverse() * HeldSnapRotation).GetTwistAngle(FVector::ForwardVector));
+		if (RollStepDegrees > 0.f) {
+			RollDegrees = FMath::RoundToFloat(RollDegrees / RollStepDegrees) * RollStepDegrees;
+		}
+
+		FQuat AlignedRotation = FacingRotation * FQuat(FVector::ForwardVector, FMath::DegreesToRadians(RollDegrees));
+		AlignedRotation.Normalize();
+		return AlignedRotation;
+	}
+
+	// Get the final transform of the held snap point once fused, located on the other snap point and facing into it
+	FORCEINLINE FTransform GetAlignedSnapTransform(const FTransform& HeldSnapTransform, const FTransform& OtherSnapTransform, float RollStepDegrees)
+	{
+		return FTransform(GetAlignedSnapRotation(HeldSnapTransform.GetRotation(), OtherSnapTransform.GetRotation(), RollStepDegrees), OtherSnapTransform.GetLocation());
+	}
+
+	// Get the new transform of a group member when the held snap point moves, keeping it rigidly attached to the snap point
+	FORCEINLINE FTransform GetGroupMemberTransform(const FTransform& MemberTransform, const FTransform& HeldSnapTransform, const FTransform& NewSnapTransform)
+	{
+		return MemberTransform.GetRelativeTransform(HeldSnapTransform) * NewSnapTransform;
+	}
+
+	// Get the closest point on an axis aligned box to a point, or the point itself if it is inside the box
+	FORCEINLINE FVector3f ClosestPointOnBox(const FVector3f& Point, const FVector3f& Center, const FVector3f& Extent)
+	{
+		return FVector3f(
+			FMath::Clamp(Point.X, Center.X - Extent.X, Center.X + Extent.X),
+			FMath::Clamp(Point.Y, Center.Y - Extent.Y, Center.Y + Extent.Y),
+			FMath::Clamp(Point.Z, Center.Z - Extent.Z, Center.Z + Extent.Z)
+		);
+	}
+
+	// Get the closest point on a capsule to a point, or the point itself if it is inside the capsule
+	FORCEINLINE FVector3f ClosestPointOnCapsule(const FVector3f& Point, const FVector3f& SegmentStart, const FVector3f& SegmentEnd, float Radius)
+	{
+		// Find the closest point on the capsule's segment, then push out to the surface
+		const FVector3f Segment = SegmentEnd - SegmentStart;
+		const float SegmentLengthSquared = Segment.SizeSquared();
+		const float T = SegmentLengthSquared > UE_SMALL_NUMBER ? FMath::Clamp(FVector3f::DotProduct(Point - SegmentStart, Segment) / SegmentLengthSquared, 0.f, 1.f) : 0.f;
+		const FVector3f SegmentPoint = SegmentStart + Segment * T;
+
+		const FVector3f ToPoint = Point - SegmentPoint;
+		const float DistSquared = ToPoint.SizeSquared();
+		if (DistSquared <= Radius * Radius) return Point;
+
+		return SegmentPoint + ToPoint * (Radius * FMath::InvSqrt(DistSquared));
+	}
+
+	// Get the closest point on a triangle to a point
+	FORCEINLINE FVector3f ClosestPointOnTriangle(const FVector3f& Point, const FVector3f& A, const FVector3f& B, const FVector3f& C)
+	{
+		// Check the vertex regions, then the edge regions, and otherwise project onto the face
+		const FVector3f AB = B - A;
+		const FVector3f AC = C - A;
+		const FVector3f AP = Point - A;
+		const float D1 = FVector3f::DotProduct(AB, AP);
+		const float D2 = FVector3f::DotProduct(AC, AP);
+		if (D1 <= 0.f && D2 <= 0.f) return A;
+
+		const FVector3f BP = Point - B;
+		const float D3 = FVector3f::DotProduct(AB, BP);
+		const float D4 = FVector3f::DotProduct(AC, BP);
+		if (D3 >= 0.f && D4 <= D3) return B;
+
+		const float VC = D1 * D4 - D3 * D2;
+		if (VC <= 0.f && D1 >= 0.f && D3 <= 0.f) return A + AB * (D1 / (D1 - D3));
+
+		const FVector3f CP = Point - C;
+		const float D5 = FVector3f::DotProduct(AB, CP);
+		const float D6 = FVector3f::DotProduct(AC, CP);
+		if (D6 >= 0.f && D5 <= D6) return C;
+
+		const float VB = D5 * D2 - D1 * D6;
+		if (VB <= 0.f && D2 >= 0.f && D6 <= 0.f) return A + AC * (D2 / (D2 - D6));
+
+		const float VA = D3 * D6 - D5 * D4;
+		if (VA <= 0.f && (D4 - D3) >= 0.f && (D5 - D6) >= 0.f) return B + (C - B) * ((D4 - D3) / ((D4 - D3) + (D5 - D6)));
+
+		const float Denom = 1.f / (VA + VB + VC);
+		return A + AB * (VB * Denom) + AC * (VC * Denom);
+	}
+
+	// Get the index of the closest point to the test point within the max squared distance. Ties keep the earliest point, returns INDEX_NONE if there is none
+	template<typename VectorType, typename RealType = typename VectorType::FReal>
+	int32 FindClosestPoint(TArrayView<const VectorType> Points, const VectorType& TestPoint, RealType MaxDistSquared = TNumericLimits<RealType>::Max())
+	{
+		int32 ClosestIndex = INDEX_NONE;
+		RealType ClosestDistSquared = MaxDistSquared;
+
+		for (int32 Index = 0; Index < Points.Num(); ++Index) {
+			const RealType DistSquared = VectorType::DistSquared(Points[Index], TestPoint);
+			if (DistSquared < ClosestDistSquared) {
+				ClosestDistSquared = DistSquared;
+				ClosestIndex = Index;
+			}
+		}
+
+		return ClosestIndex;
+	}
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "HAL/LowLevelMemTracker.h"
+
+// Stat group for the build system, view in game with the console command - stat BuildSystem
+DECLARE_STATS_GROUP(TEXT("BuildSystem"), STATGROUP_BuildSystem, STATCAT_Advanced);
+
+// Time spent in each part of the build system
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Moveable Object Tick"), STAT_BuildSystem_Tick, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Get Closest Moveable Object In Radius"), STAT_BuildSystem_GetClosestMoveableObjectInRadius, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Snap Points"), STAT_BuildSystem_UpdateSnapPoints, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Interp Fused Objects"), STAT_BuildSystem_InterpFusedObjects, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Add Physics Constraint"), STAT_BuildSystem_AddPhysicsConstraint, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Merge Moveable Objects"), STAT_BuildSystem_MergeMoveableObjects, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Split Moveable Objects"), STAT_BuildSystem_SplitMoveableObjects, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Fused Set"), STAT_BuildSystem_UpdateFusedSet, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Grabber Tick"), STAT_BuildSystem_GrabberTick, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Refresh Part Registry"), STAT_BuildSystem_RefreshPartRegistry, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Resolve Snap Points"), STAT_BuildSystem_ResolveSnapPoints, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Group Sleep"), STAT_BuildSystem_UpdateGroupSleep, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Significance"), STAT_BuildSystem_UpdateSignificance, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Instances"), STAT_BuildSystem_UpdateInstances, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Freeze Group"), STAT_BuildSystem_FreezeGroup, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Unfreeze Group"), STAT_BuildSystem_UnfreezeGroup, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Run Deferred Work"), STAT_BuildSystem_RunDeferredWork, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Capture Structural Stress"), STAT_BuildSystem_CaptureStructuralStress, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Solve Structural Stress"), STAT_BuildSystem_SolveStructuralStress, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+
+// Totals that persist between frames
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Parts"), STAT_BuildSystem_Parts, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Groups"), STAT_BuildSystem_Groups, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Links"), STAT_BuildSystem_Links, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pooled Parts"), STAT_BuildSystem_PooledParts, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Frozen Groups"), STAT_BuildSystem_FrozenGroups, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+
+// Counts that reset every frame
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Candidates Tested"), STAT_BuildSystem_CandidatesTested, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Traces Issued"), STAT_BuildSystem_TracesIssued, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("MIDs Created"), STAT_BuildSystem_MIDsCreated, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Snap Latency Frames"), STAT_BuildSystem_SnapLatencyFrames, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Awake Bodies"), STAT_BuildSystem_AwakeBodies, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Awake Groups"), STAT_BuildSystem_AwakeGroups, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Reduced Parts"), STAT_BuildSystem_ReducedParts, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Instanced Parts"), STAT_BuildSystem_InstancedParts, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Deferred Work Backlog"), STAT_BuildSystem_DeferredWork, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Deferred Work Parts"), STAT_BuildSystem_DeferredWorkParts, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Stress Parts Evaluated"), STAT_BuildSystem_StressParts, STATGROUP_BuildSystem, TOTK_BUILDSYSTEM_API);
+
+// Low level memory tracker tags for build system allocations, view in game with the console command - stat LLMFULL, or in Memory Insights with the command line argument - -trace=memory
+LLM_DECLARE_TAG_API(BuildSystem, TOTK_BUILDSYSTEM_API);
+LLM_DECLARE_TAG_API(BuildSystem_FusedSets, TOTK_BUILDSYSTEM_API);
+LLM_DECLARE_TAG_API(BuildSystem_Links, TOTK_BUILDSYSTEM_API);
+LLM_DECLARE_TAG_API(BuildSystem_SnapPoints, TOTK_BUILDSYSTEM_API);
+LLM_DECLARE_TAG_API(BuildSystem_Components, TOTK_BUILDSYSTEM_API);
+LLM_DECLARE_TAG_API(BuildSystem_Materials, TOTK_BUILDSYSTEM_API);
+
+// Memory used by build system state, gathered from every moveable object in a world
+struct TOTK_BUILDSYSTEM_API FBuildSystemMemoryUsage
+{
+	int32 NumParts = 0;
+	int32 NumLinks = 0;
+
+	// Fused object sets, which every object in a group keeps a copy of
+	SIZE_T FusedSetBytes = 0;
+
+	// Physics constraint links, stored on both linked objects, and their constraint components
+	SIZE_T LinkBytes = 0;
+
+	// Snap point components and the arrays tracking them
+	SIZE_T SnapPointBytes = 0;
+
+	// Fuse collision boxes and scratch storage for searching nearby objects
+	SIZE_T ComponentBytes = 0;
+
+	// Dynamic material instances used for overlay materials
+	SIZE_T MaterialBytes = 0;
+
+	// Fuse sessions of held objects, which are not part of any single object
+	SIZE_T SessionBytes = 0;
+
+	// Structure of arrays storage for every part in the part registry
+	SIZE_T RegistryBytes = 0;
+
+	// Collision proxies, shared by every part with the same mesh
+	SIZE_T ProxyBytes = 0;
+
+	// Get the memory used by parts, excluding the links between them
+	SIZE_T GetPartBytes() const { return FusedSetBytes + SnapPointBytes + ComponentBytes + MaterialBytes + RegistryBytes + ProxyBytes; }
+
+	// Gather the memory used by every moveable object in a world
+	static FBuildSystemMemoryUsage Gather(UWorld* World);
+};
+
+// Helper namespace for measuring build system memory
+namespace BuildSystemStats
+{
+	// Get the size of an object along with any memory it owns
+	TOTK_BUILDSYSTEM_API SIZE_T GetObjectBytes(UObject* Object);
+}
+
+// Unreal Insights trace channel for build system events, enable with the command line argument - -trace=BuildSystem
+UE_TRACE_CHANNEL_EXTERN(BuildSystemChannel, TOTK_BUILDSYSTEM_API);
+
+// Helper namespace for emitting build system events to Unreal Insights
+namespace BuildSystemTrace
+{
+	// A held group was released next to another group and started fusing with it
+	TOTK_BUILDSYSTEM_API void FuseSessionBegin(uint32 HeldGroupSize, uint32 OtherGroupSize);
+
+	// A fuse finished, leaving a merged group of the given size
+	TOTK_BUILDSYSTEM_API void FuseSessionEnd(uint32 MergedGroupSize);
+}
@@ -0,0 +1,198 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FuseSession.h"
+#include "FrozenGroup.h"
+#include "ConstraintLinkTable.h"
+#include "PartRegistry.h"
+#include "PartPool.h"
+#include "InstancedPartRenderer.h"
+#include "FlightRecorder.h"
+#include "CollisionProxy.h"
+#include "DeferredBuildWork.h"
+#include "StructuralStress.h"
+#include "UObject/ObjectKey.h"
+#include "BuildSystemSubsystem.generated.h"
+
+class AMoveableObject;
+class UStaticMesh;
+struct FBuildSystemMemoryUsage;
+
+/**
+ * World subsystem that owns build system state shared between moveable objects, such as the fuse sessions of held objects
+ */
+UCLASS()
+class TOTK_BUILDSYSTEM_API UBuildSystemSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Start dumping the flight recorder whenever an ensure fails
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	// Stop dumping the flight recorder on ensures
+	virtual void Deinitialize() override;
+
+	// Refresh the part registry from physics and update group sleep and significance, then tick every active fuse session, removing any that have finished, update structural stress, run deferred work and update part instances
+	virtual void Tick(float DeltaTime) override;
+
+	// Get the stat used to track the time spent ticking the subsystem
+	virtual TStatId GetStatId() const override;
+
+	// Start a new fuse session for an object that has been grabbed, replacing any previous session for the same object.
+	// Sessions are stored by value, so starting one may move every other session and any session pointer or reference held across it must be found again
+	FFuseSession& BeginSession(AMoveableObject* HeldObject);
+
+	// Get the fuse session for a held object, if it has one. The pointer is only valid until the next session is started or the subsystem ticks
+	FFuseSession* FindSession(const AMoveableObject* HeldObject);
+
+	// Get the fuse session of the object a grabber is holding, if it is holding one. The pointer is only valid until the next session is started or the subsystem ticks
+	FFuseSession* FindGrabberSession(const UObject* Grabber);
+
+	// Get the number of fuse sessions currently being ticked
+	int32 GetNumSessions() const { return Sessions.Num(); }
+
+	// Check if a part's group is held or being fused with by the fuse session of any object other than the given held object, in which case it cannot be grabbed or fused with
+	bool IsGroupLocked(const AMoveableObject* Part, const AMoveableObject* HeldObject) const;
+
+	// Check if a grabber cannot grab a part, as the part's own session belongs to another grabber or its group is held or being fused with by another object
+	bool IsGrabLocked(const AMoveableObject* Part, const UObject* Grabber) const;
+
+	// Get the groups held or being fused with by the fuse sessions of every object other than the given held object
+	void GetLockedGroupIds(const AMoveableObject* HeldObject, TArray<int32, TInlineAllocator<16>>& OutGroupIds) const;
+
+	// Start tracking a newly frozen group
+	FFrozenGroup& AddFrozenGroup(AMoveableObject* Anchor);
+
+	// Get the frozen group an object belongs to, if its group is frozen
+	FFrozenGroup* FindFrozenGroup(const AMoveableObject* Member);
+
+	// Stop tracking a frozen group once it has been unfrozen
+	void RemoveFrozenGroup(const AMoveableObject* Anchor);
+
+	// Get the number of frozen groups
+	int32 GetNumFrozenGroups() const { return FrozenGroups.Num(); }
+
+	// Get the table of physics constraint links between every moveable object in the world
+	FConstraintLinkTable& GetLinkTable() { return LinkTable; }
+	const FConstraintLinkTable& GetLinkTable() const { return LinkTable; }
+
+	// Get the registry of every moveable object in the world
+	FPartRegistry& GetPartRegistry() { return PartRegistry; }
+	const FPartRegistry& GetPartRegistry() const { return PartRegistry; }
+
+	// Get the pools of released moveable objects waiting to be reused
+	FPartPool& GetPartPool() { return PartPool; }
+	const FPartPool& GetPartPool() const { return PartPool; }
+
+	// Get the renderer drawing parts through instanced static meshes when instanced rendering is on
+	const FInstancedPartRenderer& GetInstancedRenderer() const { return InstancedRenderer; }
+
+	// Get the ring buffer of fuse and split decisions made in the world
+	FFlightRecorder& GetFlightRecorder() { return FlightRecorder; }
+	const FFlightRecorder& GetFlightRecorder() const { return FlightRecorder; }
+
+	// Get the build work spread over frames under the per-frame budget
+	FDeferredBuildWork& GetDeferredWork() { return DeferredWork; }
+	const FDeferredBuildWork& GetDeferredWork() const { return DeferredWork; }
+
+	// Get the structural model publishing the stress on every link when BuildSystem.StructuralStress is on
+	FStructuralStress& GetStructuralStress() { return StructuralStress; }
+	const FStructuralStress& GetStructuralStress() const { return StructuralStress; }
+
+	// Finish any deferred work of a part's group, so its fused object sets and highlight are up to date before it is moved, split, merged or frozen
+	void FinishGroupWork(const AMoveableObject* Part);
+
+	// Write the flight recorder to Saved/FlightRecorder, named with the current time unless given, returning the file it was written to or an empty string if it failed
+	FString DumpFlightRecorder(const FString& Name = FString()) const;
+
+	// Wake every member of a part's group, and only its group, keeping the group awake until it settles again
+	void WakeGroup(AMoveableObject* Part);
+
+	// Use virtual viewers for significance instead of the players' view points, such as for headless benchmarks. An empty list goes back to the players
+	void SetVirtualViewers(TArrayView<const FVector> InViewers) { VirtualViewers.Reset(); VirtualViewers.Append(InViewers.GetData(), InViewers.Num()); }
+
+	// Get the collision proxy of the given shape for a mesh, baking it the first time it is asked for
+	TSharedRef<const FCollisionProxy, ESPMode::ThreadSafe> GetCollisionProxy(const UStaticMesh* Mesh, ECollisionProxyShape Shape);
+
+	// Add the memory used by fuse sessions, links, the part registry and pool, and collision proxies to a memory usage report
+	void AccumulateMemoryUsage(FBuildSystemMemoryUsage& Usage) const;
+
+private:
+	// Sleep state of a group, gathered from its members every frame
+	struct FGroupSleepState
+	{
+		int32 NumAwake = 0;
+		int32 NumAsleep = 0;
+		bool bSettled = true;
+		bool bHeld = false;
+
+		// A group sleeps once every member has settled, unless it is being held or fused
+		bool ShouldSleep() const { return bSettled && !bHeld; }
+	};
+
+	// Put groups to sleep as one once every member has settled, and wake the rest of a group when physics wakes any of its members
+	void UpdateGroupSleep();
+
+	// Significance of a group, gathered from its members every frame
+	struct FGroupSignificanceState
+	{
+		float MinViewerDistSquared = TNumericLimits<float>::Max();
+		bool bIdle = true;
+		bool bReduced = false;
+	};
+
+	// Reduce idle groups far from every viewer to low fidelity, and return groups to full fidelity as viewers approach or they wake
+	void UpdateSignificance();
+
+	// Dump the flight recorder when an ensure fails, so the decisions leading up to it are kept
+	void OnSystemEnsure();
+
+	// Handle of the ensure delegate, removed when the subsystem is deinitialized
+	FDelegateHandle EnsureHandle;
+
+	// Fuse sessions for every object that is held or still fusing after being released
+	UPROPERTY()
+	TArray<FFuseSession> Sessions;
+
+	// Groups frozen into a single compound body, along with the parts they were frozen from
+	UPROPERTY()
+	TArray<FFrozenGroup> FrozenGroups;
+
+	// Physics constraint links between every moveable object in the world
+	FConstraintLinkTable LinkTable;
+
+	// Every moveable object in the world, in structure of arrays storage
+	FPartRegistry PartRegistry;
+
+	// Released moveable objects waiting to be reused
+	FPartPool PartPool;
+
+	// Draws parts sharing a mesh through instanced static meshes when instanced rendering is on
+	FInstancedPartRenderer InstancedRenderer;
+
+	// Fuse and split decisions made in the world, sized by BuildSystem.FlightRecorderSize
+	FFlightRecorder FlightRecorder;
+
+	// Build work spread over frames, such as handing out fused object sets after large splits and merges
+	FDeferredBuildWork DeferredWork;
+
+	// Stress on the links of fused groups, evaluated on a worker thread when BuildSystem.StructuralStress is on
+	FStructuralStress StructuralStress;
+
+	// Sleep state of every group, reused every frame
+	TMap<int32, FGroupSleepState> GroupSleepStates;
+
+	// Significance of every group and the viewer locations it was measured from, reused every frame
+	TMap<int32, FGroupSignificanceState> GroupSignificanceStates;
+	TArray<FVector> ViewerLocations;
+
+	// Viewers used instead of the players' view points when set
+	TArray<FVector> VirtualViewers;
+
+	// Collision proxies baked for each mesh and shape, shared by every part using them
+	TMap<TPair<TObjectKey<UStaticMesh>, ECollisionProxyShape>, TSharedRef<const FCollisionProxy, ESPMode::ThreadSafe>> CollisionProxies;
+};
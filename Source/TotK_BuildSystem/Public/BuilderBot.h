@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Character.h"
+#include "BuilderBot.generated.h"
+
+class UGrabber;
+class UPhysicsHandleComponent;
+class AMoveableObject;
+
+// What a builder bot is currently doing
+UENUM()
+enum class EBuilderBotState : uint8
+{
+	// Picking a part to pick up
+	FindPart,
+
+	// Walking up to the part and grabbing it
+	ApproachPart,
+
+	// Carrying the held part over to another part
+	CarryPart,
+
+	// Waiting after letting go for the fuse to finish
+	Wait,
+};
+
+/**
+ * Server side character that builds random structures out of the parts in the world, driving its grabber through the same calls the player's
+ * input does. Used by the build soak test to load a server with grabbing, fusing and carrying without any clients connected
+ */
+UCLASS()
+class TOTK_BUILDSYSTEM_API ABuilderBot : public ACharacter
+{
+	GENERATED_BODY()
+
+public:
+	// Create the grabber and physics handle the bot builds with
+	ABuilderBot();
+
+	// Seed the random choices the bot makes, so a run with the same seeds makes the same choices
+	void SetRandomSeed(int32 Seed) { RandomStream.Initialize(Seed); }
+
+	// Get what the bot is currently doing
+	EBuilderBotState GetState() const { return State; }
+
+	// Get the number of parts the bot has picked up
+	int32 GetNumGrabs() const { return NumGrabs; }
+
+	// Get the number of times the bot has let go of a part next to another one
+	int32 GetNumReleases() const { return NumReleases; }
+
+protected:
+	// Distance from a part the bot walks to before grabbing it
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Builder Bot")
+	float GrabReach = 350.f;
+
+	// Distance between the held part and the part it is carried to before letting go
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Builder Bot")
+	float ReleaseDistance = 150.f;
+
+	// Seconds the bot tries to reach a part or carry one before giving up and teleporting or letting go
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Builder Bot")
+	float GiveUpTime = 10.f;
+
+	// Seconds between random rotations and pushes of the held part while carrying it
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Builder Bot")
+	float ActionInterval = 1.f;
+
+	// Seconds to wait after letting go before picking the next part
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Builder Bot")
+	float WaitTime = 1.5f;
+
+private:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// Called every frame
+	virtual void Tick(float DeltaSeconds) override;
+
+	// Pick a random part that no grabber is holding or fusing with, other than any in the given group
+	AMoveableObject* PickRandomPart(int32 ExcludedGroupId) const;
+
+	// Walk up to the target part and grab it, teleporting next to it if it cannot be reached in time
+	void TickApproachPart();
+
+	// Carry the held part towards the target part, rotating and pushing it at random, and let go once it is close enough
+	void TickCarryPart();
+
+	// Point the grabber and the bot's view at a location
+	void AimAt(const FVector& Location);
+
+	// Move to a new state, resetting the time spent in it
+	void SetState(EBuilderBotState NewState);
+
+	// Grabber the bot builds with
+	UPROPERTY(VisibleAnywhere, Category = "Builder Bot")
+	UGrabber* Grabber;
+
+	// Physics handle the grabber moves held parts with
+	UPROPERTY(VisibleAnywhere, Category = "Builder Bot")
+	UPhysicsHandleComponent* PhysicsHandle;
+
+	// Part being walked up to, or being carried towards once a part is held
+	TWeakObjectPtr<AMoveableObject> TargetPart;
+
+	// Random choices of parts and actions
+	FRandomStream RandomStream;
+
+	EBuilderBotState State = EBuilderBotState::FindPart;
+	float StateTime = 0.f;
+	float NextActionTime = 0.f;
+	int32 NumGrabs = 0;
+	int32 NumReleases = 0;
+};
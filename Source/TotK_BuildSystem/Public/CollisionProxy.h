@@ -0,0 +1,55 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CollisionProxy.generated.h"
+
+class UStaticMesh;
+
+// Simple shapes a part's collision can be reduced to for fuse and hold distance queries
+UENUM(BlueprintType)
+enum class ECollisionProxyShape : uint8 {
+	Box UMETA(DisplayName = "Box"),
+	Capsule UMETA(DisplayName = "Capsule"),
+	Hull UMETA(DisplayName = "Convex Hull"),
+};
+
+/**
+ * Simple collision shape baked from a part's mesh, in the part's local space. Fuse and hold distance queries use the proxy
+ * so they never query the mesh's full collision, which is only needed by physics. Proxies are immutable once baked, so they can be shared between parts and threads
+ */
+struct TOTK_BUILDSYSTEM_API FCollisionProxy
+{
+	// Most triangles the baked hulls can have between them before the proxy falls back to a box
+	static constexpr int32 MaxHullTriangles = 64;
+
+	// Bake a proxy of the given shape from a mesh's simple collision, falling back to a box if the mesh has nothing to build the shape from
+	static FCollisionProxy Bake(const UStaticMesh* Mesh, ECollisionProxyShape InShape);
+
+	// Get the closest point on the proxy to a point in the part's local space, or the point itself if it is inside the proxy.
+	// The local space leaves out the part's scale, which is applied to the proxy instead so distances are measured as they are in the world
+	FVector3f GetClosestLocalPoint(const FVector3f& LocalPoint, const FVector3f& Scale = FVector3f::OneVector) const;
+
+	// Get the closest point on the proxy to a world point, or the point itself if it is inside the proxy
+	FVector GetClosestPoint(const FTransform& PartTransform, const FVector& WorldPoint) const;
+
+	// Get the memory allocated by the proxy
+	SIZE_T GetAllocatedSize() const { return HullVertices.GetAllocatedSize() + HullNormals.GetAllocatedSize() + HullStarts.GetAllocatedSize(); }
+
+	ECollisionProxyShape Shape = ECollisionProxyShape::Box;
+
+	// Box center and half extents
+	FVector3f Center = FVector3f::ZeroVector;
+	FVector3f Extent = FVector3f::ZeroVector;
+
+	// Capsule segment and radius
+	FVector3f SegmentStart = FVector3f::ZeroVector;
+	FVector3f SegmentEnd = FVector3f::ZeroVector;
+	float Radius = 0.f;
+
+	// Hull triangles, three vertices each, and the outward normal of each triangle
+	TArray<FVector3f> HullVertices;
+	TArray<FVector3f> HullNormals;
+
+	// First triangle of each hull, as a mesh's collision can be made of several convex elements
+	TArray<int32> HullStarts;
+};
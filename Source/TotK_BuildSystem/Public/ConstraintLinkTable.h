@@ -0,0 +1,132 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ConstraintLinkTable.generated.h"
+
+class AMoveableObject;
+class UPhysicsConstraintComponent;
+
+// Physics constraint link for tracking which objects are fused together
+USTRUCT()
+struct FPhysicsConstraintLink
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	UPhysicsConstraintComponent* Constraint = nullptr;
+
+	UPROPERTY()
+	AMoveableObject* ComponentA = nullptr;
+
+	UPROPERTY()
+	AMoveableObject* ComponentB = nullptr;
+
+	// Operator overload for comparing FPhysicsConstraintLinks
+	FORCEINLINE bool operator==(const FPhysicsConstraintLink& Other) const
+	{
+		return Constraint == Other.Constraint &&
+			ComponentA == Other.ComponentA &&
+			ComponentB == Other.ComponentB;
+	}
+};
+
+// Stable handle to a link in the constraint link table, which stops resolving once the link has been removed
+struct FConstraintLinkHandle
+{
+	int32 Index = INDEX_NONE;
+	uint32 Generation = 0;
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+
+	bool operator==(const FConstraintLinkHandle& Other) const { return Index == Other.Index && Generation == Other.Generation; }
+	bool operator!=(const FConstraintLinkHandle& Other) const { return !(*this == Other); }
+};
+
+/**
+ * Table of every physics constraint link between moveable objects. Each link is stored once in contiguous memory, with removed slots reused through a free list,
+ * and every object keeps the head of an intrusive list of its own links, so adding and removing a link takes constant time
+ */
+class TOTK_BUILDSYSTEM_API FConstraintLinkTable
+{
+public:
+	// Add a link between two objects and return its handle
+	FConstraintLinkHandle Add(UPhysicsConstraintComponent* Constraint, AMoveableObject* ComponentA, AMoveableObject* ComponentB);
+
+	// Remove a link, returning false if the handle no longer refers to a link
+	bool Remove(FConstraintLinkHandle Handle);
+
+	// Get the link a handle refers to, or null if it has been removed
+	const FPhysicsConstraintLink* Find(FConstraintLinkHandle Handle) const;
+
+	// Replace the constraint component of a link, returning false if the handle no longer refers to a link
+	bool SetConstraint(FConstraintLinkHandle Handle, UPhysicsConstraintComponent* Constraint);
+
+	// Get the number of links in the table
+	int32 Num() const { return NumLinks; }
+
+	// Get the number of links an object has
+	int32 NumObjectLinks(const AMoveableObject* Object) const;
+
+	// Remove every link, leaving the objects that were linked with empty link lists
+	void Reset();
+
+	// Get the memory allocated by the table
+	SIZE_T GetAllocatedSize() const { return Entries.GetAllocatedSize(); }
+
+	// Call a function with the handle and link of every link in the table, in storage order
+	template<typename FunctionType>
+	void ForEachLink(FunctionType Function) const
+	{
+		for (int32 Index = 0; Index < Entries.Num(); ++Index) {
+			const FEntry& Entry = Entries[Index];
+			if (Entry.bInUse) {
+				Function(FConstraintLinkHandle{ Index, Entry.Generation }, Entry.Link);
+			}
+		}
+	}
+
+	// Call a function with the handle and link of every link an object has. The function may remove the link it was called with, but no others
+	template<typename FunctionType>
+	void ForEachObjectLink(const AMoveableObject* Object, FunctionType Function) const
+	{
+		int32 Index = GetFirstLink(Object);
+		while (Index != INDEX_NONE) {
+			const FEntry& Entry = Entries[Index];
+			const int32 NextIndex = Entry.NextLink[GetSide(Entry, Object)];
+			Function(FConstraintLinkHandle{ Index, Entry.Generation }, Entry.Link);
+			Index = NextIndex;
+		}
+	}
+
+private:
+	// A slot in the table, holding a link along with its place in the link lists of both of its objects
+	struct FEntry
+	{
+		FPhysicsConstraintLink Link;
+
+		// Neighbouring links in the link lists of component A and component B. Free slots use the first entry to point at the next free slot
+		int32 NextLink[2] = { INDEX_NONE, INDEX_NONE };
+		int32 PrevLink[2] = { INDEX_NONE, INDEX_NONE };
+
+		// Increased every time the slot is freed, so handles to a removed link stop resolving once the slot is reused
+		uint32 Generation = 0;
+
+		bool bInUse = false;
+	};
+
+	// Get which of a link's objects the given object is, 0 for component A and 1 for component B
+	static int32 GetSide(const FEntry& Entry, const AMoveableObject* Object) { return Entry.Link.ComponentA == Object ? 0 : 1; }
+
+	// Get the first link in an object's link list
+	int32 GetFirstLink(const AMoveableObject* Object) const;
+
+	// Insert a link at the head of one of its object's link lists
+	void LinkInto(int32 Index, int32 Side);
+
+	// Remove a link from one of its object's link lists
+	void UnlinkFrom(int32 Index, int32 Side);
+
+	TArray<FEntry> Entries;
+	int32 FirstFree = INDEX_NONE;
+	int32 NumLinks = 0;
+};
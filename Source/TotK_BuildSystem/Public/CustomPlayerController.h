@@ -6,9 +6,10 @@
 #include "GameFramework/PlayerController.h"
 #include "MoveableObject.h"
 #include "TotK_BuildSystem/TotK_BuildSystemCharacter.h"
-#include "PhysicsEngine/PhysicsHandleComponent.h"
 #include "CustomPlayerController.generated.h"
 
+class UGrabber;
+
 /**
  * Player controller that detects mouse shake
  */
@@ -54,8 +55,8 @@ private:
 	// Pointer to the player character
 	ATotK_BuildSystemCharacter* PlayerCharacter;
 
-	// Pointer to the player character's physics handle
-	UPhysicsHandleComponent* PhysicsHandle;
+	// Pointer to the player character's grabber, which is one of any number of grabbers in the world
+	UGrabber* Grabber;
 
 	// Reference to the object that is currently held by the player
 	AMoveableObject* HeldObject;
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+class AMoveableObject;
+class UActorComponent;
+class UMaterialInterface;
+class UBuildSystemSubsystem;
+
+// Kinds of build system work that can be put off to later frames
+enum class EDeferredWorkType : uint8
+{
+	// Gather the parts a split left behind into their connected groups, giving each group its own fused object set and group id
+	RebuildGroups,
+
+	// Hand a merged fused object set out to every part of the merged group
+	MergeGroups,
+
+	// Set or clear the overlay material of every part of a group
+	Highlight,
+
+	// Destroy a constraint component whose constraint has already been broken
+	DestroyConstraint,
+};
+
+// A piece of deferred work, which is done one part at a time so it can be stopped and picked up again on a later frame
+struct FDeferredWork
+{
+	EDeferredWorkType Type = EDeferredWorkType::RebuildGroups;
+
+	// Group the work belongs to, or INDEX_NONE if no group depends on it. Anything that moves, splits or merges the group finishes its work first
+	int32 GroupId = INDEX_NONE;
+
+	// Parts the work visits, and the next one to visit
+	TArray<AMoveableObject*> Parts;
+	int32 NextIndex = 0;
+
+	// Fused object set being handed out, either the merged group or the connected group being rebuilt
+	TSet<AMoveableObject*> FusedSet;
+
+	// Connected group being gathered while rebuilding groups, the group id it is given, how far through it the gather and hand out have got, and every part already gathered
+	TArray<AMoveableObject*> Connected;
+	int32 ConnectedGroupId = INDEX_NONE;
+	int32 GatherIndex = 0;
+	int32 AssignIndex = 0;
+	TSet<AMoveableObject*> Gathered;
+
+	// Split being finished while rebuilding groups, and the number of groups it has left so far including the part split off, which is 0 to start with when a link was broken rather than a part split off
+	FName SplitObject;
+	int32 NumSplitGroups = 1;
+
+	// Overlay material to highlight with, or null to clear the highlight
+	TWeakObjectPtr<UMaterialInterface> Material;
+
+	// Constraint component to destroy
+	TWeakObjectPtr<UActorComponent> Constraint;
+};
+
+/**
+ * Frame budgeted scheduler for build system work that does not have to finish on the frame it is started, such as handing fused object sets out
+ * after large splits and merges, highlighting large groups and destroying broken constraints. Small work, or all work while the budget is 0, is
+ * done as soon as it is added. Until a group's work is finished its parts' fused object sets may still be the group they were in before, a
+ * superset of the connected parts, so anything that moves, splits, merges or freezes a group finishes the group's work first
+ */
+class TOTK_BUILDSYSTEM_API FDeferredBuildWork
+{
+public:
+	// Add work, doing it straight away if it is small or deferring is turned off, otherwise queuing it behind earlier work
+	void Add(UBuildSystemSubsystem& BuildSystem, FDeferredWork&& Work);
+
+	// Highlight every part of a part's group with an overlay material, or clear the highlight, replacing any highlight of the group that has not been finished
+	void Highlight(UBuildSystemSubsystem& BuildSystem, AMoveableObject* Part, UMaterialInterface* Material);
+
+	// Do queued work, oldest first, until the frame's budget from BuildSystem.DeferredWorkBudget is used up
+	void Run(UBuildSystemSubsystem& BuildSystem);
+
+	// Finish every piece of queued work belonging to a group, oldest first, including rebuilds whose current connected group has been given the group's id
+	void FinishGroup(UBuildSystemSubsystem& BuildSystem, int32 GroupId);
+
+	// Finish every piece of queued work
+	void FinishAll(UBuildSystemSubsystem& BuildSystem);
+
+	// Drop every piece of queued work without doing it, for when the world is going away
+	void Reset() { Queue.Reset(); }
+
+	// Get the number of pieces of queued work
+	int32 Num() const { return Queue.Num(); }
+
+	// Get the number of parts queued work still has to visit
+	int32 NumPartsLeft() const;
+
+	// Get the memory allocated by queued work
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	// Do one part's worth of a piece of work, returning true once the work is finished
+	bool Step(UBuildSystemSubsystem& BuildSystem, FDeferredWork& Work);
+
+	// Steps of rebuilding the groups a split left behind
+	bool StepRebuildGroups(UBuildSystemSubsystem& BuildSystem, FDeferredWork& Work);
+
+	// Queued work, oldest first
+	TArray<FDeferredWork> Queue;
+};
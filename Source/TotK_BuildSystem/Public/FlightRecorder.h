@@ -0,0 +1,121 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Fuse and split decisions the flight recorder keeps
+enum class EFlightEventType : uint8
+{
+	// A group was grabbed. Count is the size of the group
+	Grab,
+
+	// The closest fuse candidate of a held group changed. Count is the number of overlapping objects searched, Distance is how far the candidate is from the held object
+	Candidate,
+
+	// The snap pair of a held group changed. Distance is between the two points
+	Snap,
+
+	// A held group was released and started fusing. Distance is between the two points
+	FuseBegin,
+
+	// A fuse finished. The held group id is the merged group, Count is its size
+	FuseEnd,
+
+	// A group was split apart. The held group id is the group before splitting, Count is the number of groups it split into
+	Split,
+
+	// One of the groups a split left behind. The held group id is the new group, Count is its size
+	SplitGroup,
+
+	Num
+};
+
+// What a fuse is aligning on each side, a snap point component or the closest point on the object's collision
+enum class EFlightSnapType : uint8
+{
+	None,
+	SnapPoint,
+	CollisionPoint,
+};
+
+// A single fuse or split decision. Events are plain data so that recording one is a copy into the ring
+struct FFlightEvent
+{
+	double Time = 0.0;
+	uint32 Frame = 0;
+	EFlightEventType Type = EFlightEventType::Grab;
+	EFlightSnapType HeldSnapType = EFlightSnapType::None;
+	EFlightSnapType OtherSnapType = EFlightSnapType::None;
+
+	// Objects on each side of the decision, by name so they can still be identified after they are destroyed
+	FName HeldObject;
+	FName OtherObject;
+	int32 HeldGroupId = INDEX_NONE;
+	int32 OtherGroupId = INDEX_NONE;
+
+	int32 Count = 0;
+	float Distance = 0.f;
+
+	// Points being fused on each side, in world space
+	FVector3f HeldPoint = FVector3f::ZeroVector;
+	FVector3f OtherPoint = FVector3f::ZeroVector;
+};
+
+/**
+ * Fixed size ring buffer of the fuse and split decisions made in a world, recorded on the game thread and only read back when it is dumped
+ * to disk on demand or when an ensure fails. Recording never allocates once the ring has been sized, and the oldest events are overwritten first
+ */
+class TOTK_BUILDSYSTEM_API FFlightRecorder
+{
+public:
+	// Size the ring to hold the given number of events, dropping every recorded event. A capacity of 0 stops recording
+	void Init(int32 InCapacity);
+
+	// Get the number of events the ring holds
+	int32 GetCapacity() const { return Events.Num(); }
+
+	// Record a decision made on the current frame, overwriting the oldest event once the ring is full
+	void Record(const FFlightEvent& Event)
+	{
+		if (Events.Num() == 0) return;
+
+		FFlightEvent& Slot = Events[NextIndex];
+		Slot = Event;
+		Slot.Time = FPlatformTime::Seconds();
+		Slot.Frame = (uint32)GFrameCounter;
+
+		NextIndex = NextIndex + 1 < Events.Num() ? NextIndex + 1 : 0;
+		++NumRecorded;
+	}
+
+	// Get the number of events in the ring
+	int32 Num() const { return (int32)FMath::Min<uint64>(NumRecorded, Events.Num()); }
+
+	// Get the number of events recorded since the ring was sized, including the ones that have been overwritten
+	uint64 GetNumRecorded() const { return NumRecorded; }
+
+	// Copy the events in the ring, oldest first
+	void GetEvents(TArray<FFlightEvent>& OutEvents) const;
+
+	// Write the events in the ring to a file, oldest first
+	bool SaveToFile(const FString& Filename) const;
+
+	// Read the events written to a file, returning false if it could not be read or is not a flight recorder dump
+	static bool LoadFromFile(const FString& Filename, TArray<FFlightEvent>& OutEvents);
+
+	// Describe an event as a line of text, with its time relative to the given start time
+	static FString Describe(const FFlightEvent& Event, double StartTime);
+
+	// Read a dump and write it out as text next to it, one event per line, returning the number of events decoded or INDEX_NONE if it could not be read
+	static int32 DecodeFile(const FString& Filename);
+
+	// Get the file a dump with the given name is written to, which is under Saved/FlightRecorder unless the name is already a path
+	static FString GetDumpFilename(const FString& Name);
+
+	// Get the memory allocated by the ring
+	SIZE_T GetAllocatedSize() const { return Events.GetAllocatedSize(); }
+
+private:
+	TArray<FFlightEvent> Events;
+	int32 NextIndex = 0;
+	uint64 NumRecorded = 0;
+};
@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FrozenGroup.generated.h"
+
+class AMoveableObject;
+class UInstancedStaticMeshComponent;
+
+// A finished group frozen into a single compound body, with every member welded to the anchor's body and the whole group drawn through one instanced mesh per mesh and material
+USTRUCT()
+struct TOTK_BUILDSYSTEM_API FFrozenGroup
+{
+	GENERATED_BODY()
+
+	// Object whose body every other member is welded to
+	UPROPERTY()
+	AMoveableObject* Anchor = nullptr;
+
+	// Every object in the group when it was frozen, including the anchor
+	UPROPERTY()
+	TArray<AMoveableObject*> Members;
+
+	// Instanced meshes the group is drawn through while frozen, attached to the anchor so they move with its body
+	UPROPERTY()
+	TArray<UInstancedStaticMeshComponent*> Instances;
+};
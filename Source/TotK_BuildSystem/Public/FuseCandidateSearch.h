@@ -0,0 +1,81 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AMoveableObject;
+class FPartRegistry;
+
+// Closest pair of a member of the held group and a nearby moveable object that it could fuse with
+struct FFuseCandidate
+{
+	// Member of the held group closest to the candidate
+	AMoveableObject* FusedObject = nullptr;
+
+	// Nearby moveable object with a clear line of sight to the member
+	AMoveableObject* Candidate = nullptr;
+
+	// Distance between the member and the candidate
+	float Distance = 0.f;
+};
+
+/**
+ * Search for the closest fuse candidate of a held group. Overlaps are gathered on the game thread along with a snapshot of locations and group ids
+ * from the part registry, then every member's candidates are traced and compared in parallel before being reduced to the closest pair in member order.
+ * The reduction does not depend on how members were split between threads, so the result is the same for any number of workers
+ */
+class TOTK_BUILDSYSTEM_API FFuseCandidateSearch
+{
+public:
+	// Gather every member of the held object's group with a fuse collision box, along with the moveable objects overlapping it that are not in a locked group
+	void Gather(const AMoveableObject* HeldObject, const FPartRegistry& Registry, TConstArrayView<int32> LockedGroupIds = TConstArrayView<int32>());
+
+	// Find the closest unblocked candidate of every member on up to MaxWorkers threads, then reduce them to the closest pair
+	FFuseCandidate Evaluate(UWorld* World, int32 MaxWorkers);
+
+	// Get every candidate of the last evaluation with a clear line of sight to a member, paired with its closest member, for fusing at several contacts at once
+	void GetContacts(TArray<FFuseCandidate, TInlineAllocator<16>>& OutContacts) const;
+
+	// Draw the candidates and line of sight traces of the last evaluation
+	void DrawDebug(UWorld* World) const;
+
+	// Get the number of members gathered
+	int32 NumMembers() const { return Members.Num(); }
+
+	// Get the number of overlapping objects gathered for every member
+	int32 NumCandidates() const { return Candidates.Num(); }
+
+	// Get the memory allocated by the search
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	// Find the closest unblocked candidate of a single member, leaving it in the member's result
+	void EvaluateMember(UWorld* World, int32 MemberIndex);
+
+	// Snapshot of a member of the held group and the range of its candidates
+	struct FMember
+	{
+		AMoveableObject* Object = nullptr;
+		FVector Location = FVector::ZeroVector;
+		int32 GroupId = INDEX_NONE;
+		int32 FirstCandidate = 0;
+		int32 NumCandidates = 0;
+		FFuseCandidate Result;
+	};
+
+	// Snapshot of a moveable object overlapping a member, and the result of its line of sight trace
+	struct FCandidate
+	{
+		AMoveableObject* Object = nullptr;
+		FVector Location = FVector::ZeroVector;
+		FVector ImpactPoint = FVector::ZeroVector;
+		int32 GroupId = INDEX_NONE;
+		bool bTraced = false;
+		bool bClear = false;
+	};
+
+	TArray<FMember> Members;
+	TArray<FCandidate> Candidates;
+
+	// Scratch array reused for overlapping actors, so gathering does not allocate once it has grown
+	TArray<AActor*> OverlapActorsScratch;
+};
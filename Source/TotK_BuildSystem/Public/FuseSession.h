@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BuildSystemMath.h"
+#include "FuseCandidateSearch.h"
+#include "FuseSession.generated.h"
+
+class AMoveableObject;
+class USnapPointComponent;
+class UMaterialInstanceDynamic;
+class FAsyncSnapResolver;
+
+// A contact between a member of the held group and a nearby object that is fused along with the closest pair when fusing at several contacts at once
+USTRUCT()
+struct TOTK_BUILDSYSTEM_API FFuseContact
+{
+	GENERATED_BODY()
+
+	// Member of the held group
+	UPROPERTY()
+	AMoveableObject* FusedObject = nullptr;
+
+	// Nearby object the member is fused to
+	UPROPERTY()
+	AMoveableObject* NearbyObject = nullptr;
+};
+
+// State for a single held object while it is being held and fused, kept out of every moveable object as only the held object ever needs it
+USTRUCT()
+struct TOTK_BUILDSYSTEM_API FFuseSession
+{
+	GENERATED_BODY()
+
+	// Object being held that the session was started for
+	UPROPERTY()
+	AMoveableObject* HeldObject = nullptr;
+
+	// Grabber holding the object, if it was grabbed through one
+	UPROPERTY()
+	UObject* Grabber = nullptr;
+
+	// Object within the held object's fused group that is closest to the nearby moveable object
+	UPROPERTY()
+	AMoveableObject* ClosestFusedMoveableObject = nullptr;
+
+	// Current nearby moveable object
+	UPROPERTY()
+	AMoveableObject* ClosestNearbyMoveableObject = nullptr;
+
+	// Contacts other than the closest pair that line up with it, fused at the same time when BuildSystem.MultiContactFuse is on
+	UPROPERTY()
+	TArray<FFuseContact> ExtraContacts;
+
+	// Most recent nearby moveable object
+	UPROPERTY()
+	AMoveableObject* PrevMoveableObject = nullptr;
+
+	// Closest snap point object for fusing the held object to another nearby object
+	UPROPERTY()
+	USnapPointComponent* HeldClosestSnapComp = nullptr;
+
+	// Closest snap point object for fusing the nearby object to the held object
+	UPROPERTY()
+	USnapPointComponent* OtherClosestSnapComp = nullptr;
+
+	// Overlay material shared by every object in the held object's fused group
+	UPROPERTY()
+	UMaterialInstanceDynamic* HeldOverlayMat = nullptr;
+
+	// Overlay material shared by every object in the nearby moveable object's fused group
+	UPROPERTY()
+	UMaterialInstanceDynamic* NearbyOverlayMat = nullptr;
+
+	// Closest point for fusing the held object to another nearby object
+	FVector HeldClosestSnapPoint = FVector::ZeroVector;
+
+	// Closest collision point if a snap point is not available for the held object
+	FVector HeldLocalCollisionPoint = FVector::ZeroVector;
+
+	// Closest point for fusing the other nearby object to the held object
+	FVector OtherClosestSnapPoint = FVector::ZeroVector;
+
+	// Closest collision point if a snap point is not available for the other object
+	FVector OtherLocalCollisionPoint = FVector::ZeroVector;
+
+	// Anchor frame that snap and fuse math is done relative to, avoiding double precision math in world space
+	BuildSystemMath::FGroupFrame FuseFrame;
+
+	// Candidate search reused each tick, so searching for nearby objects does not allocate
+	FFuseCandidateSearch CandidateSearch;
+
+	// Resolves snap points off the game thread when asynchronous snap resolution is enabled
+	TSharedPtr<FAsyncSnapResolver, ESPMode::ThreadSafe> SnapResolver;
+
+	// Nearby object and snap pair last written to the flight recorder, only compared so that a snap decision is recorded once when it changes
+	const AMoveableObject* RecordedNearbyObject = nullptr;
+	const USnapPointComponent* RecordedHeldSnapComp = nullptr;
+	const USnapPointComponent* RecordedOtherSnapComp = nullptr;
+
+	// Degrees that the roll of a fused snap point is rounded to, matching the rotation increments of whoever is holding the object
+	float SnapRotationDegrees = BuildSystemMath::DefaultRotationDegrees;
+
+	// Track if the held object is currently grabbed
+	bool bIsGrabbed = false;
+
+	// Track if the held object is trying to fuse with another object
+	bool bIsFusing = false;
+
+	// A session is finished once its object has been released and is no longer fusing
+	bool IsActive() const { return HeldObject && (bIsGrabbed || bIsFusing); }
+};
@@ -7,6 +7,8 @@
 #include "PhysicsEngine/PhysicsHandleComponent.h"
 #include "MoveableObjectInterface.h"
 #include "MoveableObject.h"
+#include "OrientationLattice.h"
+#include "BuildSystemMath.h"
 #include "Grabber.generated.h"
 
 class ATotK_BuildSystemCharacter;
@@ -55,6 +57,15 @@ public:
 	// Check if the player is currently holding an item
 	bool IsHoldingObject();
 
+	// Get the object currently being held, if there is one
+	AMoveableObject* GetHeldObject() const;
+
+	// Get the point to aim the grabber at so that its grab sweep passes through a target, making up for the camera offset added to the end of the sweep
+	FVector GetAimPoint(const FVector& Target) const;
+
+	// Turn debug drawing on or off, for grabbers that are not set up in the editor
+	void SetDebugMode(bool bEnabled) { bDebugMode = bEnabled; }
+
 protected:
 	// Boolean for if debug information should be shown
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug")
@@ -80,9 +91,9 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grab Settings")
 	float MaxHoldDistance = 1200.f;
 
-	// Degrees for each iteration of rotating the held object
+	// Degrees for each iteration of rotating the held object. Rotations by the player are exact, only the rotation the object is grabbed at is rounded to the orientation lattice
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grab Settings")
-	float RotationDegrees = 45.f;
+	float RotationDegrees = BuildSystemMath::DefaultRotationDegrees;
 
 private:
 	// Called when the game starts
@@ -106,11 +117,8 @@ private:
 	// Grab the object, setting its initial location and rotation
 	void GrabObject(AMoveableObject* MoveableObject);
 
-	// Round off the grabbed object's initial rotation based on the preferred rotation degrees
-	FRotator RoundObjectRotation(FRotator HeldRot);
-
-	// Round off the specified pitch, yaw, or roll value
-	float CalculateRotation(float CurrRot, float CurrMod);
+	// Rotate the held object one increment in a direction
+	void StepHeldOrientation(EOrientationStep Step);
 
 	// Physics handle for moving objects
 	UPROPERTY()
@@ -131,11 +139,11 @@ private:
 	// Offset for the distance between the center of an object and its side closest to the player
 	float HoldOffset;
 
-	// Offset between the rotation when an object is picked up and the facing direction
-	FQuat OffsetQuat;
+	// Table of orientations the held object is rounded to when grabbed, based on the preferred rotation degrees
+	FOrientationLattice OrientationLattice;
 
-	// Player adjusted rotation based off of rotating the held object
-	FQuat AdjustedQuat;
+	// Held object's rotation relative to the facing direction, rounded to the orientation lattice when grabbed and then rotated exactly by the player
+	FQuat HeldOrientation = FQuat::Identity;
 
 	// Handle for object grabbing timer
 	FTimerHandle WaitToGrabHandle;
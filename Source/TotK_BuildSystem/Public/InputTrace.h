@@ -0,0 +1,74 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Input actions bound by the player character that an input trace records
+enum class EInputTraceAction : uint8
+{
+	Move,
+	Look,
+	Grab,
+	Release,
+	RotateLeft,
+	RotateRight,
+	RotateUp,
+	RotateDown,
+	MoveTowards,
+	MoveAway,
+	Num
+};
+
+// A single input action triggered on a recorded frame, along with its axis value for move and look
+struct FInputTraceEvent
+{
+	uint32 Frame = 0;
+	float Time = 0.f;
+	EInputTraceAction Action = EInputTraceAction::Move;
+	FVector2f Value = FVector2f::ZeroVector;
+
+	bool operator==(const FInputTraceEvent& Other) const { return Frame == Other.Frame && Time == Other.Time && Action == Other.Action && Value == Other.Value; }
+};
+
+/**
+ * Input actions recorded from the player character with the frame and time they were triggered on, so a build session can be replayed at a fixed timestep.
+ * Frames are stored as deltas from the previous event and only move and look store an axis value, keeping traces small
+ */
+class TOTK_BUILDSYSTEM_API FInputTrace
+{
+public:
+	// Check if an action has an axis value instead of only being triggered
+	static bool HasAxisValue(EInputTraceAction Action) { return Action == EInputTraceAction::Move || Action == EInputTraceAction::Look; }
+
+	// Add an action triggered on a frame, which must not be before the last event's frame
+	void Add(uint32 Frame, float Time, EInputTraceAction Action, const FVector2f& Value);
+
+	// Finish the trace after the given number of recorded frames, keeping any frames without input after the last event
+	void Finish(uint32 InNumFrames);
+
+	// Get the number of frames the trace was recorded over, which is at least up to its last event
+	uint32 NumFrames() const { return FMath::Max(RecordedFrames, Events.Num() > 0 ? Events.Last().Frame + 1 : 0u); }
+
+	// Read or write the trace, returning false if a trace being read is not valid
+	bool Serialize(FArchive& Ar);
+
+	// Write the trace to a file
+	bool SaveToFile(const FString& Filename) const;
+
+	// Read the trace from a file, returning false if it could not be read or is not a valid trace
+	bool LoadFromFile(const FString& Filename);
+
+	// Fixed time between frames the trace was recorded at and is replayed at
+	float FixedDeltaTime = 1.f / 60.f;
+
+	// Map the trace was recorded on, and where the player started
+	FString MapName;
+	FTransform StartTransform;
+	FRotator StartControlRotation = FRotator::ZeroRotator;
+
+	// Every recorded action, in the order they were triggered
+	TArray<FInputTraceEvent> Events;
+
+private:
+	// Number of frames recorded when the trace was finished
+	uint32 RecordedFrames = 0;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "UObject/WeakObjectPtr.h"
+#include "PartRegistry.h"
+
+class AActor;
+class AMoveableObject;
+class UInstancedStaticMeshComponent;
+class UMaterialInterface;
+class UStaticMesh;
+
+/**
+ * Optional render path that draws parts sharing a mesh and material through a single instanced static mesh component, with the instance transforms
+ * copied from the part registry. Each part keeps its own mesh component for physics, which is only hidden from rendering while the part is instanced
+ */
+class TOTK_BUILDSYSTEM_API FInstancedPartRenderer
+{
+public:
+	// Draw every part that can be instanced through the instances of its mesh and material, and every other part through its own mesh component
+	void Update(UWorld* World, const FPartRegistry& Registry);
+
+	// Draw every part through its own mesh component again and remove every instance, leaving frozen groups drawn through their own instances
+	void Reset(const FPartRegistry& Registry);
+
+	// Check if a part can be drawn as an instance, as held, fusing and highlighted parts need their own mesh component for their overlay material
+	static bool CanInstance(const AMoveableObject* Part, EPartFlags Flags);
+
+	// Get the number of instanced static mesh components parts are drawn through
+	int32 NumBatches() const { return Batches.Num(); }
+
+	// Get the number of parts drawn as instances
+	int32 NumInstances() const;
+
+	// Get the memory allocated by the renderer
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	// Instances of a single mesh and material, along with the parts drawn through them
+	struct FBatch
+	{
+		UInstancedStaticMeshComponent* Component = nullptr;
+		TArray<AMoveableObject*> Members;
+		TArray<AMoveableObject*> PrevMembers;
+		TArray<FTransform> Transforms;
+		bool bMoved = false;
+	};
+
+	typedef TPair<TObjectKey<UStaticMesh>, TObjectKey<UMaterialInterface>> FBatchKey;
+
+	// Get the batch for a mesh and material, creating its instanced static mesh component the first time it is needed
+	FBatch& FindOrAddBatch(UWorld* World, UStaticMesh* Mesh, UMaterialInterface* Material);
+
+	// Actor owning every instanced static mesh component
+	TWeakObjectPtr<AActor> Host;
+
+	// Batches for every mesh and material drawn so far
+	TMap<FBatchKey, FBatch> Batches;
+};
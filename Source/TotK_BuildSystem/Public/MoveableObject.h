@@ -5,41 +5,36 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "MoveableObjectInterface.h"
+#include "FuseSession.h"
+#include "FlightRecorder.h"
+#include "ConstraintLinkTable.h"
+#include "CollisionProxy.h"
+#include "UObject/ObjectKey.h"
 #include "PhysicsEngine/PhysicsConstraintComponent.h"
 #include "Components/BoxComponent.h"
 #include "MoveableObject.generated.h"
 
-// Physics constraint link for tracking which objects are fused together
-USTRUCT()
-struct FPhysicsConstraintLink
-{
-	GENERATED_BODY()
-
-	UPROPERTY()
-	UPhysicsConstraintComponent* Constraint;
-
-	UPROPERTY()
-	AMoveableObject* ComponentA;
-
-	UPROPERTY()
-	AMoveableObject* ComponentB;
-
-	// Operator overload for comparing FPhysicsConstraintLinks
-	FORCEINLINE bool operator==(const FPhysicsConstraintLink& Other) const
-	{
-		return Constraint == Other.Constraint &&
-			ComponentA == Other.ComponentA &&
-			ComponentB == Other.ComponentB;
-	}
-};
-
 class USnapPointComponent;
+class UBuildSystemSubsystem;
+struct FBuildSystemMemoryUsage;
+struct FSnapResolution;
+
+// Snap point candidates for a single search, kept inline so searching for snap points does not allocate
+typedef TArray<USnapPointComponent*, TInlineAllocator<16>> FSnapPointArray;
 
 UCLASS()
 class TOTK_BUILDSYSTEM_API AMoveableObject : public AActor, public IMoveableObjectInterface
 {
 	GENERATED_BODY()
 
+	// The link table keeps the head of each object's link list up to date, the part registry keeps each object's slot up to date, the part pool parks and reuses objects, the candidate search and snap snapshots read fuse collision boxes and snap points, and deferred work highlights objects with a material
+	friend class FConstraintLinkTable;
+	friend class FPartRegistry;
+	friend class FPartPool;
+	friend class FFuseCandidateSearch;
+	friend struct FSnapPartSnapshot;
+	friend class FDeferredBuildWork;
+
 public:
 	// Sets default values for this actor's properties
 	AMoveableObject();
@@ -52,6 +47,46 @@ public:
 	UPROPERTY()
 	TSet<AMoveableObject*> FusedObjects;
 
+	// Update the held object's fuse session every frame while it is held or fusing
+	void TickFuseSession(FFuseSession& Session, float DeltaTime);
+
+	// Add the memory used by this object's build state to a memory usage report
+	void AccumulateMemoryUsage(FBuildSystemMemoryUsage& Usage) const;
+
+	// Get the simple collision proxy of this object's mesh, baking it the first time it is needed or after the mesh changes
+	TSharedRef<const FCollisionProxy, ESPMode::ThreadSafe> GetCollisionProxy();
+
+	// Get the closest point on this object's collision proxy to a world point, or the point itself if it is inside the proxy
+	FVector GetClosestPointOnProxy(const FVector& WorldPoint);
+
+	// Turn debug drawing on or off, ticking only while it is on
+	UFUNCTION(BlueprintCallable, Category = "Debug")
+	void SetDebugMode(bool bEnabled);
+
+	// Check if debug information is being shown
+	bool IsDebugMode() const { return bDebugMode; }
+
+	// Drop this object to low fidelity while its group is idle and far from every viewer, or return it to full fidelity
+	void SetReducedFidelity(bool bReduced);
+
+	// Check if this object has been dropped to low fidelity
+	bool IsReducedFidelity() const { return FullFidelitySettings.IsSet(); }
+
+	// Check if this object has been released to a part pool and is waiting to be reused
+	bool IsPooled() const { return bPooled; }
+
+	// Freeze this object's fused group into a single compound body drawn through instanced meshes, keeping every part and link so it can be unfrozen. Held and fusing groups cannot be frozen
+	bool FreezeGroup();
+
+	// Unfreeze this object's group back into separate bodies held together by physics constraints
+	void UnfreezeGroup();
+
+	// Check if this object's group is frozen
+	bool IsFrozen() const { return bFrozen; }
+
+	// Break one of this object's links, such as one overloaded by structural stress, and rebuild its group into the groups its remaining links hold together, returning false if the handle is not one of its links
+	bool BreakLink(FConstraintLinkHandle Handle);
+
 protected:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -76,56 +111,26 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Snap")
 	float SnapSearchRadius = 60.f;
 
+	// Simple shape the mesh's collision is reduced to for fuse and hold distance queries, the full collision is only used by physics
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Collision")
+	ECollisionProxyShape CollisionProxyShape = ECollisionProxyShape::Box;
+
 	// Boolean for if debug information should be shown
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug")
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Debug")
 	bool bDebugMode = true;
 
-	// Object within the held object's fused group that is closest to the nearby moveable object
-	UPROPERTY()
-	AMoveableObject* ClosestFusedMoveableObject;
+	// Index of the first of this object's links in the world's constraint link table, the rest are reached through the table
+	int32 FirstLinkIndex = INDEX_NONE;
 
-	// Current nearby moveable object
-	UPROPERTY()
-	AMoveableObject* ClosestNearbyMoveableObject;
-
-	// Keep track of all physics constraints created on this object
-	TArray<FPhysicsConstraintLink> PhysicsConstraintLinks;
-
-	// Track if the held object is trying to fuse with another object
-	bool bIsFusing;
-
-	// Closest point for fusing the held object to another nearby object
-	FVector HeldClosestSnapPoint;
-
-	// Closest snap point object for fusing the held object to another nearby object
-	UPROPERTY()
-	USnapPointComponent* HeldClosestSnapComp;
-
-	// Closest collision point if a snap point is not available for the held object
-	FVector HeldLocalCollisionPoint;
-
-	// Offset center of held object to closest fusion point
-	FVector HeldLocalOffset;
-
-	// Closest point for fusing the other nearby object to the held object
-	FVector OtherClosestSnapPoint;
-
-	// Closest snap point object for fusing the nearby object to the held object
-	UPROPERTY()
-	USnapPointComponent* OtherClosestSnapComp;
-
-	// Closest collision point if a snap point is not available for the other object
-	FVector OtherLocalCollisionPoint;
-
-	// Offset center of held object to closest fusion point
-	FVector OtherLocalOffset;
+	// Slot of this object in the world's part registry
+	int32 RegistryIndex = INDEX_NONE;
 
 private:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-	// Update the current velocities of the moveable object
-	void UpdateVelocities();
+	// Called when the object is removed from the world
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	// When an object is grabbed, add an overlay material
 	virtual void OnGrab_Implementation() override;
@@ -136,96 +141,123 @@ private:
 	// Split the fused object sets of the currently held object through moveable object interface
 	virtual void SplitMoveableObjects_Implementation() override;
 
-	// Get the closest moveable object for the current actor
-	AMoveableObject* GetClosestMoveableObjectByActor(AMoveableObject* Object, TArray<AActor*> HitResults);
+	// End any fuse session, leave the fused group and park the object out of the world while it waits in a part pool
+	void DisableForPool();
 
-	// Run a line trace to check for a clear path between the hit actor and currently held object
-	AMoveableObject* CheckMoveableObjectTrace(AMoveableObject* HitActor, AMoveableObject* FusedObject);
+	// Bring a pooled object back into the world as its own group
+	void EnableFromPool(const FTransform& Transform);
 
-	// Get the closest object to what is currently held
-	AMoveableObject* GetClosestMoveable(AMoveableObject* Held, AMoveableObject* ObjectA, AMoveableObject* ObjectB);
+	// Update the closest collision points on the held object and the nearby fusion object
+	void UpdateSnapPoints(FFuseSession& Session);
 
-	// Get the closest objects between two object groups
-	AMoveableObject* GetClosestMoveableofTwo(AMoveableObject* TestFused, AMoveableObject* TestMoveable, AMoveableObject* CurrentBestFused, AMoveableObject* CurrentBestMoveable);
+	// Find the points a held member and a nearby object would fuse at, their closest snap points or the closest points on their collision where there are none, searching relative to the fuse frame
+	void FindFusePoints(const FFuseSession& Session, AMoveableObject* HeldMember, AMoveableObject* NearbyObject, USnapPointComponent*& OutHeldSnapComp, FVector& OutHeldPoint, USnapPointComponent*& OutNearbySnapComp, FVector& OutNearbyPoint);
 
-	// Update the closest collision points on the held object and the nearby fusion object
-	void UpdateSnapPoints();
+	// Find every contact between the held group and nearby groups, other than the closest pair, that closes by the same step as the closest pair so they can all be fused at once
+	void GatherExtraContacts(FFuseSession& Session);
+
+	// Pick up the snap points resolved off the game thread from last frame's snapshot, then snapshot this frame's objects for the next frame
+	void UpdateSnapPointsAsync(FFuseSession& Session);
 
-	// Get possible snap points
-	TArray<USnapPointComponent*> GetPossibleSnapPoints(FVector TestPoint, AMoveableObject* TestObject);
+	// Apply snap points resolved off the game thread to a fuse session
+	void ApplySnapResolution(FFuseSession& Session, const FSnapResolution& Resolution);
 
-	// Get the closest snap point on the held object
-	USnapPointComponent* GetClosestObjectSnapPoint(TArray<USnapPointComponent*> PossibleSnapPoints, FVector TestPoint);
+	// Get possible snap points within the snap search radius of a test point relative to the fuse frame
+	void GetPossibleSnapPoints(const FFuseSession& Session, const FVector3f& TestPoint, AMoveableObject* TestObject, FSnapPointArray& OutSnapPoints);
 
-	// Get the closest vector to the current test point
-	USnapPointComponent* GetClosestVector(FVector TestPoint, USnapPointComponent* PointA, USnapPointComponent* PointB);
+	// Get the closest snap point to a test point relative to the fuse frame
+	USnapPointComponent* GetClosestObjectSnapPoint(const FFuseSession& Session, const FSnapPointArray& PossibleSnapPoints, const FVector3f& TestPoint);
 
-	// Get the distance betwen two vectors
-	float GetVectorDistance(FVector PointA, FVector PointB);
+	// Record the snap pair chosen for a fuse in the flight recorder, only recording snap events when the pair changes
+	void RecordSnapDecision(FFuseSession& Session, EFlightEventType Type);
 
 	// Move objects being fused together via interpolation over time
-	void InterpFusedObjects(float DeltaTime);
+	void InterpFusedObjects(FFuseSession& Session, float DeltaTime);
 
-	// Get the distance betwen two moveable objects
-	float GetObjectDistance(AMoveableObject* MoveableA, AMoveableObject* MoveableB);
+	// Move every object in the held object's fused group by the same offset
+	void MoveFusedGroup(const FVector& Delta);
+
+	// Rotate the held object's fused group in a single step so its closest snap point faces the other object's closest snap point
+	void AlignFusedGroupToSnap(const FFuseSession& Session);
 
 	// Remove velocities from objects when dropping
 	void RemoveObjectVelocity();
 
-	// Update the physics constraints of the two objects being fused
-	void UpdateConstraints(AMoveableObject* MoveableObject);
+	// Update the physics constraints of the two objects being fused, and of any extra contacts fused along with them, then merge every group touched, returning the size of the merged group
+	int32 UpdateConstraints(AMoveableObject* FusedObject, AMoveableObject* MoveableObject, TConstArrayView<FFuseContact> ExtraContacts = TConstArrayView<FFuseContact>());
 
 	// Create a new physics constraint to be used with the physics constraint link
-	UPhysicsConstraintComponent* AddPhysicsConstraint(AMoveableObject* MoveableObject);
+	UPhysicsConstraintComponent* AddPhysicsConstraint(AMoveableObject* FusedObject, AMoveableObject* MoveableObject);
 
 	// Create a new constraint link and add it to both objects being fused
-	void AddConstraintLink(UPhysicsConstraintComponent* PhysicsConstraint, AMoveableObject* MoveableObject);
+	void AddConstraintLink(UPhysicsConstraintComponent* PhysicsConstraint, AMoveableObject* FusedObject, AMoveableObject* MoveableObject);
 
-	// Merge the fused object sets of the currently held object and the one it is fusing with
-	void MergeMoveableObjects(AMoveableObject* MoveableObject);
+	// Merge the fused object sets of the currently held object and every object it is fusing with, returning the size of the merged group
+	int32 MergeMoveableObjects(AMoveableObject* FusedObject, TConstArrayView<AMoveableObject*> MoveableObjects);
 
 	// Remove all physics constraints from the held object
 	void RemovePhysicsLink();
 
-	// Update fused object sets based on their physics links
-	void UpdateFusedSet();
+	// Break a link's constraint, restoring collision between its objects, and remove it from the link table
+	static void RemoveLink(UBuildSystemSubsystem& BuildSystem, FConstraintLinkHandle Handle, const FPhysicsConstraintLink& Link);
 
 	// Remove velocities on hit objects if they are another moveable object
 	UFUNCTION()
 	void OnHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& HitResult);
 
-	// Get the closest moveable object within the collision range
+	// Get the build system subsystem of this object's world
+	UBuildSystemSubsystem* GetBuildSystem() const;
+
+	// Get the fuse session of this object, if it is being held or is still fusing
+	FFuseSession* FindFuseSession() const;
+
+	// Get the table of physics constraint links for this object's world
+	FConstraintLinkTable* GetLinkTable() const;
+
+	// Get the closest moveable object within the collision range, searching through this object's fuse session. Returns null if it is not being held
 	UFUNCTION(BlueprintCallable)
 	AMoveableObject* GetClosestMoveableObjectInRadius();
 
-	// Update material of nearby fuseable object and its currently fused object set
+	// Get the closest moveable object within the collision range of a fuse session
+	AMoveableObject* FindClosestMoveableObjectInRadius(FFuseSession& Session);
+
+	// Update material of nearby fuseable object and its currently fused object set, sharing the overlay material of this object's fuse session
 	UFUNCTION(BlueprintCallable)
 	void UpdateMoveableObjectMaterial(AMoveableObject* MoveableObject, bool Fuseable);
 
+	// Update material of nearby fuseable object and its currently fused object set, sharing a single overlay material across the whole set
+	void UpdateGroupOverlayMaterial(AMoveableObject* MoveableObject, UMaterialInstanceDynamic*& OverlayMat, bool Fuseable);
+
 	// Remove material of nearby fuseable object and its currently fused object set
 	UFUNCTION(BlueprintCallable)
 	void RemoveMoveableObjectMaterial(AMoveableObject* MoveableObject);
 
-	// A dynamic material to apply to the current object, allowing for manipulation of parameters
-	UPROPERTY()
-	UMaterialInstanceDynamic* DynamicMat;
-
-	// A dynamic material to apply to the nearby moveable object
-	UPROPERTY()
-	UMaterialInstanceDynamic* MoveableDynamicMat;
-
-	// Most recent nearby moveable object
-	UPROPERTY()
-	AMoveableObject* PrevMoveableObject;
-
 	// Array to track all the existing snap points of the current moveable object
 	UPROPERTY()
 	TArray<USnapPointComponent*> SnapPoints;
 
-	// Track if a moveable object is grabbed or not
-	bool bIsGrabbed = false;
-
-	// Vectors to store the current velocity of the moveable object
-	FVector PreviousVelocity;
-	FVector PreviousAngularVelocity;
+	// Settings changed when dropping to low fidelity, kept to restore them exactly when returning to full fidelity
+	struct FFullFidelitySettings
+	{
+		ECollisionEnabled::Type MeshCollision = ECollisionEnabled::QueryAndPhysics;
+		ECollisionEnabled::Type FuseBoxCollision = ECollisionEnabled::QueryOnly;
+		bool bMeshOverlaps = false;
+		bool bFuseBoxOverlaps = false;
+		uint8 PositionSolverIterations = 8;
+		uint8 VelocitySolverIterations = 1;
+	};
+
+	// Full fidelity settings, only set while this object is at low fidelity
+	TOptional<FFullFidelitySettings> FullFidelitySettings;
+
+	// Track if the object is waiting in a part pool, and if it was simulating physics before it was pooled
+	bool bPooled = false;
+	bool bSimulatedBeforePooling = true;
+
+	// Track if the object's group is frozen into a single body
+	bool bFrozen = false;
+
+	// Collision proxy of the current mesh, and the mesh it was baked for
+	TSharedPtr<const FCollisionProxy, ESPMode::ThreadSafe> CollisionProxy;
+	TObjectKey<UStaticMesh> CollisionProxyMesh;
 };
\ No newline at end of file
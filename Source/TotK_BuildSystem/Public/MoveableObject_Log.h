@@ -13,5 +13,8 @@ UCLASS()
 class TOTK_BUILDSYSTEM_API AMoveableObject_Log : public AMoveableObject
 {
 	GENERATED_BODY()
-	
+
+public:
+	// Sets default values for this actor's properties
+	AMoveableObject_Log();
 };
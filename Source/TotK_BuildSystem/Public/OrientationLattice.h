@@ -0,0 +1,66 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Directions a held object can be rotated in
+enum class EOrientationStep : uint8
+{
+	Left,
+	Right,
+	Up,
+	Down,
+	Num
+};
+
+/**
+ * Precomputed table of every orientation a held object can be rotated to. Rotations are stored as indices into the table,
+ * so rounding is a nearest quaternion lookup and rotating is a table transition, with no drift over many rotations
+ */
+class TOTK_BUILDSYSTEM_API FOrientationLattice
+{
+public:
+	// Build the lattice for the given rotation increment
+	explicit FOrientationLattice(float InStepDegrees = 90.f);
+
+	// Rebuild the lattice for a new rotation increment
+	void Build(float InStepDegrees);
+
+	// Get the rotation increment the lattice was built for
+	float GetStepDegrees() const { return StepDegrees; }
+
+	// Get the rotation increment the lattice was asked to be built for, which differs from the increment it was built for when it fell back to quarter turns
+	float GetRequestedStepDegrees() const { return RequestedStepDegrees; }
+
+	// Get the total number of orientations in the lattice
+	int32 Num() const { return Orientations.Num(); }
+
+	// Get the orientation stored at an index of the lattice
+	const FQuat& GetOrientation(int32 Index) const { return Orientations[Index]; }
+
+	// Get the index of the lattice orientation closest to the given rotation
+	int32 FindNearest(const FQuat& Rotation) const;
+
+	// Get the index of the orientation reached by rotating the given orientation one increment in a direction. This is exact for quarter turns,
+	// finer increments can reach orientations outside the lattice and are rounded to the closest one
+	int32 GetStep(int32 Index, EOrientationStep Step) const { return Transitions[Index * (int32)EOrientationStep::Num + (int32)Step]; }
+
+	// Get the rotation applied for a single step in a direction
+	FQuat GetStepRotation(EOrientationStep Step) const;
+
+private:
+	// Rotation increment the lattice was built for, and the increment it was asked for
+	float StepDegrees = 0.f;
+	float RequestedStepDegrees = 0.f;
+
+	// Every orientation within the lattice
+	TArray<FQuat> Orientations;
+
+	// Orientation components stored separately so the nearest lookup is a straight dot product scan
+	TArray<float> OrientationX;
+	TArray<float> OrientationY;
+	TArray<float> OrientationZ;
+	TArray<float> OrientationW;
+
+	// Index reached from each orientation for each step direction
+	TArray<int32> Transitions;
+};
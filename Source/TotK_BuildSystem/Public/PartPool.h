@@ -0,0 +1,34 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/SubclassOf.h"
+#include "UObject/ObjectKey.h"
+
+class AMoveableObject;
+
+/**
+ * Pools of released moveable objects for each moveable object class. Released objects leave their group and are parked out of the world
+ * with their components still registered, so acquiring one again skips constructing components and leaves no garbage for GC
+ */
+class TOTK_BUILDSYSTEM_API FPartPool
+{
+public:
+	// Take a pooled object of the given class and move it into place, spawning a new one if none of that class are pooled
+	AMoveableObject* Acquire(UWorld* World, TSubclassOf<AMoveableObject> PartClass, const FTransform& Transform);
+
+	// Put an object into the pool of its class, destroying it instead if that pool is full
+	void Release(AMoveableObject* Part);
+
+	// Forget a pooled object that has been destroyed
+	void Remove(AMoveableObject* Part);
+
+	// Get the number of pooled objects of a class
+	int32 NumPooled(TSubclassOf<AMoveableObject> PartClass) const;
+
+	// Get the memory allocated by the pools
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	// Pooled objects of each class, acquired from the back
+	TMap<TObjectKey<UClass>, TArray<AMoveableObject*>> Pools;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AMoveableObject;
+
+// State flags for a part in the part registry
+enum class EPartFlags : uint8
+{
+	None = 0,
+	Grabbed = 1 << 0,
+	Fusing = 1 << 1,
+	Asleep = 1 << 2,
+	Reduced = 1 << 3,
+	Frozen = 1 << 4,
+};
+ENUM_CLASS_FLAGS(EPartFlags);
+
+/**
+ * Dense structure of arrays storage for every moveable object in a world. Transforms, velocities and bounds are copied from physics once per frame,
+ * so passes over every part read contiguous arrays instead of going through each actor and its components. Groups that change are recorded as
+ * they change, so passes that only care about changed groups do not have to look at every part
+ */
+class TOTK_BUILDSYSTEM_API FPartRegistry
+{
+public:
+	// Add an object to the registry in its own group
+	void Register(AMoveableObject* Part);
+
+	// Remove an object from the registry, moving the last part into its slot
+	void Unregister(AMoveableObject* Part);
+
+	// Copy the transform, velocity, bounds and sleep state of every part from physics
+	void Refresh();
+
+	// Get the number of registered parts
+	int32 Num() const { return Parts.Num(); }
+
+	// Get the slot of a part, or INDEX_NONE if it is not registered
+	int32 GetIndex(const AMoveableObject* Part) const;
+
+	// Create a new group id that no part is using yet
+	int32 NewGroupId() { return NextGroupId++; }
+
+	// Get the group id of a part, or INDEX_NONE if it is not registered
+	int32 GetGroupId(const AMoveableObject* Part) const;
+
+	// Move a part into a group
+	void SetGroupId(const AMoveableObject* Part, int32 GroupId);
+
+	// Set or clear flags on a part
+	void SetFlags(const AMoveableObject* Part, EPartFlags InFlags, bool bSet);
+
+	// Set or clear the sleep flag of the part in a slot, marking its group as changed if the part falls asleep or wakes up
+	void SetAsleep(int32 Index, bool bAsleep);
+
+	// Mark a group as changed, for passes that only revisit groups whose members, sleep or lock state have changed
+	void MarkGroupDirty(int32 GroupId);
+
+	// Get the memory allocated by the registry
+	SIZE_T GetAllocatedSize() const;
+
+	// Per part arrays, all indexed by the part's slot
+	TArray<AMoveableObject*> Parts;
+	TArray<FVector> Locations;
+	TArray<FQuat4f> Rotations;
+	TArray<FVector3f> LinearVelocities;
+	TArray<FVector3f> AngularVelocities;
+	TArray<FBox> Bounds;
+	TArray<int32> GroupIds;
+	TArray<EPartFlags> Flags;
+
+	// Number of frames in a row each part has been below the group sleep thresholds
+	TArray<uint16> SettledFrames;
+
+	// Groups whose members, sleep or lock state have changed since the structural model last took them
+	TSet<int32> DirtyGroupIds;
+
+private:
+	int32 NextGroupId = 0;
+};
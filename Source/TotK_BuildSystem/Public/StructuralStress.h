@@ -0,0 +1,144 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tasks/Task.h"
+#include "ConstraintLinkTable.h"
+
+class AMoveableObject;
+class UBuildSystemSubsystem;
+
+// Snapshot of the groups being evaluated, taken on the game thread so the evaluation can run without touching any part
+struct FStressSnapshot
+{
+	// A part of an evaluated group
+	struct FPart
+	{
+		// Part the snapshot was taken from, only handed back to the game thread, never read from other threads
+		AMoveableObject* Part = nullptr;
+
+		FVector Location = FVector::ZeroVector;
+		float Mass = 0.f;
+
+		// Held up by something other than the group, by world geometry just below it or by not simulating physics
+		bool bSupported = false;
+	};
+
+	// A link between two parts of the same group, by their index in the snapshot
+	struct FLink
+	{
+		FConstraintLinkHandle Handle;
+		int32 PartA = INDEX_NONE;
+		int32 PartB = INDEX_NONE;
+	};
+
+	// A group being evaluated, and the range of its parts and links in the snapshot
+	struct FGroup
+	{
+		int32 GroupId = INDEX_NONE;
+		int32 FirstPart = 0;
+		int32 NumParts = 0;
+		int32 FirstLink = 0;
+		int32 NumLinks = 0;
+	};
+
+	TArray<FPart> Parts;
+	TArray<FLink> Links;
+	TArray<FGroup> Groups;
+
+	// Empty the snapshot, keeping its memory
+	void Reset();
+
+	// Get the memory allocated by the snapshot
+	SIZE_T GetAllocatedSize() const { return Parts.GetAllocatedSize() + Links.GetAllocatedSize() + Groups.GetAllocatedSize(); }
+};
+
+/**
+ * Structural model of fused groups, evaluated on a worker thread from snapshots taken on the game thread. Each part's weight follows the shortest
+ * path of links down to a supported part, and each link carries the weight beyond it plus the bending moment of that weight about the link.
+ * Only groups that are awake or have changed since they were last evaluated are snapshot, up to a budget of parts each evaluation, and results
+ * are picked up on a later frame so the game thread never waits on the evaluation. Changed groups come from the part registry as they change,
+ * so while every group is asleep and unchanged an update does not look at any part
+ */
+class TOTK_BUILDSYSTEM_API FStructuralStress
+{
+public:
+	// Wait for any evaluation still running, as it reads the snapshot this owns
+	~FStructuralStress();
+
+	// Publish the stress of the last evaluation once it has finished, breaking the most stressed link of every group over the break load, then start evaluating the next groups that need it
+	void Update(UBuildSystemSubsystem& BuildSystem);
+
+	// Get the stress of a link from the last evaluation of its group, in kg of load, or 0 if it has not been evaluated or was broken by its stress
+	float GetLinkStress(FConstraintLinkHandle Handle) const;
+
+	// Check if an evaluation is still running
+	bool IsBusy() const { return Task.IsValid() && !Task.IsCompleted(); }
+
+	// Wait for the evaluation in flight to finish, for tests and benchmarks that need its result straight away
+	void WaitForEvaluation() const;
+
+	// Drop every published stress and start over, waiting for any evaluation still running
+	void Reset();
+
+	// Get the number of parts in the evaluation in flight or last evaluated
+	int32 NumSnapshotParts() const { return Snapshot.Parts.Num(); }
+
+	// Get the memory allocated by the snapshot, results and published stress
+	SIZE_T GetAllocatedSize() const;
+
+	// Work out the stress of every link in a snapshot, where a part's load reaches a support through the fewest links and links not on any part's path carry none. Safe to call from any thread
+	static void Solve(const FStressSnapshot& Snapshot, float LeverArm, TArray<float>& OutLinkStress);
+
+private:
+	// Publish the stress of the finished evaluation and break overloaded links
+	void Apply(UBuildSystemSubsystem& BuildSystem);
+
+	// Gather the size of every group waiting to be evaluated and whether it is awake, held, fusing or frozen from the part registry
+	void GatherGroupStates(const UBuildSystemSubsystem& BuildSystem);
+
+	// Snapshot the groups that need evaluating, returning false if none do
+	bool Capture(UBuildSystemSubsystem& BuildSystem);
+
+	// Stress published for a link, along with the generation of the link it was published for
+	struct FPublishedStress
+	{
+		uint32 Generation = 0;
+		float Stress = 0.f;
+	};
+
+	// State of a group gathered from its members every evaluation
+	struct FGroupState
+	{
+		int32 NumParts = 0;
+		bool bAwake = false;
+		bool bLocked = false;
+
+		// Index of the group in the snapshot, if it is being evaluated
+		int32 SnapshotGroup = INDEX_NONE;
+	};
+
+	FStressSnapshot Snapshot;
+	TArray<float> LinkStress;
+	bool bHasResult = false;
+
+	// Published stress, indexed by link table slot
+	TArray<FPublishedStress> PublishedStress;
+
+	// Groups waiting to be evaluated, from the groups the part registry saw change. Groups stay until they are evaluated asleep, as awake groups' supports may move
+	TSet<int32> PendingGroupIds;
+
+	// Every group is waiting to be evaluated, as when starting over, so the next snapshot looks at every part rather than the changed groups
+	bool bEvaluateAll = true;
+
+	// State of every waiting group and the order groups needing evaluation are taken in, reused every evaluation
+	TMap<int32, FGroupState> GroupStates;
+	TArray<int32> DirtyGroupIds;
+
+	// Index of every part in the snapshot while it is being taken, reused every evaluation
+	TMap<const AMoveableObject*, int32> SnapshotIndices;
+
+	// Group evaluated last, so groups are taken in turn when they do not all fit in the budget
+	int32 LastGroupId = INDEX_NONE;
+
+	UE::Tasks::FTask Task;
+};
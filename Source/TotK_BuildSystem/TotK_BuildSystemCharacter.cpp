@@ -11,11 +11,25 @@
 #include "EnhancedInputSubsystems.h"
 #include "InputActionValue.h"
 #include "Grabber.h"
+#include "BuildSystemSubsystem.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/FileManager.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
 
 #include "DebgugHelper.h"
 
 DEFINE_LOG_CATEGORY(LogTemplateCharacter);
 
+// Frame rate input is recorded at, which replays use as their fixed timestep
+static TAutoConsoleVariable<float> CVarInputTraceFrameRate(
+	TEXT("BuildSystem.InputTraceFrameRate"),
+	60.f,
+	TEXT("Fixed frame rate input traces are recorded and replayed at"));
+
 //////////////////////////////////////////////////////////////////////////
 // ATotK_BuildSystemCharacter
 
@@ -69,6 +83,20 @@ void ATotK_BuildSystemCharacter::BeginPlay()
 	// Initialize the camera height and depth variables
 	CameraBaseVec = CameraBoom->GetRelativeLocation();
 	CameraHoldingVec = FVector(CameraBaseVec.X + CameraDepthOffset, CameraBaseVec.Y + CameraWidthOffset, CameraBaseVec.Z + CameraHeightOffset);
+
+	// Headless perf runs replay a trace given on the command line, such as -ReplayInput=Saved/InputTraces/Bridge.inputtrace -ExitAfterReplay
+	FString ReplayFilename;
+	if (IsLocallyControlled() && FParse::Value(FCommandLine::Get(), TEXT("ReplayInput="), ReplayFilename)) {
+		StartInputReplay(ReplayFilename);
+	}
+}
+
+// Write out any input being recorded when the character leaves the world
+void ATotK_BuildSystemCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	StopInputTrace();
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -76,6 +104,10 @@ void ATotK_BuildSystemCharacter::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	if (InputTraceMode == EInputTraceMode::Replaying) {
+		ReplayInputFrame();
+	}
+
 	// If the camera should move for either grabbing or releasing, move to the correct spot
 	if (GrabberComponent) {
 		if (!GrabberComponent->IsHoldingObject() && CameraBoom->GetRelativeLocation() != CameraBaseVec) {
@@ -137,6 +169,8 @@ void ATotK_BuildSystemCharacter::SetupPlayerInputComponent(UInputComponent* Play
 
 void ATotK_BuildSystemCharacter::Move(const FInputActionValue& Value)
 {
+	if (!AcceptInput(EInputTraceAction::Move, Value)) return;
+
 	// input is a Vector2D
 	FVector2D MovementVector = Value.Get<FVector2D>();
 
@@ -160,6 +194,8 @@ void ATotK_BuildSystemCharacter::Move(const FInputActionValue& Value)
 
 void ATotK_BuildSystemCharacter::Look(const FInputActionValue& Value)
 {
+	if (!AcceptInput(EInputTraceAction::Look, Value)) return;
+
 	// input is a Vector2D
 	FVector2D LookAxisVector = Value.Get<FVector2D>();
 
@@ -174,6 +210,8 @@ void ATotK_BuildSystemCharacter::Look(const FInputActionValue& Value)
 // Grab objects
 void ATotK_BuildSystemCharacter::Grab(const FInputActionValue& value)
 {
+	if (!AcceptInput(EInputTraceAction::Grab, value)) return;
+
 	if (GrabberComponent) {
 		bIsGrabbing = true;
 		GrabberComponent->Grab();
@@ -183,6 +221,8 @@ void ATotK_BuildSystemCharacter::Grab(const FInputActionValue& value)
 // Release held objects
 void ATotK_BuildSystemCharacter::Release(const FInputActionValue& value)
 {
+	if (!AcceptInput(EInputTraceAction::Release, value)) return;
+
 	if (GrabberComponent) {
 		bIsGrabbing = false;
 		GrabberComponent->Release();
@@ -192,6 +232,8 @@ void ATotK_BuildSystemCharacter::Release(const FInputActionValue& value)
 // Rotate held objects to the left
 void ATotK_BuildSystemCharacter::RotateLeft(const FInputActionValue& value)
 {
+	if (!AcceptInput(EInputTraceAction::RotateLeft, value)) return;
+
 	if (GrabberComponent && GrabberComponent->IsHoldingObject()) {
 		GrabberComponent->RotateLeft();
 	}
@@ -200,6 +242,8 @@ void ATotK_BuildSystemCharacter::RotateLeft(const FInputActionValue& value)
 // Rotate held objects to the right
 void ATotK_BuildSystemCharacter::RotateRight(const FInputActionValue& value)
 {
+	if (!AcceptInput(EInputTraceAction::RotateRight, value)) return;
+
 	if (GrabberComponent && GrabberComponent->IsHoldingObject()) {
 		GrabberComponent->RotateRight();
 	}
@@ -208,6 +252,8 @@ void ATotK_BuildSystemCharacter::RotateRight(const FInputActionValue& value)
 // Rotate held objects up
 void ATotK_BuildSystemCharacter::RotateUp(const FInputActionValue& value)
 {
+	if (!AcceptInput(EInputTraceAction::RotateUp, value)) return;
+
 	if (GrabberComponent && GrabberComponent->IsHoldingObject()) {
 		GrabberComponent->RotateUp();
 	}
@@ -216,6 +262,8 @@ void ATotK_BuildSystemCharacter::RotateUp(const FInputActionValue& value)
 // Rotate held objects down
 void ATotK_BuildSystemCharacter::RotateDown(const FInputActionValue& value)
 {
+	if (!AcceptInput(EInputTraceAction::RotateDown, value)) return;
+
 	if (GrabberComponent && GrabberComponent->IsHoldingObject()) {
 		GrabberComponent->RotateDown();
 	}
@@ -224,6 +272,8 @@ void ATotK_BuildSystemCharacter::RotateDown(const FInputActionValue& value)
 // Move held objects towards player
 void ATotK_BuildSystemCharacter::MoveTowards(const FInputActionValue& value)
 {
+	if (!AcceptInput(EInputTraceAction::MoveTowards, value)) return;
+
 	if (GrabberComponent && GrabberComponent->IsHoldingObject()) {
 		GrabberComponent->MoveTowards();
 	}
@@ -232,7 +282,230 @@ void ATotK_BuildSystemCharacter::MoveTowards(const FInputActionValue& value)
 // Move held objects away from player
 void ATotK_BuildSystemCharacter::MoveAway(const FInputActionValue& value)
 {
+	if (!AcceptInput(EInputTraceAction::MoveAway, value)) return;
+
 	if (GrabberComponent && GrabberComponent->IsHoldingObject()) {
 		GrabberComponent->MoveAway();
 	}
-}
\ No newline at end of file
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Input traces
+
+// Start recording the player's input actions at a fixed timestep, writing them to a trace file once recording stops
+void ATotK_BuildSystemCharacter::StartInputRecording(const FString& Filename)
+{
+	StopInputTrace();
+
+	InputTrace = FInputTrace();
+	InputTrace.FixedDeltaTime = 1.f / FMath::Max(CVarInputTraceFrameRate.GetValueOnGameThread(), 1.f);
+	InputTrace.MapName = GetWorld()->GetMapName();
+	InputTrace.StartTransform = GetActorTransform();
+	InputTrace.StartControlRotation = Controller ? Controller->GetControlRotation() : GetActorRotation();
+
+	InputTraceFilename = Filename;
+	InputTraceMode = EInputTraceMode::Recording;
+	InputTraceStartFrame = GFrameCounter;
+	InputTraceStartTime = GetWorld()->GetTimeSeconds();
+
+	// Recording at the same fixed timestep a replay uses means every replayed frame sees the same input it was recorded with
+	BeginFixedTimeStep(InputTrace.FixedDeltaTime);
+
+	UE_LOG(LogTemplateCharacter, Display, TEXT("Recording input to %s"), *InputTraceFilename);
+}
+
+// Start replaying a recorded trace file at its fixed timestep, ignoring the player's own input until it finishes
+bool ATotK_BuildSystemCharacter::StartInputReplay(const FString& Filename)
+{
+	StopInputTrace();
+
+	if (!InputTrace.LoadFromFile(Filename)) {
+		UE_LOG(LogTemplateCharacter, Error, TEXT("Failed to read input trace %s"), *Filename);
+		return false;
+	}
+
+	if (InputTrace.MapName != GetWorld()->GetMapName()) {
+		UE_LOG(LogTemplateCharacter, Warning, TEXT("Input trace %s was recorded on %s, but is being replayed on %s"), *Filename, *InputTrace.MapName, *GetWorld()->GetMapName());
+	}
+
+	// Start from where the player was when recording started
+	SetActorTransform(InputTrace.StartTransform, false, nullptr, ETeleportType::ResetPhysics);
+	if (Controller) {
+		Controller->SetControlRotation(InputTrace.StartControlRotation);
+	}
+
+	InputTraceFilename = Filename;
+	InputTraceMode = EInputTraceMode::Replaying;
+	InputTraceStartFrame = GFrameCounter;
+	InputTraceStartTime = GetWorld()->GetTimeSeconds();
+	InputTraceStartSeconds = FPlatformTime::Seconds();
+	NextReplayEvent = 0;
+
+	BeginFixedTimeStep(InputTrace.FixedDeltaTime);
+
+	UE_LOG(LogTemplateCharacter, Display, TEXT("Replaying input from %s, %d events over %u frames"), *InputTraceFilename, InputTrace.Events.Num(), InputTrace.NumFrames());
+	return true;
+}
+
+// Stop recording or replaying input, writing out the trace if it was being recorded
+void ATotK_BuildSystemCharacter::StopInputTrace()
+{
+	if (InputTraceMode == EInputTraceMode::Recording) {
+		// Keep the frames after the last input, so a replay runs for as long as the recording did
+		InputTrace.Finish((uint32)(GFrameCounter - InputTraceStartFrame));
+
+		if (InputTrace.SaveToFile(InputTraceFilename)) {
+			UE_LOG(LogTemplateCharacter, Display, TEXT("Recorded %d input events over %u frames to %s"), InputTrace.Events.Num(), InputTrace.NumFrames(), *InputTraceFilename);
+		}
+
+		else {
+			UE_LOG(LogTemplateCharacter, Error, TEXT("Failed to write input trace %s"), *InputTraceFilename);
+		}
+	}
+
+	if (InputTraceMode != EInputTraceMode::None) {
+		EndFixedTimeStep();
+	}
+	InputTraceMode = EInputTraceMode::None;
+}
+
+// Check if input for an action should be handled, recording it if input is being recorded. The player's own input is ignored while a trace is replayed
+bool ATotK_BuildSystemCharacter::AcceptInput(EInputTraceAction Action, const FInputActionValue& Value)
+{
+	if (InputTraceMode == EInputTraceMode::Replaying) {
+		return bDispatchingReplay;
+	}
+
+	if (InputTraceMode == EInputTraceMode::Recording) {
+		InputTrace.Add((uint32)(GFrameCounter - InputTraceStartFrame), (float)(GetWorld()->GetTimeSeconds() - InputTraceStartTime), Action, FVector2f(Value.Get<FVector2D>()));
+	}
+
+	return true;
+}
+
+// Feed the recorded actions of the current frame into the input handlers, finishing the replay after the last recorded frame
+void ATotK_BuildSystemCharacter::ReplayInputFrame()
+{
+	const uint32 Frame = (uint32)(GFrameCounter - InputTraceStartFrame);
+
+	TGuardValue<bool> DispatchingReplay(bDispatchingReplay, true);
+	while (InputTrace.Events.IsValidIndex(NextReplayEvent) && InputTrace.Events[NextReplayEvent].Frame <= Frame) {
+		const FInputTraceEvent& Event = InputTrace.Events[NextReplayEvent++];
+		DispatchInput(Event.Action, FInputTrace::HasAxisValue(Event.Action) ? FInputActionValue(FVector2D(Event.Value)) : FInputActionValue(true));
+	}
+
+	if (Frame >= InputTrace.NumFrames()) {
+		ReportInputReplay();
+		StopInputTrace();
+
+		if (FParse::Param(FCommandLine::Get(), TEXT("ExitAfterReplay"))) {
+			FPlatformMisc::RequestExit(false);
+		}
+	}
+}
+
+// Call the input handler of an action
+void ATotK_BuildSystemCharacter::DispatchInput(EInputTraceAction Action, const FInputActionValue& Value)
+{
+	switch (Action) {
+	case EInputTraceAction::Move:			Move(Value); break;
+	case EInputTraceAction::Look:			Look(Value); break;
+	case EInputTraceAction::Grab:			Grab(Value); break;
+	case EInputTraceAction::Release:		Release(Value); break;
+	case EInputTraceAction::RotateLeft:		RotateLeft(Value); break;
+	case EInputTraceAction::RotateRight:	RotateRight(Value); break;
+	case EInputTraceAction::RotateUp:		RotateUp(Value); break;
+	case EInputTraceAction::RotateDown:		RotateDown(Value); break;
+	case EInputTraceAction::MoveTowards:	MoveTowards(Value); break;
+	case EInputTraceAction::MoveAway:		MoveAway(Value); break;
+	default: break;
+	}
+}
+
+// Log how long the replay took along with a checksum of every part's location, and add them to the replay results file so runs can be compared
+void ATotK_BuildSystemCharacter::ReportInputReplay()
+{
+	const uint32 NumFrames = InputTrace.NumFrames();
+	const double MsPerFrame = NumFrames > 0 ? (FPlatformTime::Seconds() - InputTraceStartSeconds) * 1000.0 / NumFrames : 0.0;
+
+	// Locations are rounded to a millimetre, so a replay that ends with every part in the same place has the same checksum
+	uint32 Checksum = 0;
+	if (UBuildSystemSubsystem* BuildSystem = GetWorld()->GetSubsystem<UBuildSystemSubsystem>()) {
+		for (const FVector& Location : BuildSystem->GetPartRegistry().Locations) {
+			const FIntVector Rounded(FMath::RoundToInt(Location.X * 10.0), FMath::RoundToInt(Location.Y * 10.0), FMath::RoundToInt(Location.Z * 10.0));
+			Checksum = FCrc::MemCrc32(&Rounded, sizeof(Rounded), Checksum);
+		}
+	}
+
+	UE_LOG(LogTemplateCharacter, Display, TEXT("Replayed %s: %u frames, %.3f ms per frame, part checksum %08x"), *InputTraceFilename, NumFrames, MsPerFrame, Checksum);
+
+	const FString ResultsFilename = FPaths::ProfilingDir() / TEXT("InputReplays.csv");
+	if (!FPaths::FileExists(ResultsFilename)) {
+		FFileHelper::SaveStringToFile(TEXT("Date,Trace,Frames,MsPerFrame,PartChecksum\n"), *ResultsFilename);
+	}
+	FFileHelper::SaveStringToFile(FString::Printf(TEXT("%s,%s,%u,%.3f,%08x\n"), *FDateTime::Now().ToString(), *FPaths::GetCleanFilename(InputTraceFilename), NumFrames, MsPerFrame, Checksum),
+		*ResultsFilename, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+}
+
+// Use a fixed timestep while recording or replaying, restoring the previous timestep afterwards
+void ATotK_BuildSystemCharacter::BeginFixedTimeStep(float FixedDeltaTime)
+{
+	bPrevUseFixedTimeStep = FApp::UseFixedTimeStep();
+	PrevFixedDeltaTime = FApp::GetFixedDeltaTime();
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(FixedDeltaTime);
+}
+
+// Use a fixed timestep while recording or replaying, restoring the previous timestep afterwards
+void ATotK_BuildSystemCharacter::EndFixedTimeStep()
+{
+	FApp::SetUseFixedTimeStep(bPrevUseFixedTimeStep);
+	FApp::SetFixedDeltaTime(PrevFixedDeltaTime);
+}
+
+// Find the locally controlled build system character of a world
+static ATotK_BuildSystemCharacter* FindLocalCharacter(UWorld* World)
+{
+	APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+	return PlayerController ? Cast<ATotK_BuildSystemCharacter>(PlayerController->GetPawn()) : nullptr;
+}
+
+// Get the trace file named by a console command, or the default trace file if none was given
+static FString GetInputTraceFilename(const TArray<FString>& Args)
+{
+	const FString Name = Args.Num() > 0 ? Args[0] : TEXT("Session");
+	return FPaths::IsRelative(Name) && FPaths::GetExtension(Name).IsEmpty() ? FPaths::ProjectSavedDir() / TEXT("InputTraces") / Name + TEXT(".inputtrace") : Name;
+}
+
+// Console command - BuildSystem.RecordInput [Trace]
+static FAutoConsoleCommandWithWorldAndArgs RecordInputCommand(
+	TEXT("BuildSystem.RecordInput"),
+	TEXT("Start recording the player's input to a trace, named Session unless given"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World) {
+		if (ATotK_BuildSystemCharacter* Character = FindLocalCharacter(World)) {
+			Character->StartInputRecording(GetInputTraceFilename(Args));
+		}
+	})
+);
+
+// Console command - BuildSystem.ReplayInput [Trace]
+static FAutoConsoleCommandWithWorldAndArgs ReplayInputCommand(
+	TEXT("BuildSystem.ReplayInput"),
+	TEXT("Replay a recorded input trace, named Session unless given"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World) {
+		if (ATotK_BuildSystemCharacter* Character = FindLocalCharacter(World)) {
+			Character->StartInputReplay(GetInputTraceFilename(Args));
+		}
+	})
+);
+
+// Console command - BuildSystem.StopInput
+static FAutoConsoleCommandWithWorldAndArgs StopInputCommand(
+	TEXT("BuildSystem.StopInput"),
+	TEXT("Stop recording or replaying input, writing out the trace if it was being recorded"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World) {
+		if (ATotK_BuildSystemCharacter* Character = FindLocalCharacter(World)) {
+			Character->StopInputTrace();
+		}
+	})
+);
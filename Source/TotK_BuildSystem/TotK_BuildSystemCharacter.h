@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "Logging/LogMacros.h"
+#include "InputTrace.h"
 #include "TotK_BuildSystemCharacter.generated.h"
 
 class USpringArmComponent;
@@ -106,6 +107,19 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "CameraOnGrab")
 	float CameraHeightOffset = 125.f;
 
+	// Start recording the player's input actions at a fixed timestep, writing them to a trace file once recording stops
+	void StartInputRecording(const FString& Filename);
+
+	// Start replaying a recorded trace file at its fixed timestep, ignoring the player's own input until it finishes
+	bool StartInputReplay(const FString& Filename);
+
+	// Stop recording or replaying input, writing out the trace if it was being recorded
+	void StopInputTrace();
+
+	// Check if input is being recorded or replayed
+	bool IsRecordingInput() const { return InputTraceMode == EInputTraceMode::Recording; }
+	bool IsReplayingInput() const { return InputTraceMode == EInputTraceMode::Replaying; }
+
 protected:
 
 	/** Called for movement input */
@@ -138,6 +152,18 @@ protected:
 	/** Called for moving away input */
 	void MoveAway(const FInputActionValue& value);
 
+	// Check if input for an action should be handled, recording it if input is being recorded. The player's own input is ignored while a trace is replayed
+	bool AcceptInput(EInputTraceAction Action, const FInputActionValue& Value);
+
+	// Feed the recorded actions of the current frame into the input handlers, finishing the replay after the last recorded frame
+	void ReplayInputFrame();
+
+	// Call the input handler of an action
+	void DispatchInput(EInputTraceAction Action, const FInputActionValue& Value);
+
+	// Log how long the replay took along with a checksum of every part's location, and add them to the replay results file so runs can be compared
+	void ReportInputReplay();
+
 protected:
 	// APawn interface
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
@@ -145,12 +171,45 @@ protected:
 	// To add mapping context
 	virtual void BeginPlay() override;
 
+	// Write out any input being recorded when the character leaves the world
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
 private:
 	UGrabber* GrabberComponent;
 
+	// Whether input is being recorded or replayed
+	enum class EInputTraceMode : uint8
+	{
+		None,
+		Recording,
+		Replaying
+	};
+
+	// Use a fixed timestep while recording or replaying, restoring the previous timestep afterwards
+	void BeginFixedTimeStep(float FixedDeltaTime);
+	void EndFixedTimeStep();
+
+	// Trace being recorded or replayed, and the file it is written to or was read from
+	FInputTrace InputTrace;
+	FString InputTraceFilename;
+	EInputTraceMode InputTraceMode = EInputTraceMode::None;
+
+	// Frame, world time and wall clock time the trace started at
+	uint64 InputTraceStartFrame = 0;
+	double InputTraceStartTime = 0.0;
+	double InputTraceStartSeconds = 0.0;
+
+	// Next event to replay, and whether the input handlers are being called by the replay instead of the player
+	int32 NextReplayEvent = 0;
+	bool bDispatchingReplay = false;
+
+	// Timestep in use before recording or replaying started
+	bool bPrevUseFixedTimeStep = false;
+	double PrevFixedDeltaTime = 0.0;
+
 public:
 	/** Returns CameraBoom subobject **/
 	FORCEINLINE class USpringArmComponent* GetCameraBoom() const { return CameraBoom; }